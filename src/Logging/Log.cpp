@@ -0,0 +1,161 @@
+#include "Log.h"
+#include <atomic>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+// === Ring Buffer ===
+// Bounded MPSC queue (Vyukov): each slot carries a sequence number. A producer
+// may fill slot pos once seq == pos and publishes it with seq = pos + 1; the
+// drain task frees it again with seq = pos + LOG_RING_SLOTS. Producers only
+// contend on one CAS of the head index, never on a lock.
+static LogRecord slots[LOG_RING_SLOTS];
+static std::atomic<uint32_t> slotSeq[LOG_RING_SLOTS];
+static std::atomic<uint32_t> head(0);   // Next position to claim
+static uint32_t tail = 0;               // Next position to drain (drain task only)
+static std::atomic<uint32_t> dropped(0);
+static volatile bool binaryMode = false;
+static bool initialized = false;
+
+static const char* LEVEL_NAMES[] = {"", "ERROR", "WARN", "INFO", "DEBUG"};
+
+static void ringInit() {
+    if (initialized) return;
+    for (uint32_t i = 0; i < LOG_RING_SLOTS; i++) {
+        slotSeq[i].store(i, std::memory_order_relaxed);
+    }
+    initialized = true;
+}
+
+bool logClaim(LogRecord*& slot, uint32_t& pos) {
+    if (!initialized) ringInit(); // Logging before logInit() (static init, early boot)
+    pos = head.load(std::memory_order_relaxed);
+    for (;;) {
+        uint32_t seq = slotSeq[pos & (LOG_RING_SLOTS - 1)].load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed); // Full
+            return false;
+        } else {
+            pos = head.load(std::memory_order_relaxed); // Another producer got there first
+        }
+    }
+    slot = &slots[pos & (LOG_RING_SLOTS - 1)];
+    return true;
+}
+
+void logPublish(uint32_t pos) {
+    slotSeq[pos & (LOG_RING_SLOTS - 1)].store(pos + 1, std::memory_order_release);
+}
+
+// Format one record as text. Mirrors the conversions handled by tools/log_decode.py.
+static size_t formatRecord(const LogRecord& r, char* out, size_t len) {
+    int n = snprintf(out, len, "[%5lu.%03lu] [%s] ", (unsigned long)(r.timestampUs / 1000000),
+                     (unsigned long)((r.timestampUs / 1000) % 1000), (r.level <= LOG_LEVEL_DEBUG) ? LEVEL_NAMES[r.level] : "?");
+    size_t pos = (n > 0) ? (size_t)n : 0;
+    int arg = 0;
+    for (const char* p = r.fmt; *p && pos < len - 2; p++) {
+        if (*p != '%') { out[pos++] = *p; continue; }
+        if (p[1] == '%') { out[pos++] = '%'; p++; continue; }
+
+        // Copy flags/width/precision, drop length modifiers
+        char spec[16];
+        size_t s = 0;
+        spec[s++] = *p++;
+        while (*p && strchr("-+ #0123456789.", *p) && s < sizeof(spec) - 2) spec[s++] = *p++;
+        while (*p && strchr("hlzjtL", *p)) p++;
+        if (!*p) break;
+        char conv = *p;
+        spec[s++] = conv;
+        spec[s] = '\0';
+
+        uint32_t raw = (arg < r.argc) ? r.args[arg] : 0;
+        arg++;
+        switch (conv) {
+            case 'd': case 'i': case 'c':
+                n = snprintf(out + pos, len - pos, spec, (int)(int32_t)raw); break;
+            case 'u': case 'x': case 'X': case 'o':
+                n = snprintf(out + pos, len - pos, spec, (unsigned)raw); break;
+            case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': {
+                float f;
+                memcpy(&f, &raw, sizeof(f));
+                n = snprintf(out + pos, len - pos, spec, (double)f); break;
+            }
+            case 's':
+                n = snprintf(out + pos, len - pos, spec, (raw < LOG_STR_BYTES) ? r.str + raw : "?"); break;
+            default:
+                n = snprintf(out + pos, len - pos, "%s", spec); break;
+        }
+        if (n > 0) pos += ((size_t)n < len - pos) ? (size_t)n : len - pos - 1;
+    }
+    if (pos > len - 2) pos = len - 2;
+    out[pos++] = '\n';
+    out[pos] = '\0';
+    return pos;
+}
+
+// Raw frame: sync, size, then the record fields little-endian (fmt as a 32-bit address)
+static size_t encodeRecord(const LogRecord& r, uint8_t* out) {
+    size_t pos = 2;
+    uint32_t fmtAddr = (uint32_t)(uintptr_t)r.fmt;
+    memcpy(out + pos, &r.timestampUs, 4); pos += 4;
+    memcpy(out + pos, &fmtAddr, 4); pos += 4;
+    out[pos++] = r.level;
+    out[pos++] = r.argc;
+    out[pos++] = r.strUsed;
+    memcpy(out + pos, r.args, r.argc * 4); pos += r.argc * 4;
+    memcpy(out + pos, r.str, r.strUsed); pos += r.strUsed;
+    out[0] = LOG_FRAME_SYNC;
+    out[1] = (uint8_t)(pos - 2);
+    return pos;
+}
+
+static void drainTask(void*) {
+    static char text[256];
+    static uint8_t frame[2 + 11 + LOG_MAX_ARGS * 4 + LOG_STR_BYTES];
+    uint32_t reportedDrops = 0;
+    for (;;) {
+        bool any = false;
+        for (;;) {
+            uint32_t seq = slotSeq[tail & (LOG_RING_SLOTS - 1)].load(std::memory_order_acquire);
+            if (seq != tail + 1) break; // Nothing published at tail yet
+            const LogRecord& r = slots[tail & (LOG_RING_SLOTS - 1)];
+            // This task is the only one that may block on the UART
+            if (binaryMode) {
+                size_t n = encodeRecord(r, frame);
+                Serial.write(frame, n);
+            } else {
+                size_t n = formatRecord(r, text, sizeof(text));
+                Serial.write((const uint8_t*)text, n);
+            }
+            slotSeq[tail & (LOG_RING_SLOTS - 1)].store(tail + LOG_RING_SLOTS, std::memory_order_release);
+            tail++;
+            any = true;
+        }
+        uint32_t drops = dropped.load(std::memory_order_relaxed);
+        if (drops != reportedDrops && !binaryMode) {
+            Serial.printf("[LOG] %lu entries dropped (ring full)\n", (unsigned long)(drops - reportedDrops));
+            reportedDrops = drops;
+        }
+        if (!any) vTaskDelay(pdMS_TO_TICKS(5));
+    }
+}
+
+void logInit() {
+    ringInit();
+    // Lowest useful priority on the core not running loop()
+    xTaskCreatePinnedToCore(drainTask, "logDrain", 3072, NULL, tskIDLE_PRIORITY + 1, NULL, 0);
+}
+
+void logSetBinary(bool binary) {
+    binaryMode = binary;
+}
+
+bool logIsBinary() {
+    return binaryMode;
+}
+
+uint32_t logDroppedCount() {
+    return dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,132 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+#include <type_traits>
+
+// === Deferred Logging ===
+// LOGE/LOGW/LOGI/LOGD record a fixed-size binary entry (timestamp, format
+// string address, raw 32-bit args, copied %s strings) into a lock-free ring
+// and return immediately. A low-priority task drains the ring to Serial,
+// either formatted as text or as raw frames for tools/log_decode.py, so the
+// callers never wait on the UART.
+//
+// Format strings must be string literals (only their address is stored).
+// Supported conversions: d i u x X o c s f F e E g G and %%; length
+// modifiers (l, h, z) are accepted and ignored - every arg is 32 bits.
+// The trailing newline is added by the logger.
+
+#define LOG_LEVEL_NONE  0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN  2
+#define LOG_LEVEL_INFO  3
+#define LOG_LEVEL_DEBUG 4
+
+// Entries above this level are compiled out entirely (override with -DLOG_COMPILE_LEVEL=n)
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_RING_SLOTS 128  // Must be a power of two
+#define LOG_MAX_ARGS 8
+#define LOG_STR_BYTES 48    // Space for copied %s arguments per entry (NUL-separated)
+
+// Raw frame written in binary mode: LOG_FRAME_SYNC, then the fields below
+// little-endian. See tools/log_decode.py.
+#define LOG_FRAME_SYNC 0xA5
+
+struct LogRecord {
+    uint32_t timestampUs;
+    const char* fmt;               // Address of the format literal (flash)
+    uint8_t level;
+    uint8_t argc;
+    uint8_t strUsed;               // Bytes of str[] in use
+    uint8_t reserved;
+    uint32_t args[LOG_MAX_ARGS];   // Ints as-is, floats as IEEE bits, strings as offset into str[]
+    char str[LOG_STR_BYTES];
+};
+
+/**
+ * @brief Start the drain task. Entries logged earlier are kept and printed once it runs.
+ */
+void logInit();
+
+/**
+ * @brief Switch the Serial output between text and raw binary frames.
+ */
+void logSetBinary(bool binary);
+bool logIsBinary();
+
+/**
+ * @brief Number of entries dropped because the ring was full.
+ */
+uint32_t logDroppedCount();
+
+// --- Internal: used by the LOGx macros ---
+bool logClaim(LogRecord*& slot, uint32_t& pos);
+void logPublish(uint32_t pos);
+
+inline void logPackArg(LogRecord& r, const char* s) {
+    if (!s) s = "(null)";
+    r.args[r.argc++] = r.strUsed;
+    size_t room = LOG_STR_BYTES - r.strUsed;
+    if (room == 0) { r.args[r.argc - 1] = LOG_STR_BYTES - 1; return; } // Points at the final NUL
+    // Byte loop rather than strnlen(): the bound is the ring slot, not the source
+    // array, and strnlen() with a bound past a short array is an overread warning
+    size_t n = 0;
+    for (; n < room - 1 && s[n]; n++) r.str[r.strUsed + n] = s[n];
+    r.str[r.strUsed + n] = '\0';
+    r.strUsed += (uint8_t)(n + 1);
+}
+inline void logPackArg(LogRecord& r, char* s) { logPackArg(r, (const char*)s); }
+inline void logPackArg(LogRecord& r, float v) { memcpy(&r.args[r.argc++], &v, sizeof(v)); }
+inline void logPackArg(LogRecord& r, double v) { logPackArg(r, (float)v); }
+template <typename T>
+inline void logPackArg(LogRecord& r, T v) {
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                  "Unsupported log argument type");
+    static_assert(!(std::is_pointer<T>::value &&
+                    std::is_same<typename std::remove_cv<typename std::remove_pointer<T>::type>::type, uint8_t>::value),
+                  "Cast uint8_t* to (const char*) to log it as a string");
+    r.args[r.argc++] = (uint32_t)(uintptr_t)v;
+}
+
+template <typename... Args>
+inline void logWrite(uint8_t level, const char* fmt, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments");
+    LogRecord* r;
+    uint32_t pos;
+    if (!logClaim(r, pos)) return; // Ring full: counted as dropped
+    r->timestampUs = micros();
+    r->fmt = fmt;
+    r->level = level;
+    r->argc = 0;
+    r->strUsed = 0;
+    r->str[LOG_STR_BYTES - 1] = '\0';
+    int expand[] = {0, (logPackArg(*r, args), 0)...};
+    (void)expand;
+    logPublish(pos);
+}
+
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_ERROR
+#define LOGE(fmt, ...) logWrite(LOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define LOGE(fmt, ...) do {} while (0)
+#endif
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_WARN
+#define LOGW(fmt, ...) logWrite(LOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#else
+#define LOGW(fmt, ...) do {} while (0)
+#endif
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_INFO
+#define LOGI(fmt, ...) logWrite(LOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define LOGI(fmt, ...) do {} while (0)
+#endif
+#if LOG_COMPILE_LEVEL >= LOG_LEVEL_DEBUG
+#define LOGD(fmt, ...) logWrite(LOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define LOGD(fmt, ...) do {} while (0)
+#endif
+
+#endif // LOG_H
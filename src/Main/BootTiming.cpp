@@ -0,0 +1,42 @@
+#include "BootTiming.h"
+
+static const char* PHASE_NAMES[BOOT_PHASE_COUNT] = {
+    "settings", "actuators", "steppers", "homing", "wifiLink", "services"
+};
+
+static uint32_t phaseStartUs[BOOT_PHASE_COUNT] = {0};
+static uint32_t phaseEndUs[BOOT_PHASE_COUNT] = {0};   // 0 = not finished
+static bool phaseStarted[BOOT_PHASE_COUNT] = {false};
+
+void bootPhaseBegin(BootPhase phase) {
+    if (phase >= BOOT_PHASE_COUNT || phaseStarted[phase]) return; // Only the first run counts
+    phaseStartUs[phase] = micros();
+    phaseStarted[phase] = true;
+}
+
+void bootPhaseEnd(BootPhase phase) {
+    if (phase >= BOOT_PHASE_COUNT || !phaseStarted[phase] || phaseEndUs[phase] != 0) return;
+    phaseEndUs[phase] = micros();
+    Serial.printf("[BOOT] %-9s started at %5lu ms, took %5lu ms\n", PHASE_NAMES[phase],
+                  (unsigned long)(phaseStartUs[phase] / 1000),
+                  (unsigned long)((phaseEndUs[phase] - phaseStartUs[phase]) / 1000));
+}
+
+int bootTimingWriteJson(char* buf, size_t len) {
+    int pos = snprintf(buf, len, "\"boot\":{");
+    if (pos < 0 || (size_t)pos >= len) return -1;
+    bool first = true;
+    for (int i = 0; i < BOOT_PHASE_COUNT; i++) {
+        if (!phaseStarted[i]) continue;
+        long ms = phaseEndUs[i] ? (long)((phaseEndUs[i] - phaseStartUs[i]) / 1000) : -1;
+        int n = snprintf(buf + pos, len - pos, "%s\"%s\":{\"at\":%lu,\"ms\":%ld}", first ? "" : ",",
+                         PHASE_NAMES[i], (unsigned long)(phaseStartUs[i] / 1000), ms);
+        if (n < 0 || (size_t)n >= len - pos) return -1;
+        pos += n;
+        first = false;
+    }
+    if ((size_t)pos + 1 >= len) return -1;
+    buf[pos++] = '}';
+    buf[pos] = '\0';
+    return pos;
+}
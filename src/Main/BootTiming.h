@@ -0,0 +1,37 @@
+#ifndef BOOT_TIMING_H
+#define BOOT_TIMING_H
+
+#include <Arduino.h>
+
+// === Boot Phase Timing ===
+// Start offset and duration of each startup phase, measured from reset.
+// Phases overlap (WiFi connects while the machine homes), so both are kept.
+// Logged as each phase ends and reported in full status snapshots.
+
+enum BootPhase {
+    BOOT_SETTINGS = 0,   // NVS settings + recipe filesystem
+    BOOT_ACTUATORS,      // Servo, paint gun, pneumatics
+    BOOT_STEPPERS,       // FastAccelStepper engine + axis setup
+    BOOT_HOMING,         // Initial homeAllAxes()
+    BOOT_WIFI_LINK,      // WiFi.begin() until the first connection
+    BOOT_SERVICES,       // OTA, HTTP and WebSocket servers
+    BOOT_PHASE_COUNT
+};
+
+/**
+ * @brief Mark the start of a boot phase.
+ */
+void bootPhaseBegin(BootPhase phase);
+
+/**
+ * @brief Mark the end of a boot phase and log its duration.
+ */
+void bootPhaseEnd(BootPhase phase);
+
+/**
+ * @brief Write "boot":{"<phase>":{"at":ms,"ms":ms},...} (unfinished phases have "ms":-1).
+ * @return Length written, or -1 if buf is too small.
+ */
+int bootTimingWriteJson(char* buf, size_t len);
+
+#endif // BOOT_TIMING_H
@@ -6,6 +6,7 @@
 #include <Bounce2.h>
 #include <WebServer.h>
 #include <WebSocketsServer.h>
+#include "../Web/BufferedWebSocketsServer.h"
 #include <ESP32Servo.h>
 
 // =====================
@@ -110,6 +111,7 @@ extern float patternRotAccel;    // Accel for Rotation moves within patterns (st
 
 // Inputs
 #define PNP_CYCLE_BUTTON_PIN 17
+#define ESTOP_PIN 14              // Emergency stop: NO contact to GND (internal pull-up, asserted LOW)
 
 // =====================
 // Pick and Place Settings -- MOVED TO PickPlaceSettings.h
@@ -170,7 +172,7 @@ extern FastAccelStepper *stepper_rot;
 
 // Web Server & Socket
 extern WebServer webServer;
-extern WebSocketsServer webSocket;
+extern BufferedWebSocketsServer webSocket;
 
 // Servos
 extern Servo servo_pitch;
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <FastAccelStepper.h>
 #include <WebSocketsServer.h>
+#include "../Web/BufferedWebSocketsServer.h"
 #include <Preferences.h> // Needed for Preferences object if shared
 #include <Bounce2.h>
 #include <ESP32Servo.h> // Include Servo for servo object declaration
@@ -18,10 +19,11 @@ extern FastAccelStepper *stepper_z;
 extern FastAccelStepper *stepper_rot;
 
 // WebSocket Server
-extern WebSocketsServer webSocket;
+extern BufferedWebSocketsServer webSocket;
 
 // Control/State Flags
 extern volatile bool stopRequested;
+extern volatile bool pauseRequested; // PAUSE: the toolpath executor stops at the next chance and checkpoints
 extern volatile bool isMoving; // Used by many functions
 extern bool allHomed;
 extern volatile bool isHoming;
@@ -34,6 +36,8 @@ extern volatile int currentPaintStep; // Current step in the painting state mach
 extern volatile int currentPaintSide; // Current side being painted in the sequence
 extern volatile bool isPaintSequence; // Flag for multi-side painting sequence
 extern volatile bool paintNextSide;   // Signal to move to the next side in the sequence
+extern volatile bool isPaintPaused;   // Painting held at a checkpoint until RESUME or STOP
+extern volatile bool macroRunning;    // RUN_MACRO is replaying a stored macro
 
 // PnP/Grid/Tray Settings (Potentially needed by patterns/actions)
 extern const float pnpItemWidth_inch;
@@ -65,6 +69,10 @@ extern float patternZAccel; // General Z accel
 // Painting Specific Settings (Arrays) - Defined in main.cpp
 extern float paintStartX[4]; // NEW: Start X for each side
 extern float paintStartY[4]; // NEW: Start Y for each side
+extern float paintSprayWidth_inch[4];  // Spray fan width per side (0 = one pass per item)
+extern float paintSprayOverlap_pct[4]; // Required overlap between passes (% of fan width)
+extern int paintSweepOvertravel;        // 1 = sweeps get a v^2/2a run-in/run-out, gun on only across the items
+extern volatile int paintFeedOverride_pct; // Live XY feed override (FEED_OVERRIDE_MIN_PCT..MAX), not persisted
 
 // Core Constants
 // REMOVED - These are #defined in GeneralSettings_PinDef.h
@@ -92,9 +100,14 @@ extern Preferences preferences;
 
 void moveToXYPositionInches_Paint(float targetX_inch, float targetY_inch, float speedHz, float accel);
 void moveZToPositionInches(float targetZ_inch, float speedHz, float accel);
+void moveToXYPositionSteps_Paint(long targetX_steps, long targetY_steps, float speedHz, float accel);
+void startXYPositionSteps_Paint(long targetX_steps, long targetY_steps, float speedHz, float accel); // Non-blocking
+void startXYLinearSteps_Paint(long targetX_steps, long targetY_steps, float speedHz, float accel); // Non-blocking, straight line
+bool isXYPaintMoveRunning();
+void moveZToPositionSteps(long targetZ_steps, float speedHz, float accel);
 void rotateToAbsoluteDegree(int targetDegree);
 void sendCurrentPositionUpdate(); // For updating UI after moves
-void startPaintingSide(int sideIndex, bool isSequence = false); // Function to start painting a side
+void startPaintingSide(int sideIndex, bool isSequence = false, bool resume = false); // Function to start painting a side
 void processPaintingStateMachine(); // Function to process painting state machine steps
 
 // Potentially others if needed by actions/patterns, e.g.:
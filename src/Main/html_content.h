@@ -94,6 +94,13 @@ const char HTML_PROGMEM[] PROGMEM = R"rawliteral(
   <button id="gotoButton" class="button" onclick="sendCommand('GOTO_5_5_0')">Go to (5, 5, 0)</button>
   <button id="gotoButton2020" class="button" onclick="sendCommand('GOTO_20_20_0')">Go to (20, 20, 0)</button>
   <button class="button exit-button" onclick="sendCommand('STOP')" style="margin-left: 20px;">STOP</button>
+  <button class="button exit-button" onclick="sendCommand('ESTOP')">E-STOP</button>
+  <button class="button" onclick="sendCommand('ESTOP_RESET')">Reset E-Stop</button>
+  <button class="button" onclick="sendCommand('PAUSE')">Pause</button>
+  <button class="button" onclick="sendCommand('RESUME')">Resume</button>
+  <label for="feedOverrideInput" style="margin-left: 20px;">Feed %:</label>
+  <input type="number" id="feedOverrideInput" min="25" max="200" step="5" value="100" style="width: 60px;">
+  <button class="button" onclick="sendCommand('SET_FEED_OVERRIDE ' + document.getElementById('feedOverrideInput').value)">Set Feed</button>
   <hr>
 
   <!-- == Mode Selection / High-Level Actions == -->
@@ -229,6 +236,8 @@ const char HTML_PROGMEM[] PROGMEM = R"rawliteral(
         <select id="paintR_0" onchange="setPaintSideSettings(0)">
           <option value="0" selected>Up-Down</option>
           <option value="90">Sideways</option>
+          <option value="45">Diagonal 45&deg;</option>
+          <option value="135">Diagonal 135&deg;</option>
         </select>
         <label for="paintS_0">Speed:</label>
         <input type="range" id="paintS_0" min="5" max="25" value="20" step="1" oninput="updateSliderDisplay('paintS_0')" onchange="setPaintSideSettings(0)">
@@ -247,6 +256,8 @@ const char HTML_PROGMEM[] PROGMEM = R"rawliteral(
         <select id="paintR_2" onchange="setPaintSideSettings(2)">
           <option value="0" selected>Up-Down</option>
           <option value="90">Sideways</option>
+          <option value="45">Diagonal 45&deg;</option>
+          <option value="135">Diagonal 135&deg;</option>
         </select>
         <label for="paintS_2">Speed:</label>
         <input type="range" id="paintS_2" min="5" max="25" value="20" step="1" oninput="updateSliderDisplay('paintS_2')" onchange="setPaintSideSettings(2)">
@@ -265,6 +276,8 @@ const char HTML_PROGMEM[] PROGMEM = R"rawliteral(
         <select id="paintR_3" onchange="setPaintSideSettings(3)">
           <option value="0">Up-Down</option>
           <option value="90" selected>Sideways</option>
+          <option value="45">Diagonal 45&deg;</option>
+          <option value="135">Diagonal 135&deg;</option>
         </select>
         <label for="paintS_3">Speed:</label>
         <input type="range" id="paintS_3" min="5" max="25" value="20" step="1" oninput="updateSliderDisplay('paintS_3')" onchange="setPaintSideSettings(3)">
@@ -283,6 +296,8 @@ const char HTML_PROGMEM[] PROGMEM = R"rawliteral(
         <select id="paintR_1" onchange="setPaintSideSettings(1)">
           <option value="0">Up-Down</option>
           <option value="90" selected>Sideways</option>
+          <option value="45">Diagonal 45&deg;</option>
+          <option value="135">Diagonal 135&deg;</option>
         </select>
         <label for="paintS_1">Speed:</label>
         <input type="range" id="paintS_1" min="5" max="25" value="20" step="1" oninput="updateSliderDisplay('paintS_1')" onchange="setPaintSideSettings(1)">
@@ -371,36 +386,36 @@ const char HTML_PROGMEM[] PROGMEM = R"rawliteral(
           <div class="input-group-start">
             <h4>Back (Side 0)</h4>
             <label for="paintStartX_0">Start X:</label>
-            <input type="number" id="paintStartX_0" step="0.1" value="11.5"> <!-- Default example -->
+            <input type="number" id="paintStartX_0" step="0.1" value="25.0"> <!-- Default from code -->
             <label for="paintStartY_0">Start Y:</label>
-            <input type="number" id="paintStartY_0" step="0.1" value="20.5"> <!-- Default example -->
+            <input type="number" id="paintStartY_0" step="0.1" value="30.0"> <!-- Default from code -->
           </div>
 
           <!-- Right Side Start (Side 1) -->
           <div class="input-group-start">
             <h4>Right (Side 1)</h4>
             <label for="paintStartX_1">Start X:</label>
-            <input type="number" id="paintStartX_1" step="0.1" value="29.5"> <!-- Default from code -->
+            <input type="number" id="paintStartX_1" step="0.1" value="25.0"> <!-- Default from code -->
             <label for="paintStartY_1">Start Y:</label>
-            <input type="number" id="paintStartY_1" step="0.1" value="20.0"> <!-- Default from code -->
+            <input type="number" id="paintStartY_1" step="0.1" value="30.0"> <!-- Default from code -->
           </div>
           
           <!-- Front Side Start (Side 2) -->
           <div class="input-group-start">
             <h4>Front (Side 2)</h4>
             <label for="paintStartX_2">Start X:</label>
-            <input type="number" id="paintStartX_2" step="0.1" value="11.5"> <!-- Default from code -->
+            <input type="number" id="paintStartX_2" step="0.1" value="25.0"> <!-- Default from code -->
             <label for="paintStartY_2">Start Y:</label>
-            <input type="number" id="paintStartY_2" step="0.1" value="0.5"> <!-- Default from code -->
+            <input type="number" id="paintStartY_2" step="0.1" value="30.0"> <!-- Default from code -->
           </div>
 
           <!-- Left Side Start (Side 3) -->
           <div class="input-group-start">
             <h4>Left (Side 3)</h4>
             <label for="paintStartX_3">Start X:</label>
-            <input type="number" id="paintStartX_3" step="0.1" value="8.0"> <!-- Default from code -->
+            <input type="number" id="paintStartX_3" step="0.1" value="25.0"> <!-- Default from code -->
             <label for="paintStartY_3">Start Y:</label>
-            <input type="number" id="paintStartY_3" step="0.1" value="6.5"> <!-- Default from code -->
+            <input type="number" id="paintStartY_3" step="0.1" value="30.0"> <!-- Default from code -->
           </div>
 
           <button class="button setting-button" onclick="setPaintStartPositions()" style="margin-top: 15px;">Save Start Positions</button>
@@ -427,6 +442,10 @@ const char HTML_PROGMEM[] PROGMEM = R"rawliteral(
     var inCalibrationMode = false;
     var stopRequested = false;
     var isPressurePotOn = false; // Renamed state variable for pressure pot
+    var settingsEpoch = 0;   // Boot id of the settings we hold
+    var settingsVersion = 0; // Last settings version applied (0 = none)
+    var nextRequestId = 1;   // Commands go out as "#<id> COMMAND" and are acked with timestamps
+    var requestsSent = {};   // id -> performance.now() when sent
     
     // UI element references
     var homeButton = document.getElementById('homeButton');
@@ -610,7 +629,12 @@ const char HTML_PROGMEM[] PROGMEM = R"rawliteral(
       addDebug('WebSocket State: ' + websocket.readyState + ' (OPEN=1)');
       addDebug('Sending GET_STATUS command...');
       
-      sendCommand('GET_STATUS'); // Request current status from ESP32
+      if (settingsVersion > 0) {
+        // Reconnect: ask only for settings changed since the last version we saw
+        sendCommand(`GET_SETTINGS ${settingsEpoch} ${settingsVersion}`);
+      } else {
+        sendCommand('GET_STATUS'); // Request current status from ESP32
+      }
       enableButtons(); // Enable/disable buttons based on initial state (will be updated by GET_STATUS response)
     }
 
@@ -641,7 +665,34 @@ const char HTML_PROGMEM[] PROGMEM = R"rawliteral(
         console.log('Received: ', event.data);
         try {
             const data = JSON.parse(event.data);
-            statusDiv.innerHTML = `Status: ${data.status} - ${data.message}`;
+            // Status line; settings deltas, acks, telemetry and data replies (Toolpath, Profile...) leave it alone
+            if (typeof data.status === 'string' && typeof data.message === 'string') {
+                statusDiv.innerHTML = `Status: ${data.status} - ${data.message}`;
+            }
+
+            // Command ack: log the round trip and the part spent in the firmware
+            if (data.hasOwnProperty('ack')) {
+                const sentAt = requestsSent[data.ack];
+                if (data.state === 'done') delete requestsSent[data.ack];
+                const rttMs = sentAt !== undefined ? (performance.now() - sentAt).toFixed(1) : '?';
+                const endUs = data.state === 'done' ? data.doneUs : data.startUs;
+                addDebug(`Ack #${data.ack} ${data.cmd} ${data.state}${data.ok ? '' : ' (failed)'}: ${rttMs} ms round trip, ${((endUs - data.startUs) / 1000).toFixed(1)} ms in firmware`);
+                return;
+            }
+
+            // Track settings version (full snapshots have baseVersion 0, deltas the version they build on)
+            if (data.hasOwnProperty('settingsVersion')) {
+                let isSnapshot = (data.baseVersion === 0);
+                let inSequence = (data.settingsEpoch === settingsEpoch && data.baseVersion <= settingsVersion);
+                if (isSnapshot || inSequence) {
+                    settingsEpoch = data.settingsEpoch;
+                    settingsVersion = data.settingsVersion;
+                } else {
+                    // Different boot or a missed delta: resync with a full snapshot
+                    settingsVersion = 0;
+                    sendCommand('GET_SETTINGS');
+                }
+            }
 
             // --- Add JS Debugging ---
             console.log(`JS Debug: Received status='${data.status}'`);
@@ -670,6 +721,11 @@ const char HTML_PROGMEM[] PROGMEM = R"rawliteral(
                 updatePressurizeButtonUI();
             }
 
+            // Live feed override from the machine status object
+            if (data.status && typeof data.status === 'object' && data.status.hasOwnProperty('feedOverride')) {
+                document.getElementById('feedOverrideInput').value = data.status.feedOverride;
+            }
+
             // --- Update UI Elements based on data ---
             // Update offset display and inputs if offset info is present
             if (data.hasOwnProperty('pnpOffsetX') && data.hasOwnProperty('pnpOffsetY')) {
@@ -897,6 +953,11 @@ const char HTML_PROGMEM[] PROGMEM = R"rawliteral(
       }
       
       try {
+        if (command !== 'ESTOP') { // ESTOP stays bare for the firmware's fast path
+          const id = nextRequestId++;
+          requestsSent[id] = performance.now();
+          command = `#${id} ${command}`;
+        }
         websocket.send(command);
         console.log(`Command sent: ${command}`);
         return true;
@@ -8,6 +8,7 @@
 #include "../PickPlace/PickPlace.h" // Include the new PnP header
 #include "../Painting/Painting.h" // Include the new Painting header
 #include "../Painting/PaintGunControl.h" // Include the Paint Gun Control header
+#include "../Painting/PaintCheckpoint.h"
 #include "Web/WebHandler.h" // Include the new Web Handler header
 #include <ArduinoJson.h>
 #include "../Painting/Patterns/PredefinedPatterns.h" // <<< ADDED NEW INCLUDE
@@ -15,7 +16,22 @@
 #include "../PickPlace/PickPlace.h" // <<< CORRECTED PATH
 #include "../Painting/Patterns/PatternActions.h"
 #include "../Painting/Patterns/PaintPatterns_SideSpecific.h" // <<< INCLUDE NEW HEADER
+#include "../Painting/Patterns/ToolpathExecutor.h"
 #include "../Web/WebHandler.h"
+#include "../Settings/SettingsStore.h"
+#include "../Settings/SettingsSchema.h"
+#include "../Recipes/RecipeStore.h"
+#include "../Recipes/MacroStore.h"
+#include "../Web/NetworkManager.h"
+#include "../Web/CommandAck.h"
+#include "BootTiming.h"
+#include "../Logging/Log.h"
+#include "../Profiling/Profiler.h"
+#include "../Metrics/JobMetrics.h"
+#include "../Metrics/HeapMetrics.h"
+#include "../Metrics/Diagnostics.h"
+#include "../Motion/MotionWatchdog.h"
+#include "../Motion/EmergencyStop.h"
 
 // === Pin Definitions (Additions/Overrides if not in header) ===
 #define PRESSURE_PIN 13 // Added for pressure control
@@ -37,8 +53,14 @@ int paintPatternType[4] = {0, 90, 0, 90}; // Default: Back/Front=Up-Down(0), Lef
 float paintSpeed[4] = {10.0f, 10.0f, 10.0f, 10.0f};   // Default paint speeds
 
 // NEW: Painting Start Positions (X, Y) for each side [Back, Right, Front, Left]
-float paintStartX[4] = { 11.5f, 29.5f, 11.5f, 8.0f }; // Defaults based on current logic
-float paintStartY[4] = { 20.5f, 20.0f, 0.5f,  6.5f }; // Defaults based on current logic
+float paintStartX[4] = { 25.0f, 25.0f, 25.0f, 25.0f }; // Defaults: the start every side used before per-side starts
+float paintStartY[4] = { 30.0f, 30.0f, 30.0f, 30.0f };
+
+// Spray fan model per side: passes are planned from the fan width (0 = one pass per item column/row)
+float paintSprayWidth_inch[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+float paintSprayOverlap_pct[4] = { 25.0f, 25.0f, 25.0f, 25.0f };
+int paintSweepOvertravel = 0; // Run-in/run-out so items are painted at cruise speed (0 = sweeps stop on the items)
+volatile int paintFeedOverride_pct = 100; // Live feed override; applies to the move in flight too
 
 // Painting State Machine Variables (NEW)
 volatile bool isPainting = false;      // Flag indicating active painting
@@ -46,6 +68,7 @@ volatile int currentPaintStep = 0;     // Current step in the painting process
 volatile int currentPaintSide = -1;    // Current side being painted (-1 = none)
 volatile bool isPaintSequence = false; // Flag for multi-side painting sequence
 volatile bool paintNextSide = false;   // Signal to move to the next side
+volatile bool isPaintPaused = false;   // Held at a checkpoint (PAUSE) until RESUME or STOP
 
 // Pick and Place Specific Locations - DEFINITIONS
 float pnpPickLocationX_inch = 2.0f; // Default pick location X
@@ -90,6 +113,8 @@ volatile bool inPickPlaceMode = false; // Tracks if PnP sequence is active
 volatile bool pendingHomingAfterPnP = false; // Flag to home after exiting PnP
 volatile bool inCalibrationMode = false; // Tracks if calibration mode is active
 volatile bool stopRequested = false; // <<< ADDED: Flag to signal stop request
+volatile bool pauseRequested = false; // PAUSE: honoured by the toolpath executor
+volatile bool macroRunning = false; // RUN_MACRO: replayed from loop() by macroLoop()
 volatile bool isPressurePotOn = false; // Renamed: Flag for pressure pot state
 
 // NEW: Tray Dimension Variables
@@ -144,13 +169,27 @@ void calculateAndSetGridSpacing(int cols, int rows); // Defined later in this fi
 void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length);
 void sendCurrentPositionUpdate(); // Forward declaration for position updates
 void sendCurrentSettings(uint8_t specificClientNum); // Replaced sendAllSettingsUpdate
+void broadcastSettingsDelta(); // Sends only settings changed since the last broadcast
+static void replySettingsApplied(uint8_t num, uint32_t settingsBefore); // Delta, or an explicit reply if nothing changed
+static void runCommandBatch(uint8_t num, const char* lines, size_t len); // BATCH: settings commands as one transaction
+static bool macroStart(uint8_t num, const char* name, char* msg, size_t msgLen);
+static void macroLoop(); // Replays the running macro (called from loop())
+static void macroAbort(const char* status, const char* reason);
+void sendSettingsSince(uint8_t num, uint32_t clientEpoch, uint32_t clientVersion);
 void saveSettings(); // Defined above
 void loadSettings(); // Defined above
-void setDefaultSettings(); // New helper function to set defaults
 void setPitchServoAngle(int angle);
 void movePitchServoSmoothly(int targetAngle);
 void initializeActuators(); // <<< ADDED FORWARD DECLARATION
 
+// moveTo() with the motion watchdog checking the move against its planned profile
+static void watchedMoveTo(FastAccelStepper* stepper, const char* name, long target, float speedHz, float accel) {
+    stepper->setSpeedInHz(speedHz);
+    stepper->setAcceleration(accel);
+    if (!emergencyStopMoveTo(stepper, target)) return; // Refused while the e-stop is latched
+    motionWatchdogArm(stepper, name, target, speedHz, accel);
+}
+
 // Function to home a single axis (modified slightly for reuse)
 // Returns true if homing was successful, false otherwise (timeout or error)
 bool homeSingleAxis(FastAccelStepper* stepper, Bounce* debouncer, int home_switch_pin, const char* axis_name) {
@@ -180,6 +219,8 @@ bool homeSingleAxis(FastAccelStepper* stepper, Bounce* debouncer, int home_switc
         debouncer->update();
         webSocket.loop(); // Keep WebSocket responsive during blocking operations
 
+        if (emergencyStopLatched()) break; // Axis already force-stopped by the e-stop task
+
         // Check if the switch is activated (read HIGH directly)
         if (debouncer->read() == HIGH) {
             // Serial.print(axis_name);
@@ -205,9 +246,16 @@ bool homeSingleAxis(FastAccelStepper* stepper, Bounce* debouncer, int home_switc
 
 // Function to home all axes (Kept in main.cpp as it's a core function)
 void homeAllAxes() {
+    if (emergencyStopLatched()) {
+        LOGW("homeAllAxes: Refused, emergency stop latched.");
+        webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Emergency stop latched. Release it and send ESTOP_RESET before homing.\"}");
+        return;
+    }
+    motionWatchdogDisarmAll(); // Homing moves are not planned profiles
+
     // --- Exit Calibration if Active ---
     if (inCalibrationMode) {
-        Serial.println("[DEBUG] homeAllAxes: Exiting calibration mode implicitly."); // DEBUG
+        LOGD("homeAllAxes: Exiting calibration mode implicitly."); // DEBUG
         inCalibrationMode = false;
         // Send status update immediately? Or let Homing status override?
         // Let Homing status handle the UI update. 
@@ -305,8 +353,8 @@ void homeAllAxes() {
         // If rotation motor is not already at zero, move it to zero
         long currentPos = stepper_rot->getCurrentPosition();
         if (currentPos != 0) {
-            Serial.printf("Homing rotation motor from position %ld to 0\n", currentPos);
-            stepper_rot->moveTo(0);
+            LOGI("Homing rotation motor from position %ld to 0", currentPos);
+            emergencyStopMoveTo(stepper_rot, 0);
         } else {
             rot_done = true; // Already at zero position
         }
@@ -335,6 +383,7 @@ void homeAllAxes() {
         debouncer_y_left_home.update();
         debouncer_y_right_home.update();
         debouncer_z_home.update();
+        networkLoop();    // Bring up web/OTA as soon as WiFi connects, even mid-homing
         webSocket.loop(); // Keep WebSocket responsive during blocking operations
 
         // X Axis
@@ -402,7 +451,7 @@ void homeAllAxes() {
             if (!stepper_rot->isRunning()) {
                 // Rotation has stopped, mark as done
                 rot_done = true;
-                Serial.println("Rotation axis homed to position 0.");
+                LOGI("Rotation axis homed to position 0.");
             }
         }
 
@@ -425,21 +474,21 @@ void homeAllAxes() {
         if (stepper_x) {
             stepper_x->setSpeedInHz(patternXSpeed); // Use general pattern speed
             stepper_x->setAcceleration(patternXAccel / 5.0); // Use HALF pattern acceleration
-            stepper_x->moveTo(target_steps);
+            emergencyStopMoveTo(stepper_x, target_steps);
         }
         if (stepper_y_left) {
             stepper_y_left->setSpeedInHz(patternYSpeed);
             stepper_y_left->setAcceleration(patternYAccel / 5.0); // Use HALF pattern acceleration
-            stepper_y_left->moveTo(target_steps);
+            emergencyStopMoveTo(stepper_y_left, target_steps);
         }
         if (stepper_y_right) {
             stepper_y_right->setSpeedInHz(patternYSpeed);
             stepper_y_right->setAcceleration(patternYAccel / 5.0); // Use HALF pattern acceleration
-            stepper_y_right->moveTo(target_steps);
+            emergencyStopMoveTo(stepper_y_right, target_steps);
         }
         
         // DIAGNOSTIC: Print positions BEFORE move-away
-        Serial.printf("*** Positions before move-away: X=%ld, YL=%ld, YR=%ld ***\n", 
+        LOGI("*** Positions before move-away: X=%ld, YL=%ld, YR=%ld ***", 
                       (stepper_x ? stepper_x->getCurrentPosition() : -1),
                       (stepper_y_left ? stepper_y_left->getCurrentPosition() : -1),
                       (stepper_y_right ? stepper_y_right->getCurrentPosition() : -1));
@@ -458,13 +507,11 @@ void homeAllAxes() {
         webSocket.broadcastTXT("{\"status\":\"Ready\", \"message\":\"All axes homed successfully.\"}");
     } else {
         // Serial.println("ERROR: Homing Failed!");
-        String failedAxes = "";
-        if (!x_homed) failedAxes += "X ";
-        if (!y_left_homed) failedAxes += "Y-Left ";
-        if (!y_right_homed) failedAxes += "Y-Right ";
-        if (!z_homed) failedAxes += "Z";
-        if (!rot_done) failedAxes += " Rotation";
-        webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Homing Failed for: " + failedAxes + "\"}");
+        char failMsg[120];
+        snprintf(failMsg, sizeof(failMsg), "{\"status\":\"Error\", \"message\":\"Homing Failed for: %s%s%s%s%s\"}",
+                 x_homed ? "" : "X ", y_left_homed ? "" : "Y-Left ", y_right_homed ? "" : "Y-Right ",
+                 z_homed ? "" : "Z", rot_done ? "" : " Rotation");
+        webSocket.broadcastTXT(failMsg);
         allHomed = false;
     }
 
@@ -472,9 +519,8 @@ void homeAllAxes() {
 
     // Set pitch servo to initial position
     // This servo controls the paint gun direction/angle
-    Serial.println("Setting pitch servo to initial position");
-    servo_pitch.write(SERVO_INIT_POS_PITCH);
-    delay(300); // Allow servo to settle
+    LOGI("Setting pitch servo to initial position");
+    servo_pitch.write(SERVO_INIT_POS_PITCH); // Settles on its own; nothing here waits for it
 }
 
 // --- Movement Logic ---
@@ -501,8 +547,9 @@ void moveToPositionInches(float targetX_inch, float targetY_inch, float targetZ_
 
     isMoving = true;
     // Serial.printf("Moving to X:%.2f, Y:%.2f, Z:%.2f inches\\n", targetX_inch, targetY_inch, targetZ_inch);
-    String msg = "{\"status\":\"Moving\", \"message\":\"Moving to X:" + String(targetX_inch, 2) +
-                 ", Y:" + String(targetY_inch, 2) + ", Z:" + String(targetZ_inch, 2) + "\"}";
+    char msg[100];
+    snprintf(msg, sizeof(msg), "{\"status\":\"Moving\", \"message\":\"Moving to X:%.2f, Y:%.2f, Z:%.2f\"}",
+             targetX_inch, targetY_inch, targetZ_inch);
     webSocket.broadcastTXT(msg);
 
 
@@ -521,9 +568,7 @@ void moveToPositionInches(float targetX_inch, float targetY_inch, float targetZ_
     // Move Z axis (if necessary)
     bool needToMoveZ = (stepper_z && stepper_z->getCurrentPosition() != targetZ_steps);
     if (needToMoveZ) {
-        stepper_z->setSpeedInHz(patternZSpeed);
-        stepper_z->setAcceleration(patternZAccel);
-        stepper_z->moveTo(targetZ_steps);
+        watchedMoveTo(stepper_z, "Z", targetZ_steps, patternZSpeed, patternZAccel);
         // Serial.printf("  Moving Z to %ld steps\\n", targetZ_steps);
     }
 
@@ -536,22 +581,16 @@ void moveToPositionInches(float targetX_inch, float targetY_inch, float targetZ_
                        (stepper_y_right && stepper_y_right->getCurrentPosition() != targetY_steps);
 
     if (needToMoveX) {
-        stepper_x->setSpeedInHz(patternXSpeed);
-        stepper_x->setAcceleration(patternXAccel);
-        stepper_x->moveTo(targetX_steps);
+        watchedMoveTo(stepper_x, "X", targetX_steps, patternXSpeed, patternXAccel);
         // Serial.printf("  Moving X to %ld steps\\n", targetX_steps);
     }
     if (needToMoveY) {
         if (stepper_y_left) {
-             stepper_y_left->setSpeedInHz(patternYSpeed);
-             stepper_y_left->setAcceleration(patternYAccel);
-             stepper_y_left->moveTo(targetY_steps);
+             watchedMoveTo(stepper_y_left, "Y left", targetY_steps, patternYSpeed, patternYAccel);
              // Serial.printf("  Moving Y Left to %ld steps\\n", targetY_steps);
         }
        if (stepper_y_right) {
-             stepper_y_right->setSpeedInHz(patternYSpeed);
-             stepper_y_right->setAcceleration(patternYAccel);
-             stepper_y_right->moveTo(targetY_steps);
+             watchedMoveTo(stepper_y_right, "Y right", targetY_steps, patternYSpeed, patternYAccel);
              // Serial.printf("  Moving Y Right to %ld steps\\n", targetY_steps);
        }
     }
@@ -587,18 +626,11 @@ void moveToXYPositionInches(float targetX_inch, float targetY_inch) {
 
     // Set speeds and accelerations
     if (!x_at_target) {
-        stepper_x->setSpeedInHz(patternXSpeed);
-        stepper_x->setAcceleration(patternXAccel);
-        stepper_x->moveTo(targetX_steps);
+        watchedMoveTo(stepper_x, "X", targetX_steps, patternXSpeed, patternXAccel);
     }
     if (!y_at_target) {
-        stepper_y_left->setSpeedInHz(patternYSpeed);
-        stepper_y_left->setAcceleration(patternYAccel);
-        stepper_y_left->moveTo(targetY_steps);
-
-        stepper_y_right->setSpeedInHz(patternYSpeed);
-        stepper_y_right->setAcceleration(patternYAccel);
-        stepper_y_right->moveTo(targetY_steps);
+        watchedMoveTo(stepper_y_left, "Y left", targetY_steps, patternYSpeed, patternYAccel);
+        watchedMoveTo(stepper_y_right, "Y right", targetY_steps, patternYSpeed, patternYAccel);
     }
     // The isMoving flag should be set by the caller, and completion detected in loop()
 }
@@ -608,6 +640,11 @@ void moveToXYPositionInches(float targetX_inch, float targetY_inch) {
 
 // Moves only the Z axis to the target position in inches, waits for completion
 void moveZToPositionInches(float targetZ_inch, float speedHz, float accel) {
+    moveZToPositionSteps((long)(targetZ_inch * STEPS_PER_INCH_Z), speedHz, accel);
+}
+
+// Same as moveZToPositionInches but with the target already in steps (compiled toolpaths)
+void moveZToPositionSteps(long targetZ_steps, float speedHz, float accel) {
     // REMOVED Check: if (isMoving || isHoming || inPickPlaceMode || inCalibrationMode)
     // The calling function (e.g., paintSide) is responsible for managing the overall machine state.
 
@@ -615,8 +652,6 @@ void moveZToPositionInches(float targetZ_inch, float speedHz, float accel) {
          webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Z Stepper not initialized.\"}");
          return;
     }
-
-    long targetZ_steps = (long)(targetZ_inch * STEPS_PER_INCH_Z);
     
     // === Z Limit Check (only for Pick & Place mode - though this func is mainly for painting now) ===
     // This check might be less relevant if this function is only called during painting (where inPickPlaceMode is false)
@@ -640,13 +675,12 @@ void moveZToPositionInches(float targetZ_inch, float speedHz, float accel) {
     // Serial.printf("Moving Z from %.2f to %.2f inches (Steps: %ld to %ld, Speed: %.0f, Accel: %.0f)\n",
     //               (float)currentZ_steps / STEPS_PER_INCH_Z, targetZ_inch, currentZ_steps, targetZ_steps, speedHz, accel);
 
-    stepper_z->setSpeedInHz(speedHz);
-    stepper_z->setAcceleration(accel);
-    stepper_z->moveTo(targetZ_steps);
+    watchedMoveTo(stepper_z, "Z", targetZ_steps, speedHz, accel);
 
-    // Wait for Z move completion (blocking)
+    // Wait for Z move completion (blocking); a stall force-stops Z and ends the wait
     while (stepper_z->isRunning()) { // <<< REMOVED: !stopRequested check
         webSocket.loop(); // Keep websocket alive
+        motionWatchdogPoll();
         yield();
     }
     // Serial.println("Z move complete.");
@@ -655,9 +689,48 @@ void moveZToPositionInches(float targetZ_inch, float speedHz, float accel) {
 
 // Moves X and Y axes to the target position using specified speed/accel for painting, waits for completion
 void moveToXYPositionInches_Paint(float targetX_inch, float targetY_inch, float speedHz, float accel) {
+    moveToXYPositionSteps_Paint((long)(targetX_inch * STEPS_PER_INCH_XY), (long)(targetY_inch * STEPS_PER_INCH_XY), speedHz, accel);
+}
+
+// Same as moveToXYPositionInches_Paint but with the target already in steps (compiled toolpaths)
+void moveToXYPositionSteps_Paint(long targetX_steps, long targetY_steps, float speedHz, float accel) {
+    startXYPositionSteps_Paint(targetX_steps, targetY_steps, speedHz, accel);
+
+    // Wait for XY move completion (blocking for simplicity in painting sequence)
+    while (isXYPaintMoveRunning()) { // <<< REMOVED: !stopRequested check
+        webSocket.loop(); // STOP/ESTOP are seen mid-sweep
+        motionWatchdogPoll();
+        yield();
+    }
+    // Serial.println("Paint XY move complete.");
+}
+
+// Straight-line painting XY move: each axis gets its share of speed and accel so both
+// arrive together (angled rasters). Axis-aligned moves are the same as startXYPositionSteps_Paint.
+void startXYLinearSteps_Paint(long targetX_steps, long targetY_steps, float speedHz, float accel) {
+    long dx = labs(targetX_steps - stepper_x->getCurrentPosition());
+    long dy = labs(targetY_steps - stepper_y_left->getCurrentPosition());
+    if (dx == 0 || dy == 0) {
+        startXYPositionSteps_Paint(targetX_steps, targetY_steps, speedHz, accel);
+        return;
+    }
+    float len = sqrtf((float)dx * dx + (float)dy * dy);
+    float fx = dx / len, fy = dy / len;
+    float speedX = fmaxf(1.0f, speedHz * fx), speedY = fmaxf(1.0f, speedHz * fy);
+    float accelX = fmaxf(1.0f, accel * fx), accelY = fmaxf(1.0f, accel * fy);
+
+    watchedMoveTo(stepper_x, "X", targetX_steps, speedX, accelX);
+    watchedMoveTo(stepper_y_left, "Y left", targetY_steps, speedY, accelY);
+    watchedMoveTo(stepper_y_right, "Y right", targetY_steps, speedY, accelY);
+}
+
+bool isXYPaintMoveRunning() {
+    return stepper_x->isRunning() || stepper_y_left->isRunning() || stepper_y_right->isRunning();
+}
+
+// Starts a painting XY move and returns; the toolpath executor polls it to switch the gun mid-move
+void startXYPositionSteps_Paint(long targetX_steps, long targetY_steps, float speedHz, float accel) {
     // No state checking here, assumes caller (paintSide) manages state
-    long targetX_steps = (long)(targetX_inch * STEPS_PER_INCH_XY);
-    long targetY_steps = (long)(targetY_inch * STEPS_PER_INCH_XY);
 
     long currentX_steps = stepper_x->getCurrentPosition();
     long currentY_steps_L = stepper_y_left->getCurrentPosition();
@@ -675,33 +748,20 @@ void moveToXYPositionInches_Paint(float targetX_inch, float targetY_inch, float
     //               targetX_inch, targetY_inch, targetX_steps, targetY_steps, speedHz, accel);
 
     if (!x_at_target) {
-        stepper_x->setSpeedInHz(speedHz); // Use provided speed
-        stepper_x->setAcceleration(accel); // Use provided accel
-        stepper_x->moveTo(targetX_steps);
+        watchedMoveTo(stepper_x, "X", targetX_steps, speedHz, accel); // Use provided speed/accel
     }
     if (!y_at_target) {
         // Assuming Y speed/accel are the same for painting moves
-        stepper_y_left->setSpeedInHz(speedHz);
-        stepper_y_left->setAcceleration(accel);
-        stepper_y_left->moveTo(targetY_steps);
-
-        stepper_y_right->setSpeedInHz(speedHz);
-        stepper_y_right->setAcceleration(accel);
-        stepper_y_right->moveTo(targetY_steps);
-    }
-
-    // Wait for XY move completion (blocking for simplicity in painting sequence)
-    while (stepper_x->isRunning() || stepper_y_left->isRunning() || stepper_y_right->isRunning()) { // <<< REMOVED: !stopRequested check
-        yield();
+        watchedMoveTo(stepper_y_left, "Y left", targetY_steps, speedHz, accel);
+        watchedMoveTo(stepper_y_right, "Y right", targetY_steps, speedHz, accel);
     }
-    // Serial.println("Paint XY move complete.");
 }
 
 // --- NEW: Rotation Function ---
 // Moves the rotation axis to a specific absolute degree position and waits
 void rotateToAbsoluteDegree(int targetDegree) {
     if (!stepper_rot) {
-        Serial.println("[WARN] rotateToAbsoluteDegree: Rotation stepper not available.");
+        LOGW("rotateToAbsoluteDegree: Rotation stepper not available.");
         webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Rotation control unavailable (pin conflict?)\"}");
         return;
     }
@@ -709,7 +769,7 @@ void rotateToAbsoluteDegree(int targetDegree) {
     // REMOVED CONDITION: We no longer check for isMoving which was preventing automated sequences
     // Only check for homing, pick/place and calibration modes which truly should prevent rotation
     if (isHoming || inPickPlaceMode || inCalibrationMode) {
-        Serial.printf("[WARN] rotateToAbsoluteDegree: Cannot rotate while in special mode (Hm=%d, PnP=%d, Cal=%d).\n",
+        LOGW("rotateToAbsoluteDegree: Cannot rotate while in special mode (Hm=%d, PnP=%d, Cal=%d).",
                      isHoming, inPickPlaceMode, inCalibrationMode);
         webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Cannot rotate: Machine is in special mode.\"}");
         return;
@@ -720,11 +780,11 @@ void rotateToAbsoluteDegree(int targetDegree) {
     float currentAngle = (float)currentSteps / STEPS_PER_DEGREE;
 
     if (abs(targetSteps - currentSteps) < 2) { // Check if already at target (within tolerance)
-        Serial.printf("Rotation already at target %.1f degrees.\n", (float)targetSteps / STEPS_PER_DEGREE);
+        LOGI("Rotation already at target %.1f degrees.", (float)targetSteps / STEPS_PER_DEGREE);
         return; // Already there
     }
 
-    Serial.printf("Rotating from %.1f deg to %d deg (Steps: %ld to %ld)\n", currentAngle, targetDegree, currentSteps, targetSteps);
+    LOGI("Rotating from %.1f deg to %d deg (Steps: %ld to %ld)", currentAngle, targetDegree, currentSteps, targetSteps);
     
     // Set a local moving flag but don't interfere with the global isMoving flag
     // which may be set by the painting sequence
@@ -741,9 +801,14 @@ void rotateToAbsoluteDegree(int targetDegree) {
     stepper_rot->setAcceleration(patternRotAccel);
     
     // Check if the move can be properly executed
-    if (!stepper_rot->moveTo(targetSteps)) {
-        Serial.println("[ERROR] Rotation move failed - stepper may be disabled");
-        webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Rotation failed. Motor might be disabled.\"}");
+    if (!emergencyStopMoveTo(stepper_rot, targetSteps)) {
+        if (emergencyStopLatched()) {
+            LOGE("Rotation move refused - emergency stop latched");
+            webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Rotation refused: emergency stop latched.\"}");
+        } else {
+            LOGE("Rotation move failed - stepper may be disabled");
+            webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Rotation failed. Motor might be disabled.\"}");
+        }
         
         // Only reset isMoving if we set it (not if it was already set)
         if (!wasMovingBefore) {
@@ -751,10 +816,12 @@ void rotateToAbsoluteDegree(int targetDegree) {
         }
         return;
     }
+    motionWatchdogArm(stepper_rot, "Rotation", targetSteps, patternRotSpeed, patternRotAccel);
 
-    // Wait for rotation completion (blocking)
+    // Wait for rotation completion (blocking); a stall force-stops the axis and ends the wait
     while (stepper_rot->isRunning()) {
         webSocket.loop(); // Keep WebSocket responsive
+        motionWatchdogPoll();
         yield();
     }
 
@@ -764,11 +831,11 @@ void rotateToAbsoluteDegree(int targetDegree) {
     
     // Verify if move completed successfully
     if (abs(finalPos - targetSteps) > 2) { // More than 2 steps off (> 0.18 degrees)
-        Serial.printf("[WARN] Rotation didn't reach exact target. Final: %ld steps (%.2f°), Target: %ld steps (%d°)\n",
+        LOGW("Rotation didn't reach exact target. Final: %ld steps (%.2f°), Target: %ld steps (%d°)",
                     finalPos, finalAngle, targetSteps, targetDegree);
     }
 
-    Serial.printf("Rotation to %d degrees complete. Final steps: %ld (%.2f°)\n", 
+    LOGI("Rotation to %d degrees complete. Final steps: %ld (%.2f°)", 
                 targetDegree, finalPos, finalAngle);
                 
     // Only reset isMoving if we set it (not if it was already set)
@@ -788,13 +855,15 @@ void rotateToAbsoluteDegree(int targetDegree) {
 // --- Painting Logic ---
 
 // --- Start a painting operation on a specific side (can be part of a sequence)
-void startPaintingSide(int sideIndex, bool isSequence) {
-    Serial.printf("Starting painting for side %d (sequence: %s)\n", sideIndex, isSequence ? "true" : "false");
+// resume: continue from the stored checkpoint (RESUME after a reboot) instead of discarding it
+void startPaintingSide(int sideIndex, bool isSequence, bool resume) {
+    LOGI("Starting painting for side %d (sequence: %s%s)", sideIndex, isSequence ? "true" : "false", resume ? ", resume" : "");
     stopRequested = false; // Reset stop flag at start
+    pauseRequested = false;
     
     // Validate painting request
     if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode || isPainting) {
-        Serial.printf("[ERROR] startPaintingSide denied: Invalid state (allHomed=%d, isMoving=%d, isHoming=%d, inPickPlaceMode=%d, inCalibrationMode=%d, isPainting=%d)\n",
+        LOGE("startPaintingSide denied: Invalid state (allHomed=%d, isMoving=%d, isHoming=%d, inPickPlaceMode=%d, inCalibrationMode=%d, isPainting=%d)",
                       allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode, isPainting);
         webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Cannot start painting, invalid machine state.\"}");
         return;
@@ -802,18 +871,22 @@ void startPaintingSide(int sideIndex, bool isSequence) {
     
     // Validate side index
     if (sideIndex < 0 || sideIndex > 3) {
-        Serial.printf("[ERROR] startPaintingSide denied: Invalid side index %d\n", sideIndex);
+        LOGE("startPaintingSide denied: Invalid side index %d", sideIndex);
         webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Invalid side index provided for painting.\"}");
         return;
     }
     
+    if (!resume) paintCheckpointClear(); // A fresh start abandons any paused job
+
     // Set new flags
     isPainting = true;
+    isPaintPaused = false;
     isMoving = true;
     currentPaintSide = sideIndex;
     currentPaintStep = 0;
     isPaintSequence = isSequence;
     paintNextSide = false;
+    jobBegin(isSequence ? JOB_PAINT_ALL : JOB_PAINT_SIDE, sideIndex);
     
     // Send status message
     char busyMsg[100];
@@ -829,17 +902,27 @@ void processPaintingStateMachine() {
     
     // Check for stop request
     if (stopRequested) {
-        Serial.println("Painting operation stopped by user request");
+        LOGI("Painting operation stopped by user request");
         deactivatePaintGun(true);
+        paintCheckpointClear();
         isPainting = false;
+        isPaintPaused = false;
+        pauseRequested = false;
         isMoving = false;
         currentPaintSide = -1;
         currentPaintStep = 0;
         isPaintSequence = false;
         paintNextSide = false;
+        jobEnd(JOB_STOPPED);
         webSocket.broadcastTXT("{\"status\":\"Ready\", \"message\":\"Painting stopped by user.\"}");
         return;
     }
+
+    // Paused: hold at the checkpoint until RESUME (or STOP above)
+    if (isPaintPaused) return;
+
+    // Stalled move: loop() aborts the job and reports it
+    if (motionWatchdogFaulted()) return;
     
     // Check if we're waiting for motors to stop moving
     if ((stepper_x && stepper_x->isRunning()) || 
@@ -867,7 +950,9 @@ void processPaintingStateMachine() {
                 currentPaintSide = -1;
                 currentPaintStep = 0;
                 isPaintSequence = false;
-                Serial.println("Paint All Sides sequence complete!");
+                pauseRequested = false; // A PAUSE that came too late for the last pattern
+                jobEnd(JOB_DONE);
+                LOGI("Paint All Sides sequence complete!");
                 webSocket.broadcastTXT("{\"status\":\"Ready\", \"message\":\"Paint All Sides sequence completed successfully.\"}");
                 return;
             default:
@@ -890,9 +975,11 @@ void processPaintingStateMachine() {
         case 0: // Initial setup - set servo angle
             {
                 int pitch = paintPitchAngle[currentPaintSide];
-                Serial.printf("Setting servo pitch to %d for side %d\n", pitch, currentPaintSide);
+                LOGI("Setting servo pitch to %d for side %d", pitch, currentPaintSide);
                 servo_pitch.write(pitch);
+                jobSetCategory(JOB_CAT_DWELL);
                 delay(300); // Allow servo to settle
+                jobSetCategory(JOB_CAT_OTHER);
                 currentPaintStep = 1;
             }
             break;
@@ -903,7 +990,7 @@ void processPaintingStateMachine() {
                 float accel = patternXAccel;
                 bool patternSuccessful = false;
                 
-                Serial.printf("Executing paint pattern for side %d\n", currentPaintSide);
+                LOGI("Executing paint pattern for side %d", currentPaintSide);
                 
                 // Call the appropriate side-specific pattern function
                 switch (currentPaintSide) {
@@ -923,16 +1010,29 @@ void processPaintingStateMachine() {
                 
                 // Check if pattern was successful
                 if (patternSuccessful) {
-                    Serial.println("Paint pattern executed successfully");
+                    LOGI("Paint pattern executed successfully");
                     currentPaintStep = 2;
+                } else if (isPaintPaused && !stopRequested) {
+                    // The executor stored a checkpoint; RESUME re-runs this side from step 0
+                    char pausedMsg[160];
+                    PaintCheckpoint cp;
+                    paintCheckpointGet(cp);
+                    isMoving = false;
+                    jobSetCategory(JOB_CAT_IDLE);
+                    snprintf(pausedMsg, sizeof(pausedMsg),
+                             "{\"status\":\"Paused\", \"message\":\"Side %d paused at segment %u. RESUME to continue, STOP to abort.\"}",
+                             currentPaintSide, cp.segment);
+                    webSocket.broadcastTXT(pausedMsg);
+                    sendCurrentPositionUpdate();
                 } else {
-                    Serial.println("Paint pattern execution failed or stopped");
+                    LOGW("Paint pattern execution failed or stopped");
                     deactivatePaintGun(true);
                     isPainting = false;
                     isMoving = false;
                     currentPaintSide = -1;
                     currentPaintStep = 0;
                     isPaintSequence = false;
+                    jobEnd(stopRequested ? JOB_STOPPED : JOB_FAILED);
                     webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Pattern execution failed or stopped.\"}");
                 }
             }
@@ -942,25 +1042,27 @@ void processPaintingStateMachine() {
             deactivatePaintGun(true);
             digitalWrite(PAINT_GUN_PIN, LOW);      // Double check directly with pins
             digitalWrite(PRESSURE_POT_PIN, LOW);   // for safety
-            Serial.println("Deactivated paint gun after pattern completion");
+            LOGI("Deactivated paint gun after pattern completion");
             currentPaintStep = 3;
             break;
             
         case 3: // Move Z to safe height
-            Serial.println("Moving Z axis to safe height (0)");
+            LOGI("Moving Z axis to safe height (0)");
+            jobSetCategory(JOB_CAT_REPOSITION);
             moveZToPositionInches(0.0, patternZSpeed, patternZAccel);
             currentPaintStep = 4;
             break;
             
         case 4: // Move to home XY position
-            Serial.println("Returning to home XY position (0,0)");
+            LOGI("Returning to home XY position (0,0)");
             moveToXYPositionInches(0.0, 0.0);
             currentPaintStep = 5;
             break;
             
         case 5: // Return rotation to 0
             if (stepper_rot) {
-                Serial.println("Returning rotation to 0 position");
+                LOGI("Returning rotation to 0 position");
+                jobSetCategory(JOB_CAT_ROTATE);
                 rotateToAbsoluteDegree(0);
                 currentPaintStep = 6;
             } else {
@@ -972,10 +1074,12 @@ void processPaintingStateMachine() {
         case 6: // Complete painting of this side
             {
                 char readyMsg[100];
+                jobSetCategory(JOB_CAT_OTHER);
+                jobAddUnit();
                 
                 if (isPaintSequence) {
                     // If in a sequence, signal to move to the next side
-                    Serial.printf("Side %d painting complete. Ready for next side.\n", currentPaintSide);
+                    LOGI("Side %d painting complete. Ready for next side.", currentPaintSide);
                     paintNextSide = true;
                 } else {
                     // If single side, complete the painting operation
@@ -983,9 +1087,11 @@ void processPaintingStateMachine() {
                     webSocket.broadcastTXT(readyMsg);
                     Serial.println(readyMsg);
                     sendCurrentPositionUpdate();
+                    jobEnd(JOB_DONE);
                     
                     isPainting = false;
                     isMoving = false;
+                    pauseRequested = false; // A PAUSE that came too late for the pattern
                     currentPaintSide = -1;
                     currentPaintStep = 0;
                 }
@@ -999,7 +1105,7 @@ void processPaintingStateMachine() {
 void paintSide(int sideIndex) {
     // Make sure we're not already in a painting state
     if (isPainting) {
-        Serial.println("[WARN] Attempting to start paintSide while already painting - resetting state first");
+        LOGW("Attempting to start paintSide while already painting - resetting state first");
         isPainting = false;
         isMoving = false;
         currentPaintSide = -1;
@@ -1015,6 +1121,7 @@ void paintSide(int sideIndex) {
 // --- Arduino Setup ---
 void setup() {
     Serial.begin(115200);
+    logInit(); // LOGx calls from here on are drained to Serial by a background task
     Serial.println("\n=== Booting Paint + PnP Machine ==="); // Clearer boot message
     Serial.println("Loading settings from NVS...");
 
@@ -1022,12 +1129,21 @@ void setup() {
     pinMode(PRESSURE_PIN, OUTPUT);
     digitalWrite(PRESSURE_PIN, LOW); // Default to OFF
 
-    // Initialize Preferences
-    preferences.begin("paint-machine", false); // Use "paint-machine" namespace, read/write mode
+    // Start WiFi first so it associates in the background while we home
+    networkBegin();
 
-    // Load settings from NVS
+    // Load settings from NVS (SettingsStore opens/closes the namespace per access)
+    bootPhaseBegin(BOOT_SETTINGS);
     loadSettings();
 
+    // Mount the recipe filesystem (recipes are only loaded on request)
+    recipeStoreInit();
+    macroStoreInit();
+
+    // A job paused before the reboot can be resumed once homed
+    paintCheckpointLoad();
+    bootPhaseEnd(BOOT_SETTINGS);
+
     // Calculate initial grid gap based on potentially loaded dimensions
     Serial.printf("[DEBUG] setup: pnpOffsetX after loadSettings() = %.2f\n", pnpOffsetX_inch);
     calculateAndSetGridSpacing(placeGridCols, placeGridRows);
@@ -1052,6 +1168,7 @@ void setup() {
     Serial.println("Booting...");
 
     // --- Servo Setup ---
+    bootPhaseBegin(BOOT_ACTUATORS);
     // Serial.println("Initializing Servos...");
     // Allow allocation of all timers
     ESP32PWM::allocateTimer(0);
@@ -1069,10 +1186,10 @@ void setup() {
     // Move servos to initial max positions
     Serial.printf("[DEBUG Setup] Setting initial Pitch Servo position to %d\n", SERVO_INIT_POS_PITCH); // DEBUG (Replaced PITCH_SERVO_MAX)
     servo_pitch.write(SERVO_INIT_POS_PITCH); // Use defined init position (Replaced PITCH_SERVO_MAX)
-    delay(500); // Allow servo to reach position
+    // No settling delay: the servo moves on its own while the steppers are set up and homed
 
     // Add a simple servo test sequence if needed
-    int currentPitch = servo_pitch.read();
+    // int currentPitch = servo_pitch.read();
     // Serial.printf("[DEBUG Setup] Current actual pitch read: %d\n", currentPitch);
     // int testDownPosition = currentPitch + 20; // Example: Try to move down 20 deg
     // int testUpPosition = currentPitch - 20;   // Example: Try to move up 20 deg
@@ -1101,62 +1218,14 @@ void setup() {
     // --- Actuator Pins Initialization ---
     initializeActuators();
 
-    // --- WiFi Connection ---
-    // Serial.print("Connecting to ");
-    // Serial.println(ssid);
-    WiFi.setHostname(hostname); // Set hostname
-    WiFi.mode(WIFI_STA); // Set WiFi to station mode
-    WiFi.begin(ssid, password);
-    int wifi_retries = 0;
-    while (WiFi.status() != WL_CONNECTED) {
-        delay(500);
-        // Serial.print(".");
-        wifi_retries++;
-        if (wifi_retries > 40) { // Timeout after ~20 seconds
-            // Serial.println("\nFailed to connect to WiFi!");
-            break; // Continue without WiFi if timeout
-        }
-    }
-
-    bool wifiConnected = (WiFi.status() == WL_CONNECTED);
-
-    if (wifiConnected) {
-        // Serial.println("\nWiFi connected.");
-        // Serial.print("IP address: ");
-        // Serial.println(WiFi.localIP());
-
-        // --- OTA Setup ---
-        ArduinoOTA.setHostname(hostname);
-        // ArduinoOTA.setPassword("your_ota_password"); // Optional: set password
-        ArduinoOTA
-            .onStart([]() {
-                String type;
-                isMoving = true; // Prevent web commands during OTA
-                isHoming = true; // Prevent web commands during OTA
-                if (ArduinoOTA.getCommand() == U_FLASH) type = "sketch";
-                else type = "filesystem";
-                // Serial.println("Start updating " + type);
-                if(stepper_x) stepper_x->forceStopAndNewPosition(stepper_x->getCurrentPosition());
-                if(stepper_y_left) stepper_y_left->forceStopAndNewPosition(stepper_y_left->getCurrentPosition());
-                if(stepper_y_right) stepper_y_right->forceStopAndNewPosition(stepper_y_right->getCurrentPosition());
-                if(stepper_z) stepper_z->forceStopAndNewPosition(stepper_z->getCurrentPosition());
-            })
-            .onEnd([]() { /* Serial.println("\nEnd"); */ })
-            .onProgress([](unsigned int progress, unsigned int total) { /* Serial.printf("Progress: %u%%\r", (progress / (total / 100))); */ })
-            .onError([](ota_error_t error) { /* Error handling */ });
-        ArduinoOTA.begin();
-        // Serial.println("OTA Initialized");
-
-        // --- Web Server & WebSocket Setup ---
-        setupWebServerAndWebSocket(); // Setup web server only if WiFi connected (function in WebHandler.cpp)
+    bootPhaseEnd(BOOT_ACTUATORS);
 
-    } else {
-        // Serial.println("Proceeding without WiFi/OTA/Web Interface.");
-    }
-    // --- End WiFi/OTA/Web Setup ---
+    // --- WiFi/OTA/Web ---
+    // Started by networkLoop() once the link is up (see NetworkManager.h)
 
     // Serial.println("Initializing Steppers...");
     // Initialize Stepper Engine
+    bootPhaseBegin(BOOT_STEPPERS);
     engine.init();
 
     // Setup Steppers
@@ -1217,9 +1286,16 @@ void setup() {
         }
     }
 
+    // Physical e-stop input and the e-stop task (needs the steppers)
+    emergencyStopInit();
+    diagnosticsInit(); // Samples stacks, idle time and stepper queues on a timer
+    bootPhaseEnd(BOOT_STEPPERS);
+
     // --- Initial Homing on Boot ---
      // Serial.println("Performing initial homing sequence...");
-    homeAllAxes(); // Call the refactored homing function
+    bootPhaseBegin(BOOT_HOMING);
+    homeAllAxes(); // Call the refactored homing function (services WiFi while it waits)
+    bootPhaseEnd(BOOT_HOMING);
 
     // Note: allHomed flag is set within homeAllAxes()
      if (allHomed) {
@@ -1241,87 +1317,128 @@ void setup() {
     // digitalWrite(SUCTION_PIN, LOW);       // REMOVED
     // Serial.println("Actuator pins initialized."); // REMOVED
 
-    // Initialize WebSockets server
-    webSocket.begin();
-    webSocket.onEvent(webSocketEvent);
+    // WebSocket server is started with the web server in setupWebServerAndWebSocket()
 }
 
 // --- Arduino Loop ---
 void loop() {
-    // Handle Wi-Fi and OTA
-    if (WiFi.status() == WL_CONNECTED) {
-        ArduinoOTA.handle();
-        webServer.handleClient();
-        webSocket.loop();
-    }
-    
-    // NEW: Process painting state machine for non-blocking operation
-    processPaintingStateMachine();
-    
-    // Handle the PnP mode request button (if pressed)
-    debouncer_pnp_cycle_button.update();
-    if (debouncer_pnp_cycle_button.rose()) {
-        Serial.println("PnP cycle button pressed!");
-        // Handle PnP button press (future feature)
-    }
+    { // Profiled body (the trailing delay is excluded)
+        PROFILE_SCOPE("loop");
+
+        // Handle Wi-Fi (connect/reconnect) and OTA
+        { PROFILE_SCOPE("wifi"); networkLoop(); }
+        if (networkServicesUp()) {
+            { PROFILE_SCOPE("ota"); ArduinoOTA.handle(); }
+            { PROFILE_SCOPE("httpServer"); webServer.handleClient(); }
+            { PROFILE_SCOPE("webSocketLoop"); webSocket.loop(); }
+        }
+        heapMetricsLoop(); // Fragmentation trend (GET_HEAP)
     
-    // Handle pending homing after PnP sequence completes
-    if (pendingHomingAfterPnP && !isMoving && !isHoming) {
-        Serial.println("Executing pending homing after PnP exit");
-        pendingHomingAfterPnP = false; // Clear the flag first to prevent re-trigger
-        homeAllAxes(); // Home all axes after PnP sequence completes
-    }
+        // NEW: Process painting state machine for non-blocking operation
+        { PROFILE_SCOPE("paintStateMachine"); processPaintingStateMachine(); }
+
+        // Commit pending settings changes (debounced, only while idle)
+        { PROFILE_SCOPE("settingsStore"); settingsStoreLoop(); }
     
-    // IMPROVED FIX: Check for movement completion and reset flags
-    // This ensures we don't get stuck in a "busy" state when movements complete
-    // Also checks if we're stuck in a painting state without actual painting happening
+        // Handle the PnP mode request button (if pressed)
+        { PROFILE_SCOPE("debouncers"); debouncer_pnp_cycle_button.update(); }
+        if (debouncer_pnp_cycle_button.rose()) {
+            LOGI("PnP cycle button pressed!");
+            // Handle PnP button press (future feature)
+        }
     
-    // Check if machine is stuck in painting mode
-    static unsigned long lastPaintStepChangeTime = 0;
-    static int lastPaintStep = -1;
+        // Handle pending homing after PnP sequence completes
+        if (pendingHomingAfterPnP && !isMoving && !isHoming) {
+            LOGI("Executing pending homing after PnP exit");
+            pendingHomingAfterPnP = false; // Clear the flag first to prevent re-trigger
+            homeAllAxes(); // Home all axes after PnP sequence completes
+        }
     
-    if (isPainting) {
-        if (currentPaintStep != lastPaintStep) {
-            lastPaintStep = currentPaintStep;
-            lastPaintStepChangeTime = millis();
-        } else if (millis() - lastPaintStepChangeTime > 10000) { // 10 seconds timeout
-            // Machine is stuck in same painting step for too long
-            Serial.println("WARNING: Machine appears stuck in painting mode - resetting state");
+        // IMPROVED FIX: Check for movement completion and reset flags
+        // This ensures we don't get stuck in a "busy" state when movements complete
+        // Also checks if we're stuck in a painting state without actual painting happening
+    
+        // Emergency stop: the steppers and paint outputs are already off; reset the machine state once per trip
+        if (emergencyStopService()) {
+            uint32_t outputsOffUs, stopUs;
+            emergencyStopLastLatency(outputsOffUs, stopUs);
+            char estopMsg[220];
+            snprintf(estopMsg, sizeof(estopMsg),
+                     "{\"status\":\"Error\", \"message\":\"EMERGENCY STOP: outputs off after %lu us, steppers stopped after %lu us. Release it, send ESTOP_RESET, then home.\"}",
+                     (unsigned long)outputsOffUs, (unsigned long)stopUs);
+            motionWatchdogDisarmAll();
             deactivatePaintGun(true);
+            isPressurePotOn = false;
+            if (isPainting) jobEnd(JOB_STOPPED);
             isPainting = false;
-            isMoving = false;
+            isPaintPaused = false;
+            pauseRequested = false;
+            paintCheckpointClear();
             currentPaintSide = -1;
             currentPaintStep = 0;
             isPaintSequence = false;
             paintNextSide = false;
-            webSocket.broadcastTXT("{\"status\":\"Ready\", \"message\":\"Painting operation reset due to inactivity.\"}");
-            lastPaintStep = -1;
+            isMoving = false;
+            isHoming = false;
+            inPickPlaceMode = false;
+            inCalibrationMode = false;
+            allHomed = false; // Axes may have coasted past the counted position
+            webSocket.broadcastTXT(estopMsg);
+            if (macroRunning) macroAbort("Error", "emergency stop");
+        }
+
+        // Motion watchdog: a move falling behind its planned profile is a stall.
+        // Blocking waits (toolpath executor, Z, rotation) poll it themselves.
+        { PROFILE_SCOPE("motionWatchdog"); motionWatchdogPoll(); }
+        if (motionWatchdogFaulted()) {
+            char faultMsg[200];
+            snprintf(faultMsg, sizeof(faultMsg), "{\"status\":\"Error\", \"message\":\"Motion stalled: %s.%s\"}",
+                     motionWatchdogFault(), isPainting ? " Painting aborted." : "");
+            LOGW("Motion stall handled%s", isPainting ? " - aborting painting" : "");
+            deactivatePaintGun(true);
+            if (isPainting) {
+                isPainting = false;
+                isPaintPaused = false;
+                currentPaintSide = -1;
+                currentPaintStep = 0;
+                isPaintSequence = false;
+                paintNextSide = false;
+                jobEnd(JOB_FAILED);
+            }
+            isMoving = false;
+            webSocket.broadcastTXT(faultMsg);
+            motionWatchdogClear();
         }
-    } else {
-        lastPaintStep = -1;
-    }
     
-    // Check for normal movement completion
-    if (isMoving) {
-        // Check if all motors have stopped
-        bool anyMotorRunning = false;
-        if (stepper_x && stepper_x->isRunning()) anyMotorRunning = true;
-        if (stepper_y_left && stepper_y_left->isRunning()) anyMotorRunning = true;
-        if (stepper_y_right && stepper_y_right->isRunning()) anyMotorRunning = true;
-        if (stepper_z && stepper_z->isRunning()) anyMotorRunning = true;
-        if (stepper_rot && stepper_rot->isRunning()) anyMotorRunning = true;
+        // Check for normal movement completion
+        if (isMoving) {
+            PROFILE_SCOPE("isMovingPoll");
+            // Check if all motors have stopped
+            bool anyMotorRunning = false;
+            if (stepper_x && stepper_x->isRunning()) anyMotorRunning = true;
+            if (stepper_y_left && stepper_y_left->isRunning()) anyMotorRunning = true;
+            if (stepper_y_right && stepper_y_right->isRunning()) anyMotorRunning = true;
+            if (stepper_z && stepper_z->isRunning()) anyMotorRunning = true;
+            if (stepper_rot && stepper_rot->isRunning()) anyMotorRunning = true;
         
-        // If no motors are running but we still have the isMoving flag set, clear it
-        if (!anyMotorRunning) {
-            isMoving = false;
-            Serial.println("Movement completed - resetting busy flag");
-            sendCurrentPositionUpdate();
+            // If no motors are running but we still have the isMoving flag set, clear it
+            if (!anyMotorRunning) {
+                isMoving = false;
+                LOGI("Movement completed - resetting busy flag");
+                sendCurrentPositionUpdate();
             
-            // Only send the ready message if we're not in a special mode
-            if (!isPainting && !isHoming && !inPickPlaceMode && !inCalibrationMode) {
-                webSocket.broadcastTXT("{\"status\":\"Ready\", \"message\":\"Movement completed.\"}");
+                // Only send the ready message if we're not in a special mode
+                if (!isPainting && !isHoming && !inPickPlaceMode && !inCalibrationMode) {
+                    webSocket.broadcastTXT("{\"status\":\"Ready\", \"message\":\"Movement completed.\"}");
+                }
             }
         }
+
+        // Next macro step once the previous one has finished
+        { PROFILE_SCOPE("macro"); macroLoop(); }
+
+        // "done" acks for commands whose operation has now finished
+        commandAckLoop();
     }
     
     // Small delay to prevent CPU from maxing out
@@ -1330,22 +1447,22 @@ void loop() {
 
 // NEW: Function to calculate and set grid spacing automatically
 void calculateAndSetGridSpacing(int cols, int rows) {
-    Serial.printf("[DEBUG] calculateAndSetGridSpacing with cols=%d, rows=%d, trayWidth=%.2f, trayHeight=%.2f\n", 
+    LOGD("calculateAndSetGridSpacing with cols=%d, rows=%d, trayWidth=%.2f, trayHeight=%.2f", 
                  cols, rows, trayWidth_inch, trayHeight_inch);
                  
     // Input validation for columns and rows
     if (cols <= 0 || rows <= 0) {
-        Serial.printf("[ERROR] Invalid grid dimensions: cols=%d, rows=%d. Must be positive.\n", cols, rows);
+        LOGE("Invalid grid dimensions: cols=%d, rows=%d. Must be positive.", cols, rows);
         return; // Exit without calculations
     }
     
     if (trayWidth_inch <= 0 || trayHeight_inch <= 0) {
-        Serial.printf("[ERROR] Invalid tray dimensions: width=%.2f, height=%.2f. Must be positive.\n", 
+        LOGE("Invalid tray dimensions: width=%.2f, height=%.2f. Must be positive.", 
                      trayWidth_inch, trayHeight_inch);
         // Use defaults to prevent crashes
         trayWidth_inch = max(trayWidth_inch, 24.0f);
         trayHeight_inch = max(trayHeight_inch, 18.0f);
-        Serial.printf("[WARN] Using default tray dimensions: width=%.2f, height=%.2f\n", 
+        LOGW("Using default tray dimensions: width=%.2f, height=%.2f", 
                      trayWidth_inch, trayHeight_inch);
     }
     
@@ -1368,12 +1485,12 @@ void calculateAndSetGridSpacing(int cols, int rows) {
     float totalItemYSpace = rows * pnpItemHeight_inch; // Total space occupied by items
     float totalGapYSpace = totalYSpace - totalItemYSpace; // Total space for gaps
     
-    Serial.printf("[DEBUG] Using tray dimensions: Width=%.2f, Height=%.2f\n", trayWidth_inch, trayHeight_inch);
-    Serial.printf("[DEBUG] Border width: %.2f, Item width: %.2f, Item height: %.2f\n", 
+    LOGD("Using tray dimensions: Width=%.2f, Height=%.2f", trayWidth_inch, trayHeight_inch);
+    LOGD("Border width: %.2f, Item width: %.2f, Item height: %.2f", 
                  pnpBorderWidth_inch, pnpItemWidth_inch, pnpItemHeight_inch);
-    Serial.printf("[DEBUG] Using formula: (%.2f - (.25*2) - (3*%d))/%d for X gap\n", 
+    LOGD("Using formula: (%.2f - (.25*2) - (3*%d))/%d for X gap", 
                  trayWidth_inch, cols, (cols-1));
-    Serial.printf("[DEBUG] X gap changed from %.3f to %.3f\n", placeGapX_inch_old, placeGapX_inch);
+    LOGD("X gap changed from %.3f to %.3f", placeGapX_inch_old, placeGapX_inch);
 
     if (rows > 1) {
         placeGapY_inch = totalGapYSpace / (rows - 1);
@@ -1384,13 +1501,13 @@ void calculateAndSetGridSpacing(int cols, int rows) {
     // Basic validation: Check if calculated gap is negative
     bool fitError = false;
     if (placeGapX_inch < 0) {
-        Serial.printf("[WARN] Calculated X Gap is negative: %.3f. Items don't fit in fixed width of 26 inches.\n", 
+        LOGW("Calculated X Gap is negative: %.3f. Items don't fit in fixed width of 26 inches.", 
                      placeGapX_inch);
         fitError = true;
         placeGapX_inch = 0; // Clamp gap to 0 if negative
     }
     if (totalGapYSpace < 0) {
-        Serial.printf("[WARN] Items (%.2f) + borders (%.2f) exceed tray height (%.2f). Calculated Y Gap=%.3f\n", 
+        LOGW("Items (%.2f) + borders (%.2f) exceed tray height (%.2f). Calculated Y Gap=%.3f", 
                      totalItemYSpace, 2*pnpBorderWidth_inch, trayHeight_inch, placeGapY_inch);
         fitError = true;
         placeGapY_inch = 0; // Clamp gap to 0 if negative
@@ -1400,203 +1517,31 @@ void calculateAndSetGridSpacing(int cols, int rows) {
     placeGridCols = cols;
     placeGridRows = rows;
 
-    Serial.printf("[INFO] Final calculated gap values: X=%.3f, Y=%.3f\n", placeGapX_inch, placeGapY_inch);
+    LOGI("Final calculated gap values: X=%.3f, Y=%.3f", placeGapX_inch, placeGapY_inch);
 
     // Send update to UI
-    String message = "Grid Columns/Rows updated. Gap calculated.";
-    if (fitError) {
-        message += " Warning: Items may not fit within tray dimensions!";
-    }
-    
-    Serial.printf("[DEBUG] Sending update to UI with message: %s\n", message.c_str());
+    LOGD("Sending update to UI with message: Grid Columns/Rows updated. Gap calculated.%s",
+         fitError ? " Warning: Items may not fit within tray dimensions!" : "");
     // sendAllSettingsUpdate(255, message); // OLD: Call to old function
-    sendCurrentSettings(255); // NEW: Call the renamed function (sends to all clients)
+    broadcastSettingsDelta(); // Only the changed grid/gap values go out
 } 
 
 // Function to save all configurable settings to NVS
+// Write-behind: only marks the settings store dirty. The single settings blob is
+// committed from settingsStoreLoop() once edits settle and the machine is idle.
 void saveSettings() {
-    Serial.println("[DEBUG] saveSettings() started.");
-    
-    // Log some key values before saving
-    Serial.println("[DEBUG] Values being saved:");
-    Serial.printf("  Grid: %d cols, %d rows\n", placeGridCols, placeGridRows);
-    Serial.printf("  Tray: %.2f x %.2f inches\n", trayWidth_inch, trayHeight_inch);
-    Serial.printf("  PnP Pick: (%.2f, %.2f, %.2f)\n", pnpPickLocationX_inch, pnpPickLocationY_inch, pnpPickLocationZ_inch);
-    Serial.printf("  Place First: (%.2f, %.2f)\n", placeFirstXAbsolute_inch, placeFirstYAbsolute_inch);
-    
-    // Log paint start positions
-    Serial.println("  Paint Start X positions:");
-    for (int i = 0; i < 4; i++) {
-        Serial.printf("    Side %d: %.2f\n", i, paintStartX[i]);
-    }
-    Serial.println("  Paint Start Y positions:");
-    for (int i = 0; i < 4; i++) {
-        Serial.printf("    Side %d: %.2f\n", i, paintStartY[i]);
-    }
-    
-    // Open NVS in R/W mode with error checking
-    if (!preferences.begin("paint-machine", false)) {
-        Serial.println("[ERROR] Failed to open NVS namespace for writing!");
-        return;
-    }
-    
-    // Save all settings with error checking
-    
-    // Save PnP/Grid Settings
-    preferences.putInt("gridCols", placeGridCols);
-    preferences.putInt("gridRows", placeGridRows);
-    preferences.putFloat("trayWidth", trayWidth_inch);
-    preferences.putFloat("trayHeight", trayHeight_inch);
-    preferences.putFloat("gunOffsetX", paintGunOffsetX_inch);
-    preferences.putFloat("gunOffsetY", paintGunOffsetY_inch);
-    
-    // Save PnP positions
-    preferences.putFloat("pnpPickX", pnpPickLocationX_inch);
-    preferences.putFloat("pnpPickY", pnpPickLocationY_inch);
-    preferences.putFloat("pnpPickZ", pnpPickLocationZ_inch);
-    preferences.putFloat("pnpPlaceZ", pnpPlaceHeight_inch);
-    preferences.putFloat("firstPlaceX", placeFirstXAbsolute_inch);
-    preferences.putFloat("firstPlaceY", placeFirstYAbsolute_inch);
-    
-    // Save Painting Side Settings
-    size_t bytesWritten = preferences.putBytes("paintZ", paintZHeight_inch, sizeof(paintZHeight_inch));
-    if (bytesWritten != sizeof(paintZHeight_inch)) {
-        Serial.printf("[ERROR] Failed to save paintZ: expected %d bytes, wrote %d bytes\n", 
-                     sizeof(paintZHeight_inch), bytesWritten);
-    }
-    
-    bytesWritten = preferences.putBytes("paintP", paintPitchAngle, sizeof(paintPitchAngle));
-    if (bytesWritten != sizeof(paintPitchAngle)) {
-        Serial.printf("[ERROR] Failed to save paintP: expected %d bytes, wrote %d bytes\n", 
-                     sizeof(paintPitchAngle), bytesWritten);
-    }
-    
-    bytesWritten = preferences.putBytes("paintPat", paintPatternType, sizeof(paintPatternType));
-    if (bytesWritten != sizeof(paintPatternType)) {
-        Serial.printf("[ERROR] Failed to save paintPat: expected %d bytes, wrote %d bytes\n", 
-                     sizeof(paintPatternType), bytesWritten);
-    }
-    
-    bytesWritten = preferences.putBytes("paintS", paintSpeed, sizeof(paintSpeed));
-    if (bytesWritten != sizeof(paintSpeed)) {
-        Serial.printf("[ERROR] Failed to save paintS: expected %d bytes, wrote %d bytes\n", 
-                     sizeof(paintSpeed), bytesWritten);
-    }
-
-    // NEW: Save Painting Start Positions with error checking
-    bytesWritten = preferences.putBytes("paintStartX", paintStartX, sizeof(paintStartX));
-    if (bytesWritten != sizeof(paintStartX)) {
-        Serial.printf("[ERROR] Failed to save paintStartX: expected %d bytes, wrote %d bytes\n", 
-                     sizeof(paintStartX), bytesWritten);
-    }
-    
-    bytesWritten = preferences.putBytes("paintStartY", paintStartY, sizeof(paintStartY));
-    if (bytesWritten != sizeof(paintStartY)) {
-        Serial.printf("[ERROR] Failed to save paintStartY: expected %d bytes, wrote %d bytes\n", 
-                     sizeof(paintStartY), bytesWritten);
-    }
-
-    // Verification - check a few key values
-    int verifyGridCols = preferences.getInt("gridCols", -1);
-    float verifyFirstPlaceX = preferences.getFloat("firstPlaceX", -999.0);
-    
-    if (verifyGridCols != placeGridCols) {
-        Serial.printf("[ERROR] Verification failed for gridCols: expected %d, got %d\n", 
-                      placeGridCols, verifyGridCols);
-    }
-    
-    if (abs(verifyFirstPlaceX - placeFirstXAbsolute_inch) > 0.001) {
-        Serial.printf("[ERROR] Verification failed for firstPlaceX: expected %.2f, got %.2f\n", 
-                      placeFirstXAbsolute_inch, verifyFirstPlaceX);
-    }
-    
-    // Close preferences
-    preferences.end();
-    Serial.println("[INFO] Settings saved to NVS and verified.");
-    Serial.println("[DEBUG] saveSettings() finished.");
+    settingsValidate(); // Clamp anything a command handler let through
+    settingsStoreMarkDirty();
 }
 
 // Function to load all configurable settings from NVS
 void loadSettings() {
     Serial.println("[DEBUG] loadSettings() started.");
-    
-    // Open NVS in read-only mode with error checking
-    if (!preferences.begin("paint-machine", true)) {
-        Serial.println("[ERROR] Failed to open NVS namespace for reading!");
-        // Set default values since we can't read from NVS
-        setDefaultSettings();
-        return;
-    }
 
-    // Load PnP/Grid Settings (with defaults if not found)
-    placeGridCols = preferences.getInt("gridCols", 4);
-    placeGridRows = preferences.getInt("gridRows", 5);
-    trayWidth_inch = preferences.getFloat("trayWidth", 24.0f);
-    trayHeight_inch = preferences.getFloat("trayHeight", 18.0f); 
-    paintGunOffsetX_inch = preferences.getFloat("gunOffsetX", 0.0f);
-    paintGunOffsetY_inch = preferences.getFloat("gunOffsetY", 1.5f);
-    
-    // Load PnP positions (using defaults)
-    pnpPickLocationX_inch = preferences.getFloat("pnpPickX", 2.0f);
-    pnpPickLocationY_inch = preferences.getFloat("pnpPickY", 2.0f);
-    pnpPickLocationZ_inch = preferences.getFloat("pnpPickZ", 2.0f);
-    pnpPlaceHeight_inch = preferences.getFloat("pnpPlaceZ", 0.5f);
-    placeFirstXAbsolute_inch = preferences.getFloat("firstPlaceX", 5.0f);
-    placeFirstYAbsolute_inch = preferences.getFloat("firstPlaceY", 5.0f);
-
-    // Load Painting Side Settings with error checking
-    float defaultZ[4] = {1.0, 1.0, 1.0, 1.0};
-    int defaultP[4] = {SERVO_INIT_POS_PITCH, SERVO_INIT_POS_PITCH, SERVO_INIT_POS_PITCH, SERVO_INIT_POS_PITCH};
-    int defaultPat[4] = {0, 90, 0, 90};
-    float defaultS[4] = {10000.0, 10000.0, 10000.0, 10000.0};
-    
-    size_t bytesRead = preferences.getBytes("paintZ", paintZHeight_inch, sizeof(paintZHeight_inch));
-    if (bytesRead != sizeof(paintZHeight_inch)) {
-        Serial.printf("[WARN] Failed to load paintZ: expected %d bytes, read %d bytes. Using defaults.\n", 
-                     sizeof(paintZHeight_inch), bytesRead);
-        memcpy(paintZHeight_inch, defaultZ, sizeof(paintZHeight_inch));
-    }
-    
-    bytesRead = preferences.getBytes("paintP", paintPitchAngle, sizeof(paintPitchAngle));
-    if (bytesRead != sizeof(paintPitchAngle)) {
-        Serial.printf("[WARN] Failed to load paintP: expected %d bytes, read %d bytes. Using defaults.\n", 
-                     sizeof(paintPitchAngle), bytesRead);
-        memcpy(paintPitchAngle, defaultP, sizeof(paintPitchAngle));
-    }
-    
-    bytesRead = preferences.getBytes("paintPat", paintPatternType, sizeof(paintPatternType));
-    if (bytesRead != sizeof(paintPatternType)) {
-        Serial.printf("[WARN] Failed to load paintPat: expected %d bytes, read %d bytes. Using defaults.\n", 
-                     sizeof(paintPatternType), bytesRead);
-        memcpy(paintPatternType, defaultPat, sizeof(paintPatternType));
+    // Single blob read. The store migrates older blobs and the legacy keys itself
+    if (!settingsStoreLoad()) {
+        Serial.println("[INFO] No stored settings. Using defaults.");
     }
-    
-    bytesRead = preferences.getBytes("paintS", paintSpeed, sizeof(paintSpeed));
-    if (bytesRead != sizeof(paintSpeed)) {
-        Serial.printf("[WARN] Failed to load paintS: expected %d bytes, read %d bytes. Using defaults.\n", 
-                     sizeof(paintSpeed), bytesRead);
-        memcpy(paintSpeed, defaultS, sizeof(paintSpeed));
-    }
-
-    // Load Painting Start Positions with error checking
-    float defaultStartX[4] = { 11.5f, 29.5f, 11.5f, 8.0f };
-    float defaultStartY[4] = { 20.5f, 20.0f, 0.5f,  6.5f };
-    
-    bytesRead = preferences.getBytes("paintStartX", paintStartX, sizeof(paintStartX));
-    if (bytesRead != sizeof(paintStartX)) {
-        Serial.printf("[WARN] Failed to load paintStartX: expected %d bytes, read %d bytes. Using defaults.\n", 
-                     sizeof(paintStartX), bytesRead);
-        memcpy(paintStartX, defaultStartX, sizeof(paintStartX));
-    }
-    
-    bytesRead = preferences.getBytes("paintStartY", paintStartY, sizeof(paintStartY));
-    if (bytesRead != sizeof(paintStartY)) {
-        Serial.printf("[WARN] Failed to load paintStartY: expected %d bytes, read %d bytes. Using defaults.\n", 
-                     sizeof(paintStartY), bytesRead);
-        memcpy(paintStartY, defaultStartY, sizeof(paintStartY));
-    }
-    
-    preferences.end();
 
     // Log the loaded values
     Serial.println("[DEBUG] Values loaded from NVS:");
@@ -1621,63 +1566,20 @@ void loadSettings() {
     Serial.println("[DEBUG] loadSettings() finished.");
 }
 
-// Helper function to set default values for all settings
-void setDefaultSettings() {
-    Serial.println("[INFO] Setting default values for all settings");
-    
-    // PnP/Grid Settings
-    placeGridCols = 4;
-    placeGridRows = 5;
-    trayWidth_inch = 24.0f;
-    trayHeight_inch = 18.0f;
-    paintGunOffsetX_inch = 0.0f;
-    paintGunOffsetY_inch = 1.5f;
-    
-    // PnP positions
-    pnpPickLocationX_inch = 2.0f;
-    pnpPickLocationY_inch = 2.0f;
-    pnpPickLocationZ_inch = 2.0f;
-    pnpPlaceHeight_inch = 0.5f;
-    placeFirstXAbsolute_inch = 5.0f;
-    placeFirstYAbsolute_inch = 5.0f;
-    
-    // Paint settings
-    for (int i = 0; i < 4; i++) {
-        paintZHeight_inch[i] = 1.0f;
-        paintPitchAngle[i] = SERVO_INIT_POS_PITCH;
-        paintPatternType[i] = (i % 2 == 0) ? 0 : 90; // Alternating patterns
-        paintSpeed[i] = 10000.0f;
-    }
-    
-    // Paint start positions
-    paintStartX[0] = 11.5f;  // Back
-    paintStartX[1] = 29.5f;  // Right
-    paintStartX[2] = 11.5f;  // Front
-    paintStartX[3] = 8.0f;   // Left
-    
-    paintStartY[0] = 20.5f;  // Back
-    paintStartY[1] = 20.0f;  // Right
-    paintStartY[2] = 0.5f;   // Front
-    paintStartY[3] = 6.5f;   // Left
-    
-    // Recalculate grid spacing
-    calculateAndSetGridSpacing(placeGridCols, placeGridRows);
-}
-
 // Function to set the pitch servo angle directly
 void setPitchServoAngle(int angle) {
-    Serial.printf("[DEBUG setPitchServoAngle] Received angle: %d\n", angle); // <<< ADDED DEBUG
+    LOGD("Received angle: %d", angle); // <<< ADDED DEBUG
     // Ensure angle is within the servo's physical limits (0-180 typical)
     // Even without software limits, it's good practice to clamp to the standard range
     int targetAngle = constrain(angle, 0, 180); 
-    Serial.printf("[DEBUG setPitchServoAngle] Clamped targetAngle: %d\n", targetAngle); // <<< ADDED DEBUG
+    LOGD("Clamped targetAngle: %d", targetAngle); // <<< ADDED DEBUG
 
     if (servo_pitch.attached()) {
-        Serial.printf("[DEBUG setPitchServoAngle] Servo IS attached. Writing angle %d\n", targetAngle); // <<< ADDED DEBUG
+        LOGD("Servo IS attached. Writing angle %d", targetAngle); // <<< ADDED DEBUG
         servo_pitch.write(targetAngle);
         delay(15); // Small delay to allow servo to start moving
     } else {
-        Serial.println("[ERROR setPitchServoAngle] Pitch servo NOT attached!"); // <<< MODIFIED DEBUG
+        LOGE("setPitchServoAngle: Pitch servo NOT attached!"); // <<< MODIFIED DEBUG
     }
 }
 
@@ -1689,8 +1591,26 @@ void movePitchServoSmoothly(int targetAngle) {
 void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length) {
     switch (type) {
         case WStype_TEXT: {
+            // --- ESTOP: ahead of logging and parsing; latency is measured from here ---
+            if (length == 5 && memcmp(payload, "ESTOP", 5) == 0) {
+                emergencyStopTrigger(ESTOP_SOURCE_COMMAND);
+                return; // loop() reports the trip to every client
+            }
+
+            // --- Optional request id ("#<id> COMMAND"): replies are tagged and acked (CommandAck.h) ---
+            char requestId[CMD_ACK_ID_MAX + 1];
+            size_t idLength = commandAckParseId(payload, length, requestId);
+            payload += idLength;
+            length -= idLength;
+            CommandAckScope ack(num, requestId);
+            if (length == 5 && memcmp(payload, "ESTOP", 5) == 0) {
+                ack.setCommand("ESTOP");
+                emergencyStopTrigger(ESTOP_SOURCE_COMMAND);
+                return;
+            }
+
             // --- Log Raw Payload ---
-            Serial.printf("[%u] WebSocket RAW Received (%d bytes): %.*s\n", num, length, length, payload); // Log raw payload
+            LOGD("[%u] WebSocket RAW Received (%d bytes): %s", num, length, (const char*)payload); // Log raw payload
 
             // Create a mutable copy for strtok
             char payload_copy[length + 1];
@@ -1698,20 +1618,22 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
             payload_copy[length] = '\0';
 
             // --- Parse Command (Only the first token) ---
-            char* cmd = strtok(payload_copy, " "); // Get the first word/command
+            char* cmd = strtok(payload_copy, " \r\n"); // Get the first word/command (BATCH/DEFINE_MACRO end it with a newline)
             if (cmd == NULL) {
-                Serial.printf("[%u] WebSocket: Ignoring empty message.\n", num);
+                LOGI("[%u] WebSocket: Ignoring empty message.", num);
+                commandAckReject();
                 return; 
             }
             // Store the command safely before strtok potentially modifies the buffer further if args are parsed
             char commandStr[32]; // Adjust size if longer commands are expected
             strncpy(commandStr, cmd, sizeof(commandStr) - 1);
             commandStr[sizeof(commandStr) - 1] = '\0'; // Ensure null termination
+            ack.setCommand(commandStr);
             
-            Serial.printf("[%u] WebSocket Parsed Command: '%s'\n", num, commandStr);
+            LOGI("[%u] WebSocket Parsed Command: '%s'", num, commandStr);
 
             // --- Log Current State BEFORE Handling Command ---
-            Serial.printf("    State Before Check: allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d, isPressurePotOn=%d\n",
+            LOGD("    State Before Check: allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d, isPressurePotOn=%d",
                           allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode, isPressurePotOn); // Added pressure pot state
 
             // --- Handle Command (Revised Structure) ---
@@ -1720,208 +1642,492 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
             // --- Simple Commands (No Args or State Checks needed beyond basic parse) ---
             if (strcmp(commandStr, "GET_STATUS") == 0) {
                 commandHandled = true;
-                Serial.printf("[%u] Handling GET_STATUS\n", num);
+                LOGI("[%u] Handling GET_STATUS", num);
                 sendCurrentSettings(num);
                 if (allHomed) { sendCurrentPositionUpdate(); }
             } 
+            else if (strcmp(commandStr, "GET_SETTINGS") == 0) {
+                commandHandled = true;
+                // GET_SETTINGS [epoch version] - delta since the client's last-seen version
+                char* epoch_str = strtok(NULL, " ");
+                char* version_str = strtok(NULL, " ");
+                if (epoch_str && version_str) {
+                    sendSettingsSince(num, strtoul(epoch_str, NULL, 10), strtoul(version_str, NULL, 10));
+                } else {
+                    sendCurrentSettings(num);
+                }
+            }
+            else if (strcmp(commandStr, "GET_ESTOP") == 0) {
+                commandHandled = true;
+                // E-stop latch, input level and the trip latencies in microseconds
+                char estopBuf[220];
+                int len = emergencyStopWriteJson(estopBuf, sizeof(estopBuf));
+                if (len < 0) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"E-stop status exceeds buffer.\"}"); }
+                else { webSocket.sendTXT(num, estopBuf, len); }
+            }
+            else if (strcmp(commandStr, "ESTOP_RESET") == 0) {
+                commandHandled = true;
+                LOGI("[%u] Handling ESTOP_RESET", num);
+                if (!emergencyStopLatched()) {
+                    webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Emergency stop is not latched.\"}");
+                } else if (!emergencyStopReset()) {
+                    LOGW("    ESTOP_RESET Denied: Input still asserted.");
+                    webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Emergency stop input is still asserted.\"}");
+                } else {
+                    stopRequested = false;
+                    webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Emergency stop reset. Home the machine before moving.\"}");
+                }
+            }
+            else if (strcmp(commandStr, "GET_PROFILE") == 0) {
+                commandHandled = true;
+                // Dump loop() region timings and start a new measurement window
+                static char profileBuf[2048];
+                int len = profilerWriteJson(profileBuf, sizeof(profileBuf), true);
+                if (len < 0) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Profile exceeds buffer; counters reset.\"}"); }
+                else { webSocket.sendTXT(num, profileBuf, len); }
+            }
+            else if (strcmp(commandStr, "SET_SPRAY_MODEL") == 0) {
+                commandHandled = true;
+                // SET_SPRAY_MODEL <side> <widthInch> <overlapPct> - width 0 returns to one pass per item
+                if (isMoving || isHoming || isPainting) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot change the spray model while busy.\"}"); }
+                else {
+                    char* side_str = strtok(NULL, " "); char* width_str = strtok(NULL, " "); char* overlap_str = strtok(NULL, " ");
+                    int side = side_str ? atoi(side_str) : -1;
+                    float width = width_str ? atof(width_str) : -1.0f;
+                    float overlap = overlap_str ? atof(overlap_str) : -1.0f;
+                    if (side < 0 || side > 3 || !(width == 0.0f || (width >= 0.25f && width <= 24.0f)) || overlap < 0.0f || overlap > 90.0f) {
+                        webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Usage: SET_SPRAY_MODEL <side 0-3> <width 0 or 0.25-24 in> <overlap 0-90 %>\"}");
+                    } else {
+                        uint32_t settingsBefore = settingsScanChanges();
+                        paintSprayWidth_inch[side] = width;
+                        paintSprayOverlap_pct[side] = overlap;
+                        LOGI("[%u] Spray model side %d: width %.2f in, overlap %.0f%%", num, side, width, overlap);
+                        saveSettings();
+                        replySettingsApplied(num, settingsBefore);
+                    }
+                }
+            }
+            else if (strcmp(commandStr, "SET_SWEEP_OVERTRAVEL") == 0) {
+                commandHandled = true;
+                // SET_SWEEP_OVERTRAVEL 0|1 - run-in/run-out from paint speed and accel, clamped to the travel limits
+                char* value_str = strtok(NULL, " ");
+                if (isMoving || isHoming || isPainting) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot change sweep overtravel while busy.\"}"); }
+                else if (!value_str || (strcmp(value_str, "0") != 0 && strcmp(value_str, "1") != 0)) {
+                    webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Usage: SET_SWEEP_OVERTRAVEL 0|1\"}");
+                } else {
+                    uint32_t settingsBefore = settingsScanChanges();
+                    paintSweepOvertravel = atoi(value_str);
+                    LOGI("[%u] Sweep overtravel %s", num, paintSweepOvertravel ? "ON" : "OFF");
+                    saveSettings();
+                    replySettingsApplied(num, settingsBefore);
+                }
+            }
+            else if (strcmp(commandStr, "SET_FEED_OVERRIDE") == 0) {
+                commandHandled = true;
+                // SET_FEED_OVERRIDE <pct> - live; the paint move in flight is re-issued at the new speed
+                char* value_str = strtok(NULL, " ");
+                int pct = value_str ? atoi(value_str) : 0;
+                if (pct < FEED_OVERRIDE_MIN_PCT || pct > FEED_OVERRIDE_MAX_PCT) {
+                    char usage[100];
+                    snprintf(usage, sizeof(usage), "{\"status\":\"Error\", \"message\":\"Usage: SET_FEED_OVERRIDE %d-%d\"}",
+                             FEED_OVERRIDE_MIN_PCT, FEED_OVERRIDE_MAX_PCT);
+                    webSocket.sendTXT(num, usage);
+                } else if (pct == paintFeedOverride_pct) {
+                    webSocket.sendTXT(num, "{\"status\":\"Ready\", \"message\":\"No change: feed override already at that value.\"}");
+                } else {
+                    paintFeedOverride_pct = pct;
+                    LOGI("[%u] Feed override %d%%", num, pct);
+                    broadcastSettingsDelta(); // Status carries the override
+                }
+            }
+            else if (strcmp(commandStr, "GET_TOOLPATH") == 0) {
+                commandHandled = true;
+                // GET_TOOLPATH <side> - compiled path for the current settings (input for tools/paint_sim)
+                char* side_str = strtok(NULL, " ");
+                int side = side_str ? atoi(side_str) : -1;
+                const Toolpath* path = (side_str && side >= 0 && side <= 3) ? getSideToolpath(side, paintSpeed[side]) : nullptr;
+                static char toolpathBuf[4096];
+                int len = path ? toolpathWriteJson(*path, toolpathBuf, sizeof(toolpathBuf)) : -1;
+                if (!path && side_str && side >= 0 && side <= 3) { char err[220]; snprintf(err, sizeof(err), "{\"status\":\"Error\", \"message\":\"%s\"}", sideToolpathError()); webSocket.sendTXT(num, err); }
+                else if (!path) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Usage: GET_TOOLPATH <0-3>\"}"); }
+                else if (len < 0) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Toolpath exceeds buffer.\"}"); }
+                else { webSocket.sendTXT(num, toolpathBuf, len); }
+            }
+            else if (strcmp(commandStr, "GET_RASTER_PLAN") == 0) {
+                commandHandled = true;
+                // GET_RASTER_PLAN <side> - passes and path length per raster angle for the side's grid
+                char* side_str = strtok(NULL, " ");
+                int side = side_str ? atoi(side_str) : -1;
+                static char rasterBuf[1536];
+                int len = (side_str && side >= 0 && side <= 3) ? rasterPlanWriteJson(side, rasterBuf, sizeof(rasterBuf)) : 0;
+                if (len == 0) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Usage: GET_RASTER_PLAN <0-3>\"}"); }
+                else if (len < 0) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Raster plan exceeds buffer.\"}"); }
+                else { webSocket.sendTXT(num, rasterBuf, len); }
+            }
+            else if (strcmp(commandStr, "GET_HEAP") == 0) {
+                commandHandled = true;
+                // Free heap and largest free block now, their lows since boot and the boot baseline
+                char heapBuf[220];
+                int pos = snprintf(heapBuf, sizeof(heapBuf), "{\"status\":\"Heap\",");
+                int n = heapMetricsWriteJson(heapBuf + pos, sizeof(heapBuf) - pos - 1);
+                if (n < 0) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Heap metrics exceed buffer.\"}"); }
+                else { pos += n; heapBuf[pos++] = '}'; webSocket.sendTXT(num, heapBuf, pos); }
+            }
+            else if (strcmp(commandStr, "GET_DIAGNOSTICS") == 0) {
+                commandHandled = true;
+                // Heap, task stack high-water marks, per-core idle, stepper queues and WebSocket clients
+                static char diagBuf[1536];
+                int len = diagnosticsWriteJson(diagBuf, sizeof(diagBuf));
+                if (len < 0) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Diagnostics exceed buffer.\"}"); }
+                else { webSocket.sendTXT(num, diagBuf, len); }
+            }
+            else if (strcmp(commandStr, "GET_JOB_METRICS") == 0) {
+                commandHandled = true;
+                // Time breakdown of the running job and the last JOB_HISTORY_SIZE jobs
+                static char metricsBuf[4096];
+                int len = jobMetricsWriteJson(metricsBuf, sizeof(metricsBuf));
+                if (len < 0) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Job metrics exceed buffer.\"}"); }
+                else { webSocket.sendTXT(num, metricsBuf, len); }
+            }
+            else if (strcmp(commandStr, "SET_LOG_MODE") == 0) {
+                commandHandled = true;
+                // SET_LOG_MODE TEXT|BINARY - binary frames are decoded with tools/log_decode.py
+                char* mode_str = strtok(NULL, " ");
+                if (mode_str && (strcmp(mode_str, "TEXT") == 0 || strcmp(mode_str, "BINARY") == 0)) {
+                    logSetBinary(strcmp(mode_str, "BINARY") == 0);
+                    char reply[96];
+                    snprintf(reply, sizeof(reply), "{\"status\":\"Ready\", \"message\":\"Serial log mode: %s (%lu dropped).\"}",
+                             mode_str, (unsigned long)logDroppedCount());
+                    webSocket.sendTXT(num, reply);
+                } else {
+                    webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid format for SET_LOG_MODE. Use: SET_LOG_MODE TEXT|BINARY\"}");
+                }
+            }
+            else if (strcmp(commandStr, "LIST_RECIPES") == 0) {
+                commandHandled = true;
+                static char listBuf[1536];
+                int len = recipeListJson(listBuf, sizeof(listBuf));
+                if (len < 0) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Too many recipes to list.\"}"); }
+                else { webSocket.sendTXT(num, listBuf, len); }
+            }
+            else if (strcmp(commandStr, "SAVE_RECIPE") == 0 || strcmp(commandStr, "LOAD_RECIPE") == 0 || strcmp(commandStr, "DELETE_RECIPE") == 0) {
+                commandHandled = true;
+                LOGI("[%u] Handling %s", num, commandStr);
+                char* name_str = strtok(NULL, " ");
+                char resultMsg[96];
+                char reply[160];
+                bool ok;
+                // Flash writes stall motion and a load swaps the job under the machine's feet
+                if (isMoving || isHoming || isPainting || inPickPlaceMode || inCalibrationMode) {
+                    ok = false;
+                    snprintf(resultMsg, sizeof(resultMsg), "Cannot change recipes while machine is busy.");
+                } else if (strcmp(commandStr, "SAVE_RECIPE") == 0) {
+                    ok = recipeSave(name_str, resultMsg, sizeof(resultMsg));
+                } else if (strcmp(commandStr, "LOAD_RECIPE") == 0) {
+                    ok = recipeLoad(name_str, resultMsg, sizeof(resultMsg)); // Broadcasts the new settings itself
+                } else {
+                    ok = recipeDelete(name_str, resultMsg, sizeof(resultMsg));
+                }
+                LOGI("    %s %s: %s", commandStr, ok ? "Accepted" : "Denied", resultMsg);
+                snprintf(reply, sizeof(reply), "{\"status\":\"%s\", \"message\":\"%s\"}", ok ? "Ready" : "Error", resultMsg);
+                webSocket.sendTXT(num, reply);
+            }
+            else if (strcmp(commandStr, "BATCH") == 0) {
+                commandHandled = true;
+                // BATCH, then one settings command per line: applied together or not at all
+                LOGI("[%u] Handling BATCH", num);
+                const char* lines = (const char*)memchr(payload, '\n', length);
+                if (!lines) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Usage: BATCH, then one settings command per line.\"}"); }
+                else { runCommandBatch(num, lines + 1, length - (lines + 1 - (const char*)payload)); }
+            }
+            else if (strcmp(commandStr, "LIST_MACROS") == 0) {
+                commandHandled = true;
+                static char listBuf[1536];
+                int len = macroListJson(listBuf, sizeof(listBuf));
+                if (len < 0) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Too many macros to list.\"}"); }
+                else { webSocket.sendTXT(num, listBuf, len); }
+            }
+            else if (strcmp(commandStr, "DEFINE_MACRO") == 0 || strcmp(commandStr, "RUN_MACRO") == 0 || strcmp(commandStr, "DELETE_MACRO") == 0) {
+                commandHandled = true;
+                // DEFINE_MACRO <name>, then one command per line; RUN_MACRO <name>; DELETE_MACRO <name>
+                LOGI("[%u] Handling %s", num, commandStr);
+                char* name_str = strtok(NULL, " \r\n");
+                char resultMsg[128];
+                char reply[192];
+                bool ok;
+                bool run = strcmp(commandStr, "RUN_MACRO") == 0;
+                if (isMoving || isHoming || isPainting || macroRunning) {
+                    ok = false;
+                    snprintf(resultMsg, sizeof(resultMsg), "Cannot change or run macros while machine is busy.");
+                } else if (run) {
+                    ok = macroStart(num, name_str, resultMsg, sizeof(resultMsg)); // loop() replays it
+                } else if (strcmp(commandStr, "DEFINE_MACRO") == 0) {
+                    const char* body = (const char*)memchr(payload, '\n', length);
+                    if (name_str && body && name_str - payload_copy > body - (const char*)payload) name_str = NULL; // Name must be on the first line
+                    if (!body) {
+                        ok = false;
+                        snprintf(resultMsg, sizeof(resultMsg), "Usage: DEFINE_MACRO <name>, then one command per line.");
+                    } else {
+                        ok = macroSave(name_str, body + 1, length - (body + 1 - (const char*)payload), resultMsg, sizeof(resultMsg));
+                    }
+                } else {
+                    ok = macroDelete(name_str, resultMsg, sizeof(resultMsg));
+                }
+                LOGI("    %s %s: %s", commandStr, ok ? "Accepted" : "Denied", resultMsg);
+                snprintf(reply, sizeof(reply), "{\"status\":\"%s\", \"message\":\"%s\"}", ok ? (run ? "Busy" : "Ready") : "Error", resultMsg);
+                webSocket.sendTXT(num, reply);
+            }
             else if (strcmp(commandStr, "EXIT_PICKPLACE") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling EXIT_PICKPLACE\n", num);
-                 Serial.println("    EXIT_PICKPLACE Accepted: Exiting PnP mode.");
+                 LOGI("[%u] Handling EXIT_PICKPLACE", num);
+                 LOGI("    EXIT_PICKPLACE Accepted: Exiting PnP mode.");
                  exitPickPlaceMode(true); 
              }
              else if (strcmp(commandStr, "EXIT_CALIBRATION") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling EXIT_CALIBRATION\n", num);
-                 Serial.println("    EXIT_CALIBRATION Accepted: Exiting calibration mode.");
+                 LOGI("[%u] Handling EXIT_CALIBRATION", num);
+                 LOGI("    EXIT_CALIBRATION Accepted: Exiting calibration mode.");
                  inCalibrationMode = false;
                  webSocket.broadcastTXT("{\"status\":\"Ready\", \"message\":\"Exited calibration mode.\"}");
              }
              else if (strcmp(commandStr, "STOP") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling STOP\n", num);
-                 Serial.println("    STOP Accepted: Initiating stop sequence.");
+                 LOGI("[%u] Handling STOP", num);
+                 LOGI("    STOP Accepted: Initiating stop sequence.");
                  stopRequested = true; 
+                 pauseRequested = false;
+                 paintCheckpointClear(); // STOP abandons a paused job too
+                 motionWatchdogDisarmAll();
+                 jobEnd(JOB_STOPPED);
                  if(stepper_x) stepper_x->forceStop();
                  if(stepper_y_left) stepper_y_left->forceStop();
                  if(stepper_y_right) stepper_y_right->forceStop();
                  if(stepper_z) stepper_z->forceStop();
                  if(stepper_rot) stepper_rot->forceStop(); 
-                 Serial.println("    STOP: Motors force stopped.");
+                 LOGI("    STOP: Motors force stopped.");
                  isMoving = false; isHoming = false; inPickPlaceMode = false; inCalibrationMode = false; 
+                 if (macroRunning) macroAbort("Stopped", "STOP requested");
                  webSocket.broadcastTXT("{\"status\":\"Busy\", \"message\":\"STOP initiated. Homing axes...\"}"); 
                  homeAllAxes(); 
              }
+             else if (strcmp(commandStr, "PAUSE") == 0) {
+                 commandHandled = true;
+                 LOGI("[%u] Handling PAUSE", num);
+                 if (!isPainting || isPaintPaused) {
+                     LOGW("    PAUSE Denied: Not painting.");
+                     webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Nothing to pause.\"}");
+                 } else {
+                     // The executor cuts the gun, decelerates and checkpoints at the next chance
+                     LOGI("    PAUSE Accepted.");
+                     pauseRequested = true;
+                     webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Pausing...\"}");
+                 }
+             }
+             else if (strcmp(commandStr, "RESUME") == 0) {
+                 commandHandled = true;
+                 LOGI("[%u] Handling RESUME", num);
+                 PaintCheckpoint cp;
+                 char resumeMsg[120];
+                 if (isPainting && isPaintPaused) {
+                     // Back through step 0 (servo pitch), then the executor resumes from the checkpoint
+                     LOGI("    RESUME Accepted: Continuing side %d.", currentPaintSide);
+                     isPaintPaused = false;
+                     isMoving = true;
+                     currentPaintStep = 0;
+                     jobSetCategory(JOB_CAT_OTHER);
+                     snprintf(resumeMsg, sizeof(resumeMsg), "{\"status\":\"Busy\", \"message\":\"Resuming side %d...\"}", currentPaintSide);
+                     webSocket.broadcastTXT(resumeMsg);
+                 } else if (isPainting) {
+                     webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Painting is not paused.\"}");
+                 } else if (!paintCheckpointGet(cp)) {
+                     webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"No paused job to resume.\"}");
+                 } else if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode) {
+                     LOGW("    RESUME Denied: Invalid state.");
+                     webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot resume, machine is busy or not homed.\"}");
+                 } else {
+                     // Checkpoint from before a reboot: start the job again at the paused side
+                     LOGI("    RESUME Accepted: Restarting side %u from its checkpoint.", cp.side);
+                     startPaintingSide(cp.side, cp.sequence != 0, true);
+                 }
+             }
+             else if (strcmp(commandStr, "GET_CHECKPOINT") == 0) {
+                 commandHandled = true;
+                 char checkpointBuf[256];
+                 int len = paintCheckpointWriteJson(checkpointBuf, sizeof(checkpointBuf));
+                 if (len < 0) { webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Checkpoint exceeds buffer.\"}"); }
+                 else { webSocket.sendTXT(num, checkpointBuf, len); }
+             }
              // --- PnP Step Commands (Require PnP Mode) ---
              else if (strcmp(commandStr, "PNP_NEXT_STEP") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling PNP_NEXT_STEP\n", num);
-                 Serial.printf("    State Check (PNP_NEXT_STEP): inPnP=%d, isMoving=%d, isHoming=%d\n", inPickPlaceMode, isMoving, isHoming);
-                 if (!inPickPlaceMode) { Serial.println("    PNP_NEXT_STEP Denied: Not in PnP mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Not in Pick/Place mode.\"}"); } 
-                 else if (isMoving || isHoming) { Serial.println("    PNP_NEXT_STEP Denied: Busy."); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Machine is busy, cannot perform next step.\"}"); } 
-                 else { Serial.println("    PNP_NEXT_STEP Accepted: Executing next step."); executeNextPickPlaceStep(); }
+                 LOGI("[%u] Handling PNP_NEXT_STEP", num);
+                 LOGD("    State Check (PNP_NEXT_STEP): inPnP=%d, isMoving=%d, isHoming=%d", inPickPlaceMode, isMoving, isHoming);
+                 if (!inPickPlaceMode) { LOGW("    PNP_NEXT_STEP Denied: Not in PnP mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Not in Pick/Place mode.\"}"); } 
+                 else if (isMoving || isHoming) { LOGW("    PNP_NEXT_STEP Denied: Busy."); commandAckReject(); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Machine is busy, cannot perform next step.\"}"); } 
+                 else { LOGI("    PNP_NEXT_STEP Accepted: Executing next step."); executeNextPickPlaceStep(); }
              } 
              else if (strcmp(commandStr, "PNP_SKIP_LOCATION") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling PNP_SKIP_LOCATION\n", num);
-                 Serial.printf("    State Check (PNP_SKIP_LOCATION): inPnP=%d, isMoving=%d, isHoming=%d\n", inPickPlaceMode, isMoving, isHoming);
-                 if (!inPickPlaceMode) { Serial.println("    PNP_SKIP_LOCATION Denied: Not in PnP mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Not in Pick/Place mode.\"}"); } 
-                 else if (isMoving || isHoming) { Serial.println("    PNP_SKIP_LOCATION Denied: Busy."); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Machine is busy, cannot skip location.\"}"); } 
-                 else { Serial.println("    PNP_SKIP_LOCATION Accepted: Skipping location."); skipPickPlaceLocation(); }
+                 LOGI("[%u] Handling PNP_SKIP_LOCATION", num);
+                 LOGD("    State Check (PNP_SKIP_LOCATION): inPnP=%d, isMoving=%d, isHoming=%d", inPickPlaceMode, isMoving, isHoming);
+                 if (!inPickPlaceMode) { LOGW("    PNP_SKIP_LOCATION Denied: Not in PnP mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Not in Pick/Place mode.\"}"); } 
+                 else if (isMoving || isHoming) { LOGW("    PNP_SKIP_LOCATION Denied: Busy."); commandAckReject(); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Machine is busy, cannot skip location.\"}"); } 
+                 else { LOGI("    PNP_SKIP_LOCATION Accepted: Skipping location."); skipPickPlaceLocation(); }
              } 
              else if (strcmp(commandStr, "PNP_BACK_LOCATION") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling PNP_BACK_LOCATION\n", num);
-                 Serial.printf("    State Check (PNP_BACK_LOCATION): inPnP=%d, isMoving=%d, isHoming=%d\n", inPickPlaceMode, isMoving, isHoming);
-                 if (!inPickPlaceMode) { Serial.println("    PNP_BACK_LOCATION Denied: Not in PnP mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Not in Pick/Place mode.\"}"); } 
-                 else if (isMoving || isHoming) { Serial.println("    PNP_BACK_LOCATION Denied: Busy."); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Machine is busy, cannot go back.\"}"); } 
-                 else { Serial.println("    PNP_BACK_LOCATION Accepted: Going back one location."); goBackPickPlaceLocation(); }
+                 LOGI("[%u] Handling PNP_BACK_LOCATION", num);
+                 LOGD("    State Check (PNP_BACK_LOCATION): inPnP=%d, isMoving=%d, isHoming=%d", inPickPlaceMode, isMoving, isHoming);
+                 if (!inPickPlaceMode) { LOGW("    PNP_BACK_LOCATION Denied: Not in PnP mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Not in Pick/Place mode.\"}"); } 
+                 else if (isMoving || isHoming) { LOGW("    PNP_BACK_LOCATION Denied: Busy."); commandAckReject(); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Machine is busy, cannot go back.\"}"); } 
+                 else { LOGI("    PNP_BACK_LOCATION Accepted: Going back one location."); goBackPickPlaceLocation(); }
              }
              // --- Calibration Mode Commands (Require Calibration Mode) ---
               else if (strcmp(commandStr, "JOG") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling JOG\n", num);
-                 Serial.printf("    State Check (JOG): inCalib=%d, isMoving=%d, isHoming=%d\n", inCalibrationMode, isMoving, isHoming);
-                 if (!inCalibrationMode) { Serial.println("    JOG Denied: Not in calibration mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Must be in calibration mode to jog.\"}"); } 
-                 else if (isMoving || isHoming) { Serial.println("    JOG Denied: Busy."); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Cannot jog while machine is moving.\"}"); } 
+                 LOGI("[%u] Handling JOG", num);
+                 LOGD("    State Check (JOG): inCalib=%d, isMoving=%d, isHoming=%d", inCalibrationMode, isMoving, isHoming);
+                 if (!inCalibrationMode) { LOGW("    JOG Denied: Not in calibration mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Must be in calibration mode to jog.\"}"); } 
+                 else if (isMoving || isHoming) { LOGW("    JOG Denied: Busy."); commandAckReject(); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Cannot jog while machine is moving.\"}"); } 
+                 else if (emergencyStopLatched()) { LOGW("    JOG Denied: Emergency stop latched."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Emergency stop latched. Release it and send ESTOP_RESET.\"}"); } 
                  else {
                      char* axis_str = strtok(NULL, " "); char* dist_str = strtok(NULL, " ");
                      if (axis_str && dist_str && strlen(axis_str) == 1) {
                          char axis = axis_str[0]; float distance_inch = atof(dist_str);
-                         Serial.printf("    JOG Accepted: Axis %c, Dist %.3f\n", axis, distance_inch);
+                         LOGI("    JOG Accepted: Axis %c, Dist %.3f", axis, distance_inch);
                          // Find stepper based on axis...
                          FastAccelStepper* stepper_to_move = NULL; long current_steps = 0; long jog_steps = 0; float speed = 0, accel = 0;
                          if (axis == 'X' && stepper_x) { stepper_to_move = stepper_x; current_steps = stepper_x->getCurrentPosition(); jog_steps = (long)(distance_inch * STEPS_PER_INCH_XY); speed = patternXSpeed; accel = patternXAccel; } 
                          else if (axis == 'Y' && stepper_y_left && stepper_y_right) { stepper_to_move = stepper_y_left; current_steps = stepper_y_left->getCurrentPosition(); jog_steps = (long)(distance_inch * STEPS_PER_INCH_XY); speed = patternYSpeed; accel = patternYAccel; } 
                          else if (axis == 'Z' && stepper_z) { stepper_to_move = stepper_z; current_steps = stepper_z->getCurrentPosition(); jog_steps = (long)(distance_inch * STEPS_PER_INCH_Z); speed = patternZSpeed; accel = patternZAccel; } 
-                         else { Serial.printf("    JOG Denied: Invalid axis '%c' or stepper not available.\n", axis); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid axis for jog.\"}"); stepper_to_move = NULL; }
+                         else { LOGW("    JOG Denied: Invalid axis '%c' or stepper not available.", axis); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid axis for jog.\"}"); stepper_to_move = NULL; }
 
                          if (stepper_to_move) {
                              isMoving = true; webSocket.broadcastTXT("{\"status\":\"Busy\", \"message\":\"Jogging...\"}");
                              long target_steps = current_steps + jog_steps;
                              stepper_to_move->setSpeedInHz(speed); stepper_to_move->setAcceleration(accel);
-                             if (axis == 'Z') { float target_pos_inch = constrain((float)target_steps / STEPS_PER_INCH_Z, Z_MAX_TRAVEL_NEG_INCH, Z_MAX_TRAVEL_POS_INCH); target_steps = (long)(target_pos_inch * STEPS_PER_INCH_Z); Serial.printf("    Jogging Z (constrained) to %.3f inches (%ld steps)\n", target_pos_inch, target_steps); } 
-                             else { Serial.printf("    Jogging %c to %ld steps\n", axis, target_steps); }
-                             stepper_to_move->moveTo(target_steps);
-                             if (axis == 'Y' && stepper_y_right) { stepper_y_right->setSpeedInHz(speed); stepper_y_right->setAcceleration(accel); stepper_y_right->moveTo(target_steps); }
+                             if (axis == 'Z') { float target_pos_inch = constrain((float)target_steps / STEPS_PER_INCH_Z, Z_MAX_TRAVEL_NEG_INCH, Z_MAX_TRAVEL_POS_INCH); target_steps = (long)(target_pos_inch * STEPS_PER_INCH_Z); LOGI("    Jogging Z (constrained) to %.3f inches (%ld steps)", target_pos_inch, target_steps); } 
+                             else { LOGI("    Jogging %c to %ld steps", axis, target_steps); }
+                             emergencyStopMoveTo(stepper_to_move, target_steps);
+                             if (axis == 'Y' && stepper_y_right) { stepper_y_right->setSpeedInHz(speed); stepper_y_right->setAcceleration(accel); emergencyStopMoveTo(stepper_y_right, target_steps); }
                          }
-                     } else { Serial.println("    JOG Denied: Invalid format."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid JOG format. Use: JOG X/Y/Z distance\"}"); }
+                     } else { LOGW("    JOG Denied: Invalid format."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid JOG format. Use: JOG X/Y/Z distance\"}"); }
                  }
              } 
              else if (strcmp(commandStr, "MOVE_TO_COORDS") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling MOVE_TO_COORDS\n", num);
-                 Serial.printf("    State Check (MOVE_TO_COORDS): inCalib=%d, isMoving=%d, isHoming=%d\n", inCalibrationMode, isMoving, isHoming);
-                 if (!inCalibrationMode) { Serial.println("    MOVE_TO_COORDS Denied: Not in calibration mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Must be in calibration mode to move to coords.\"}"); } 
-                 else if (isMoving || isHoming) { Serial.println("    MOVE_TO_COORDS Denied: Busy."); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Cannot move while machine is moving.\"}"); } 
+                 LOGI("[%u] Handling MOVE_TO_COORDS", num);
+                 LOGD("    State Check (MOVE_TO_COORDS): inCalib=%d, isMoving=%d, isHoming=%d", inCalibrationMode, isMoving, isHoming);
+                 if (!inCalibrationMode) { LOGW("    MOVE_TO_COORDS Denied: Not in calibration mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Must be in calibration mode to move to coords.\"}"); } 
+                 else if (isMoving || isHoming) { LOGW("    MOVE_TO_COORDS Denied: Busy."); commandAckReject(); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Cannot move while machine is moving.\"}"); } 
                  else {
                      char* x_str = strtok(NULL, " "); char* y_str = strtok(NULL, " ");
                      if (x_str && y_str) {
                          float xVal = atof(x_str); float yVal = atof(y_str);
-                         if (xVal >= 0 && yVal >= 0) { Serial.printf("    MOVE_TO_COORDS Accepted: X=%.2f, Y=%.2f\n", xVal, yVal); isMoving = true; webSocket.broadcastTXT("{\"status\":\"Busy\", \"message\":\"Moving to position...\"}"); moveToXYPositionInches(xVal, yVal); } 
-                         else { Serial.println("    MOVE_TO_COORDS Denied: Coordinates must be non-negative."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Coordinates must be non-negative.\"}"); }
-                     } else { Serial.println("    MOVE_TO_COORDS Denied: Invalid format."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid MOVE_TO_COORDS format. Use: MOVE_TO_COORDS X Y\"}"); }
+                         if (xVal >= 0 && yVal >= 0) { LOGI("    MOVE_TO_COORDS Accepted: X=%.2f, Y=%.2f", xVal, yVal); isMoving = true; webSocket.broadcastTXT("{\"status\":\"Busy\", \"message\":\"Moving to position...\"}"); moveToXYPositionInches(xVal, yVal); } 
+                         else { LOGW("    MOVE_TO_COORDS Denied: Coordinates must be non-negative."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Coordinates must be non-negative.\"}"); }
+                     } else { LOGW("    MOVE_TO_COORDS Denied: Invalid format."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid MOVE_TO_COORDS format. Use: MOVE_TO_COORDS X Y\"}"); }
                  }
              } 
              else if (strcmp(commandStr, "SET_OFFSET_FROM_CURRENT") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling SET_OFFSET_FROM_CURRENT\n", num);
-                 Serial.printf("    State Check (SET_OFFSET_FROM_CURRENT): inCalib=%d, isMoving=%d, isHoming=%d\n", inCalibrationMode, isMoving, isHoming);
-                 if (!inCalibrationMode) { Serial.println("    SET_OFFSET_FROM_CURRENT Denied: Not in calibration mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Must be in calibration mode.\"}"); } 
-                 else if (isMoving || isHoming) { Serial.println("    SET_OFFSET_FROM_CURRENT Denied: Busy."); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Cannot set while moving.\"}"); } 
+                 LOGI("[%u] Handling SET_OFFSET_FROM_CURRENT", num);
+                 LOGD("    State Check (SET_OFFSET_FROM_CURRENT): inCalib=%d, isMoving=%d, isHoming=%d", inCalibrationMode, isMoving, isHoming);
+                 if (!inCalibrationMode) { LOGW("    SET_OFFSET_FROM_CURRENT Denied: Not in calibration mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Must be in calibration mode.\"}"); } 
+                 else if (isMoving || isHoming) { LOGW("    SET_OFFSET_FROM_CURRENT Denied: Busy."); commandAckReject(); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Cannot set while moving.\"}"); } 
                  else {
-                     if (stepper_x && stepper_y_left) { pnpOffsetX_inch = (float)stepper_x->getCurrentPosition() / STEPS_PER_INCH_XY; pnpOffsetY_inch = (float)stepper_y_left->getCurrentPosition() / STEPS_PER_INCH_XY; saveSettings(); Serial.printf("    SET_OFFSET_FROM_CURRENT Accepted: Set to X: %.2f, Y: %.2f\n", pnpOffsetX_inch, pnpOffsetY_inch); sendCurrentSettings(num); } 
-                     else { Serial.println("    SET_OFFSET_FROM_CURRENT Denied: Steppers not available."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Steppers not available.\"}"); }
+                     if (stepper_x && stepper_y_left) { uint32_t settingsBefore = settingsScanChanges(); pnpOffsetX_inch = (float)stepper_x->getCurrentPosition() / STEPS_PER_INCH_XY; pnpOffsetY_inch = (float)stepper_y_left->getCurrentPosition() / STEPS_PER_INCH_XY; saveSettings(); LOGI("    SET_OFFSET_FROM_CURRENT Accepted: Set to X: %.2f, Y: %.2f", pnpOffsetX_inch, pnpOffsetY_inch); replySettingsApplied(num, settingsBefore); } 
+                     else { LOGW("    SET_OFFSET_FROM_CURRENT Denied: Steppers not available."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Steppers not available.\"}"); }
                  }
              } 
              else if (strcmp(commandStr, "SET_FIRST_PLACE_ABS_FROM_CURRENT") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling SET_FIRST_PLACE_ABS_FROM_CURRENT\n", num);
-                 Serial.printf("    State Check (SET_FIRST_PLACE_ABS_FROM_CURRENT): inCalib=%d, isMoving=%d, isHoming=%d\n", inCalibrationMode, isMoving, isHoming);
-                 if (!inCalibrationMode) { Serial.println("    SET_FIRST_PLACE_ABS_FROM_CURRENT Denied: Not in calibration mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Must be in Calibration Mode to set First Place position from current.\"}"); } 
-                 else if (isMoving || isHoming) { Serial.println("    SET_FIRST_PLACE_ABS_FROM_CURRENT Denied: Busy."); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Cannot set while moving.\"}"); } 
+                 LOGI("[%u] Handling SET_FIRST_PLACE_ABS_FROM_CURRENT", num);
+                 LOGD("    State Check (SET_FIRST_PLACE_ABS_FROM_CURRENT): inCalib=%d, isMoving=%d, isHoming=%d", inCalibrationMode, isMoving, isHoming);
+                 if (!inCalibrationMode) { LOGW("    SET_FIRST_PLACE_ABS_FROM_CURRENT Denied: Not in calibration mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Must be in Calibration Mode to set First Place position from current.\"}"); } 
+                 else if (isMoving || isHoming) { LOGW("    SET_FIRST_PLACE_ABS_FROM_CURRENT Denied: Busy."); commandAckReject(); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Cannot set while moving.\"}"); } 
                  else {
-                     if (stepper_x && stepper_y_left) { placeFirstXAbsolute_inch = (float)stepper_x->getCurrentPosition() / STEPS_PER_INCH_XY; placeFirstYAbsolute_inch = (float)stepper_y_left->getCurrentPosition() / STEPS_PER_INCH_XY; saveSettings(); Serial.printf("    SET_FIRST_PLACE_ABS_FROM_CURRENT Accepted: Set to X: %.2f, Y: %.2f\n", placeFirstXAbsolute_inch, placeFirstYAbsolute_inch); sendCurrentSettings(num); } 
-                     else { Serial.println("    SET_FIRST_PLACE_ABS_FROM_CURRENT Denied: Steppers not available."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Internal stepper error.\"}"); }
+                     if (stepper_x && stepper_y_left) { uint32_t settingsBefore = settingsScanChanges(); placeFirstXAbsolute_inch = (float)stepper_x->getCurrentPosition() / STEPS_PER_INCH_XY; placeFirstYAbsolute_inch = (float)stepper_y_left->getCurrentPosition() / STEPS_PER_INCH_XY; saveSettings(); LOGI("    SET_FIRST_PLACE_ABS_FROM_CURRENT Accepted: Set to X: %.2f, Y: %.2f", placeFirstXAbsolute_inch, placeFirstYAbsolute_inch); replySettingsApplied(num, settingsBefore); } 
+                     else { LOGW("    SET_FIRST_PLACE_ABS_FROM_CURRENT Denied: Steppers not available."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Internal stepper error.\"}"); }
                  }
              }
              // --- General Idle Commands (Require Homing, but not specific mode) ---
              else if (strcmp(commandStr, "HOME") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling HOME\n", num);
-                 Serial.printf("    State Check (HOME): isMoving=%d, isHoming=%d\n", isMoving, isHoming);
-                 if (isMoving || isHoming) { Serial.println("    HOME Denied: Busy"); webSocket.sendTXT(num, "{\"status\":\"Busy\",\"message\":\"Cannot home, machine is busy.\"}"); } 
-                 else { Serial.println("    HOME Accepted: Starting homing sequence."); homeAllAxes(); }
+                 LOGI("[%u] Handling HOME", num);
+                 LOGD("    State Check (HOME): isMoving=%d, isHoming=%d", isMoving, isHoming);
+                 if (isMoving || isHoming) { LOGW("    HOME Denied: Busy"); commandAckReject(); webSocket.sendTXT(num, "{\"status\":\"Busy\",\"message\":\"Cannot home, machine is busy.\"}"); } 
+                 else { LOGI("    HOME Accepted: Starting homing sequence."); homeAllAxes(); }
              } 
              else if (strcmp(commandStr, "GOTO_5_5_0") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling GOTO_5_5_0\n", num);
-                 Serial.printf("    State Check (GOTO): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d\n", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
-                 if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode) { Serial.println("    GOTO_5_5_0 Denied: Invalid state."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot GOTO: Machine busy or not ready.\"}"); } 
-                 else { Serial.println("    GOTO_5_5_0 Accepted: Moving."); moveToPositionInches(5.0, 5.0, 0.0); }
+                 LOGI("[%u] Handling GOTO_5_5_0", num);
+                 LOGD("    State Check (GOTO): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
+                 if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode) { LOGW("    GOTO_5_5_0 Denied: Invalid state."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot GOTO: Machine busy or not ready.\"}"); } 
+                 else { LOGI("    GOTO_5_5_0 Accepted: Moving."); moveToPositionInches(5.0, 5.0, 0.0); }
              } 
              else if (strcmp(commandStr, "GOTO_20_20_0") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling GOTO_20_20_0\n", num);
-                 Serial.printf("    State Check (GOTO): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d\n", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
-                 if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode) { Serial.println("    GOTO_20_20_0 Denied: Invalid state."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot GOTO: Machine busy or not ready.\"}"); } 
-                 else { Serial.println("    GOTO_20_20_0 Accepted: Moving."); moveToPositionInches(20.0, 20.0, 0.0); }
+                 LOGI("[%u] Handling GOTO_20_20_0", num);
+                 LOGD("    State Check (GOTO): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
+                 if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode) { LOGW("    GOTO_20_20_0 Denied: Invalid state."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot GOTO: Machine busy or not ready.\"}"); } 
+                 else { LOGI("    GOTO_20_20_0 Accepted: Moving."); moveToPositionInches(20.0, 20.0, 0.0); }
              } 
              else if (strcmp(commandStr, "ENTER_PICKPLACE") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling ENTER_PICKPLACE\n", num);
-                 Serial.printf("    State Check (ENTER_PICKPLACE): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d\n", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
-                 if (!allHomed) { Serial.println("    ENTER_PICKPLACE Denied: Not homed."); webSocket.sendTXT(num, "{\"status\":\"Error\",\"message\":\"Machine not homed.\"}"); } 
-                 else if (isMoving || isHoming) { Serial.println("    ENTER_PICKPLACE Denied: Busy."); webSocket.sendTXT(num, "{\"status\":\"Busy\",\"message\":\"Machine is busy.\"}"); } 
-                 else if (inPickPlaceMode) { Serial.println("    ENTER_PICKPLACE Denied: Already in PnP mode."); webSocket.sendTXT(num, "{\"status\":\"PickPlaceReady\", \"message\":\"Already in Pick/Place mode. Use Exit button.\"}"); } 
-                 else if (inCalibrationMode) { Serial.println("    ENTER_PICKPLACE Denied: In Calibration mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Exit calibration before entering PnP mode.\"}"); } 
-                 else { Serial.println("    ENTER_PICKPLACE Accepted: Entering PnP mode."); enterPickPlaceMode(); }
+                 LOGI("[%u] Handling ENTER_PICKPLACE", num);
+                 LOGD("    State Check (ENTER_PICKPLACE): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
+                 if (!allHomed) { LOGW("    ENTER_PICKPLACE Denied: Not homed."); webSocket.sendTXT(num, "{\"status\":\"Error\",\"message\":\"Machine not homed.\"}"); } 
+                 else if (isMoving || isHoming) { LOGW("    ENTER_PICKPLACE Denied: Busy."); commandAckReject(); webSocket.sendTXT(num, "{\"status\":\"Busy\",\"message\":\"Machine is busy.\"}"); } 
+                 else if (inPickPlaceMode) { LOGW("    ENTER_PICKPLACE Denied: Already in PnP mode."); webSocket.sendTXT(num, "{\"status\":\"PickPlaceReady\", \"message\":\"Already in Pick/Place mode. Use Exit button.\"}"); } 
+                 else if (inCalibrationMode) { LOGW("    ENTER_PICKPLACE Denied: In Calibration mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Exit calibration before entering PnP mode.\"}"); } 
+                 else { LOGI("    ENTER_PICKPLACE Accepted: Entering PnP mode."); enterPickPlaceMode(); }
              } 
               else if (strcmp(commandStr, "ENTER_CALIBRATION") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling ENTER_CALIBRATION\n", num);
-                 Serial.printf("    State Check (ENTER_CALIBRATION): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d\n", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
-                 if (!allHomed) { Serial.println("    ENTER_CALIBRATION Denied: Not homed."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Machine must be homed before entering calibration.\"}"); } 
-                 else if (isMoving || isHoming || inPickPlaceMode) { Serial.println("    ENTER_CALIBRATION Denied: Machine busy or in PnP mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Machine busy or in PnP mode. Cannot enter calibration.\"}"); } 
-                 else { Serial.println("    ENTER_CALIBRATION Accepted: Entering calibration mode."); inCalibrationMode = true; webSocket.broadcastTXT("{\"status\":\"CalibrationActive\", \"message\":\"Calibration mode entered.\"}"); sendCurrentPositionUpdate(); }
+                 LOGI("[%u] Handling ENTER_CALIBRATION", num);
+                 LOGD("    State Check (ENTER_CALIBRATION): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
+                 if (!allHomed) { LOGW("    ENTER_CALIBRATION Denied: Not homed."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Machine must be homed before entering calibration.\"}"); } 
+                 else if (isMoving || isHoming || inPickPlaceMode) { LOGW("    ENTER_CALIBRATION Denied: Machine busy or in PnP mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Machine busy or in PnP mode. Cannot enter calibration.\"}"); } 
+                 else { LOGI("    ENTER_CALIBRATION Accepted: Entering calibration mode."); inCalibrationMode = true; webSocket.broadcastTXT("{\"status\":\"CalibrationActive\", \"message\":\"Calibration mode entered.\"}"); sendCurrentPositionUpdate(); }
              }
              else if (strcmp(commandStr, "ROTATE") == 0) { // Also allow general rotation when idle
                  commandHandled = true;
-                 Serial.printf("[%u] Handling ROTATE (General Idle)\n", num);
-                 Serial.printf("    State Check (ROTATE): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d\n", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
-                 if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode) { Serial.println("    ROTATE Denied: Invalid state."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot rotate: Machine busy or not ready.\"}"); }
-                 else if (!stepper_rot) { Serial.println("    ROTATE Denied: Rotation Stepper Not Available"); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Rotation control unavailable (pin conflict?)\"}"); } 
+                 LOGI("[%u] Handling ROTATE (General Idle)", num);
+                 LOGD("    State Check (ROTATE): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
+                 if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode) { LOGW("    ROTATE Denied: Invalid state."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot rotate: Machine busy or not ready.\"}"); }
+                 else if (!stepper_rot) { LOGW("    ROTATE Denied: Rotation Stepper Not Available"); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Rotation control unavailable (pin conflict?)\"}"); } 
                  else {
                      char* degrees_str = strtok(NULL, " "); 
-                     if (degrees_str) { float degrees = atof(degrees_str); Serial.printf("    ROTATE Accepted: Rotating by %.2f degrees\n", degrees); float currentAngle = (float)stepper_rot->getCurrentPosition() / STEPS_PER_DEGREE; int targetAngle = (int)round(currentAngle + degrees); rotateToAbsoluteDegree(targetAngle); } 
-                     else { Serial.println("    ROTATE Denied: Missing degrees value"); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Missing degrees for ROTATE\"}"); }
+                     if (degrees_str) { float degrees = atof(degrees_str); LOGI("    ROTATE Accepted: Rotating by %.2f degrees", degrees); float currentAngle = (float)stepper_rot->getCurrentPosition() / STEPS_PER_DEGREE; int targetAngle = (int)round(currentAngle + degrees); rotateToAbsoluteDegree(targetAngle); } 
+                     else { LOGW("    ROTATE Denied: Missing degrees value"); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Missing degrees for ROTATE\"}"); }
                  }
              } 
              else if (strcmp(commandStr, "SET_ROT_ZERO") == 0) { // Allow general set zero when idle
                  commandHandled = true;
-                 Serial.printf("[%u] Handling SET_ROT_ZERO (General Idle)\n", num);
-                 Serial.printf("    State Check (SET_ROT_ZERO): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d\n", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
-                 if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode) { Serial.println("    SET_ROT_ZERO Denied: Invalid state."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set zero while machine is busy or in special mode.\"}"); } 
-                 else if (!stepper_rot) { Serial.println("    SET_ROT_ZERO Denied: Rotation stepper not enabled."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Rotation stepper not enabled.\"}"); } 
-                 else { Serial.println("    SET_ROT_ZERO Accepted: Setting current position to zero."); stepper_rot->setCurrentPosition(0); webSocket.sendTXT(num, "{\"status\":\"Ready\", \"message\":\"Current rotation set to zero.\"}"); sendCurrentPositionUpdate(); }
+                 LOGI("[%u] Handling SET_ROT_ZERO (General Idle)", num);
+                 LOGD("    State Check (SET_ROT_ZERO): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
+                 if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode) { LOGW("    SET_ROT_ZERO Denied: Invalid state."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set zero while machine is busy or in special mode.\"}"); } 
+                 else if (!stepper_rot) { LOGW("    SET_ROT_ZERO Denied: Rotation stepper not enabled."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Rotation stepper not enabled.\"}"); } 
+                 else { LOGI("    SET_ROT_ZERO Accepted: Setting current position to zero."); stepper_rot->setCurrentPosition(0); webSocket.sendTXT(num, "{\"status\":\"Ready\", \"message\":\"Current rotation set to zero.\"}"); sendCurrentPositionUpdate(); }
              }
              else if (strcmp(commandStr, "PAINT_SIDE_0") == 0 || strcmp(commandStr, "PAINT_SIDE_1") == 0 || strcmp(commandStr, "PAINT_SIDE_2") == 0 || strcmp(commandStr, "PAINT_SIDE_3") == 0) {
                  commandHandled = true;
                  int sideIndex = commandStr[strlen(commandStr)-1] - '0'; // Extract side index from command name
-                 Serial.printf("[%u] Handling PAINT_SIDE_%d\n", num, sideIndex);
-                 Serial.printf("    State Check (PAINT_SIDE): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d\n", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
-                 if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode) { Serial.printf("    PAINT_SIDE_%d Denied: Invalid state.\n", sideIndex); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot start painting, invalid machine state.\"}"); } 
-                 else { Serial.printf("    PAINT_SIDE_%d Accepted: Starting paint sequence.\n", sideIndex); paintSide(sideIndex); }
+                 LOGI("[%u] Handling PAINT_SIDE_%d", num, sideIndex);
+                 LOGD("    State Check (PAINT_SIDE): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
+                 if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode || isPaintPaused) { LOGW("    PAINT_SIDE_%d Denied: Invalid state.", sideIndex); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot start painting, invalid machine state.\"}"); } 
+                 else { LOGI("    PAINT_SIDE_%d Accepted: Starting paint sequence.", sideIndex); paintSide(sideIndex); }
              } 
              else if (strcmp(commandStr, "PAINT_ALL") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling PAINT_ALL\n", num);
-                 Serial.printf("    State Check (PAINT_ALL): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d\n", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
-                 if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode) { 
-                     Serial.println("    PAINT_ALL Denied: Invalid state."); 
+                 LOGI("[%u] Handling PAINT_ALL", num);
+                 LOGD("    State Check (PAINT_ALL): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
+                 if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode || isPaintPaused) { 
+                     LOGW("    PAINT_ALL Denied: Invalid state."); 
                      webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot start Paint All, machine is busy or not ready.\"}"); 
                  } else {
-                     Serial.println("    PAINT_ALL Accepted: Starting sequence."); 
+                     LOGI("    PAINT_ALL Accepted: Starting sequence."); 
                      webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Starting Paint All sequence...\"}");
                      
                      // Start the painting sequence using the non-blocking approach
@@ -1931,43 +2137,43 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
              } 
              else if (strcmp(commandStr, "CLEAN_GUN") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling CLEAN_GUN\n", num);
-                 Serial.printf("    State Check (CLEAN_GUN): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d\n", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
-                 if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode) { Serial.println("    CLEAN_GUN Denied: Invalid state."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot start Clean Gun, machine is busy or not ready.\"}"); } 
+                 LOGI("[%u] Handling CLEAN_GUN", num);
+                 LOGD("    State Check (CLEAN_GUN): allHomed=%d, isMoving=%d, isHoming=%d, inPnP=%d, inCalib=%d", allHomed, isMoving, isHoming, inPickPlaceMode, inCalibrationMode);
+                 if (!allHomed || isMoving || isHoming || inPickPlaceMode || inCalibrationMode) { LOGW("    CLEAN_GUN Denied: Invalid state."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot start Clean Gun, machine is busy or not ready.\"}"); } 
                  else {
-                     Serial.println("    CLEAN_GUN Accepted: Starting sequence."); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Starting Clean Gun sequence...\"}");
+                     LOGI("    CLEAN_GUN Accepted: Starting sequence."); webSocket.sendTXT(num, "{\"status\":\"Busy\", \"message\":\"Starting Clean Gun sequence...\"}");
                      isMoving = true; stopRequested = false; 
                      
                      // Set servo to initial position (controls paint gun direction)
-                     Serial.println("Setting pitch servo to initial position for cleaning");
+                     LOGI("Setting pitch servo to initial position for cleaning");
                      servo_pitch.write(SERVO_INIT_POS_PITCH);
                      delay(300); // Allow servo to settle
                      
                      // Sequence...
-                     rotateToAbsoluteDegree(0); if (stopRequested) { Serial.println("Clean Gun stopped during Rotation"); deactivatePaintGun(true); isMoving = false; return; } 
-                     moveToXYPositionInches_Paint(3.0, 10.0, patternXSpeed / 2, patternXAccel / 2); if (stopRequested) { Serial.println("Clean Gun stopped during XY Move"); deactivatePaintGun(true); isMoving = false; return; } 
+                     rotateToAbsoluteDegree(0); if (stopRequested) { LOGI("Clean Gun stopped during Rotation"); deactivatePaintGun(true); isMoving = false; return; } 
+                     moveToXYPositionInches_Paint(3.0, 10.0, patternXSpeed / 2, patternXAccel / 2); if (stopRequested) { LOGI("Clean Gun stopped during XY Move"); deactivatePaintGun(true); isMoving = false; return; } 
                      activatePaintGun(); unsigned long sprayStartTime = millis();
-                     while (millis() - sprayStartTime < 3000) { webSocket.loop(); if (stopRequested) { Serial.println("Clean Gun stopped during Spray"); break; } yield(); }
+                     while (millis() - sprayStartTime < 3000) { webSocket.loop(); if (stopRequested) { LOGI("Clean Gun stopped during Spray"); break; } yield(); }
                      // Always deactivate the paint gun, regardless of stop status
                      deactivatePaintGun(true); 
                      if (stopRequested) { isMoving = false; return; } 
-                     if (!stopRequested) { moveToXYPositionInches(0.0, 0.0); while ((stepper_x && stepper_x->isRunning()) || (stepper_y_left && stepper_y_left->isRunning()) || (stepper_y_right && stepper_y_right->isRunning())) { webSocket.loop(); if (stopRequested) { Serial.println("Clean Gun stopped during Return Home"); break; } yield(); } }
+                     if (!stopRequested) { moveToXYPositionInches(0.0, 0.0); while ((stepper_x && stepper_x->isRunning()) || (stepper_y_left && stepper_y_left->isRunning()) || (stepper_y_right && stepper_y_right->isRunning())) { webSocket.loop(); if (stopRequested) { LOGI("Clean Gun stopped during Return Home"); break; } yield(); } }
                      
                      // Ensure servo is back to initial position after cleaning
-                     Serial.println("Returning pitch servo to initial position after cleaning");
+                     LOGI("Returning pitch servo to initial position after cleaning");
                      servo_pitch.write(SERVO_INIT_POS_PITCH);
                      delay(300); // Allow servo to settle
                      
                      isMoving = false; 
-                     if (stopRequested) { Serial.println("Clean Gun stopped by user."); } 
-                     else { Serial.println("Clean Gun sequence completed."); webSocket.broadcastTXT("{\"status\":\"Ready\", \"message\":\"Clean Gun sequence completed.\"}"); }
+                     if (stopRequested) { LOGI("Clean Gun stopped by user."); } 
+                     else { LOGI("Clean Gun sequence completed."); webSocket.broadcastTXT("{\"status\":\"Ready\", \"message\":\"Clean Gun sequence completed.\"}"); }
                      sendCurrentPositionUpdate();
                  }
              }
              // --- Settings Commands (Can usually run when idle, some need args) ---
              else if (strcmp(commandStr, "SET_SERVO_PITCH") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling SET_SERVO_PITCH\n", num);
+                 LOGI("[%u] Handling SET_SERVO_PITCH", num);
                  char* angle_str = strtok(NULL, " "); 
                  if (angle_str) {
                      int angle = atoi(angle_str);
@@ -1977,91 +2183,91 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
              } 
              else if (strcmp(commandStr, "SET_PNP_OFFSET") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling SET_PNP_OFFSET\n", num);
-                 Serial.printf("    State Check (SET_PNP_OFFSET): isMoving=%d, isHoming=%d, inPnP=%d\n", isMoving, isHoming, inPickPlaceMode);
-                 if (isMoving || isHoming || inPickPlaceMode) { Serial.println("    SET_PNP_OFFSET Denied: Machine busy or in PnP mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set offset while machine is busy or in PnP mode.\"}"); } 
+                 LOGI("[%u] Handling SET_PNP_OFFSET", num);
+                 LOGD("    State Check (SET_PNP_OFFSET): isMoving=%d, isHoming=%d, inPnP=%d", isMoving, isHoming, inPickPlaceMode);
+                 if (isMoving || isHoming || inPickPlaceMode) { LOGW("    SET_PNP_OFFSET Denied: Machine busy or in PnP mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set offset while machine is busy or in PnP mode.\"}"); } 
                  else {
                      char* x_str = strtok(NULL, " "); char* y_str = strtok(NULL, " ");
-                     if (x_str && y_str) { pnpOffsetX_inch = atof(x_str); pnpOffsetY_inch = atof(y_str); saveSettings(); Serial.printf("    SET_PNP_OFFSET Accepted: Set to X: %.2f, Y: %.2f\n", pnpOffsetX_inch, pnpOffsetY_inch); sendCurrentSettings(num); } 
-                     else { Serial.println("    SET_PNP_OFFSET Denied: Missing values."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid format for SET_PNP_OFFSET. Use: SET_PNP_OFFSET X Y\"}"); }
+                     if (x_str && y_str) { uint32_t settingsBefore = settingsScanChanges(); pnpOffsetX_inch = atof(x_str); pnpOffsetY_inch = atof(y_str); saveSettings(); LOGI("    SET_PNP_OFFSET Accepted: Set to X: %.2f, Y: %.2f", pnpOffsetX_inch, pnpOffsetY_inch); replySettingsApplied(num, settingsBefore); } 
+                     else { LOGW("    SET_PNP_OFFSET Denied: Missing values."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid format for SET_PNP_OFFSET. Use: SET_PNP_OFFSET X Y\"}"); }
                  }
              } 
              else if (strcmp(commandStr, "SET_FIRST_PLACE_ABS") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling SET_FIRST_PLACE_ABS\n", num);
-                 Serial.printf("    State Check (SET_FIRST_PLACE_ABS): isMoving=%d, isHoming=%d, inPnP=%d\n", isMoving, isHoming, inPickPlaceMode);
-                 if (isMoving || isHoming || inPickPlaceMode) { Serial.println("    SET_FIRST_PLACE_ABS Denied: Machine busy or in PnP mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set first place while machine is busy or in PnP mode.\"}"); } 
+                 LOGI("[%u] Handling SET_FIRST_PLACE_ABS", num);
+                 LOGD("    State Check (SET_FIRST_PLACE_ABS): isMoving=%d, isHoming=%d, inPnP=%d", isMoving, isHoming, inPickPlaceMode);
+                 if (isMoving || isHoming || inPickPlaceMode) { LOGW("    SET_FIRST_PLACE_ABS Denied: Machine busy or in PnP mode."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set first place while machine is busy or in PnP mode.\"}"); } 
                  else {
                      char* x_str = strtok(NULL, " "); char* y_str = strtok(NULL, " ");
-                     if (x_str && y_str) { placeFirstXAbsolute_inch = atof(x_str); placeFirstYAbsolute_inch = atof(y_str); saveSettings(); Serial.printf("    SET_FIRST_PLACE_ABS Accepted: Set to X: %.2f, Y: %.2f\n", placeFirstXAbsolute_inch, placeFirstYAbsolute_inch); sendCurrentSettings(num); } 
-                     else { Serial.println("    SET_FIRST_PLACE_ABS Denied: Missing values."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid SET_FIRST_PLACE_ABS format.\"}"); }
+                     if (x_str && y_str) { uint32_t settingsBefore = settingsScanChanges(); placeFirstXAbsolute_inch = atof(x_str); placeFirstYAbsolute_inch = atof(y_str); saveSettings(); LOGI("    SET_FIRST_PLACE_ABS Accepted: Set to X: %.2f, Y: %.2f", placeFirstXAbsolute_inch, placeFirstYAbsolute_inch); replySettingsApplied(num, settingsBefore); } 
+                     else { LOGW("    SET_FIRST_PLACE_ABS Denied: Missing values."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid SET_FIRST_PLACE_ABS format.\"}"); }
                  }
              } 
              else if (strcmp(commandStr, "SET_GRID_SPACING") == 0) { 
                  commandHandled = true;
-                 Serial.printf("[%u] Handling SET_GRID_SPACING\n", num);
-                 Serial.printf("    State Check (SET_GRID_SPACING): isMoving=%d, isHoming=%d\n", isMoving, isHoming);
-                 if (isMoving || isHoming) { Serial.println("    SET_GRID_SPACING Denied: Machine busy."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set grid while machine is busy.\"}"); } 
+                 LOGI("[%u] Handling SET_GRID_SPACING", num);
+                 LOGD("    State Check (SET_GRID_SPACING): isMoving=%d, isHoming=%d", isMoving, isHoming);
+                 if (isMoving || isHoming) { LOGW("    SET_GRID_SPACING Denied: Machine busy."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set grid while machine is busy.\"}"); } 
                  else {
                      char* cols_str = strtok(NULL, " "); char* rows_str = strtok(NULL, " ");
                      if (cols_str && rows_str) {
                          int cols = atoi(cols_str); int rows = atoi(rows_str);
-                         if (cols > 0 && rows > 0) { Serial.printf("    SET_GRID_SPACING Accepted: %d x %d\n", cols, rows); calculateAndSetGridSpacing(cols, rows); } 
-                         else { Serial.println("    SET_GRID_SPACING Denied: Invalid cols/rows value."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid grid columns/rows. Must be positive integers.\"}"); }
-                     } else { Serial.println("    SET_GRID_SPACING Denied: Missing values."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid format for SET_GRID_SPACING. Use: SET_GRID_SPACING cols rows\"}"); }
+                         if (cols > 0 && rows > 0) { uint32_t settingsBefore = settingsScanChanges(); LOGI("    SET_GRID_SPACING Accepted: %d x %d", cols, rows); calculateAndSetGridSpacing(cols, rows); saveSettings(); replySettingsApplied(num, settingsBefore); } 
+                         else { LOGW("    SET_GRID_SPACING Denied: Invalid cols/rows value."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid grid columns/rows. Must be positive integers.\"}"); }
+                     } else { LOGW("    SET_GRID_SPACING Denied: Missing values."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid format for SET_GRID_SPACING. Use: SET_GRID_SPACING cols rows\"}"); }
                  }
              } 
              else if (strcmp(commandStr, "SET_TRAY_SIZE") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling SET_TRAY_SIZE\n", num);
-                 Serial.printf("    State Check (SET_TRAY_SIZE): isMoving=%d, isHoming=%d\n", isMoving, isHoming);
-                 if (isMoving || isHoming) { Serial.println("    SET_TRAY_SIZE Denied: Machine busy."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set tray size while machine is busy.\"}"); } 
+                 LOGI("[%u] Handling SET_TRAY_SIZE", num);
+                 LOGD("    State Check (SET_TRAY_SIZE): isMoving=%d, isHoming=%d", isMoving, isHoming);
+                 if (isMoving || isHoming) { LOGW("    SET_TRAY_SIZE Denied: Machine busy."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set tray size while machine is busy.\"}"); } 
                  else {
                      char* width_str = strtok(NULL, " "); char* height_str = strtok(NULL, " ");
                      if (width_str && height_str) {
                          float width = atof(width_str); float height = atof(height_str);
-                         if (width > 0 && height > 0) { Serial.printf("    SET_TRAY_SIZE Accepted: W=%.2f, H=%.2f\n", width, height); trayWidth_inch = width; trayHeight_inch = height; saveSettings(); calculateAndSetGridSpacing(placeGridCols, placeGridRows); } 
-                         else { Serial.println("    SET_TRAY_SIZE Denied: Invalid width/height value."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid tray dimensions. Width and Height must be positive numbers.\"}"); }
-                     } else { Serial.println("    SET_TRAY_SIZE Denied: Missing values."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid format for SET_TRAY_SIZE. Use: SET_TRAY_SIZE width height\"}"); }
+                         if (width > 0 && height > 0) { uint32_t settingsBefore = settingsScanChanges(); LOGI("    SET_TRAY_SIZE Accepted: W=%.2f, H=%.2f", width, height); trayWidth_inch = width; trayHeight_inch = height; saveSettings(); calculateAndSetGridSpacing(placeGridCols, placeGridRows); replySettingsApplied(num, settingsBefore); } 
+                         else { LOGW("    SET_TRAY_SIZE Denied: Invalid width/height value."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid tray dimensions. Width and Height must be positive numbers.\"}"); }
+                     } else { LOGW("    SET_TRAY_SIZE Denied: Missing values."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid format for SET_TRAY_SIZE. Use: SET_TRAY_SIZE width height\"}"); }
                  }
              } 
              else if (strcmp(commandStr, "SET_PNP_SPEEDS") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling SET_PNP_SPEEDS\n", num);
-                 Serial.printf("    State Check (SET_PNP_SPEEDS): isMoving=%d, isHoming=%d\n", isMoving, isHoming);
-                 if (isMoving || isHoming) { Serial.println("    SET_PNP_SPEEDS Denied: Machine busy."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set speeds while machine is busy.\"}"); } 
+                 LOGI("[%u] Handling SET_PNP_SPEEDS", num);
+                 LOGD("    State Check (SET_PNP_SPEEDS): isMoving=%d, isHoming=%d", isMoving, isHoming);
+                 if (isMoving || isHoming) { LOGW("    SET_PNP_SPEEDS Denied: Machine busy."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set speeds while machine is busy.\"}"); } 
                  else {
                      char* xs_str = strtok(NULL, " "); char* ys_str = strtok(NULL, " ");
                      if (xs_str && ys_str) {
                          float receivedXS = atof(xs_str); float receivedYS = atof(ys_str);
-                         if (receivedXS > 0 && receivedYS > 0) { Serial.printf("    SET_PNP_SPEEDS Accepted: XS=%.0f, YS=%.0f\n", receivedXS, receivedYS); patternXSpeed = receivedXS; patternYSpeed = receivedYS; saveSettings(); sendCurrentSettings(num); } 
-                         else { Serial.println("    SET_PNP_SPEEDS Denied: Invalid speed values."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid speed values. Must be positive numbers.\"}"); }
-                     } else { Serial.println("    SET_PNP_SPEEDS Denied: Missing values."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid format for SET_PNP_SPEEDS. Use: SET_PNP_SPEEDS XS YS\"}"); }
+                         if (receivedXS > 0 && receivedYS > 0) { uint32_t settingsBefore = settingsScanChanges(); LOGI("    SET_PNP_SPEEDS Accepted: XS=%.0f, YS=%.0f", receivedXS, receivedYS); patternXSpeed = receivedXS; patternYSpeed = receivedYS; saveSettings(); replySettingsApplied(num, settingsBefore); } 
+                         else { LOGW("    SET_PNP_SPEEDS Denied: Invalid speed values."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid speed values. Must be positive numbers.\"}"); }
+                     } else { LOGW("    SET_PNP_SPEEDS Denied: Missing values."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid format for SET_PNP_SPEEDS. Use: SET_PNP_SPEEDS XS YS\"}"); }
                  }
              } 
              else if (strcmp(commandStr, "SET_PAINT_GUN_OFFSET") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling SET_PAINT_GUN_OFFSET\n", num);
-                 Serial.printf("    State Check (SET_PAINT_GUN_OFFSET): isMoving=%d, isHoming=%d\n", isMoving, isHoming); 
-                 if (isMoving || isHoming) { Serial.println("    SET_PAINT_GUN_OFFSET Denied: Busy."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set paint offset while busy.\"}"); } 
+                 LOGI("[%u] Handling SET_PAINT_GUN_OFFSET", num);
+                 LOGD("    State Check (SET_PAINT_GUN_OFFSET): isMoving=%d, isHoming=%d", isMoving, isHoming); 
+                 if (isMoving || isHoming) { LOGW("    SET_PAINT_GUN_OFFSET Denied: Busy."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set paint offset while busy.\"}"); } 
                  else {
                      char* gunX_str = strtok(NULL, " "); char* gunY_str = strtok(NULL, " ");
-                     if (gunX_str && gunY_str) { paintGunOffsetX_inch = atof(gunX_str); paintGunOffsetY_inch = atof(gunY_str); saveSettings(); Serial.printf("    SET_PAINT_GUN_OFFSET Accepted: Set to X:%.2f, Y:%.2f\n", paintGunOffsetX_inch, paintGunOffsetY_inch); sendCurrentSettings(num); } 
-                     else { Serial.println("    SET_PAINT_GUN_OFFSET Denied: Invalid format."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid paint gun offset format.\"}"); }
+                     if (gunX_str && gunY_str) { uint32_t settingsBefore = settingsScanChanges(); paintGunOffsetX_inch = atof(gunX_str); paintGunOffsetY_inch = atof(gunY_str); saveSettings(); LOGI("    SET_PAINT_GUN_OFFSET Accepted: Set to X:%.2f, Y:%.2f", paintGunOffsetX_inch, paintGunOffsetY_inch); replySettingsApplied(num, settingsBefore); } 
+                     else { LOGW("    SET_PAINT_GUN_OFFSET Denied: Invalid format."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid paint gun offset format.\"}"); }
                  }
              } 
              else if (strcmp(commandStr, "SET_PAINT_SIDE_SETTINGS") == 0) {
                  commandHandled = true;
-                 Serial.printf("[%u] Handling SET_PAINT_SIDE_SETTINGS\n", num);
-                 Serial.printf("    State Check (SET_PAINT_SIDE_SETTINGS): isMoving=%d, isHoming=%d\n", isMoving, isHoming); 
-                 if (isMoving || isHoming) { Serial.println("    SET_PAINT_SIDE_SETTINGS Denied: Busy."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set paint side settings while busy.\"}"); } 
+                 LOGI("[%u] Handling SET_PAINT_SIDE_SETTINGS", num);
+                 LOGD("    State Check (SET_PAINT_SIDE_SETTINGS): isMoving=%d, isHoming=%d", isMoving, isHoming); 
+                 if (isMoving || isHoming) { LOGW("    SET_PAINT_SIDE_SETTINGS Denied: Busy."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set paint side settings while busy.\"}"); } 
                  else {
                      char* sideIdx_str = strtok(NULL, " "); char* zVal_str = strtok(NULL, " "); char* pitchVal_str = strtok(NULL, " "); char* patternVal_str = strtok(NULL, " "); char* speedVal_str = strtok(NULL, " ");
                      if (sideIdx_str && zVal_str && pitchVal_str && patternVal_str && speedVal_str) {
                          int sideIdx = atoi(sideIdx_str); float zVal = atof(zVal_str); int pitchVal = atoi(pitchVal_str); int patternVal = atoi(patternVal_str); float speedVal = atof(speedVal_str);
-                         if (sideIdx >= 0 && sideIdx < 4 && pitchVal >= 0 && pitchVal <= 180 && (patternVal == 0 || patternVal == 90)) { Serial.printf("    SET_PAINT_SIDE_SETTINGS Accepted: Side %d, Z=%.2f, P=%d, Pat=%d, S=%.0f\n", sideIdx, zVal, pitchVal, patternVal, speedVal); paintZHeight_inch[sideIdx] = zVal; paintPitchAngle[sideIdx] = pitchVal; paintPatternType[sideIdx] = patternVal; paintSpeed[sideIdx] = speedVal; saveSettings(); sendCurrentSettings(num); } 
-                         else { Serial.println("    SET_PAINT_SIDE_SETTINGS Denied: Invalid parameter values."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid parameter values (Side 0-3, Pitch 0-180, Pattern 0/90).\"}"); }
-                     } else { Serial.println("    SET_PAINT_SIDE_SETTINGS Denied: Invalid format."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid paint side settings format.\"}"); }
+                         if (sideIdx >= 0 && sideIdx < 4 && pitchVal >= 0 && pitchVal <= 180 && patternVal >= 0 && patternVal < 180) { uint32_t settingsBefore = settingsScanChanges(); LOGI("    SET_PAINT_SIDE_SETTINGS Accepted: Side %d, Z=%.2f, P=%d, Pat=%d, S=%.0f", sideIdx, zVal, pitchVal, patternVal, speedVal); paintZHeight_inch[sideIdx] = zVal; paintPitchAngle[sideIdx] = pitchVal; paintPatternType[sideIdx] = patternVal; paintSpeed[sideIdx] = speedVal; saveSettings(); replySettingsApplied(num, settingsBefore); } 
+                         else { LOGW("    SET_PAINT_SIDE_SETTINGS Denied: Invalid parameter values."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid parameter values (Side 0-3, Pitch 0-180, Pattern 0-179 deg).\"}"); }
+                     } else { LOGW("    SET_PAINT_SIDE_SETTINGS Denied: Invalid format."); webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid paint side settings format.\"}"); }
                  }
              } 
              // --- JSON Command Handling ---
@@ -2071,23 +2277,24 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
                  DeserializationError error = deserializeJson(doc, payload, length);
                  
                  if (error) {
-                     Serial.printf("[%u] Failed to parse JSON command: %s\n", num, error.c_str());
+                     LOGW("[%u] Failed to parse JSON command: %s", num, error.c_str());
                      webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid JSON format\"}");
                  } else {
                      // Successfully parsed JSON - handle commands
                      const char* cmd = doc["command"];
                      if (cmd && strcmp(cmd, "SET_PAINT_STARTS") == 0) {
                          commandHandled = true;
-                         Serial.printf("[%u] Handling SET_PAINT_STARTS (JSON)\n", num);
-                         Serial.printf("    State Check (SET_PAINT_STARTS): isMoving=%d, isHoming=%d\n", isMoving, isHoming);
+                         LOGI("[%u] Handling SET_PAINT_STARTS (JSON)", num);
+                         LOGD("    State Check (SET_PAINT_STARTS): isMoving=%d, isHoming=%d", isMoving, isHoming);
                          
                          if (isMoving || isHoming) {
-                             Serial.println("    SET_PAINT_STARTS Denied: Busy.");
+                             LOGW("    SET_PAINT_STARTS Denied: Busy.");
                              webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot set paint start positions while busy.\"}");
                          } else {
                              // Extract values from the JSON data
                              JsonObject data = doc["data"];
                              if (data) {
+                                 uint32_t settingsBefore = settingsScanChanges();
                                  bool allValid = true;
                                  
                                  // Process each side's start position
@@ -2099,65 +2306,65 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
                                      if (data.containsKey(xKey) && data.containsKey(yKey)) {
                                          paintStartX[i] = data[xKey];
                                          paintStartY[i] = data[yKey];
-                                         Serial.printf("    SET_PAINT_STARTS: Side %d set to X=%.2f, Y=%.2f\n", 
+                                         LOGI("    SET_PAINT_STARTS: Side %d set to X=%.2f, Y=%.2f", 
                                                     i, paintStartX[i], paintStartY[i]);
                                      } else {
                                          allValid = false;
-                                         Serial.printf("    SET_PAINT_STARTS: Missing data for side %d\n", i);
+                                         LOGI("    SET_PAINT_STARTS: Missing data for side %d", i);
                                      }
                                  }
                                  
                                  if (allValid) {
                                      saveSettings();
-                                     Serial.println("    SET_PAINT_STARTS Accepted: All paint start positions updated.");
-                                     sendCurrentSettings(num);
+                                     LOGI("    SET_PAINT_STARTS Accepted: All paint start positions updated.");
+                                     replySettingsApplied(num, settingsBefore);
                                  } else {
-                                     Serial.println("    SET_PAINT_STARTS Partially Processed: Some positions may be missing.");
+                                     LOGI("    SET_PAINT_STARTS Partially Processed: Some positions may be missing.");
                                      webSocket.sendTXT(num, "{\"status\":\"Warning\", \"message\":\"Some paint start positions were missing in the data\"}");
                                      saveSettings(); // Save what we could process
-                                     sendCurrentSettings(num);
+                                     broadcastSettingsDelta(); // The Warning above is the reply
                                  }
                              } else {
-                                 Serial.println("    SET_PAINT_STARTS Denied: Missing data object.");
+                                 LOGW("    SET_PAINT_STARTS Denied: Missing data object.");
                                  webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Invalid SET_PAINT_STARTS format: missing data\"}");
                              }
                          }
                      } else {
-                         Serial.printf("[%u] Unknown JSON command: %s\n", num, cmd ? cmd : "null");
+                         LOGW("[%u] Unknown JSON command: %s", num, cmd ? cmd : "null");
                          webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Unknown JSON command\"}");
                      }
                  }
              }
              else if (strcmp(commandStr, "TOGGLE_PRESSURE_POT") == 0) { // Renamed command
                  commandHandled = true;
-                 Serial.printf("[%u] Handling TOGGLE_PRESSURE_POT\n", num);
+                 LOGI("[%u] Handling TOGGLE_PRESSURE_POT", num);
                  // Toggle the state and the pin
                  isPressurePotOn = !isPressurePotOn; // Renamed state variable
                  digitalWrite(PRESSURE_POT_PIN, isPressurePotOn ? HIGH : LOW); // Use alias
-                 Serial.printf("    Pressure Pot state toggled to: %s\n", isPressurePotOn ? "ON" : "OFF");
+                 LOGI("    Pressure Pot state toggled to: %s", isPressurePotOn ? "ON" : "OFF");
                  // Send an update to all clients reflecting the new state
-                 sendCurrentSettings(255); // 255 = broadcast (will include updated state)
+                 broadcastSettingsDelta(); // Status flag changed; delta carries the new state
              }
 
             // --- Final Check for Unhandled Commands ---
             if (!commandHandled) {
                 // Use commandStr here as cmd might be NULL or pointing elsewhere if args were parsed
-                Serial.printf("[%u] Unknown command received (Fell through all checks): '%s'\n", num, commandStr); 
+                LOGW("[%u] Unknown command received (Fell through all checks): '%s'", num, commandStr); 
                 webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Unknown command\"}");
             }
         }
         break;
         // ... other WStype cases ...
         case WStype_BIN:
-             Serial.printf("[%u] WebSocket Received Binary Data (%d bytes)\n", num, length);
+             LOGI("[%u] WebSocket Received Binary Data (%d bytes)", num, length);
             break;
         case WStype_DISCONNECTED:
-             Serial.printf("[%u] WebSocket Client Disconnected!\n", num);
+             LOGI("[%u] WebSocket Client Disconnected!", num);
+             commandAckDropClient(num);
              break;
         case WStype_CONNECTED: {
             IPAddress ip = webSocket.remoteIP(num);
-            Serial.printf("[%u] WebSocket Client Connected from %s url: %s\n", num, ip.toString().c_str(), payload);
-             String welcomeMsg = "Welcome! Connected to Paint + PnP Machine.";
+            LOGI("[%u] WebSocket Client Connected from %u.%u.%u.%u url: %s", num, ip[0], ip[1], ip[2], ip[3], (const char*)payload);
              sendCurrentSettings(num);
              if (allHomed) {
                   sendCurrentPositionUpdate();
@@ -2165,10 +2372,10 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
             }
              break;
         case WStype_ERROR:
-             Serial.printf("[%u] WebSocket Error!\n", num);
+             LOGE("[%u] WebSocket Error!", num);
              break;
         default:
-             Serial.printf("[%u] WebSocket Unhandled Event Type: %d\n", num, type);
+             LOGI("[%u] WebSocket Unhandled Event Type: %d", num, type);
              break;
 
     }
@@ -2176,6 +2383,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
 
 // Function to stop all movement
 void stopAllMovement() {
+    motionWatchdogDisarmAll();
     isMoving = false;
     isHoming = false;
     
@@ -2201,85 +2409,338 @@ void stopAllMovement() {
     // Serial.println("All movement stopped.");
 }
 
-// Helper function to send ALL current settings
-// Includes machine state, PnP/Grid settings, and all Painting settings.
+// Writes the machine state object ("status":{...}) into buf. Returns length or -1.
+static int writeStatusJson(char* buf, size_t len) {
+    int n = snprintf(buf, len,
+        "\"status\":{\"isMoving\":%s,\"isHoming\":%s,\"allHomed\":%s,\"inCalibrationMode\":%s,"
+        "\"inPickPlaceMode\":%s,\"isPainting\":%s,\"isPressurized\":%s,\"isPaused\":%s,\"feedOverride\":%d,\"eStop\":%s,"
+        "\"macroRunning\":%s}",
+        isMoving ? "true" : "false", isHoming ? "true" : "false", allHomed ? "true" : "false",
+        inCalibrationMode ? "true" : "false", inPickPlaceMode ? "true" : "false",
+        isPainting ? "true" : "false", isPressurePotOn ? "true" : "false",
+        isPaintPaused ? "true" : "false", (int)paintFeedOverride_pct, emergencyStopLatched() ? "true" : "false",
+        macroRunning ? "true" : "false");
+    return (n < 0 || (size_t)n >= len) ? -1 : n;
+}
+
+// Machine state flags (and the feed override above them) packed into a word, used to detect status changes
+static uint32_t statusBits() {
+    return (isMoving ? 0x01 : 0) | (isHoming ? 0x02 : 0) | (allHomed ? 0x04 : 0) |
+           (inCalibrationMode ? 0x08 : 0) | (inPickPlaceMode ? 0x10 : 0) |
+           (isPainting ? 0x20 : 0) | (isPressurePotOn ? 0x40 : 0) | (isPaintPaused ? 0x80 : 0) |
+           ((uint32_t)paintFeedOverride_pct << 8) | (emergencyStopLatched() ? 0x10000 : 0) | (macroRunning ? 0x20000 : 0);
+}
+
+static uint32_t lastBroadcastVersion = 0; // Settings version all clients have seen
+static uint32_t lastBroadcastStatus = 0xFFFFFFFF; // statusBits() at the last broadcast
+static int settingsBroadcastHold = 0; // >0 while a command list runs: one delta goes out at its end
+
+// Builds {"settingsEpoch":E,"settingsVersion":V,"baseVersion":B,"status":{...},"settings":{...}}
+// with only the settings changed after sinceVersion (0 = all). Returns length or -1.
+static int buildSettingsMessage(char* buf, size_t len, uint32_t sinceVersion, bool includeStatus, bool includePosition) {
+    int pos = snprintf(buf, len, "{\"settingsEpoch\":%lu,\"settingsVersion\":%lu,\"baseVersion\":%lu",
+                       (unsigned long)settingsEpoch(), (unsigned long)settingsVersion(), (unsigned long)sinceVersion);
+    if (pos < 0 || (size_t)pos >= len) return -1;
+    if (includeStatus) {
+        if ((size_t)pos + 1 >= len) return -1;
+        buf[pos++] = ',';
+        int n = writeStatusJson(buf + pos, len - pos);
+        if (n < 0) return -1;
+        pos += n;
+    }
+    if (includePosition) {
+        // Current Position (Tool Center Point - TCP)
+        float x = 0.0f, y = 0.0f, z = 0.0f, rot = 0.0f;
+        if (allHomed) {
+            x = stepper_x ? (float)stepper_x->getCurrentPosition() / STEPS_PER_INCH_XY : 0.0f;
+            y = stepper_y_left ? (float)stepper_y_left->getCurrentPosition() / STEPS_PER_INCH_XY : 0.0f; // Use left Y
+            z = stepper_z ? (float)stepper_z->getCurrentPosition() / STEPS_PER_INCH_Z : 0.0f;
+            rot = stepper_rot ? (float)stepper_rot->getCurrentPosition() / STEPS_PER_DEGREE : 0.0f;
+        }
+        int n = snprintf(buf + pos, len - pos, ",\"position\":{\"x\":%.3f,\"y\":%.3f,\"z\":%.3f,\"rot\":%.3f}", x, y, z, rot);
+        if (n < 0 || (size_t)n >= len - pos) return -1;
+        pos += n;
+        // Full snapshots also carry boot phase timings and the WiFi link state
+        if ((size_t)pos + 1 >= len) return -1;
+        buf[pos++] = ',';
+        n = bootTimingWriteJson(buf + pos, len - pos);
+        if (n < 0) return -1;
+        pos += n;
+        if ((size_t)pos + 1 >= len) return -1;
+        buf[pos++] = ',';
+        n = networkWriteJson(buf + pos, len - pos);
+        if (n < 0) return -1;
+        pos += n;
+        if ((size_t)pos + 1 >= len) return -1;
+        buf[pos++] = ',';
+        n = heapMetricsWriteJson(buf + pos, len - pos);
+        if (n < 0) return -1;
+        pos += n;
+    }
+    int n = snprintf(buf + pos, len - pos, ",\"settings\":{");
+    if (n < 0 || (size_t)n >= len - pos) return -1;
+    pos += n;
+    n = settingsWriteJsonSince(sinceVersion, buf + pos, len - pos - 3);
+    if (n < 0) return -1;
+    pos += n;
+    buf[pos++] = '}';
+    buf[pos++] = '}';
+    buf[pos] = '\0';
+    return pos;
+}
+
+// Helper function to send ALL current settings (full snapshot)
+// Includes machine state, position, PnP/Grid settings, and all Painting settings.
+// Used for new connections and clients whose version can't be served as a delta.
 void sendCurrentSettings(uint8_t specificClientNum) {
-    JsonDocument doc; // Use ArduinoJson library V7+ syntax
-
-    // Machine State
-    JsonObject statusObj = doc.createNestedObject("status");
-    statusObj["isMoving"] = isMoving;
-    statusObj["isHoming"] = isHoming;
-    statusObj["allHomed"] = allHomed;
-    statusObj["inCalibrationMode"] = inCalibrationMode;
-    statusObj["inPickPlaceMode"] = inPickPlaceMode;
-    statusObj["isPainting"] = isPainting; // <<< Added isPainting state
-    statusObj["isPressurized"] = isPressurePotOn; // <<< Renamed state variable
-
-    // Current Position (Tool Center Point - TCP)
-    JsonObject positionObj = doc.createNestedObject("position");
-    if (allHomed) {
-        positionObj["x"] = stepper_x ? (float)stepper_x->getCurrentPosition() / STEPS_PER_INCH_XY : 0.0f;
-        positionObj["y"] = stepper_y_left ? (float)stepper_y_left->getCurrentPosition() / STEPS_PER_INCH_XY : 0.0f; // Use left Y
-        positionObj["z"] = stepper_z ? (float)stepper_z->getCurrentPosition() / STEPS_PER_INCH_Z : 0.0f;
-        positionObj["rot"] = stepper_rot ? (float)stepper_rot->getCurrentPosition() / STEPS_PER_DEGREE : 0.0f;
-    } else {
-        positionObj["x"] = 0.0f;
-        positionObj["y"] = 0.0f;
-        positionObj["z"] = 0.0f;
-        positionObj["rot"] = 0.0f;
-    }
-
-
-    // All Configurable Settings
-    JsonObject settingsObj = doc.createNestedObject("settings");
-
-    // Grid/Tray Settings
-    settingsObj["gridCols"] = placeGridCols;
-    settingsObj["gridRows"] = placeGridRows;
-    settingsObj["gapX"] = placeGapX_inch;
-    settingsObj["gapY"] = placeGapY_inch;
-    settingsObj["trayWidth"] = trayWidth_inch;
-    settingsObj["trayHeight"] = trayHeight_inch;
-
-    // Painting General Settings
-    settingsObj["paintGunOffsetX"] = paintGunOffsetX_inch;
-    settingsObj["paintGunOffsetY"] = paintGunOffsetY_inch;
-    // Add general paint speed/accel if they become configurable via UI
-
-    // Painting Side-Specific Settings
-    for (int i = 0; i < 4; ++i) {
-        settingsObj["paintZ_" + String(i)] = paintZHeight_inch[i];
-        settingsObj["paintP_" + String(i)] = paintPitchAngle[i]; // Send raw angle (0-180)
-        settingsObj["paintR_" + String(i)] = paintPatternType[i]; // Use 'R' key for pattern to match HTML select ID
-        settingsObj["paintS_" + String(i)] = paintSpeed[i];
-        // --- ADDED: Paint Start Positions ---
-        settingsObj["paintStartX_" + String(i)] = paintStartX[i];
-        settingsObj["paintStartY_" + String(i)] = paintStartY[i];
-        // ------------------------------------
-    }
-
-    // PnP Specific Settings
-    settingsObj["pnpPickX"] = pnpPickLocationX_inch;
-    settingsObj["pnpPickY"] = pnpPickLocationY_inch;
-    settingsObj["pnpPickZ"] = pnpPickLocationZ_inch;
-    settingsObj["pnpPlaceZ"] = pnpPlaceHeight_inch;
-    settingsObj["firstPlaceX"] = placeFirstXAbsolute_inch;
-    settingsObj["firstPlaceY"] = placeFirstYAbsolute_inch;
-    // Add PnP speeds/accels if they become configurable
-
-    // Serialize JSON to string
-    String output;
-    serializeJson(doc, output);
+    // Built with snprintf into a static buffer: no heap allocation per update
+    static char output[3072]; // Full snapshot: all settings plus boot, wifi and heap
+    settingsScanChanges();
+    int len = buildSettingsMessage(output, sizeof(output), 0, true, true);
+    if (len < 0) {
+        LOGE("sendCurrentSettings: Settings JSON exceeds buffer!");
+        return;
+    }
 
     // Send to specific client or broadcast
     if (specificClientNum < 255) { // 255 used as indicator to broadcast
-        // Serial.printf("[DEBUG] Sending settings update to client %d: %s\\n", specificClientNum, output.c_str());
-        webSocket.sendTXT(specificClientNum, output);
+        webSocket.sendTXT(specificClientNum, output, len);
     } else {
-        // Serial.printf("[DEBUG] Broadcasting settings update: %s\\n", output.c_str());
-        webSocket.broadcastTXT(output);
+        webSocket.broadcastTXT(output, len);
+        lastBroadcastVersion = settingsVersion();
+        lastBroadcastStatus = statusBits();
+    }
+}
+
+// Broadcast only what changed since the last broadcast: settings whose version
+// is newer, plus the status object if any machine flag flipped. Sends nothing
+// if neither changed.
+void broadcastSettingsDelta() {
+    static char output[2048];
+    if (settingsBroadcastHold > 0) return; // Sent once the command list is done
+    uint32_t version = settingsScanChanges();
+    uint32_t status = statusBits();
+    bool statusChanged = (status != lastBroadcastStatus);
+    if (version == lastBroadcastVersion && !statusChanged) return;
+
+    int len = buildSettingsMessage(output, sizeof(output), lastBroadcastVersion, statusChanged, false);
+    if (len < 0) {
+        LOGE("broadcastSettingsDelta: Settings JSON exceeds buffer!");
+        return;
+    }
+    webSocket.broadcastTXT(output, len);
+    lastBroadcastVersion = version;
+    lastBroadcastStatus = status;
+}
+
+// Answer a SET_* command: the sender gets its copy of the delta broadcast. A SET
+// that changed nothing broadcasts nothing, so it gets a reply of its own.
+// settingsBefore is settingsScanChanges() from before the command applied its values.
+static void replySettingsApplied(uint8_t num, uint32_t settingsBefore) {
+    broadcastSettingsDelta();
+    if (settingsBroadcastHold > 0 || settingsVersion() != settingsBefore) return; // Delta sent (or held for the list)
+    webSocket.sendTXT(num, "{\"status\":\"Ready\", \"message\":\"No change: settings already have these values.\"}");
+}
+
+// Reply to GET_SETTINGS <epoch> <version>: a delta if the client's version is
+// from this boot and not ahead of ours, otherwise a full snapshot.
+void sendSettingsSince(uint8_t num, uint32_t clientEpoch, uint32_t clientVersion) {
+    static char output[2048];
+    uint32_t version = settingsScanChanges();
+    if (clientEpoch != settingsEpoch() || clientVersion == 0 || clientVersion > version) {
+        sendCurrentSettings(num);
+        return;
+    }
+    int len = buildSettingsMessage(output, sizeof(output), clientVersion, true, false);
+    if (len < 0) {
+        LOGE("sendSettingsSince: Settings JSON exceeds buffer!");
+        return;
+    }
+    webSocket.sendTXT(num, output, len);
+}
+
+// --- Command Lists: BATCH and macros ---
+// Both feed their lines through webSocketEvent() as if the client had sent
+// them, so every command behaves exactly as it does on its own, and stop at
+// the first line that fails (commandAckLastOk()). Settings broadcasts are held
+// while lines run back to back, so a list sends one delta instead of one per
+// line; the NVS blob is written once by the settings store's debounce anyway.
+
+// Settings-only commands: a failed batch can be undone by restoring the settings
+static const char* const BATCH_COMMANDS[] = {
+    "SET_TRAY_SIZE", "SET_GRID_SPACING", "SET_PNP_OFFSET", "SET_FIRST_PLACE_ABS", "SET_PNP_SPEEDS",
+    "SET_PAINT_GUN_OFFSET", "SET_PAINT_SIDE_SETTINGS", "SET_SPRAY_MODEL", "SET_SWEEP_OVERTRAVEL"
+};
+static const char BATCH_JSON_PREFIX[] = "{\"command\":\"SET_PAINT_STARTS\""; // As the UI sends it
+
+static bool batchLineAllowed(const char* line) {
+    char id[CMD_ACK_ID_MAX + 1];
+    line += commandAckParseId((const uint8_t*)line, strlen(line), id); // Lines may carry their own ids
+    if (strncmp(line, BATCH_JSON_PREFIX, sizeof(BATCH_JSON_PREFIX) - 1) == 0) return true;
+    size_t len = strcspn(line, " ");
+    for (const char* cmd : BATCH_COMMANDS) {
+        if (len == strlen(cmd) && strncmp(line, cmd, len) == 0) return true;
+    }
+    return false;
+}
+
+static bool machineIdleForList() {
+    return !isMoving && !isHoming && !isPainting && !pendingHomingAfterPnP;
+}
+
+// Apply every line or none: on the first failure the settings are restored
+static void runCommandBatch(uint8_t num, const char* lines, size_t len) {
+    char msg[128];
+    char reply[192];
+    char line[MACRO_LINE_MAX];
+    if (!machineIdleForList() || macroRunning) {
+        webSocket.sendTXT(num, "{\"status\":\"Error\", \"message\":\"Cannot apply a batch while machine is busy.\"}");
+        return;
+    }
+    bool ok = macroCheckBody(lines, len, msg, sizeof(msg));
+    const char* pos = lines;
+    const char* end = lines + len;
+    for (int n = 1; ok && macroNextLine(pos, end, line, sizeof(line)) > 0; n++) {
+        if (!batchLineAllowed(line)) {
+            ok = false;
+            snprintf(msg, sizeof(msg), "Line %d: only settings commands can be batched.", n);
+        }
+    }
+    if (!ok) {
+        LOGW("    BATCH Denied: %s", msg);
+        snprintf(reply, sizeof(reply), "{\"status\":\"Error\", \"message\":\"Batch rejected: %s\"}", msg);
+        webSocket.sendTXT(num, reply);
+        return;
+    }
+
+    static uint8_t snapshot[RECIPE_SETTINGS_MAX];
+    size_t snapshotSize = settingsPack(snapshot, sizeof(snapshot));
+    unsigned long startUs = micros();
+    int count = 0;
+    int failedLine = 0;
+    settingsBroadcastHold++;
+    pos = lines;
+    while (!failedLine && macroNextLine(pos, end, line, sizeof(line)) > 0) {
+        count++;
+        webSocketEvent(num, WStype_TEXT, (uint8_t*)line, strlen(line));
+        if (!commandAckLastOk()) failedLine = count;
+    }
+    if (failedLine) {
+        settingsUnpack(snapshot, snapshotSize);
+        calculateAndSetGridSpacing(placeGridCols, placeGridRows); // Gaps are derived from the restored grid
+    }
+    settingsBroadcastHold--;
+    broadcastSettingsDelta(); // The whole batch in one delta (nothing after a rollback)
+
+    if (failedLine) {
+        LOGW("    BATCH failed at line %d, settings restored", failedLine);
+        snprintf(reply, sizeof(reply), "{\"status\":\"Error\", \"message\":\"Batch line %d failed; no settings were changed.\"}", failedLine);
+    } else {
+        LOGI("    BATCH applied: %d commands in %lu us", count, micros() - startUs);
+        snprintf(reply, sizeof(reply), "{\"status\":\"Ready\", \"message\":\"Batch applied: %d commands.\"}", count);
+    }
+    webSocket.sendTXT(num, reply);
+}
+
+// The macro being replayed. Lines run back to back while the machine stays
+// idle; a line that starts an operation is waited for before the next one.
+static struct {
+    uint8_t num;                // Client that started it (gets the replies)
+    char name[RECIPE_NAME_MAX + 1];
+    char body[MACRO_BODY_MAX];
+    size_t len;
+    const char* pos;            // Next line
+    int line;                   // Lines started so far
+    bool waiting;               // The last line left the machine busy
+    uint32_t failureBroadcasts; // webSocket.failureBroadcasts() before that line
+    unsigned long startMs;
+} macroRun;
+
+static bool macroStart(uint8_t num, const char* name, char* msg, size_t msgLen) {
+    size_t len;
+    if (!macroLoad(name, macroRun.body, len, msg, msgLen)) return false;
+    if (!macroCheckBody(macroRun.body, len, msg, msgLen)) return false; // Also counts the lines
+    macroRun.num = num;
+    strncpy(macroRun.name, name, RECIPE_NAME_MAX);
+    macroRun.name[RECIPE_NAME_MAX] = '\0';
+    macroRun.len = len;
+    macroRun.pos = macroRun.body;
+    macroRun.line = 0;
+    macroRun.waiting = false;
+    macroRun.startMs = millis();
+    macroRunning = true;
+    char lines[32];
+    strncpy(lines, msg, sizeof(lines) - 1); // "<n> commands."
+    lines[sizeof(lines) - 1] = '\0';
+    snprintf(msg, msgLen, "Running macro '%s': %s", name, lines);
+    return true;
+}
+
+static char macroStopMsg[160]; // Reported by macroLoop(), outside the command that stopped the macro
+
+static void macroAbort(const char* status, const char* reason) {
+    macroRunning = false;
+    snprintf(macroStopMsg, sizeof(macroStopMsg), "{\"status\":\"%s\", \"message\":\"Macro '%s' stopped at line %d: %s.\"}",
+             status, macroRun.name, macroRun.line, reason);
+    LOGW("Macro '%s' stopped at line %d: %s", macroRun.name, macroRun.line, reason);
+}
+
+// Broadcast from loop() so a STOP is not acked as failed for the macro it ended
+static void macroReportStop() {
+    if (!macroStopMsg[0]) return;
+    webSocket.broadcastTXT(macroStopMsg);
+    macroStopMsg[0] = '\0';
+}
+
+static void macroLoop() {
+    macroReportStop();
+    if (!macroRunning) return;
+    if (macroRun.waiting) {
+        if (!machineIdleForList()) return; // Step still running
+        macroRun.waiting = false;
+        if (webSocket.failureBroadcasts() != macroRun.failureBroadcasts) {
+            macroAbort("Error", "the command failed");
+            return;
+        }
+    }
+
+    char line[MACRO_LINE_MAX];
+    const char* end = macroRun.body + macroRun.len;
+    settingsBroadcastHold++;
+    while (macroRunning) {
+        int n = macroNextLine(macroRun.pos, end, line, sizeof(line));
+        if (n < 0) { // macroStart() checked the body; guard only
+            macroAbort("Error", "line too long");
+            break;
+        }
+        if (n == 0) {
+            macroRunning = false;
+            char msg[160];
+            snprintf(msg, sizeof(msg), "{\"status\":\"Ready\", \"message\":\"Macro '%s' completed: %d commands in %lu ms.\"}",
+                     macroRun.name, macroRun.line, millis() - macroRun.startMs);
+            LOGI("Macro '%s' completed (%d commands)", macroRun.name, macroRun.line);
+            webSocket.broadcastTXT(msg);
+            break;
+        }
+        macroRun.line++;
+        uint32_t failuresBefore = webSocket.failureBroadcasts();
+        LOGD("Macro '%s' line %d: %s", macroRun.name, macroRun.line, line);
+        commandAckLoop(); // The previous step's ack before this step's replies
+        webSocketEvent(macroRun.num, WStype_TEXT, (uint8_t*)line, n);
+        if (!macroRunning) break; // STOP or ESTOP during a blocking step
+        if (!commandAckLastOk() || webSocket.failureBroadcasts() != failuresBefore) {
+            macroAbort("Error", "the command failed");
+            break;
+        }
+        if (!machineIdleForList()) {
+            macroRun.waiting = true;
+            macroRun.failureBroadcasts = failuresBefore;
+            break;
+        }
     }
+    settingsBroadcastHold--;
+    broadcastSettingsDelta();
+    macroReportStop();
 }
 
 // Actuator Pins Initialization
@@ -2291,6 +2752,6 @@ void initializeActuators() {
     digitalWrite(SUCTION_PIN, LOW);       // Start suction off
     digitalWrite(PRESSURE_POT_PIN, LOW);  // Start pressure pot off
     isPressurePotOn = false;                // Ensure state matches pin
-    Serial.println("Actuator pins initialized (Pick, Suction, Pressure Pot).");
+    LOGI("Actuator pins initialized (Pick, Suction, Pressure Pot).");
 }
 
@@ -0,0 +1,142 @@
+#include "Diagnostics.h"
+#include <esp_timer.h>
+#include <esp_freertos_hooks.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "HeapMetrics.h"
+#include "../Main/SharedGlobals.h" // For the steppers and webSocket
+
+struct DiagTask {
+    const char* label;     // JSON key
+    const char* taskName;  // FreeRTOS task name (nullptr: captured in diagnosticsInit)
+    TaskHandle_t handle;   // Looked up until found (WiFi starts after setup)
+    uint32_t stackFree;    // High-water mark: least free stack ever (bytes)
+};
+
+static DiagTask tasks[DIAG_TASKS] = {
+    {"loop", nullptr, nullptr, 0},
+    {"wifi", "wifi", nullptr, 0},
+    {"stepper", "StepperTask", nullptr, 0},
+    {"estop", "estop", nullptr, 0},
+    {"logDrain", "logDrain", nullptr, 0},
+    {"esp_timer", "esp_timer", nullptr, 0},
+};
+
+#define DIAG_AXES 5
+static const char* const AXIS_NAMES[DIAG_AXES] = {"x", "yLeft", "yRight", "z", "rot"};
+static uint8_t queueFill[DIAG_AXES];
+static uint8_t queueLowRunning[DIAG_AXES]; // 0xFF = not running this window
+
+static volatile uint32_t idleCount[2] = {0, 0};
+static uint32_t idlePeak[2] = {0, 0}; // Highest count per window so far (= 100% idle)
+static uint8_t idlePct[2] = {0, 0};
+
+static esp_timer_handle_t sampleTimer = nullptr;
+
+// Returning false keeps the idle task spinning (no WFI) so the count tracks idle time
+static bool idleHookCore0() { idleCount[0]++; return false; }
+static bool idleHookCore1() { idleCount[1]++; return false; }
+
+static FastAccelStepper* axisStepper(int i) {
+    switch (i) {
+        case 0: return stepper_x;
+        case 1: return stepper_y_left;
+        case 2: return stepper_y_right;
+        case 3: return stepper_z;
+        default: return stepper_rot;
+    }
+}
+
+static void sample(void*) {
+    for (int c = 0; c < 2; c++) {
+        uint32_t n = idleCount[c];
+        idleCount[c] = 0;
+        if (n > idlePeak[c]) idlePeak[c] = n;
+        idlePct[c] = idlePeak[c] ? (uint8_t)((uint64_t)n * 100 / idlePeak[c]) : 0;
+    }
+    for (int i = 0; i < DIAG_TASKS; i++) {
+        DiagTask& t = tasks[i];
+        if (!t.handle && t.taskName) t.handle = xTaskGetHandle(t.taskName);
+        if (t.handle) t.stackFree = uxTaskGetStackHighWaterMark(t.handle);
+    }
+    for (int i = 0; i < DIAG_AXES; i++) {
+        FastAccelStepper* s = axisStepper(i);
+        if (!s) continue;
+        queueFill[i] = s->queueEntries();
+        if (s->isRunning() && queueFill[i] < queueLowRunning[i]) queueLowRunning[i] = queueFill[i];
+    }
+}
+
+void diagnosticsInit() {
+    tasks[0].handle = xTaskGetCurrentTaskHandle(); // setup() runs in the loop task
+    memset(queueLowRunning, 0xFF, sizeof(queueLowRunning));
+    esp_register_freertos_idle_hook_for_cpu(idleHookCore0, 0);
+    esp_register_freertos_idle_hook_for_cpu(idleHookCore1, 1);
+
+    esp_timer_create_args_t args = {};
+    args.callback = sample;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "diag";
+    if (esp_timer_create(&args, &sampleTimer) == ESP_OK) {
+        esp_timer_start_periodic(sampleTimer, DIAG_SAMPLE_MS * 1000ULL);
+    }
+}
+
+int diagnosticsWriteJson(char* buf, size_t len) {
+    int pos = snprintf(buf, len, "{\"status\":\"Diagnostics\",\"uptimeMs\":%lu,\"sampleMs\":%d,",
+                       (unsigned long)millis(), DIAG_SAMPLE_MS);
+    if (pos < 0 || (size_t)pos >= len) return -1;
+    int n = heapMetricsWriteJson(buf + pos, len - pos);
+    if (n < 0) return -1;
+    pos += n;
+
+    n = snprintf(buf + pos, len - pos, ",\"tasks\":{");
+    if (n < 0 || (size_t)n >= len - pos) return -1;
+    pos += n;
+    for (int i = 0; i < DIAG_TASKS; i++) {
+        // -1 until the task exists
+        n = snprintf(buf + pos, len - pos, "%s\"%s\":{\"stackFree\":%ld}", i ? "," : "", tasks[i].label,
+                     tasks[i].handle ? (long)tasks[i].stackFree : -1L);
+        if (n < 0 || (size_t)n >= len - pos) return -1;
+        pos += n;
+    }
+
+    n = snprintf(buf + pos, len - pos, "},\"cpuIdlePct\":[%u,%u],\"stepperQueues\":{", idlePct[0], idlePct[1]);
+    if (n < 0 || (size_t)n >= len - pos) return -1;
+    pos += n;
+    bool first = true;
+    for (int i = 0; i < DIAG_AXES; i++) {
+        if (!axisStepper(i)) continue;
+        // lowWhileRunning: -1 if the axis did not run since the last GET_DIAGNOSTICS
+        n = snprintf(buf + pos, len - pos, "%s\"%s\":{\"fill\":%u,\"lowWhileRunning\":%d}", first ? "" : ",",
+                     AXIS_NAMES[i], queueFill[i], queueLowRunning[i] == 0xFF ? -1 : (int)queueLowRunning[i]);
+        if (n < 0 || (size_t)n >= len - pos) return -1;
+        pos += n;
+        queueLowRunning[i] = 0xFF;
+        first = false;
+    }
+
+    n = snprintf(buf + pos, len - pos, "},\"webSocket\":{\"clients\":%u,\"slowDisconnects\":%lu,\"connected\":[",
+                 webSocket.connectedClients(), (unsigned long)webSocket.slowDisconnects());
+    if (n < 0 || (size_t)n >= len - pos) return -1;
+    pos += n;
+    first = true;
+    for (uint8_t c = 0; c < WEBSOCKETS_SERVER_CLIENT_MAX; c++) {
+        if (!webSocket.clientIsConnected(c)) continue;
+        IPAddress ip = webSocket.remoteIP(c);
+        WsClientStats ws = {};
+        webSocket.clientStats(c, ws);
+        n = snprintf(buf + pos, len - pos,
+                     "%s{\"num\":%u,\"ip\":\"%u.%u.%u.%u\",\"pendingBytes\":%lu,\"peakBytes\":%lu,"
+                     "\"deferred\":%lu,\"telemetryDropped\":%lu,\"slowSends\":%lu}",
+                     first ? "" : ",", c, ip[0], ip[1], ip[2], ip[3], (unsigned long)ws.pendingBytes,
+                     (unsigned long)ws.peakBytes, (unsigned long)ws.deferred, (unsigned long)ws.telemetryDropped,
+                     (unsigned long)ws.slowSends);
+        if (n < 0 || (size_t)n >= len - pos) return -1;
+        pos += n;
+        first = false;
+    }
+    n = snprintf(buf + pos, len - pos, "]}}");
+    if (n < 0 || (size_t)n >= len - pos) return -1;
+    return pos + n;
+}
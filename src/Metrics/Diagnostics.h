@@ -0,0 +1,35 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <Arduino.h>
+
+// === Diagnostics ===
+// Resource telemetry for GET_DIAGNOSTICS. A periodic esp_timer samples every
+// DIAG_SAMPLE_MS (in the esp_timer task, off loop()):
+//  - stack high-water marks of the loop, WiFi, stepper and our own tasks;
+//  - per-core idle percentage from idle-hook counters, scaled against the
+//    highest count seen in a window (self-calibrating: the first quiet
+//    window after boot sets the 100% reference);
+//  - FastAccelStepper queue fill per axis, plus the lowest fill seen while
+//    the axis was running (a queue that runs dry stutters the motion).
+// Heap figures come from HeapMetrics; the WebSocket client list, with each
+// client's outbound queue and drop counters, is read in loop() context when
+// the snapshot is written.
+
+#define DIAG_SAMPLE_MS 1000
+#define DIAG_TASKS 6 // loop, wifi, stepper, estop, logDrain, esp_timer
+
+/**
+ * @brief Register the idle hooks and start the sampling timer.
+ * Call from setup() (captures the loop task handle) after the steppers exist.
+ */
+void diagnosticsInit();
+
+/**
+ * @brief Write {"status":"Diagnostics","uptimeMs":N,"heap":{...},"tasks":{...},"cpuIdlePct":[c0,c1],
+ * "stepperQueues":{...},"webSocket":{...}}. Resets the per-window queue lows.
+ * @return Length written, or -1 if buf is too small.
+ */
+int diagnosticsWriteJson(char* buf, size_t len);
+
+#endif // DIAGNOSTICS_H
@@ -0,0 +1,38 @@
+#include "HeapMetrics.h"
+
+static unsigned long lastSampleMs = 0;
+static bool sampled = false;
+static uint32_t freeBytes = 0;
+static uint32_t largestBlock = 0;
+static uint32_t minLargestBlock = 0;
+static uint32_t baselineLargestBlock = 0;
+
+static void sample() {
+    freeBytes = ESP.getFreeHeap();
+    largestBlock = ESP.getMaxAllocHeap();
+    if (!sampled) {
+        baselineLargestBlock = largestBlock;
+        minLargestBlock = largestBlock;
+        sampled = true;
+    } else if (largestBlock < minLargestBlock) {
+        minLargestBlock = largestBlock;
+    }
+}
+
+void heapMetricsLoop() {
+    unsigned long now = millis();
+    if (sampled && now - lastSampleMs < HEAP_SAMPLE_MS) return;
+    lastSampleMs = now;
+    sample();
+}
+
+int heapMetricsWriteJson(char* buf, size_t len) {
+    sample(); // Current values, not up to HEAP_SAMPLE_MS old
+    int fragPct = freeBytes ? (int)(100 - (uint64_t)largestBlock * 100 / freeBytes) : 0;
+    int n = snprintf(buf, len,
+                     "\"heap\":{\"free\":%lu,\"minFree\":%lu,\"largestBlock\":%lu,\"minLargestBlock\":%lu,"
+                     "\"baselineLargestBlock\":%lu,\"fragPct\":%d}",
+                     (unsigned long)freeBytes, (unsigned long)ESP.getMinFreeHeap(), (unsigned long)largestBlock,
+                     (unsigned long)minLargestBlock, (unsigned long)baselineLargestBlock, fragPct);
+    return (n < 0 || (size_t)n >= len) ? -1 : n;
+}
@@ -0,0 +1,27 @@
+#ifndef HEAP_METRICS_H
+#define HEAP_METRICS_H
+
+#include <Arduino.h>
+
+// === Heap Metrics ===
+// Tracks free heap and the largest free block over the uptime, so heap
+// fragmentation shows up as a trend instead of a crash days later. loop()
+// samples every HEAP_SAMPLE_MS; the snapshot carries the current values, the
+// lows since boot and the largest block at the first sample as a baseline.
+// A flat process keeps largestBlock near baseline and fragPct steady.
+
+#define HEAP_SAMPLE_MS 1000
+
+/**
+ * @brief Call from loop(); samples at most every HEAP_SAMPLE_MS.
+ */
+void heapMetricsLoop();
+
+/**
+ * @brief Write "heap":{"free":N,"minFree":N,"largestBlock":N,"minLargestBlock":N,"baselineLargestBlock":N,"fragPct":N}.
+ * fragPct is 100 * (1 - largestBlock / free). Values are bytes.
+ * @return Length written, or -1 if buf is too small.
+ */
+int heapMetricsWriteJson(char* buf, size_t len);
+
+#endif // HEAP_METRICS_H
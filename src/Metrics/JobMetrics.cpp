@@ -0,0 +1,137 @@
+#include "JobMetrics.h"
+#include <esp_timer.h>
+
+static const char* TYPE_NAMES[] = {"none", "paintSide", "paintAll", "pickPlace"};
+static const char* RESULT_NAMES[] = {"running", "done", "stopped", "failed"};
+static const char* CATEGORY_NAMES[JOB_CATEGORY_COUNT] = {
+    "spray", "sweepDry", "reposition", "rotate", "dwell", "network", "idle", "other"
+};
+
+// === Internal State ===
+static JobRecord current;
+static bool active = false;
+static JobCategory currentCategory = JOB_CAT_OTHER;
+static int64_t lastSwitchUs = 0;   // esp_timer time (64-bit, no wrap) of the last category switch
+static uint32_t nextJobId = 1;
+
+static JobRecord history[JOB_HISTORY_SIZE];
+static int historyCount = 0;
+static int historyHead = 0;        // Next slot to write
+
+static void chargeElapsed() {
+    int64_t now = esp_timer_get_time();
+    current.categoryUs[currentCategory] += (uint64_t)(now - lastSwitchUs);
+    lastSwitchUs = now;
+}
+
+void jobBegin(JobType type, int side) {
+    if (active) jobEnd(JOB_STOPPED);
+    memset(&current, 0, sizeof(current));
+    current.id = nextJobId++;
+    current.type = type;
+    current.side = (int8_t)side;
+    current.result = JOB_RUNNING;
+    current.startMs = millis();
+    currentCategory = JOB_CAT_OTHER;
+    lastSwitchUs = esp_timer_get_time();
+    active = true;
+}
+
+JobCategory jobSetCategory(JobCategory category) {
+    if (!active) return JOB_CAT_OTHER;
+    JobCategory prev = currentCategory;
+    if (category != prev) {
+        chargeElapsed();
+        currentCategory = category;
+    }
+    return prev;
+}
+
+void jobAddUnit() {
+    if (active) current.units++;
+}
+
+void jobEnd(JobResult result) {
+    if (!active) return;
+    chargeElapsed();
+    current.result = result;
+    current.totalUs = 0;
+    for (int c = 0; c < JOB_CATEGORY_COUNT; c++) current.totalUs += current.categoryUs[c];
+    active = false;
+
+    history[historyHead] = current;
+    historyHead = (historyHead + 1) % JOB_HISTORY_SIZE;
+    if (historyCount < JOB_HISTORY_SIZE) historyCount++;
+}
+
+bool jobActive() {
+    return active;
+}
+
+static int writeJob(const JobRecord& job, char* buf, size_t len) {
+    float totalMs = job.totalUs / 1000.0f;
+    float sprayMs = job.categoryUs[JOB_CAT_SPRAY] / 1000.0f;
+    int pos = snprintf(buf, len,
+                       "{\"id\":%lu,\"type\":\"%s\",\"side\":%d,\"result\":\"%s\",\"startMs\":%lu,\"units\":%u,"
+                       "\"totalMs\":%.1f,\"utilization\":%.3f,\"ms\":{",
+                       (unsigned long)job.id, TYPE_NAMES[job.type & 3], job.side, RESULT_NAMES[job.result & 3],
+                       (unsigned long)job.startMs, job.units, totalMs, totalMs > 0 ? sprayMs / totalMs : 0.0f);
+    if (pos < 0 || (size_t)pos >= len) return -1;
+    for (int c = 0; c < JOB_CATEGORY_COUNT; c++) {
+        int n = snprintf(buf + pos, len - pos, "%s\"%s\":%.1f", c ? "," : "", CATEGORY_NAMES[c],
+                         job.categoryUs[c] / 1000.0f);
+        if (n < 0 || (size_t)n >= len - pos) return -1;
+        pos += n;
+    }
+    int n = snprintf(buf + pos, len - pos, "}}");
+    if (n < 0 || (size_t)n >= len - pos) return -1;
+    return pos + n;
+}
+
+int jobMetricsWriteJson(char* buf, size_t len) {
+    int pos = snprintf(buf, len, "{\"status\":\"JobMetrics\",\"current\":");
+    if (pos < 0 || (size_t)pos >= len) return -1;
+
+    int n;
+    if (active) {
+        // Snapshot with the running category charged up to now
+        chargeElapsed();
+        JobRecord snapshot = current;
+        for (int c = 0; c < JOB_CATEGORY_COUNT; c++) snapshot.totalUs += snapshot.categoryUs[c];
+        n = writeJob(snapshot, buf + pos, len - pos);
+    } else {
+        n = snprintf(buf + pos, len - pos, "null");
+        if (n >= 0 && (size_t)n >= len - pos) n = -1;
+    }
+    if (n < 0) return -1;
+    pos += n;
+
+    // History, newest first, plus per-category totals across it
+    uint64_t totals[JOB_CATEGORY_COUNT] = {0};
+    uint64_t totalUs = 0;
+    n = snprintf(buf + pos, len - pos, ",\"history\":[");
+    if (n < 0 || (size_t)n >= len - pos) return -1;
+    pos += n;
+    for (int i = 0; i < historyCount; i++) {
+        const JobRecord& job = history[(historyHead - 1 - i + JOB_HISTORY_SIZE) % JOB_HISTORY_SIZE];
+        if (i) buf[pos++] = ',';
+        n = writeJob(job, buf + pos, len - pos);
+        if (n < 0) return -1;
+        pos += n;
+        for (int c = 0; c < JOB_CATEGORY_COUNT; c++) totals[c] += job.categoryUs[c];
+        totalUs += job.totalUs;
+    }
+    n = snprintf(buf + pos, len - pos, "],\"totals\":{\"jobs\":%d,\"totalMs\":%.1f,\"utilization\":%.3f,\"ms\":{",
+                 historyCount, totalUs / 1000.0f,
+                 totalUs ? (float)totals[JOB_CAT_SPRAY] / totalUs : 0.0f);
+    if (n < 0 || (size_t)n >= len - pos) return -1;
+    pos += n;
+    for (int c = 0; c < JOB_CATEGORY_COUNT; c++) {
+        n = snprintf(buf + pos, len - pos, "%s\"%s\":%.1f", c ? "," : "", CATEGORY_NAMES[c], totals[c] / 1000.0f);
+        if (n < 0 || (size_t)n >= len - pos) return -1;
+        pos += n;
+    }
+    n = snprintf(buf + pos, len - pos, "}}}");
+    if (n < 0 || (size_t)n >= len - pos) return -1;
+    return pos + n;
+}
@@ -0,0 +1,90 @@
+#ifndef JOB_METRICS_H
+#define JOB_METRICS_H
+
+#include <Arduino.h>
+
+// === Job Metrics ===
+// Attributes the wall time of each paint / PnP job to what the machine was
+// doing. Exactly one category is "current" while a job runs; switching
+// category charges the time since the last switch to the previous one, so the
+// categories always add up to the job's total. Finished jobs go into a small
+// ring (GET_JOB_METRICS).
+
+#define JOB_HISTORY_SIZE 8
+
+enum JobType : uint8_t {
+    JOB_NONE = 0,
+    JOB_PAINT_SIDE,     // PAINT_SIDE_n
+    JOB_PAINT_ALL,      // PAINT_ALL (4 sides)
+    JOB_PICK_PLACE      // ENTER_PICKPLACE .. EXIT_PICKPLACE
+};
+
+enum JobCategory : uint8_t {
+    JOB_CAT_SPRAY = 0,  // Moving with the gun on
+    JOB_CAT_SWEEP_DRY,  // Sweep move with the gun off
+    JOB_CAT_REPOSITION, // Travel, Z moves, return to (0,0), PnP moves
+    JOB_CAT_ROTATE,     // Tray rotation
+    JOB_CAT_DWELL,      // Fixed waits (servo settling, cylinder/suction timing)
+    JOB_CAT_NETWORK,    // Blocked sending WebSocket status between moves
+    JOB_CAT_IDLE,       // Waiting on the operator (PnP between steps)
+    JOB_CAT_OTHER,      // Anything not attributed above
+    JOB_CATEGORY_COUNT
+};
+
+enum JobResult : uint8_t {
+    JOB_RUNNING = 0,
+    JOB_DONE,
+    JOB_STOPPED,
+    JOB_FAILED
+};
+
+struct JobRecord {
+    uint32_t id;
+    uint8_t type;         // JobType
+    int8_t side;          // First side for paint jobs, -1 otherwise
+    uint8_t result;       // JobResult
+    uint16_t units;       // Sides painted / items placed
+    uint32_t startMs;     // millis() at start
+    uint64_t totalUs;
+    uint64_t categoryUs[JOB_CATEGORY_COUNT];
+};
+
+/**
+ * @brief Start accounting a job (an unfinished previous job is closed as stopped).
+ */
+void jobBegin(JobType type, int side);
+
+/**
+ * @brief Charge elapsed time to the current category and switch to a new one.
+ * @return The previous category (no-op returning JOB_CAT_OTHER when no job runs).
+ */
+JobCategory jobSetCategory(JobCategory category);
+
+/**
+ * @brief Count one completed unit (side painted / item placed).
+ */
+void jobAddUnit();
+
+/**
+ * @brief Close the current job and add it to the history.
+ */
+void jobEnd(JobResult result);
+
+bool jobActive();
+
+/**
+ * @brief Write {"status":"JobMetrics","current":{...}|null,"history":[...],"totals":{...}}.
+ * @return Length written, or -1 if buf is too small.
+ */
+int jobMetricsWriteJson(char* buf, size_t len);
+
+// Switches category for a scope and restores the previous one on exit
+class JobCategoryScope {
+public:
+    explicit JobCategoryScope(JobCategory category) : prev_(jobSetCategory(category)) {}
+    ~JobCategoryScope() { jobSetCategory(prev_); }
+private:
+    JobCategory prev_;
+};
+
+#endif // JOB_METRICS_H
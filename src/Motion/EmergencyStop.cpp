@@ -0,0 +1,156 @@
+#include "EmergencyStop.h"
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "../Main/SharedGlobals.h" // For the steppers and stopRequested
+#include "../Main/GeneralSettings_PinDef.h" // For ESTOP_PIN, PAINT_GUN_PIN, PRESSURE_POT_PIN
+#include "../Logging/Log.h"
+
+static TaskHandle_t estopTask = nullptr;
+static portMUX_TYPE estopMux = portMUX_INITIALIZER_UNLOCKED;
+
+static volatile bool latched = false;
+static volatile bool pending = false;         // Trip not yet handled by emergencyStopService()
+static volatile uint8_t source = ESTOP_SOURCE_NONE;
+static volatile int64_t tripUs = 0;           // Input edge / command receipt (esp_timer)
+static volatile uint32_t outputsOffUs = 0;    // Trip -> gun and pot pins low
+static volatile uint32_t stopUs = 0;          // Trip -> every stepper force-stopped
+static uint32_t maxStopUs = 0;                // Worst stopUs since boot
+static uint32_t tripCount = 0;
+
+// Arduino-ESP32 keeps digitalWrite in IRAM, so this is ISR safe
+static void IRAM_ATTR outputsOff() {
+    digitalWrite(PAINT_GUN_PIN, LOW);
+    digitalWrite(PRESSURE_POT_PIN, LOW);
+}
+
+static void IRAM_ATTR estopIsr() {
+    int64_t now = esp_timer_get_time();
+    outputsOff(); // Idempotent, so contact bounce is harmless
+    portENTER_CRITICAL_ISR(&estopMux);
+    bool first = !latched;
+    if (first) {
+        latched = true;
+        pending = true;
+        source = ESTOP_SOURCE_INPUT;
+        tripUs = now;
+        outputsOffUs = (uint32_t)(esp_timer_get_time() - now);
+    }
+    portEXIT_CRITICAL_ISR(&estopMux);
+    if (!first || !estopTask) return;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(estopTask, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void forceStopAll() {
+    if (stepper_x) stepper_x->forceStop();
+    if (stepper_y_left) stepper_y_left->forceStop();
+    if (stepper_y_right) stepper_y_right->forceStop();
+    if (stepper_z) stepper_z->forceStop();
+    if (stepper_rot) stepper_rot->forceStop();
+}
+
+static void estopTaskFn(void*) {
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        stopRequested = true; // Blocking waits bail out when loop() runs again
+        forceStopAll();
+        outputsOff(); // Again, in case loop() switched them between the trip and here
+        uint32_t us = (uint32_t)(esp_timer_get_time() - tripUs);
+        stopUs = us;
+        if (us > maxStopUs) maxStopUs = us;
+        tripCount++;
+    }
+}
+
+void emergencyStopInit() {
+    pinMode(ESTOP_PIN, INPUT_PULLUP);
+    // Highest priority on the core running loop(): preempts it as soon as it is notified
+    xTaskCreatePinnedToCore(estopTaskFn, "estop", ESTOP_TASK_STACK, NULL, configMAX_PRIORITIES - 1, &estopTask, 1);
+    attachInterrupt(digitalPinToInterrupt(ESTOP_PIN), estopIsr, FALLING);
+    if (emergencyStopInputActive()) {
+        emergencyStopTrigger(ESTOP_SOURCE_INPUT); // Asserted at power-up: no edge will come
+    }
+}
+
+void emergencyStopTrigger(EStopSource src) {
+    int64_t now = esp_timer_get_time();
+    outputsOff();
+    portENTER_CRITICAL(&estopMux);
+    bool first = !latched;
+    if (first) {
+        latched = true;
+        pending = true;
+        source = src;
+        tripUs = now;
+        outputsOffUs = (uint32_t)(esp_timer_get_time() - now);
+    }
+    portEXIT_CRITICAL(&estopMux);
+    if (!first) return;
+    if (estopTask) {
+        xTaskNotifyGive(estopTask);
+    } else {
+        forceStopAll(); // Before init: stop inline
+        stopUs = (uint32_t)(esp_timer_get_time() - now);
+        if (stopUs > maxStopUs) maxStopUs = stopUs;
+        tripCount++;
+    }
+}
+
+bool emergencyStopLatched() {
+    return latched;
+}
+
+bool emergencyStopMoveTo(FastAccelStepper* stepper, long target) {
+    if (latched) return false;
+    bool ok = stepper->moveTo(target) == MOVE_OK;
+    if (latched) { // Tripped after the check: the e-stop task may already have run
+        stepper->forceStop();
+        return false;
+    }
+    return ok;
+}
+
+bool emergencyStopInputActive() {
+    return digitalRead(ESTOP_PIN) == LOW;
+}
+
+bool emergencyStopService() {
+    if (!latched && emergencyStopInputActive()) {
+        emergencyStopTrigger(ESTOP_SOURCE_INPUT); // Edge missed (e.g. asserted during a glitch)
+    }
+    if (!pending) return false;
+    pending = false;
+    LOGE("EMERGENCY STOP (%s): outputs off after %lu us, steppers stopped after %lu us",
+         source == ESTOP_SOURCE_INPUT ? "input" : "command", (unsigned long)outputsOffUs, (unsigned long)stopUs);
+    return true;
+}
+
+void emergencyStopLastLatency(uint32_t& outputsOff, uint32_t& steppersStopped) {
+    outputsOff = outputsOffUs;
+    steppersStopped = stopUs;
+}
+
+bool emergencyStopReset() {
+    if (emergencyStopInputActive()) return false;
+    portENTER_CRITICAL(&estopMux);
+    latched = false;
+    pending = false;
+    source = ESTOP_SOURCE_NONE;
+    portEXIT_CRITICAL(&estopMux);
+    LOGI("Emergency stop reset");
+    return true;
+}
+
+int emergencyStopWriteJson(char* buf, size_t len) {
+    static const char* const sourceNames[] = {"none", "input", "command"};
+    int n = snprintf(buf, len,
+                     "{\"status\":\"EStop\",\"latched\":%s,\"inputActive\":%s,\"source\":\"%s\","
+                     "\"outputsOffUs\":%lu,\"stopUs\":%lu,\"maxStopUs\":%lu,\"trips\":%lu}",
+                     latched ? "true" : "false", emergencyStopInputActive() ? "true" : "false",
+                     sourceNames[source < 3 ? source : 0], (unsigned long)outputsOffUs,
+                     (unsigned long)stopUs, (unsigned long)maxStopUs, (unsigned long)tripCount);
+    if (n < 0 || (size_t)n >= len) return -1;
+    return n;
+}
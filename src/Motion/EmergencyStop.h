@@ -0,0 +1,86 @@
+#ifndef EMERGENCY_STOP_H
+#define EMERGENCY_STOP_H
+
+#include <Arduino.h>
+
+// === Emergency Stop ===
+// A stop path that does not wait for loop() or the WebSocket. Two sources:
+//  - ESTOP_PIN: a falling-edge interrupt drives the paint gun and pressure pot
+//    pins low in the ISR itself and wakes the e-stop task;
+//  - the ESTOP command: handled ahead of every other command, does the same
+//    from the WebSocket callback.
+// The e-stop task runs at the highest priority on the loop() core, so it
+// preempts whatever loop() is blocked in and force-stops every stepper
+// straight away. Both latencies are measured from the trip (input edge or
+// command receipt) with esp_timer and reported in microseconds.
+//
+// The stop latches: the paint outputs stay interlocked off, homing and moves
+// are refused and allHomed is dropped until ESTOP_RESET (which requires the input to be
+// released). loop() does the state cleanup and reporting via
+// emergencyStopService().
+
+#define ESTOP_TASK_STACK 2048
+
+class FastAccelStepper;
+
+enum EStopSource : uint8_t {
+    ESTOP_SOURCE_NONE = 0,
+    ESTOP_SOURCE_INPUT,   // ESTOP_PIN
+    ESTOP_SOURCE_COMMAND  // ESTOP over the WebSocket
+};
+
+/**
+ * @brief Configure ESTOP_PIN, its interrupt and the e-stop task.
+ * Call once the steppers exist (before the boot homing).
+ */
+void emergencyStopInit();
+
+/**
+ * @brief Trip the e-stop from task context (ESTOP command).
+ * Outputs go off before this returns; the steppers are stopped by the e-stop
+ * task, which preempts the caller.
+ */
+void emergencyStopTrigger(EStopSource source);
+
+/**
+ * @brief True from a trip until emergencyStopReset().
+ */
+bool emergencyStopLatched();
+
+/**
+ * @brief stepper->moveTo(target), refused while latched.
+ * Every move goes through this, so code that resumes after the steppers were
+ * force-stopped (a blocking wait, the next PnP stage) cannot restart them.
+ * @return true if the move was queued.
+ */
+bool emergencyStopMoveTo(FastAccelStepper* stepper, long target);
+
+/**
+ * @brief True while the physical input is asserted.
+ */
+bool emergencyStopInputActive();
+
+/**
+ * @brief Call from loop(): catches an input edge the ISR missed.
+ * @return true once per trip, for the caller to reset machine state and report.
+ */
+bool emergencyStopService();
+
+/**
+ * @brief Latencies of the last trip, measured from the input edge / command receipt (us).
+ */
+void emergencyStopLastLatency(uint32_t& outputsOff, uint32_t& steppersStopped);
+
+/**
+ * @brief Release the latch.
+ * @return false (and stays latched) while the input is still asserted.
+ */
+bool emergencyStopReset();
+
+/**
+ * @brief Write {"status":"EStop","latched":bool,"source":"...","outputsOffUs":N,"stopUs":N,...}.
+ * @return Length written, or -1 if buf is too small.
+ */
+int emergencyStopWriteJson(char* buf, size_t len);
+
+#endif // EMERGENCY_STOP_H
@@ -0,0 +1,106 @@
+#include "MotionWatchdog.h"
+#include <math.h>
+#include "../Logging/Log.h"
+
+struct WatchedMove {
+    FastAccelStepper* stepper; // nullptr = slot free
+    const char* name;
+    int32_t start;
+    int32_t target;
+    float speedHz;
+    float accel;
+    uint32_t startUs;
+};
+
+static WatchedMove watched[MOTION_WATCHDOG_AXES];
+static int armedCount = 0;
+static bool faulted = false;
+static char faultText[120] = "";
+
+float motionProfileDistance(float steps, float speedHz, float accel, float t) {
+    float d = fabsf(steps);
+    if (t <= 0.0f || d == 0.0f || speedHz <= 0.0f) return 0.0f;
+    if (accel <= 0.0f) return fminf(d, speedHz * t);
+
+    float rampT = speedHz / accel;
+    float rampD = 0.5f * speedHz * rampT;
+    float peak = speedHz;
+    if (2.0f * rampD > d) { // Triangular: never reaches cruise
+        peak = sqrtf(accel * d);
+        rampT = peak / accel;
+        rampD = 0.5f * d;
+    }
+    float cruiseT = (d - 2.0f * rampD) / peak;
+    if (t < rampT) return 0.5f * accel * t * t;
+    if (t < rampT + cruiseT) return rampD + peak * (t - rampT);
+    float left = 2.0f * rampT + cruiseT - t;
+    if (left <= 0.0f) return d;
+    return d - 0.5f * accel * left * left;
+}
+
+void motionWatchdogArm(FastAccelStepper* stepper, const char* name, int32_t target, float speedHz, float accel) {
+    if (!stepper) return;
+    WatchedMove* slot = nullptr;
+    for (int i = 0; i < MOTION_WATCHDOG_AXES; i++) {
+        if (watched[i].stepper == stepper) { slot = &watched[i]; break; }
+        if (!slot && !watched[i].stepper) slot = &watched[i];
+    }
+    if (!slot) return;
+    if (!slot->stepper) armedCount++;
+    slot->stepper = stepper;
+    slot->name = name;
+    slot->start = stepper->getCurrentPosition();
+    slot->target = target;
+    slot->speedHz = speedHz;
+    slot->accel = accel;
+    slot->startUs = micros();
+}
+
+void motionWatchdogDisarmAll() {
+    for (int i = 0; i < MOTION_WATCHDOG_AXES; i++) watched[i].stepper = nullptr;
+    armedCount = 0;
+}
+
+bool motionWatchdogPoll() {
+    if (armedCount == 0) return false;
+    uint32_t nowUs = micros();
+    for (int i = 0; i < MOTION_WATCHDOG_AXES; i++) {
+        WatchedMove& m = watched[i];
+        if (!m.stepper) continue;
+        if (!m.stepper->isRunning()) { // Done (or stopped on purpose)
+            m.stepper = nullptr;
+            armedCount--;
+            continue;
+        }
+        float elapsed = (nowUs - m.startUs) * 1e-6f;
+        float distance = (float)m.target - m.start;
+        float expected = motionProfileDistance(distance, m.speedHz, m.accel, elapsed - MOTION_WATCHDOG_LAG_MS / 1000.0f);
+        float done = ((float)m.stepper->getCurrentPosition() - m.start) * (distance < 0 ? -1.0f : 1.0f);
+        if (done + MOTION_WATCHDOG_SLACK_STEPS >= expected) continue;
+
+        snprintf(faultText, sizeof(faultText), "%s stalled: %ld of %ld steps after %lu ms (plan: %ld by now)",
+                 m.name, (long)done, (long)fabsf(distance), (unsigned long)(elapsed * 1000.0f),
+                 (long)motionProfileDistance(distance, m.speedHz, m.accel, elapsed));
+        LOGE("Motion watchdog: %s", faultText);
+        for (int k = 0; k < MOTION_WATCHDOG_AXES; k++) {
+            if (watched[k].stepper) watched[k].stepper->forceStop();
+        }
+        motionWatchdogDisarmAll();
+        faulted = true;
+        return true;
+    }
+    return false;
+}
+
+bool motionWatchdogFaulted() {
+    return faulted;
+}
+
+const char* motionWatchdogFault() {
+    return faulted ? faultText : "";
+}
+
+void motionWatchdogClear() {
+    faulted = false;
+    faultText[0] = '\0';
+}
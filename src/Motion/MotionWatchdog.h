@@ -0,0 +1,65 @@
+#ifndef MOTION_WATCHDOG_H
+#define MOTION_WATCHDOG_H
+
+#include <Arduino.h>
+#include <FastAccelStepper.h>
+
+// === Motion Watchdog ===
+// Checks each commanded move against the trapezoid it was planned with. A move
+// is armed per axis right after its moveTo() with the speed and acceleration
+// it was given; every poll compares the axis' progress toward the target with
+// where the profile says it should have been MOTION_WATCHDOG_LAG_MS ago. An
+// axis that falls further behind than that is stalled: every watched axis is
+// force-stopped and the fault is latched for the caller to report.
+//
+// Long moves are judged by their own profile, so a slow 40 s sweep is fine
+// while a move that stops progressing is caught within the lag window.
+// An axis that is no longer running is simply disarmed; code that stops or
+// re-homes axes on purpose calls motionWatchdogDisarmAll() first.
+
+#define MOTION_WATCHDOG_AXES 5        // X, Y left, Y right, Z, rotation
+#define MOTION_WATCHDOG_LAG_MS 250    // Allowed lag behind the planned profile
+#define MOTION_WATCHDOG_SLACK_STEPS 4 // Step rounding / queue latency at the start of a move
+
+/**
+ * @brief Watch a move that was just started with moveTo().
+ * @param stepper The axis (re-arming an axis replaces its previous move).
+ * @param name Axis name for the fault message (string literal).
+ * @param target Target position of the move (steps).
+ * @param speedHz Cruise speed the move was given (steps/s).
+ * @param accel Acceleration the move was given (steps/s^2).
+ */
+void motionWatchdogArm(FastAccelStepper* stepper, const char* name, int32_t target, float speedHz, float accel);
+
+/**
+ * @brief Stop watching all axes (pause, STOP, homing).
+ */
+void motionWatchdogDisarmAll();
+
+/**
+ * @brief Check all watched axes. Cheap when nothing is armed.
+ * @return true if a stall was detected by this call.
+ */
+bool motionWatchdogPoll();
+
+/**
+ * @brief True while a detected stall has not been cleared.
+ */
+bool motionWatchdogFaulted();
+
+/**
+ * @brief Human-readable description of the latched fault ("" if none).
+ */
+const char* motionWatchdogFault();
+
+/**
+ * @brief Clear the latched fault once it has been reported.
+ */
+void motionWatchdogClear();
+
+/**
+ * @brief Steps a trapezoidal move of distance steps should have covered after t seconds.
+ */
+float motionProfileDistance(float steps, float speedHz, float accel, float t);
+
+#endif // MOTION_WATCHDOG_H
@@ -0,0 +1,88 @@
+#include "PaintCheckpoint.h"
+#include <stddef.h> // offsetof
+#include "../Main/SharedGlobals.h" // For preferences
+#include "../Main/GeneralSettings_PinDef.h" // For STEPS_PER_INCH_XY / STEPS_PER_INCH_Z
+#include "../Settings/SettingsStore.h" // For settingsCrc32()
+#include "../Logging/Log.h"
+
+static PaintCheckpoint checkpoint;
+static bool checkpointValid = false;
+
+static uint32_t checkpointCrc(const PaintCheckpoint& cp) {
+    return settingsCrc32(0, &cp, offsetof(PaintCheckpoint, crc));
+}
+
+bool paintCheckpointLoad() {
+    checkpointValid = false;
+    if (!preferences.begin(PAINT_CHECKPOINT_NVS_NAMESPACE, true)) {
+        return false; // Namespace does not exist until the first pause
+    }
+    PaintCheckpoint cp;
+    size_t bytesRead = 0;
+    if (preferences.getBytesLength(PAINT_CHECKPOINT_KEY) == sizeof(cp)) {
+        bytesRead = preferences.getBytes(PAINT_CHECKPOINT_KEY, &cp, sizeof(cp));
+    }
+    preferences.end();
+
+    if (bytesRead != sizeof(cp)) return false;
+    if (cp.version != PAINT_CHECKPOINT_VERSION || cp.crc != checkpointCrc(cp) || cp.side > 3) {
+        LOGW("Ignoring stored paint checkpoint (version %u, bad CRC or side)", cp.version);
+        return false;
+    }
+    checkpoint = cp;
+    checkpointValid = true;
+    LOGI("Paused paint job found: side %u, segment %u%s. Home and send RESUME to continue, STOP to discard.",
+         cp.side, cp.segment, cp.sequence ? " (Paint All)" : "");
+    return true;
+}
+
+bool paintCheckpointSave(PaintCheckpoint& cp) {
+    cp.version = PAINT_CHECKPOINT_VERSION;
+    cp.crc = checkpointCrc(cp);
+    checkpoint = cp;
+    checkpointValid = true;
+
+    if (!preferences.begin(PAINT_CHECKPOINT_NVS_NAMESPACE, false)) {
+        LOGE("Paint checkpoint: failed to open NVS; it will not survive a reboot");
+        return false;
+    }
+    size_t bytesWritten = preferences.putBytes(PAINT_CHECKPOINT_KEY, &cp, sizeof(cp));
+    preferences.end();
+    if (bytesWritten != sizeof(cp)) {
+        LOGE("Paint checkpoint: NVS write failed (%u of %u bytes)", (unsigned)bytesWritten, (unsigned)sizeof(cp));
+        return false;
+    }
+    return true;
+}
+
+void paintCheckpointClear() {
+    if (!checkpointValid) return;
+    checkpointValid = false;
+    if (preferences.begin(PAINT_CHECKPOINT_NVS_NAMESPACE, false)) {
+        preferences.remove(PAINT_CHECKPOINT_KEY);
+        preferences.end();
+    }
+    LOGI("Paint checkpoint cleared");
+}
+
+bool paintCheckpointGet(PaintCheckpoint& out) {
+    if (!checkpointValid) return false;
+    out = checkpoint;
+    return true;
+}
+
+int paintCheckpointWriteJson(char* buf, size_t len) {
+    int n;
+    if (!checkpointValid) {
+        n = snprintf(buf, len, "{\"status\":\"Checkpoint\",\"valid\":false}");
+    } else {
+        const PaintCheckpoint& cp = checkpoint;
+        n = snprintf(buf, len,
+                     "{\"status\":\"Checkpoint\",\"valid\":true,\"side\":%u,\"sequence\":%s,\"segment\":%u,"
+                     "\"gun\":%u,\"pot\":%u,\"x\":%.3f,\"y\":%.3f,\"z\":%.3f}",
+                     cp.side, cp.sequence ? "true" : "false", cp.segment, cp.gunOn, cp.potOn,
+                     (float)cp.x / STEPS_PER_INCH_XY, (float)cp.y / STEPS_PER_INCH_XY, (float)cp.z / STEPS_PER_INCH_Z);
+    }
+    if (n < 0 || (size_t)n >= len) return -1;
+    return n;
+}
@@ -0,0 +1,64 @@
+#ifndef PAINT_CHECKPOINT_H
+#define PAINT_CHECKPOINT_H
+
+#include <Arduino.h>
+
+// === Paint Checkpoint ===
+// Where a paused paint job left off (PAUSE). The toolpath executor stores it
+// when a pause takes effect and RESUME continues from it, including after a
+// reboot: the checkpoint is kept in NVS as one small blob with a CRC until the
+// side completes or STOP discards it.
+//
+// The segment index refers to the compiled toolpath of the side; pathCrc pins
+// that toolpath (and its placement) so a resume after a settings change is
+// refused instead of continuing on a different path.
+
+#define PAINT_CHECKPOINT_NVS_NAMESPACE "paint-ckpt"
+#define PAINT_CHECKPOINT_KEY "ckpt"
+#define PAINT_CHECKPOINT_VERSION 1
+
+struct PaintCheckpoint {
+    uint16_t version;   // PAINT_CHECKPOINT_VERSION
+    uint8_t side;       // 0=Back, 1=Right, 2=Front, 3=Left
+    uint8_t sequence;   // 1 = PAINT_ALL: the remaining sides follow after this one
+    uint16_t segment;   // Segment that was running; resume re-enters it
+    uint8_t gunOn;      // Gun at the pause (resume re-derives it from the path)
+    uint8_t potOn;      // Pressure pot at the pause; switched back on before resuming
+    int32_t x;          // Paint progress point (machine steps): where the gun went off
+    int32_t y;
+    int32_t z;          // Z steps at the pause
+    uint32_t pathCrc;   // toolpathCheckpointCrc() of the side when paused
+    uint32_t crc;       // settingsCrc32 over the fields above
+};
+
+/**
+ * @brief Read the checkpoint from NVS (call once from setup()).
+ * @return true if a valid checkpoint exists.
+ */
+bool paintCheckpointLoad();
+
+/**
+ * @brief Store a checkpoint in RAM and NVS (replaces any previous one).
+ * version and crc are filled in here.
+ * @return true if the NVS write succeeded.
+ */
+bool paintCheckpointSave(PaintCheckpoint& cp);
+
+/**
+ * @brief Discard the checkpoint. Does not touch flash when there is none.
+ */
+void paintCheckpointClear();
+
+/**
+ * @brief Copy the current checkpoint.
+ * @return false if there is none.
+ */
+bool paintCheckpointGet(PaintCheckpoint& out);
+
+/**
+ * @brief Write {"status":"Checkpoint","valid":bool,...} (inches for the positions).
+ * @return Length written, or -1 if buf is too small.
+ */
+int paintCheckpointWriteJson(char* buf, size_t len);
+
+#endif // PAINT_CHECKPOINT_H
@@ -1,6 +1,8 @@
 #include "PaintGunControl.h"
 #include "../Main/SharedGlobals.h"
 #include "../Main/GeneralSettings_PinDef.h"
+#include "../Logging/Log.h"
+#include "../Motion/EmergencyStop.h"
 
 void initializePaintGunControl() {
     // Configure the paint gun and pressure pot pins as outputs
@@ -15,6 +17,8 @@ void initializePaintGunControl() {
 }
 
 void activatePaintGun(bool activatePressurePot) {
+    if (emergencyStopLatched()) return; // Interlocked off until ESTOP_RESET
+
     // Activate paint gun
     digitalWrite(PAINT_GUN_PIN, HIGH);
     
@@ -33,12 +37,26 @@ void deactivatePaintGun(bool deactivatePressurePot) {
     // Deactivate pressure pot if requested
     if (deactivatePressurePot) {
         digitalWrite(PRESSURE_POT_PIN, LOW);
-        Serial.println("Paint Gun and Pressure Pot deactivated");
+        LOGI("Paint Gun and Pressure Pot deactivated");
     } else {
-        Serial.println("Paint Gun deactivated (Pressure Pot remains active)");
+        LOGI("Paint Gun deactivated (Pressure Pot remains active)");
     }
 }
 
+void activatePressurePot() {
+    if (emergencyStopLatched()) return;
+    digitalWrite(PRESSURE_POT_PIN, HIGH);
+    LOGI("Pressure Pot activated");
+}
+
+bool paintGunIsOn() {
+    return digitalRead(PAINT_GUN_PIN) == HIGH;
+}
+
+bool pressurePotIsOn() {
+    return digitalRead(PRESSURE_POT_PIN) == HIGH;
+}
+
 void updatePaintGunForMovement(bool isXMovement, int patternType) {
     // Implement pattern-specific control logic:
     // - For sideways pattern (90), activate during X movement, deactivate during Y movement
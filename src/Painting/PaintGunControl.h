@@ -24,11 +24,26 @@ void activatePaintGun(bool activatePressurePot = true);
  */
 void deactivatePaintGun(bool deactivatePressurePot = true);
 
+/**
+ * @brief Switch the pressure pot on without the gun (resume after a pause)
+ */
+void activatePressurePot();
+
+/**
+ * @brief Current gun / pressure pot output levels.
+ * Read back from the pins (OUTPUT keeps the input buffer enabled on the ESP32),
+ * so direct digitalWrite()s elsewhere are reflected too.
+ */
+bool paintGunIsOn();
+bool pressurePotIsOn();
+
 /**
  * @brief Activate or deactivate the paint gun based on current movement direction
  * Implements pattern-specific logic:
  * - For sideways pattern (90), activate during X movement, deactivate during Y movement
  * - For vertical pattern (0), activate during Y movement, deactivate during X movement
+ * Other (raster) angles leave the gun alone: compiled toolpaths carry the gun
+ * state per segment and do not use this.
  * 
  * @param isXMovement True if moving in X direction, false if moving in Y direction
  * @param patternType The current pattern type (0 for vertical, 90 for sideways)
@@ -2,6 +2,8 @@
 #include <Arduino.h>
 #include <FastAccelStepper.h> // Include if needed for future painting moves
 #include <WebSocketsServer.h> // Include if needed for status updates
+#include "../Web/BufferedWebSocketsServer.h"
+#include "../Logging/Log.h"
 
 // === Constant Definitions (Declared extern in Painting.h) ===
 const int ROT_POS_BACK_DEG = 0;
@@ -11,7 +13,7 @@ const int ROT_POS_LEFT_DEG = 270;
 
 // === Extern Global Variables (Defined in main.cpp) ===
 // Declare external references to variables defined in main.cpp that painting logic might need
-extern WebSocketsServer webSocket; // For sending status messages
+extern BufferedWebSocketsServer webSocket; // For sending status messages
 extern FastAccelStepper *stepper_x;
 extern FastAccelStepper *stepper_y_left;
 extern FastAccelStepper *stepper_y_right;
@@ -41,7 +43,7 @@ void startPaintingSequence() {
         return;
     }
 
-    Serial.println("*** Starting Painting Sequence (Placeholder) ***");
+    LOGI("*** Starting Painting Sequence (Placeholder) ***");
     webSocket.broadcastTXT("{\"status\":\"Busy\", \"message\":\"Starting painting sequence...\"}");
     isMoving = true; // Block other actions
 
@@ -53,26 +55,26 @@ void startPaintingSequence() {
     // 5. Call paintSide(1)
     // ... and so on for all 4 sides
 
-    Serial.println("Painting Side 0 (Back) - Placeholder");
+    LOGI("Painting Side 0 (Back) - Placeholder");
     paintSide(0);
     delay(1000); // Placeholder delay
 
-    Serial.println("Painting Side 1 (Right) - Placeholder");
+    LOGI("Painting Side 1 (Right) - Placeholder");
     paintSide(1);
     delay(1000);
 
-    Serial.println("Painting Side 2 (Front) - Placeholder");
+    LOGI("Painting Side 2 (Front) - Placeholder");
     paintSide(2);
     delay(1000);
 
-    Serial.println("Painting Side 3 (Left) - Placeholder");
+    LOGI("Painting Side 3 (Left) - Placeholder");
     paintSide(3);
     delay(1000);
 
     // --- End Placeholder ---
 
     isMoving = false;
-    Serial.println("*** Painting Sequence Complete (Placeholder) ***");
+    LOGI("*** Painting Sequence Complete (Placeholder) ***");
     webSocket.broadcastTXT("{\"status\":\"Ready\", \"message\":\"Painting sequence complete.\"}");
 }
 
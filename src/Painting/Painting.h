@@ -20,6 +20,10 @@ extern float paintSpeed[4];
 
 #define PAINT_Z_TRAVEL_CLEARANCE_INCH 0.2f // How far above paint height to travel
 
+// Live feed override (SET_FEED_OVERRIDE), percent of the programmed XY speed
+#define FEED_OVERRIDE_MIN_PCT 25
+#define FEED_OVERRIDE_MAX_PCT 200
+
 // Rotation Positions (degrees relative to Back=0)
 // Declared here, defined in Painting.cpp
 extern const int ROT_POS_BACK_DEG;
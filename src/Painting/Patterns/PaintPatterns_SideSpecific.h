@@ -2,11 +2,19 @@
 #define PAINT_PATTERNS_SIDE_SPECIFIC_H
 
 #include <Arduino.h>
+#include "ToolpathCompiler.h" // For ToolpathSideConfig
 
 // NOTE: Requires inclusion of SharedGlobals.h and PatternActions.h before use in .cpp
 
+// === Per-Side Direction Configs (defined in PaintPattern_<Side>.cpp) ===
+extern const ToolpathSideConfig SIDE_CONFIG_BACK;
+extern const ToolpathSideConfig SIDE_CONFIG_RIGHT;
+extern const ToolpathSideConfig SIDE_CONFIG_FRONT;
+extern const ToolpathSideConfig SIDE_CONFIG_LEFT;
+
 // === Side-Specific Pattern Function Declarations ===
-// Each function executes the complete painting sequence for one side.
+// Each function executes the complete painting sequence for one side
+// (compiled toolpath, see ToolpathExecutor.h).
 // They return 'true' if stopRequested becomes true during execution, 'false' otherwise.
 
 /**
@@ -2,15 +2,18 @@
 #include "../../Main/SharedGlobals.h" // <<< ADDED INCLUDE for externs and prototypes
 #include "../../Main/GeneralSettings_PinDef.h" // For steps/inch if needed, though might not be needed if currentX/Y updated correctly
 #include "../PaintGunControl.h" // Include paint gun control
+#include "../../Logging/Log.h"
+#include "../../Metrics/JobMetrics.h"
 
 // Helper function: Prints a message to Serial and WebSocket
 // Duplicated here for simplicity, could be moved to a shared utility
 void printAndBroadcastAction(const char* actionName, const char* details) {
-    Serial.printf("[Action: %s] %s\n", actionName, details);
+    LOGI("[Action: %s] %s", actionName, details);
     char jsonMsg[250]; // Adjust size as needed
     // Using Busy status for actions
     sprintf(jsonMsg, "{\"status\":\"Busy\", \"message\":\"Action [%s]: %s\"}", actionName, details);
     if (webSocket.connectedClients() > 0) { // Check if any clients are connected
+         JobCategoryScope blocked(JOB_CAT_NETWORK); // Motion waits on this send
          webSocket.broadcastTXT(jsonMsg);
     }
 }
@@ -24,10 +27,10 @@ bool actionRotateTo(int targetAngle) {
     printAndBroadcastAction("Rotate", details);
 
     if (!stepper_rot) {
-        Serial.println("ERROR: Rotation stepper not available!");
+        LOGE("Rotation stepper not available!");
         // Log more detailed error information
-        Serial.println("  Check ROTATION_STEP_PIN and ROTATION_DIR_PIN in GeneralSettings_PinDef.h");
-        Serial.println("  Ensure there are no pin conflicts with other steppers");
+        LOGE("  Check ROTATION_STEP_PIN and ROTATION_DIR_PIN in GeneralSettings_PinDef.h");
+        LOGE("  Ensure there are no pin conflicts with other steppers");
         webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Rotation stepper not available. Check configuration.\"}");
         return true; // Signal error to caller
     }
@@ -35,8 +38,8 @@ bool actionRotateTo(int targetAngle) {
     // Get current position before rotation for logging
     long currentSteps = stepper_rot->getCurrentPosition();
     float currentAngle = (float)currentSteps / STEPS_PER_DEGREE;
-    Serial.printf("  Current rotation before move: %.2f degrees (Steps: %ld)\n", currentAngle, currentSteps);
-    Serial.printf("  Target rotation: %d degrees\n", targetAngle);
+    LOGI("  Current rotation before move: %.2f degrees (Steps: %ld)", currentAngle, currentSteps);
+    LOGI("  Target rotation: %d degrees", targetAngle);
 
     // Call the existing global function (declared extern in .h)
     rotateToAbsoluteDegree(targetAngle); 
@@ -44,7 +47,7 @@ bool actionRotateTo(int targetAngle) {
     // Log final position after rotation
     currentSteps = stepper_rot->getCurrentPosition();
     currentAngle = (float)currentSteps / STEPS_PER_DEGREE;
-    Serial.printf("  Final rotation after move: %.2f degrees (Steps: %ld)\n", currentAngle, currentSteps);
+    LOGI("  Final rotation after move: %.2f degrees (Steps: %ld)", currentAngle, currentSteps);
 
     // rotateToAbsoluteDegree has its own check for stopRequested and waits for completion.
     // We just need to check the flag *after* it returns in case it was stopped.
@@ -11,6 +11,13 @@
 // via "../../Main/SharedGlobals.h" BEFORE this header is included in a .cpp file.
 
 
+/**
+ * @brief Prints an action message to Serial and broadcasts it as a Busy status.
+ * @param actionName Short action name (e.g. "Rotate").
+ * @param details Human readable details.
+ */
+void printAndBroadcastAction(const char* actionName, const char* details);
+
 // === Action Function Declarations ===
 // These functions represent the basic "blocks" for building patterns.
 // They return 'true' if stopRequested becomes true during execution, 'false' otherwise.
@@ -0,0 +1,316 @@
+#include "ToolpathCompiler.h"
+#include <math.h>
+#include <stdlib.h> // llabs
+
+// Pattern type values (match PATTERN_UP_DOWN / PATTERN_SIDEWAYS in SharedGlobals.h)
+static const int TOOLPATH_PATTERN_UP_DOWN = 0;
+static const int TOOLPATH_PATTERN_SIDEWAYS = 90;
+static const float TOOLPATH_DEG_TO_RAD = 0.017453292f;
+
+static bool addSegment(Toolpath& out, uint8_t type, uint8_t gun, uint16_t pass, int32_t x, int32_t y, float speedHz) {
+    if (out.count >= TOOLPATH_MAX_SEGMENTS) return false;
+    ToolpathSegment& seg = out.segments[out.count++];
+    seg.type = type;
+    seg.gun = gun;
+    seg.pass = pass;
+    seg.x = x;
+    seg.y = y;
+    seg.speedHz = (uint32_t)speedHz;
+    return true;
+}
+
+// Same inch -> step conversion as moveToXYPositionInches_Paint (truncation)
+static int32_t toSteps(float inches, float stepsPerInch) {
+    return (int32_t)(inches * stepsPerInch);
+}
+
+PassPlan planPasses(int itemPasses, float pitch, float sprayWidth, float sprayOverlap) {
+    PassPlan plan = {itemPasses, 0.0f, pitch};
+    if (sprayWidth <= 0.0f || itemPasses < 1) return plan;
+
+    float band = itemPasses * pitch;
+    if (sprayWidth >= band) {
+        // One pass through the middle of the band covers it
+        plan.count = 1;
+        plan.first = (itemPasses - 1) * pitch * 0.5f;
+        plan.step = 0.0f;
+        return plan;
+    }
+    float overlap = sprayOverlap < 0.0f ? 0.0f : (sprayOverlap > 0.9f ? 0.9f : sprayOverlap);
+    float maxStep = sprayWidth * (1.0f - overlap);
+    plan.count = (int)ceilf((band - sprayWidth) / maxStep - 1e-4f) + 1;
+    plan.step = (band - sprayWidth) / (plan.count - 1);
+    plan.first = (sprayWidth - pitch) * 0.5f; // First fan edge on the band edge
+    return plan;
+}
+
+float sweepRunDistance(float speedHz, float accel, float stepsPerInch) {
+    if (speedHz <= 0.0f || accel <= 0.0f || stepsPerInch <= 0.0f) return 0.0f;
+    return speedHz * speedHz / (2.0f * accel) / stepsPerInch;
+}
+
+// Run-in/run-out from pos heading dir, shortened to stay within [0, travel]
+static float clampRun(float pos, float dir, float run, float travel) {
+    if (run <= 0.0f || travel <= 0.0f) return run;
+    float room = dir > 0.0f ? travel - pos : pos;
+    return room <= 0.0f ? 0.0f : (run < room ? run : room);
+}
+
+void toolpathTransformIdentity(ToolpathTransform& t) {
+    t.m[0] = TOOLPATH_Q16_ONE;
+    t.m[1] = 0;
+    t.m[2] = 0;
+    t.m[3] = TOOLPATH_Q16_ONE;
+    t.tx = 0;
+    t.ty = 0;
+}
+
+void buildSideTransform(ToolpathTransform& t, int rotationDeg, float gunOffsetX, float gunOffsetY,
+                        float patternOffsetX, float patternOffsetY, float stepsPerInchXY) {
+    // Side patterns are already laid out in machine axes, so M stays identity;
+    // only the pattern offset turns with the tray.
+    toolpathTransformIdentity(t);
+    float a = rotationDeg * TOOLPATH_DEG_TO_RAD;
+    float c = cosf(a), s = sinf(a);
+    float dx = c * patternOffsetX - s * patternOffsetY - gunOffsetX;
+    float dy = s * patternOffsetX + c * patternOffsetY - gunOffsetY;
+    t.tx = (int32_t)lroundf(dx * stepsPerInchXY);
+    t.ty = (int32_t)lroundf(dy * stepsPerInchXY);
+}
+
+int toolpathTravelFault(const Toolpath& path, const ToolpathTransform& xf, float travelX, float travelY,
+                        float stepsPerInchXY) {
+    int32_t maxX = (int32_t)(travelX * stepsPerInchXY);
+    int32_t maxY = (int32_t)(travelY * stepsPerInchXY);
+    for (int i = 0; i < path.count; i++) {
+        const ToolpathSegment& seg = path.segments[i];
+        if (seg.type == SEG_ROTATE || seg.type == SEG_MOVE_Z) continue;
+        int32_t x, y;
+        toolpathTransformPoint(xf, seg.x, seg.y, x, y);
+        if (travelX > 0.0f && (x < 0 || x > maxX)) return i;
+        if (travelY > 0.0f && (y < 0 || y > maxY)) return i;
+    }
+    return -1;
+}
+
+int toolpathMoveEnd(const Toolpath& path, int first, int32_t fromX, int32_t fromY) {
+    int last = first;
+    int64_t px = fromX, py = fromY;
+    while (last + 1 < path.count) {
+        const ToolpathSegment& a = path.segments[last];
+        const ToolpathSegment& b = path.segments[last + 1];
+        if ((a.type != SEG_RAMP && a.type != SEG_SWEEP) || (b.type != SEG_RAMP && b.type != SEG_SWEEP)) break;
+        int64_t ax = a.x - px, ay = a.y - py;
+        int64_t bx = b.x - (int64_t)a.x, by = b.y - (int64_t)a.y;
+        // Must keep going the same way; angled sweeps are off by up to a step from truncation
+        int64_t cross = ax * by - ay * bx;
+        int64_t slack = 2 * (llabs(ax) + llabs(ay) + llabs(bx) + llabs(by));
+        if (llabs(cross) > slack || ax * bx + ay * by <= 0) break;
+        px = a.x;
+        py = a.y;
+        last++;
+    }
+    return last;
+}
+
+// Run-in/run-out from (x, y) heading (dx, dy) (unit), shortened to stay within [0, travel] on both axes
+static float clampRun2(float x, float y, float dx, float dy, float run, float travelX, float travelY) {
+    if (run <= 0.0f) return 0.0f;
+    if (travelX > 0.0f && fabsf(dx) > 1e-6f) run = fminf(run, fmaxf(0.0f, (dx > 0.0f ? travelX - x : x) / fabsf(dx)));
+    if (travelY > 0.0f && fabsf(dy) > 1e-6f) run = fminf(run, fmaxf(0.0f, (dy > 0.0f ? travelY - y : y) / fabsf(dy)));
+    return run;
+}
+
+// Raster at p.patternType degrees over the item grid (see compileSideToolpath)
+static bool compileRasterToolpath(const ToolpathSideConfig& config, const ToolpathParams& p, Toolpath& out) {
+    float pitchX = p.itemWidth + p.gapX;
+    float pitchY = p.itemHeight + p.gapY;
+    if (p.gridCols < 1 || p.gridRows < 1 || pitchX <= 0.0f || pitchY <= 0.0f) return false;
+
+    // Grid rectangle: item cells from the start (first item centre) in the shift directions
+    float xa = p.startX - config.columnShiftSign * pitchX * 0.5f;
+    float xb = p.startX + config.columnShiftSign * (p.gridCols - 0.5f) * pitchX;
+    float ya = p.startY - config.rowShiftSign * pitchY * 0.5f;
+    float yb = p.startY + config.rowShiftSign * (p.gridRows - 0.5f) * pitchY;
+    float x0 = fminf(xa, xb), x1 = fmaxf(xa, xb), y0 = fminf(ya, yb), y1 = fmaxf(ya, yb);
+
+    // Sweep direction d and step-over direction n (unit, d x n = -1)
+    float a = p.patternType * TOOLPATH_DEG_TO_RAD;
+    float dx = sinf(a), dy = cosf(a);
+    float nx = dy, ny = -dx;
+
+    // Extent of the rectangle across the sweeps
+    float cornersN[4] = {x0 * nx + y0 * ny, x1 * nx + y0 * ny, x0 * nx + y1 * ny, x1 * nx + y1 * ny};
+    float nMin = cornersN[0], nMax = cornersN[0];
+    for (int i = 1; i < 4; i++) {
+        nMin = fminf(nMin, cornersN[i]);
+        nMax = fmaxf(nMax, cornersN[i]);
+    }
+    float band = nMax - nMin;
+    PassPlan plan;
+    if (p.sprayWidth > 0.0f) {
+        plan = planPasses(1, band, p.sprayWidth, p.sprayOverlap); // Offsets from the band centre
+    } else {
+        float pitch = fminf(pitchX, pitchY);
+        plan.count = (int)ceilf(band / pitch - 1e-4f);
+        if (plan.count < 1) plan.count = 1;
+        plan.step = band / plan.count;
+        plan.first = (plan.step - band) * 0.5f;
+    }
+    // Start with the pass nearest the start point
+    float centre = (nMin + nMax) * 0.5f;
+    float order = (p.startX * nx + p.startY * ny <= centre) ? 1.0f : -1.0f;
+
+    // First sweep heads down (or right, for a horizontal raster) as configured
+    float firstDir = (fabsf(dy) > 1e-4f) ? ((dy < 0.0f) == config.sweepDownFirst ? 1.0f : -1.0f)
+                                         : ((dx > 0.0f) == config.sweepRightFirst ? 1.0f : -1.0f);
+    float run = sweepRunDistance(p.speedHz, p.sweepAccel, p.stepsPerInchXY);
+
+    auto addAt = [&](uint8_t type, uint8_t gun, int pass, float x, float y) {
+        return addSegment(out, type, gun, (uint16_t)pass, toSteps(x, p.stepsPerInchXY), toSteps(y, p.stepsPerInchXY), p.speedHz);
+    };
+
+    bool ok = addSegment(out, SEG_ROTATE, GUN_KEEP, 0, config.rotationDeg, 0, 0.0f);
+    ok = ok && addSegment(out, SEG_MOVE_Z, GUN_KEEP, 0, toSteps(p.startZ, p.stepsPerInchZ), 0, p.zSpeedHz);
+
+    int pass = 0;
+    float dir = firstDir;
+    bool gunLeftOn = false; // No run-out to switch the gun off after the last sweep
+    for (int k = 0; ok && k < plan.count; k++) {
+        float offset = centre + order * (plan.first + k * plan.step);
+        // Clip the pass line offset*n + t*d to the rectangle
+        float ox = offset * nx, oy = offset * ny;
+        float t0 = -1e9f, t1 = 1e9f;
+        if (fabsf(dx) > 1e-6f) {
+            float ta = (x0 - ox) / dx, tb = (x1 - ox) / dx;
+            t0 = fmaxf(t0, fminf(ta, tb));
+            t1 = fminf(t1, fmaxf(ta, tb));
+        }
+        if (fabsf(dy) > 1e-6f) {
+            float ta = (y0 - oy) / dy, tb = (y1 - oy) / dy;
+            t0 = fmaxf(t0, fminf(ta, tb));
+            t1 = fminf(t1, fmaxf(ta, tb));
+        }
+        if (t1 - t0 <= 0.001f) continue; // Touches a corner only
+
+        float sx = dir > 0.0f ? t0 : t1, ex = dir > 0.0f ? t1 : t0;
+        float startX = ox + sx * dx, startY = oy + sx * dy;
+        float endX = ox + ex * dx, endY = oy + ex * dy;
+        float ux = dir * dx, uy = dir * dy; // Travel direction of this sweep
+        float runIn = clampRun2(p.travelOriginX + startX, p.travelOriginY + startY, -ux, -uy, run, p.travelX, p.travelY);
+        float runOut = clampRun2(p.travelOriginX + endX, p.travelOriginY + endY, ux, uy, run, p.travelX, p.travelY);
+
+        float leadX = startX - ux * runIn, leadY = startY - uy * runIn;
+        if (pass == 0) ok = addAt(SEG_TRAVEL_XY, GUN_KEEP, pass, leadX, leadY);
+        else ok = addAt(SEG_SHIFT, gunLeftOn ? GUN_OFF : GUN_KEEP, pass, leadX, leadY);
+        if (ok && runIn > 0.0f) ok = addAt(SEG_RAMP, GUN_KEEP, pass, startX, startY);
+        ok = ok && addAt(SEG_SWEEP, GUN_ON, pass, endX, endY);
+        if (ok && runOut > 0.0f) ok = addAt(SEG_RAMP, GUN_OFF, pass, endX + ux * runOut, endY + uy * runOut);
+        gunLeftOn = runOut <= 0.0f;
+        pass++;
+        dir = -dir;
+    }
+    return ok && pass > 0;
+}
+
+bool compileSideToolpath(const ToolpathSideConfig& config, const ToolpathParams& p, Toolpath& out) {
+    out.valid = 0;
+    out.count = 0;
+
+    if (p.patternType > 0 && p.patternType < 180 && p.patternType != TOOLPATH_PATTERN_SIDEWAYS) {
+        if (!compileRasterToolpath(config, p, out)) {
+            out.count = 0;
+            return false;
+        }
+        out.valid = 1;
+        return true;
+    }
+    if (p.patternType != TOOLPATH_PATTERN_UP_DOWN && p.patternType != TOOLPATH_PATTERN_SIDEWAYS) {
+        return false;
+    }
+
+    bool upDown = (p.patternType == TOOLPATH_PATTERN_UP_DOWN);
+    PassPlan plan = upDown ? planPasses(p.gridCols, p.itemWidth + p.gapX, p.sprayWidth, p.sprayOverlap)
+                           : planPasses(p.gridRows, p.itemHeight + p.gapY, p.sprayWidth, p.sprayOverlap);
+
+    // Positions are accumulated in inches like the original pattern code so the
+    // step targets come out identical.
+    float x = p.startX;
+    float y = p.startY;
+    if (upDown) x += config.columnShiftSign * plan.first;
+    else y += config.rowShiftSign * plan.first;
+
+    // Up/Down sweeps along Y and steps over in X, Sideways the other way round
+    float& along = upDown ? y : x;
+    float& across = upDown ? x : y;
+    float sweep = upDown ? p.trayHeight : p.trayWidth;
+    float shift = (upDown ? config.columnShiftSign : config.rowShiftSign) * plan.step;
+    float travel = upDown ? p.travelY : p.travelX;
+    float origin = upDown ? p.travelOriginY : p.travelOriginX;
+    bool forward = upDown ? !config.sweepDownFirst : config.sweepRightFirst;
+    float run = (sweep > 0.001f) ? sweepRunDistance(p.speedHz, p.sweepAccel, p.stepsPerInchXY) : 0.0f;
+
+    // XY target at the current step-over position and the given sweep-axis position
+    auto addXY = [&](uint8_t type, uint8_t gun, int pass, float alongPos) {
+        float tx = upDown ? x : alongPos;
+        float ty = upDown ? alongPos : y;
+        return addSegment(out, type, gun, (uint16_t)pass,
+                          toSteps(tx, p.stepsPerInchXY), toSteps(ty, p.stepsPerInchXY), p.speedHz);
+    };
+
+    // Positioning: rotation first, then Z, then XY to the first pass (its run-in start)
+    float dir = forward ? 1.0f : -1.0f;
+    float runIn = clampRun(origin + along, -dir, run, travel);
+    bool ok = addSegment(out, SEG_ROTATE, GUN_KEEP, 0, config.rotationDeg, 0, 0.0f);
+    ok = ok && addSegment(out, SEG_MOVE_Z, GUN_KEEP, 0, toSteps(p.startZ, p.stepsPerInchZ), 0, p.zSpeedHz);
+    ok = ok && addXY(SEG_TRAVEL_XY, GUN_KEEP, 0, along - dir * runIn);
+
+    bool gunLeftOn = false; // Windowed sweeps whose run-out was clamped away still need the gun off
+    for (int i = 0; ok && i < plan.count; ++i) {
+        dir = forward ? 1.0f : -1.0f;
+        runIn = clampRun(origin + along, -dir, run, travel);
+        if (i > 0) {
+            across += shift;
+            ok = addXY(SEG_SHIFT, gunLeftOn ? GUN_OFF : GUN_KEEP, i, along - dir * runIn);
+        }
+        if (ok && sweep > 0.001f) {
+            if (runIn > 0.0f) ok = addXY(SEG_RAMP, GUN_KEEP, i, along);
+            along += forward ? sweep : -sweep;
+            ok = ok && addXY(SEG_SWEEP, GUN_ON, i, along);
+            float runOut = clampRun(origin + along, dir, run, travel);
+            if (runOut > 0.0f) ok = ok && addXY(SEG_RAMP, GUN_OFF, i, along + dir * runOut);
+            gunLeftOn = run > 0.0f && runOut <= 0.0f;
+        }
+        forward = !forward;
+    }
+
+    if (!ok) {
+        out.count = 0;
+        return false;
+    }
+    out.valid = 1;
+    return true;
+}
+
+bool compilePlaceTable(const PlaceTableParams& p, PlaceTable& out) {
+    out.valid = 0;
+    out.count = 0;
+    if (p.cols <= 0 || p.rows <= 0 || p.cols * p.rows > PLACE_TABLE_MAX) return false;
+
+    float stepX = p.itemWidth + p.gapX;
+    float stepY = p.itemHeight + p.gapY;
+    for (int row = 0; row < p.rows; ++row) {
+        for (int col = 0; col < p.cols; ++col) {
+            // Odd rows reverse direction (serpentine)
+            int effectiveCol = (row % 2 != 0) ? (p.cols - 1 - col) : col;
+            int idx = row * p.cols + col;
+            out.x[idx] = p.firstX - (effectiveCol * stepX);
+            out.y[idx] = p.firstY - (row * stepY);
+        }
+    }
+    out.cols = (uint16_t)p.cols;
+    out.rows = (uint16_t)p.rows;
+    out.count = (uint16_t)(p.cols * p.rows);
+    out.valid = 1;
+    return true;
+}
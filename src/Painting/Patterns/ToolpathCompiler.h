@@ -0,0 +1,223 @@
+#ifndef TOOLPATH_COMPILER_H
+#define TOOLPATH_COMPILER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// === Toolpath Compiler ===
+// Turns the painting settings for one side into a flat list of motion
+// segments (absolute step targets + gun state), and the PnP grid into a table
+// of place positions. Pure C++ with no Arduino dependencies so the same code
+// can run on the host (simulation/optimisation tools).
+//
+// The compiled output is what gets executed, cached and stored in recipes;
+// pattern files only provide their per-side direction config.
+
+// Meaning of stored segment coordinates. Bump when compiled output changes
+// meaning, so recipes holding older toolpaths recompile them instead.
+//   1: machine coordinates (gun and pattern offsets compiled in)
+//   2: pattern coordinates, placed by the side transform at run time
+#define TOOLPATH_FORMAT_VERSION 2
+
+#define TOOLPATH_MAX_SEGMENTS 88  // Rotate + Z + start + 4 per pass with run-in/run-out (20 passes max)
+#define PLACE_TABLE_MAX 400       // 20 x 20 grid
+
+enum ToolpathSegmentType : uint8_t {
+    SEG_ROTATE = 0, // x = target angle in degrees
+    SEG_MOVE_Z,     // x = target Z in steps
+    SEG_TRAVEL_XY,  // x/y = target XY in steps (positioning, e.g. to pattern start)
+    SEG_SWEEP,      // x/y = target XY in steps (painting pass)
+    SEG_SHIFT,      // x/y = target XY in steps (step-over between passes)
+    SEG_RAMP        // x/y = target XY in steps (sweep run-in/run-out, runs on into/out of the sweep)
+};
+
+enum ToolpathGun : uint8_t {
+    GUN_KEEP = 0,   // Leave the gun as it is
+    GUN_ON,         // Gun on before the move starts
+    GUN_OFF         // Gun off before the move starts (pressure pot stays on)
+};
+
+struct ToolpathSegment {
+    uint8_t type;     // ToolpathSegmentType
+    uint8_t gun;      // ToolpathGun
+    uint16_t pass;    // Pass (column/row) index this segment belongs to
+    int32_t x;
+    int32_t y;
+    uint32_t speedHz; // Max speed for the move (unused for SEG_ROTATE)
+};
+
+struct Toolpath {
+    uint8_t side;     // 0=Back, 1=Right, 2=Front, 3=Left
+    uint8_t valid;
+    uint16_t count;
+    ToolpathSegment segments[TOOLPATH_MAX_SEGMENTS];
+};
+
+// Per-side pattern directions (defined in the PaintPattern_<Side>.cpp files)
+struct ToolpathSideConfig {
+    const char* name;
+    int rotationDeg;       // Tray rotation for this side
+    int8_t columnShiftSign; // Up/Down: X direction of the step-over between columns (+1/-1)
+    int8_t rowShiftSign;    // Sideways: Y direction of the step-over between rows (+1/-1)
+    bool sweepDownFirst;   // Up/Down: first vertical sweep goes -Y
+    bool sweepRightFirst;  // Sideways: first horizontal sweep goes +X
+};
+
+// Job settings the compiler needs (filled from the globals by the executor)
+struct ToolpathParams {
+    int patternType;       // 0 = Up/Down, 90 = Sideways, other 1-179 = raster at that angle (see compileSideToolpath)
+    float startX;          // Pattern start (inches)
+    float startY;
+    float startZ;          // Paint height (inches)
+    float trayWidth;       // Horizontal sweep length (inches)
+    float trayHeight;      // Vertical sweep length (inches)
+    int gridCols;          // Up/Down pass count
+    int gridRows;          // Sideways pass count
+    float itemWidth;       // Step-over = item size + gap
+    float itemHeight;
+    float gapX;
+    float gapY;
+    float speedHz;         // XY speed for travel/sweeps/shifts
+    float zSpeedHz;
+    float stepsPerInchXY;
+    float stepsPerInchZ;
+    float sprayWidth;      // Fan width on the part (inches), 0 = one pass per item column/row
+    float sprayOverlap;    // Required overlap between neighbouring passes (fraction of sprayWidth)
+    float sweepAccel;      // XY accel (steps/s^2) for sweep run-in/run-out, 0 = sweeps start and stop on the items
+    float travelX;         // Axis travel (inches from home) the run-in/run-out must stay within, 0 = unlimited
+    float travelY;
+    float travelOriginX;   // Machine position of pattern (0,0) after the side transform (inches), for the travel clamp
+    float travelOriginY;
+};
+
+// === Side Transform ===
+// Compiled paths are in pattern coordinates (where the spray lands for an
+// ideal gun). At execution every XY target goes through a per-side affine
+// map in fixed point: machine = M * pattern + t, M in Q16.16, t in steps.
+// Placement settings (gun mount, pattern offset) only change the transform,
+// so they take effect without recompiling.
+
+#define TOOLPATH_Q16_ONE 65536
+
+struct ToolpathTransform {
+    int32_t m[4];          // Row-major 2x2, Q16.16
+    int32_t tx;            // Translation (steps)
+    int32_t ty;
+};
+
+/**
+ * @brief Identity transform.
+ */
+void toolpathTransformIdentity(ToolpathTransform& t);
+
+/**
+ * @brief Transform for one side: tray rotation x gun offset x pattern offset.
+ * The pattern offset is measured on the tray as seen from the Back (0 deg) and
+ * turns with the tray; the gun offset (nozzle from the tool point, machine axes)
+ * is taken off so the nozzle lands where the pattern says.
+ * @param rotationDeg Tray rotation for the side.
+ * @param gunOffsetX Nozzle offset from the tool point (inches).
+ * @param patternOffsetX Pattern offset on the tray (inches).
+ */
+void buildSideTransform(ToolpathTransform& t, int rotationDeg, float gunOffsetX, float gunOffsetY,
+                        float patternOffsetX, float patternOffsetY, float stepsPerInchXY);
+
+/**
+ * @brief Map a pattern point (steps) to machine steps. Identity M is exact.
+ */
+static inline void toolpathTransformPoint(const ToolpathTransform& t, int32_t x, int32_t y, int32_t& outX, int32_t& outY) {
+    outX = (int32_t)(((int64_t)t.m[0] * x + (int64_t)t.m[1] * y + (TOOLPATH_Q16_ONE / 2)) >> 16) + t.tx;
+    outY = (int32_t)(((int64_t)t.m[2] * x + (int64_t)t.m[3] * y + (TOOLPATH_Q16_ONE / 2)) >> 16) + t.ty;
+}
+
+/**
+ * @brief First XY target that the transform puts outside the axis travel.
+ * The compiler only keeps run-in/run-out within travel; start, sweeps and
+ * step-overs go wherever the settings put them, so check before executing.
+ * @param travelX Axis travel (inches from home), target must be in [0, travel]; 0 = unlimited.
+ * @return Segment index, or -1 if every XY target is within travel.
+ */
+int toolpathTravelFault(const Toolpath& path, const ToolpathTransform& xf, float travelX, float travelY,
+                        float stepsPerInchXY);
+
+/**
+ * @brief Passes across the step-over direction, as offsets from the pattern start.
+ * Without a spray width this is one pass per item (offset k * pitch). With one,
+ * the item band (itemPasses * pitch, centred on the item passes) is covered with
+ * the fewest passes whose fans overlap by at least sprayOverlap, spread evenly.
+ */
+struct PassPlan {
+    int count;
+    float first;           // Offset of the first pass from the start (inches, along the shift sign)
+    float step;            // Distance between passes
+};
+
+PassPlan planPasses(int itemPasses, float pitch, float sprayWidth, float sprayOverlap);
+
+/**
+ * @brief Distance (inches) an axis needs to reach speedHz from rest, v^2 / 2a.
+ * @return 0 if accel or speed is not positive.
+ */
+float sweepRunDistance(float speedHz, float accel, float stepsPerInch);
+
+/**
+ * @brief Last segment of the continuous move that starts at segments[first].
+ * Consecutive SEG_RAMP/SEG_SWEEP segments heading the same way (within step
+ * rounding) run as one move (a sweep with its run-in and run-out), so the
+ * items are painted at cruise speed; each segment's gun state applies once the
+ * axes pass its start.
+ * @param fromX Position before segments[first] (steps).
+ * @param fromY
+ * @return first if the segment is not part of such a run.
+ */
+int toolpathMoveEnd(const Toolpath& path, int first, int32_t fromX, int32_t fromY);
+
+/**
+ * @brief Compile the painting toolpath for one side.
+ * Rotate, move Z, travel to the first pass, then serpentine sweeps with step-overs
+ * (pass layout from planPasses()). With sweepAccel set, every sweep gets a
+ * run-in and run-out of sweepRunDistance() (clamped to the travel) and the gun is
+ * only on across the items.
+ *
+ * Any other patternType in 1-179 is a raster at that angle: sweeps run at
+ * patternType degrees from the Y axis towards +X (so 0 would be Up/Down and 90
+ * Sideways) across the item grid (gridCols x gridRows from the start, stepping
+ * the side's shift signs), passes spaced by planPasses() over the grid's width
+ * across the sweeps, or by the smaller item pitch without a spray width. Sweeps
+ * and step-overs are coordinated XY moves; the gun is off during step-overs
+ * since they can cut a corner of the grid.
+ * @param config Per-side directions.
+ * @param params Job settings.
+ * @param out Receives the segments (out.side is left to the caller).
+ * @return false for an unknown pattern type or if the path does not fit.
+ */
+bool compileSideToolpath(const ToolpathSideConfig& config, const ToolpathParams& params, Toolpath& out);
+
+struct PlaceTableParams {
+    float firstX;          // Absolute position of the first item (inches)
+    float firstY;
+    int cols;
+    int rows;
+    float itemWidth;
+    float itemHeight;
+    float gapX;
+    float gapY;
+};
+
+struct PlaceTable {
+    uint8_t valid;
+    uint16_t cols;
+    uint16_t rows;
+    uint16_t count;
+    float x[PLACE_TABLE_MAX]; // Indexed by row * cols + col, col in visit order (serpentine)
+    float y[PLACE_TABLE_MAX];
+};
+
+/**
+ * @brief Compile the serpentine PnP place positions.
+ * Even rows run -X from firstX, odd rows come back; rows step -Y.
+ * @return false if the grid exceeds PLACE_TABLE_MAX.
+ */
+bool compilePlaceTable(const PlaceTableParams& params, PlaceTable& out);
+
+#endif // TOOLPATH_COMPILER_H
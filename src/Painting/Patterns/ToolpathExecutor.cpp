@@ -0,0 +1,583 @@
+#include "ToolpathExecutor.h"
+#include "PatternActions.h"
+#include "PaintPatterns_SideSpecific.h" // For the per-side configs
+#include "../../Main/SharedGlobals.h"
+#include "../../Main/GeneralSettings_PinDef.h" // For STEPS_PER_INCH_XY / STEPS_PER_INCH_Z
+#include "../PaintGunControl.h"
+#include "../Painting.h" // For paintPatternOffsetX_inch / paintPatternOffsetY_inch
+#include "../PaintCheckpoint.h"
+#include "../../Settings/SettingsSchema.h" // For settingsScanChanges()
+#include "../../Settings/SettingsStore.h" // For settingsCrc32()
+#include "../../Logging/Log.h"
+#include "../../Metrics/JobMetrics.h"
+#include "../../Motion/MotionWatchdog.h"
+
+extern float patternXSpeed; // Defined in main.cpp
+extern float patternXAccel;
+extern float paintGunOffsetX_inch;
+extern float paintGunOffsetY_inch;
+
+// === Toolpath Cache ===
+static Toolpath sideToolpaths[4];
+static uint32_t sideToolpathVersion[4] = {0, 0, 0, 0}; // Settings version compiled for (0 = invalid)
+static float sideToolpathSpeed[4] = {0, 0, 0, 0};     // Speed compiled for
+static ToolpathTransform sideTransforms[4];
+static uint32_t sideTransformVersion[4] = {0, 0, 0, 0}; // Settings version built for (0 = invalid)
+
+static const char* SIDE_NAMES[4] = {"BACK", "RIGHT", "FRONT", "LEFT"};
+static char toolpathError[160] = ""; // Why getSideToolpath() last returned nullptr
+
+const ToolpathSideConfig* getSideConfig(int sideIndex) {
+    switch (sideIndex) {
+        case 0: return &SIDE_CONFIG_BACK;
+        case 1: return &SIDE_CONFIG_RIGHT;
+        case 2: return &SIDE_CONFIG_FRONT;
+        case 3: return &SIDE_CONFIG_LEFT;
+        default: return nullptr;
+    }
+}
+
+const ToolpathTransform& getSideTransform(int sideIndex) {
+    int side = sideIndex & 3;
+    uint32_t version = settingsScanChanges();
+    ToolpathTransform& t = sideTransforms[side];
+    if (sideTransformVersion[side] != version) {
+        buildSideTransform(t, getSideConfig(side)->rotationDeg, paintGunOffsetX_inch, paintGunOffsetY_inch,
+                           paintPatternOffsetX_inch, paintPatternOffsetY_inch, STEPS_PER_INCH_XY);
+        sideTransformVersion[side] = version;
+        LOGD("%s transform: offset (%ld, %ld) steps (settings v%lu)", SIDE_NAMES[side],
+             (long)t.tx, (long)t.ty, (unsigned long)version);
+    }
+    return t;
+}
+
+// Version the compiled paths are keyed on. Placement settings only move the
+// transform, except with sweep overtravel where the run-in/run-out clamp
+// depends on where the pattern lands.
+static uint32_t toolpathInputsVersion() {
+    uint32_t version = settingsScanChanges();
+    return paintSweepOvertravel ? version : settingsVersionExcept(SETTING_TRANSFORM);
+}
+
+// Fill compiler inputs from the current global settings
+static void buildToolpathParams(int sideIndex, float speed, ToolpathParams& p) {
+    p.patternType = paintPatternType[sideIndex];
+    p.startX = paintStartX[sideIndex];
+    p.startY = paintStartY[sideIndex];
+    p.startZ = paintZHeight_inch[sideIndex];
+    p.trayWidth = trayWidth_inch;
+    p.trayHeight = trayHeight_inch;
+    p.gridCols = placeGridCols;
+    p.gridRows = placeGridRows;
+    p.itemWidth = pnpItemWidth_inch;
+    p.itemHeight = pnpItemHeight_inch;
+    p.gapX = placeGapX_inch;
+    p.gapY = placeGapY_inch;
+    p.speedHz = speed;
+    p.zSpeedHz = patternZSpeed;
+    p.stepsPerInchXY = STEPS_PER_INCH_XY;
+    p.stepsPerInchZ = STEPS_PER_INCH_Z;
+    p.sprayWidth = paintSprayWidth_inch[sideIndex];
+    p.sprayOverlap = paintSprayOverlap_pct[sideIndex] / 100.0f;
+    p.sweepAccel = paintSweepOvertravel ? patternXAccel : 0.0f; // Same accel executeSideToolpath() is given
+    p.travelX = X_MAX_TRAVEL_POS_INCH;
+    p.travelY = Y_MAX_TRAVEL_POS_INCH;
+    const ToolpathTransform& t = getSideTransform(sideIndex);
+    p.travelOriginX = t.tx / STEPS_PER_INCH_XY;
+    p.travelOriginY = t.ty / STEPS_PER_INCH_XY;
+}
+
+const Toolpath* getSideToolpath(int sideIndex, float speed) {
+    const ToolpathSideConfig* config = getSideConfig(sideIndex);
+    if (!config) {
+        snprintf(toolpathError, sizeof(toolpathError), "Invalid side %d.", sideIndex);
+        return nullptr;
+    }
+
+    uint32_t version = toolpathInputsVersion();
+    Toolpath& path = sideToolpaths[sideIndex];
+    if (sideToolpathVersion[sideIndex] != version || sideToolpathSpeed[sideIndex] != speed) {
+        ToolpathParams params;
+        buildToolpathParams(sideIndex, speed, params);
+        unsigned long startUs = micros();
+        if (!compileSideToolpath(*config, params, path)) {
+            sideToolpathVersion[sideIndex] = 0;
+            snprintf(toolpathError, sizeof(toolpathError), "%s toolpath does not compile (pattern type %d).",
+                     SIDE_NAMES[sideIndex], params.patternType);
+            LOGE("%s", toolpathError);
+            return nullptr;
+        }
+        path.side = (uint8_t)sideIndex;
+        sideToolpathVersion[sideIndex] = version;
+        sideToolpathSpeed[sideIndex] = speed;
+        LOGD("Compiled %s toolpath: %d segments in %lu us (settings v%lu)",
+                      SIDE_NAMES[sideIndex], path.count, micros() - startUs, (unsigned long)version);
+    }
+
+    // Checked on cache hits too: placement moves the path without recompiling it
+    const ToolpathTransform& xf = getSideTransform(sideIndex);
+    int bad = toolpathTravelFault(path, xf, X_MAX_TRAVEL_POS_INCH, Y_MAX_TRAVEL_POS_INCH, STEPS_PER_INCH_XY);
+    if (bad >= 0) {
+        int32_t x, y;
+        toolpathTransformPoint(xf, path.segments[bad].x, path.segments[bad].y, x, y);
+        snprintf(toolpathError, sizeof(toolpathError),
+                 "%s toolpath leaves the travel: segment %d goes to (%.2f, %.2f), limits 0-%.0f x 0-%.0f in. Adjust the side's start or the offsets.",
+                 SIDE_NAMES[sideIndex], bad, (float)x / STEPS_PER_INCH_XY, (float)y / STEPS_PER_INCH_XY,
+                 (float)X_MAX_TRAVEL_POS_INCH, (float)Y_MAX_TRAVEL_POS_INCH);
+        LOGE("%s", toolpathError);
+        return nullptr;
+    }
+    return &path;
+}
+
+const char* sideToolpathError() {
+    return toolpathError;
+}
+
+void installSideToolpath(int sideIndex, const Toolpath& path) {
+    if (sideIndex < 0 || sideIndex > 3) return;
+    sideToolpaths[sideIndex] = path;
+    sideToolpaths[sideIndex].side = (uint8_t)sideIndex;
+    sideToolpathVersion[sideIndex] = path.valid ? toolpathInputsVersion() : 0;
+    sideToolpathSpeed[sideIndex] = paintSpeed[sideIndex];
+}
+
+void invalidateToolpathCache() {
+    for (int i = 0; i < 4; i++) sideToolpathVersion[i] = 0;
+}
+
+// Gun state is applied before the segment's move starts; gunOn tracks it for job time attribution
+static void applySegmentGun(const ToolpathSegment& seg, bool& gunOn) {
+    if (seg.gun == GUN_ON) activatePaintGun();
+    else if (seg.gun == GUN_OFF) deactivatePaintGun(false); // Keep pressure pot on
+    if (seg.gun != GUN_KEEP) gunOn = (seg.gun == GUN_ON);
+
+    jobSetCategory(seg.type == SEG_ROTATE ? JOB_CAT_ROTATE :
+                   (seg.type == SEG_MOVE_Z || seg.type == SEG_TRAVEL_XY) ? JOB_CAT_REPOSITION :
+                   gunOn ? JOB_CAT_SPRAY :
+                   (seg.type == SEG_SWEEP || seg.type == SEG_RAMP) ? JOB_CAT_SWEEP_DRY : JOB_CAT_REPOSITION);
+}
+
+// === Feed Override ===
+// paintFeedOverride_pct scales every XY paint move as it starts, and a move in
+// flight is re-issued to the same target when the override changes, so the
+// current pass speeds up or slows down without stopping. Gun switching follows
+// position, so the spray windows stay on the items at any feed. Run-ins are
+// compiled for 100%: above that a sweep may still be accelerating at the first item.
+
+struct XYMove {
+    int32_t x, y;    // Machine target
+    float speedHz;   // Speed at 100%
+    float accel;
+    bool linear;     // Straight line (startXYLinearSteps_Paint) or independent axes
+    int overridePct; // Override the move was last issued with
+};
+
+static void startXYMove(XYMove& m) {
+    m.overridePct = paintFeedOverride_pct;
+    float speed = m.speedHz * m.overridePct / 100.0f;
+    if (m.linear) startXYLinearSteps_Paint(m.x, m.y, speed, m.accel);
+    else startXYPositionSteps_Paint(m.x, m.y, speed, m.accel);
+}
+
+// Re-issue a running move at the new override (the steppers ramp to the new speed)
+static void trackFeedOverride(XYMove& m) {
+    if (m.overridePct == paintFeedOverride_pct) return;
+    LOGD("Feed override %d%% -> %d%% mid-move", m.overridePct, (int)paintFeedOverride_pct);
+    startXYMove(m);
+}
+
+// === Pause / Resume ===
+// PAUSE is honoured between segments and inside XY moves. Mid-move the gun is
+// cut at once and the axes decelerate to a stop; the point where the gun went
+// off is the paint progress the checkpoint records, so a resume backs up along
+// the move and passes that point at speed again.
+
+#define PAUSE_POLL_MS 20 // WebSocket service interval while an XY move runs
+
+// Lets PAUSE/STOP arrive during long moves without stalling gun switching every pass
+static void serviceWebSocket() {
+    static unsigned long lastMs = 0;
+    if (millis() - lastMs < PAUSE_POLL_MS) return;
+    lastMs = millis();
+    webSocket.loop();
+}
+
+uint32_t toolpathCheckpointCrc(const Toolpath& path, const ToolpathTransform& xf) {
+    uint32_t crc = settingsCrc32(0, path.segments, path.count * sizeof(ToolpathSegment));
+    return settingsCrc32(crc, &xf, sizeof(xf));
+}
+
+// Pattern XY position before segment index (end of the last XY segment), (0,0) if none
+static bool toolpathXYBefore(const Toolpath& path, int index, int32_t& x, int32_t& y) {
+    for (int k = index - 1; k >= 0; k--) {
+        const ToolpathSegment& seg = path.segments[k];
+        if (seg.type == SEG_ROTATE || seg.type == SEG_MOVE_Z) continue;
+        x = seg.x;
+        y = seg.y;
+        return true;
+    }
+    x = 0;
+    y = 0;
+    return false;
+}
+
+// Gun state once segment index has been applied
+static bool toolpathGunAt(const Toolpath& path, int index) {
+    for (int k = index; k >= 0; k--) {
+        if (path.segments[k].gun != GUN_KEEP) return path.segments[k].gun == GUN_ON;
+    }
+    return false;
+}
+
+// Cut the gun and pot, let XY decelerate to a stop and store the checkpoint.
+// (x, y) is the paint progress point in machine steps.
+static void pauseToolpath(const Toolpath& path, const ToolpathTransform& xf, int segment,
+                          int32_t x, int32_t y, bool gunWasOn) {
+    bool potWasOn = pressurePotIsOn();
+    deactivatePaintGun(true); // Depressurised for a refill or a clog
+    motionWatchdogDisarmAll(); // Stopping short on purpose
+    stepper_x->stopMove();
+    stepper_y_left->stopMove();
+    stepper_y_right->stopMove();
+    while (isXYPaintMoveRunning()) yield();
+
+    PaintCheckpoint cp = {};
+    cp.side = path.side;
+    cp.sequence = isPaintSequence ? 1 : 0;
+    cp.segment = (uint16_t)segment;
+    cp.gunOn = gunWasOn ? 1 : 0;
+    cp.potOn = potWasOn ? 1 : 0;
+    cp.x = x;
+    cp.y = y;
+    cp.z = stepper_z->getCurrentPosition();
+    cp.pathCrc = toolpathCheckpointCrc(path, xf);
+    paintCheckpointSave(cp);
+
+    pauseRequested = false;
+    isPaintPaused = true;
+    LOGI("Paused %s at segment %d/%d, (%.3f, %.3f) gun %s, pot %s", SIDE_NAMES[path.side & 3], segment, path.count,
+         (float)x / STEPS_PER_INCH_XY, (float)y / STEPS_PER_INCH_XY, gunWasOn ? "on" : "off", potWasOn ? "on" : "off");
+}
+
+// Starts a travel / step-over move of segment and waits for it, pausing it on request.
+// keep: a resume approach, pausing keeps its progress point.
+// Returns true if stopped or paused.
+static bool runXYMove(const Toolpath& path, const ToolpathTransform& xf, int segment, XYMove& move,
+                      const PaintCheckpoint* keep = nullptr) {
+    startXYMove(move);
+    while (isXYPaintMoveRunning()) {
+        if (stopRequested) return true;
+        if (pauseRequested) {
+            if (keep) pauseToolpath(path, xf, segment, keep->x, keep->y, keep->gunOn);
+            else pauseToolpath(path, xf, segment, stepper_x->getCurrentPosition(),
+                               stepper_y_left->getCurrentPosition(), paintGunIsOn());
+            return true;
+        }
+        if (motionWatchdogPoll()) return true; // Stalled: axes stopped, loop() reports it
+        serviceWebSocket();
+        trackFeedOverride(move);
+        yield();
+    }
+    return stopRequested;
+}
+
+// Runs segments first..last (see toolpathMoveEnd) as one move from machine (fromX, fromY)
+// and applies each later segment's gun state as the axes pass its start.
+// A resumed move starts behind the paused point (armX, armY) and only sets armGun
+// (0/1) once it gets there; armGun < 0 means segment first's gun is already applied.
+// Returns true if stopped or paused.
+static bool runContinuousMove(const Toolpath& path, int first, int last, const ToolpathTransform& xf,
+                              int32_t fromX, int32_t fromY, int32_t armX, int32_t armY, int armGun,
+                              float accel, bool& gunOn) {
+    int32_t endX, endY;
+    toolpathTransformPoint(xf, path.segments[last].x, path.segments[last].y, endX, endY);
+    int64_t dx = (int64_t)endX - fromX, dy = (int64_t)endY - fromY;
+    auto progress = [&](int64_t x, int64_t y) { return (x - fromX) * dx + (y - fromY) * dy; };
+    auto boundary = [&](int k) {
+        int32_t bx, by;
+        toolpathTransformPoint(xf, path.segments[k].x, path.segments[k].y, bx, by);
+        return progress(bx, by);
+    };
+
+    XYMove move = {endX, endY, (float)path.segments[last].speedHz, accel, true, 0};
+    startXYMove(move);
+    bool armed = armGun < 0;
+    int next = first + 1;
+    for (;;) {
+        if (stopRequested) return true; // Never switch the gun back on after a STOP
+        bool running = isXYPaintMoveRunning();
+        int32_t x = stepper_x->getCurrentPosition(), y = stepper_y_left->getCurrentPosition();
+        int64_t now = progress(x, y);
+        if (!armed && (!running || now >= progress(armX, armY))) {
+            if (armGun) activatePaintGun();
+            gunOn = armGun != 0;
+            jobSetCategory(gunOn ? JOB_CAT_SPRAY : JOB_CAT_SWEEP_DRY);
+            armed = true;
+        }
+        while (armed && next <= last && (!running || now >= boundary(next - 1))) {
+            applySegmentGun(path.segments[next++], gunOn);
+        }
+        if (!running) break;
+        if (pauseRequested) {
+            // Not yet back at the paused point: keep the old progress point
+            if (armed) pauseToolpath(path, xf, next - 1, x, y, paintGunIsOn());
+            else pauseToolpath(path, xf, first, armX, armY, armGun != 0);
+            return true;
+        }
+        if (motionWatchdogPoll()) return true; // Stalled: axes stopped, loop() reports it
+        serviceWebSocket();
+        trackFeedOverride(move);
+        yield();
+    }
+    return false;
+}
+
+// Puts the machine back where the checkpoint left the path and finishes the
+// interrupted segment. next is the first segment still to execute.
+// Returns true if stopped, paused again or failed.
+static bool resumeToolpath(const Toolpath& path, const ToolpathTransform& xf, float accel,
+                           const PaintCheckpoint& cp, int32_t& prevX, int32_t& prevY, bool& gunOn, int& next) {
+    int j = cp.segment;
+    char details[100];
+    sprintf(details, "Segment %d/%d of %s", j, path.count, SIDE_NAMES[path.side & 3]);
+    printAndBroadcastAction("Resume", details);
+
+    // Rotation and Z height the path had set up before segment j
+    bool haveRot = false, haveZ = false;
+    int rotDeg = 0;
+    int32_t zSteps = 0;
+    for (int k = 0; k < j; k++) {
+        const ToolpathSegment& seg = path.segments[k];
+        if (seg.type == SEG_ROTATE) { haveRot = true; rotDeg = seg.x; }
+        else if (seg.type == SEG_MOVE_Z) { haveZ = true; zSteps = seg.x; }
+    }
+    if (haveRot && stepper_rot && lroundf(stepper_rot->getCurrentPosition() / STEPS_PER_DEGREE) != rotDeg) {
+        moveZToPositionSteps(0, patternZSpeed, patternZAccel); // Rotate clear of the part (after a reboot)
+        if (actionRotateTo(rotDeg)) return true;
+    }
+    if (haveZ && stepper_z->getCurrentPosition() != zSteps) {
+        moveZToPositionSteps(zSteps, patternZSpeed, patternZAccel);
+    }
+    if (stopRequested) return true;
+    if (cp.potOn) activatePressurePot(); // Repressurises during the approach
+
+    bool hadXY = toolpathXYBefore(path, j, prevX, prevY);
+    const ToolpathSegment& seg = path.segments[j];
+    if (seg.type != SEG_SWEEP && seg.type != SEG_RAMP) {
+        // Rotation, Z, travel and step-overs simply run again from the segment start
+        if (hadXY) {
+            int32_t x, y;
+            toolpathTransformPoint(xf, prevX, prevY, x, y);
+            XYMove move = {x, y, patternXSpeed, accel, false, 0};
+            if (runXYMove(path, xf, j, move)) return true;
+        }
+        next = j;
+        return false;
+    }
+
+    // Sweep / ramp chain: approach along the move so the paused point is passed at speed.
+    // The back-up stays on the chain (clamped to where it started).
+    int last = toolpathMoveEnd(path, j, prevX, prevY);
+    int c = j;
+    while (c > 0) {
+        int32_t bx, by;
+        toolpathXYBefore(path, c - 1, bx, by);
+        const ToolpathSegment& before = path.segments[c - 1];
+        if ((before.type != SEG_SWEEP && before.type != SEG_RAMP) || toolpathMoveEnd(path, c - 1, bx, by) < j) break;
+        c--;
+    }
+    int32_t sx, sy, ex, ey, chainX, chainY;
+    toolpathXYBefore(path, c, chainX, chainY);
+    toolpathTransformPoint(xf, chainX, chainY, sx, sy);
+    toolpathTransformPoint(xf, path.segments[last].x, path.segments[last].y, ex, ey);
+    float ux = (float)(ex - sx), uy = (float)(ey - sy);
+    float length = sqrtf(ux * ux + uy * uy);
+    bool gunAtPoint = toolpathGunAt(path, j);
+    float back = 0.0f;
+    if (length > 0.0f && gunAtPoint) {
+        ux /= length;
+        uy /= length;
+        float along = (cp.x - sx) * ux + (cp.y - sy) * uy;
+        float v = seg.speedHz * paintFeedOverride_pct / 100.0f;
+        back = (accel > 0.0f) ? v * v / (2.0f * accel) : 0.0f; // v^2/2a at the current feed
+        back = fmaxf(0.0f, fminf(back, along));
+    }
+    int32_t fromX = cp.x - lroundf(ux * back), fromY = cp.y - lroundf(uy * back);
+    sprintf(details, "Approach (%.3f, %.3f), gun %s at (%.3f, %.3f)",
+            (float)fromX / STEPS_PER_INCH_XY, (float)fromY / STEPS_PER_INCH_XY, gunAtPoint ? "on" : "off",
+            (float)cp.x / STEPS_PER_INCH_XY, (float)cp.y / STEPS_PER_INCH_XY);
+    printAndBroadcastAction("Resume", details);
+    deactivatePaintGun(false);
+    gunOn = false;
+    XYMove approach = {fromX, fromY, patternXSpeed, accel, false, 0};
+    if (runXYMove(path, xf, j, approach, &cp)) return true; // A pause here keeps the old progress point
+    if (runContinuousMove(path, j, last, xf, fromX, fromY, cp.x, cp.y, gunAtPoint ? 1 : 0, accel, gunOn)) return true;
+    prevX = path.segments[last].x;
+    prevY = path.segments[last].y;
+    next = last + 1;
+    return false;
+}
+
+bool executeToolpath(const Toolpath& path, const ToolpathTransform& xf, float accel, const PaintCheckpoint* resume) {
+    char details[100];
+    int32_t prevX = 0; // Pattern coordinates; a sweep that keeps X is vertical
+    int32_t prevY = 0;
+    int32_t x, y;      // Machine target
+    bool gunOn = false; // Only for job time attribution
+    int i = 0;
+    if (resume && resumeToolpath(path, xf, accel, *resume, prevX, prevY, gunOn, i)) return true;
+    for (; i < path.count; i++) {
+        if (stopRequested || motionWatchdogFaulted()) return true;
+        if (pauseRequested) {
+            pauseToolpath(path, xf, i, stepper_x->getCurrentPosition(), stepper_y_left->getCurrentPosition(), paintGunIsOn());
+            return true;
+        }
+        const ToolpathSegment& seg = path.segments[i];
+        applySegmentGun(seg, gunOn);
+
+        switch (seg.type) {
+            case SEG_ROTATE:
+                if (actionRotateTo(seg.x)) return true;
+                break;
+            case SEG_MOVE_Z:
+                sprintf(details, "Moving to Z: %.3f inches", (float)seg.x / STEPS_PER_INCH_Z);
+                printAndBroadcastAction("MoveToZ", details);
+                moveZToPositionSteps(seg.x, seg.speedHz, patternZAccel);
+                break;
+            case SEG_TRAVEL_XY:
+            case SEG_SHIFT: {
+                const char* name = (seg.type == SEG_TRAVEL_XY) ? "MoveToXY" : "ShiftXY";
+                toolpathTransformPoint(xf, seg.x, seg.y, x, y);
+                sprintf(details, "Pass %d: to (%.3f, %.3f)", seg.pass,
+                        (float)x / STEPS_PER_INCH_XY, (float)y / STEPS_PER_INCH_XY);
+                printAndBroadcastAction(name, details);
+                // Step-overs are straight lines: angled rasters step over diagonally
+                XYMove move = {x, y, (float)seg.speedHz, accel, seg.type == SEG_SHIFT, 0};
+                if (runXYMove(path, xf, i, move)) return true;
+                prevX = seg.x;
+                prevY = seg.y;
+                break;
+            }
+            case SEG_SWEEP:
+            case SEG_RAMP: {
+                // A sweep with its run-in/run-out is one move so the items see cruise speed
+                int last = toolpathMoveEnd(path, i, prevX, prevY);
+                const ToolpathSegment& end = path.segments[last];
+                toolpathTransformPoint(xf, end.x, end.y, x, y);
+                sprintf(details, "Pass %d: to (%.3f, %.3f)", seg.pass,
+                        (float)x / STEPS_PER_INCH_XY, (float)y / STEPS_PER_INCH_XY);
+                printAndBroadcastAction(end.x == prevX ? "SweepVertical" : end.y == prevY ? "SweepHorizontal" : "SweepAngled", details);
+                toolpathTransformPoint(xf, prevX, prevY, x, y);
+                if (runContinuousMove(path, i, last, xf, x, y, x, y, -1, accel, gunOn)) return true;
+                prevX = end.x;
+                prevY = end.y;
+                i = last;
+                break;
+            }
+            default:
+                LOGE("Unknown toolpath segment type %d at %d", seg.type, i);
+                return true;
+        }
+    }
+    jobSetCategory(JOB_CAT_OTHER);
+    return stopRequested;
+}
+
+bool executeSideToolpath(int sideIndex, float speed, float accel) {
+    LOGI("[Pattern Sequence] Executing %s Side Pattern (Side %d) - Type: %s (%d deg)",
+                  SIDE_NAMES[sideIndex & 3], sideIndex,
+                  (paintPatternType[sideIndex] == PATTERN_UP_DOWN) ? "Up_Down" :
+                  (paintPatternType[sideIndex] == PATTERN_SIDEWAYS ? "Sideways" : "Raster"), paintPatternType[sideIndex]);
+
+    const Toolpath* path = getSideToolpath(sideIndex, speed);
+    if (!path) { // Nothing has moved yet
+        char msg[220];
+        snprintf(msg, sizeof(msg), "{\"status\":\"Error\", \"message\":\"%s\"}", sideToolpathError());
+        webSocket.broadcastTXT(msg);
+        return true; // Indicate an error/stop condition
+    }
+
+    const ToolpathTransform& xf = getSideTransform(sideIndex);
+    PaintCheckpoint checkpoint;
+    bool resuming = paintCheckpointGet(checkpoint) && checkpoint.side == sideIndex;
+    if (resuming && checkpoint.pathCrc != toolpathCheckpointCrc(*path, xf)) {
+        LOGE("[Pattern Sequence] %s toolpath changed since the pause; not resuming.", SIDE_NAMES[sideIndex]);
+        webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Settings changed since the pause; cannot resume. Restore them or STOP to discard the checkpoint.\"}");
+        return true;
+    }
+    if (resuming) {
+        LOGI("[Pattern Sequence] Resuming %s Side Pattern at segment %u.", SIDE_NAMES[sideIndex], checkpoint.segment);
+    }
+
+    if (executeToolpath(*path, xf, accel, resuming ? &checkpoint : nullptr)) {
+        LOGI("[Pattern Sequence] %s Side Pattern %s.", SIDE_NAMES[sideIndex], isPaintPaused ? "paused" : "stopped");
+        return true;
+    }
+    paintCheckpointClear(); // Side done; nothing left to resume
+    LOGI("[Pattern Sequence] %s Side Pattern COMPLETED (%d segments).", SIDE_NAMES[sideIndex], path->count);
+    return false; // Completed successfully
+}
+
+int toolpathWriteJson(const Toolpath& path, char* buf, size_t len) {
+    int pos = snprintf(buf, len, "{\"status\":\"Toolpath\",\"side\":%d,\"stepsPerInchXY\":%.1f,\"stepsPerInchZ\":%.1f,\"segments\":[",
+                       path.side, (float)STEPS_PER_INCH_XY, (float)STEPS_PER_INCH_Z);
+    if (pos < 0 || (size_t)pos >= len) return -1;
+    for (int i = 0; i < path.count; i++) {
+        const ToolpathSegment& seg = path.segments[i];
+        int n = snprintf(buf + pos, len - pos, "%s[%u,%u,%u,%ld,%ld,%lu]", i ? "," : "",
+                         seg.type, seg.gun, seg.pass, (long)seg.x, (long)seg.y, (unsigned long)seg.speedHz);
+        if (n < 0 || (size_t)n >= len - pos) return -1;
+        pos += n;
+    }
+    int n = snprintf(buf + pos, len - pos, "]}");
+    if (n < 0 || (size_t)n >= len - pos) return -1;
+    return pos + n;
+}
+
+int rasterPlanWriteJson(int sideIndex, char* buf, size_t len) {
+    static Toolpath scratch; // Too big for the WebSocket task stack
+    const ToolpathSideConfig* config = getSideConfig(sideIndex);
+    if (!config) return -1;
+    ToolpathParams params;
+    buildToolpathParams(sideIndex, paintSpeed[sideIndex], params);
+
+    int pos = snprintf(buf, len, "{\"status\":\"RasterPlan\",\"side\":%d,\"current\":%d,\"angles\":[",
+                       sideIndex, paintPatternType[sideIndex]);
+    if (pos < 0 || (size_t)pos >= len) return -1;
+    int best = -1, bestPasses = 0;
+    float bestLength = 0.0f;
+    bool first = true;
+    for (int angle = 0; angle < 180; angle += RASTER_PLAN_STEP_DEG) {
+        params.patternType = angle;
+        if (!compileSideToolpath(*config, params, scratch)) continue;
+        // Passes and XY path length (inches) from the pattern start on
+        int passes = 0;
+        float sweepIn = 0.0f, totalIn = 0.0f;
+        int32_t px = 0, py = 0;
+        bool started = false;
+        for (int i = 0; i < scratch.count; i++) {
+            const ToolpathSegment& seg = scratch.segments[i];
+            if (seg.type == SEG_ROTATE || seg.type == SEG_MOVE_Z) continue;
+            float d = hypotf((float)(seg.x - px), (float)(seg.y - py)) / STEPS_PER_INCH_XY;
+            if (started) totalIn += d;
+            if (seg.type == SEG_SWEEP) { passes++; sweepIn += d; }
+            px = seg.x;
+            py = seg.y;
+            started = true;
+        }
+        if (best < 0 || passes < bestPasses || (passes == bestPasses && totalIn < bestLength)) {
+            best = angle;
+            bestPasses = passes;
+            bestLength = totalIn;
+        }
+        int n = snprintf(buf + pos, len - pos, "%s[%d,%d,%.1f,%.1f]", first ? "" : ",",
+                         angle, passes, sweepIn, totalIn);
+        if (n < 0 || (size_t)n >= len - pos) return -1;
+        pos += n;
+        first = false;
+    }
+    int n = snprintf(buf + pos, len - pos, "],\"best\":%d}", best);
+    if (n < 0 || (size_t)n >= len - pos) return -1;
+    return pos + n;
+}
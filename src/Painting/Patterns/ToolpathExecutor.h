@@ -0,0 +1,98 @@
+#ifndef TOOLPATH_EXECUTOR_H
+#define TOOLPATH_EXECUTOR_H
+
+#include <Arduino.h>
+#include "ToolpathCompiler.h"
+#include "../PaintCheckpoint.h"
+
+// === Toolpath Executor / Cache ===
+// Compiles side toolpaths from the current settings on demand and caches them
+// per side, keyed on the settings version (see SettingsSchema.h). Recipes can
+// install precompiled toolpaths directly so nothing is recompiled after a load.
+// Paths are cached in pattern coordinates; the per-side transform (gun and
+// pattern offsets) is applied to each XY target as it executes.
+
+/**
+ * @brief Direction config for a side (0=Back, 1=Right, 2=Front, 3=Left).
+ * @return nullptr for an invalid side.
+ */
+const ToolpathSideConfig* getSideConfig(int sideIndex);
+
+/**
+ * @brief Pattern-to-machine transform for a side, rebuilt when settings changed.
+ */
+const ToolpathTransform& getSideTransform(int sideIndex);
+
+/**
+ * @brief Get the toolpath for a side, compiling it if settings changed.
+ * Every XY target, after the side transform, must be within the axis travel.
+ * @param sideIndex Side (0-3).
+ * @param speed XY speed (Hz) the path is compiled for.
+ * @return nullptr if the side's settings cannot be compiled or the path leaves the travel.
+ */
+const Toolpath* getSideToolpath(int sideIndex, float speed);
+
+/**
+ * @brief Why the last getSideToolpath() returned nullptr (for an Error status message).
+ */
+const char* sideToolpathError();
+
+/**
+ * @brief Install a precompiled toolpath for the current settings version.
+ */
+void installSideToolpath(int sideIndex, const Toolpath& path);
+
+/**
+ * @brief Drop all cached toolpaths (they recompile on next use).
+ */
+void invalidateToolpathCache();
+
+/**
+ * @brief Run a compiled toolpath segment by segment (blocking).
+ * Checks stopRequested and pauseRequested between segments and during XY moves.
+ * XY speeds are scaled by paintFeedOverride_pct, including a change mid-move.
+ * A pause cuts the gun and pot, decelerates XY, stores a PaintCheckpoint and
+ * sets isPaintPaused.
+ * @param path The compiled path.
+ * @param xf Side transform applied to every XY target.
+ * @param accel XY acceleration.
+ * @param resume Checkpoint to continue from (nullptr = from the start). The
+ *        machine is brought back to the paused point first (rotation, Z, then
+ *        an approach along the interrupted sweep).
+ * @return true if stopped, paused or failed, false if completed.
+ */
+bool executeToolpath(const Toolpath& path, const ToolpathTransform& xf, float accel,
+                     const PaintCheckpoint* resume = nullptr);
+
+/**
+ * @brief Compile (or fetch cached) and execute the toolpath for one side.
+ * Used by the PaintPattern_<Side>.cpp wrappers. Resumes from the stored
+ * checkpoint when it is for this side, and clears it once the side completes.
+ * @return true if stopped, paused or failed, false if completed.
+ */
+bool executeSideToolpath(int sideIndex, float speed, float accel);
+
+/**
+ * @brief CRC of a side's segments and transform; a checkpoint only resumes on the same value.
+ */
+uint32_t toolpathCheckpointCrc(const Toolpath& path, const ToolpathTransform& xf);
+
+/**
+ * @brief Write a toolpath as {"status":"Toolpath","side":n,...,"segments":[[type,gun,pass,x,y,speedHz],...]}.
+ * Segments are in pattern coordinates (before the side transform).
+ * This is the input format of tools/paint_sim.
+ * @return Length written, or -1 if buf is too small.
+ */
+int toolpathWriteJson(const Toolpath& path, char* buf, size_t len);
+
+#define RASTER_PLAN_STEP_DEG 5
+
+/**
+ * @brief Compile the side at every raster angle (0-175 in RASTER_PLAN_STEP_DEG steps)
+ * and write {"status":"RasterPlan","side":n,"current":deg,"angles":[[deg,passes,sweepInches,pathInches],...],"best":deg}.
+ * best has the fewest passes (turnarounds), then the shortest path.
+ * @return Length written, or -1 if buf is too small.
+ */
+int rasterPlanWriteJson(int sideIndex, char* buf, size_t len);
+
+#endif // TOOLPATH_EXECUTOR_H
@@ -3,6 +3,10 @@
 #include "../Main/GeneralSettings_PinDef.h" // Include pin definitions
 #include <WiFi.h> // Needed for WiFi.status() check
 #include <Arduino.h> // Include Arduino core
+#include "../Settings/SettingsSchema.h" // For settingsScanChanges() (place table cache key)
+#include "../Logging/Log.h"
+#include "../Metrics/JobMetrics.h"
+#include "../Motion/EmergencyStop.h"
 
 // === PnP Variable Definitions ===
 // Define the variables declared extern in PickPlace.h
@@ -44,12 +48,53 @@ int currentPlaceCol = 0; // 0-based index
 int currentPlaceRow = 0; // 0-based index
 bool pnpSequenceComplete = false;
 
+// Compiled place positions, rebuilt when the settings version changes
+static PlaceTable placeTable;
+static uint32_t placeTableVersion = 0; // 0 = invalid
+
 // --- PnP Helper Functions ---
 
+const PlaceTable* getPlaceTable() {
+    uint32_t version = settingsScanChanges();
+    if (placeTableVersion == version && placeTable.valid) return &placeTable;
+
+    PlaceTableParams params;
+    params.firstX = placeFirstXAbsolute_inch;
+    params.firstY = placeFirstYAbsolute_inch;
+    params.cols = placeGridCols;
+    params.rows = placeGridRows;
+    params.itemWidth = pnpItemWidth_inch;
+    params.itemHeight = pnpItemHeight_inch;
+    params.gapX = placeGapX_inch;
+    params.gapY = placeGapY_inch;
+    if (!compilePlaceTable(params, placeTable)) {
+        LOGE("Place table compile failed (%d x %d grid)", placeGridCols, placeGridRows);
+        placeTableVersion = 0;
+        return nullptr;
+    }
+    placeTableVersion = version;
+    return &placeTable;
+}
+
+void installPlaceTable(const PlaceTable& table) {
+    placeTable = table;
+    placeTableVersion = table.valid ? settingsScanChanges() : 0;
+}
+
+// Looks up the place position for a row/col (col in visit order). Returns false if out of range.
+static bool getPlaceTarget(int row, int col, float& x, float& y) {
+    const PlaceTable* table = getPlaceTable();
+    if (!table || row < 0 || col < 0 || row >= table->rows || col >= table->cols) return false;
+    int idx = row * table->cols + col;
+    x = table->x[idx];
+    y = table->y[idx];
+    return true;
+}
+
 // PnP specific Z move
 void moveToZ_PnP(float targetZ_inch, bool wait_for_completion /*= true*/) {
     if (!stepper_z) {
-        Serial.println("ERROR: Cannot move Z (PnP) - Stepper not initialized.");
+        LOGE("Cannot move Z (PnP) - Stepper not initialized.");
         webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Z Stepper not initialized.\"}");
         return;
     }
@@ -65,21 +110,21 @@ void moveToZ_PnP(float targetZ_inch, bool wait_for_completion /*= true*/) {
     // === End Z Limit Check ===
 
     if (stepper_z->getCurrentPosition() == targetZ_steps) {
-        Serial.println("PnP: Already at target Z position.");
+        LOGI("PnP: Already at target Z position.");
         return; // No move needed
     }
 
     // Set speed and acceleration
     stepper_z->setSpeedInHz(patternZSpeed);
     stepper_z->setAcceleration(patternZAccel);
-    stepper_z->moveTo(targetZ_steps);
+    if (!emergencyStopMoveTo(stepper_z, targetZ_steps)) return;
 
     // Optional wait
     if (wait_for_completion) {
         unsigned long zMoveStartTime = millis();
         while (stepper_z->isRunning()) {
             if (millis() - zMoveStartTime > 10000) { // Timeout (adjust as needed)
-                 Serial.println("[ERROR] Timeout moving Z (PnP)!");
+                 LOGE("Timeout moving Z (PnP)!");
                  if (stepper_z) stepper_z->forceStop();
                  isMoving = false; // May need adjustment depending on where this is called
                  webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Timeout moving Z (PnP)!\"}");
@@ -96,7 +141,7 @@ void moveToZ_PnP(float targetZ_inch, bool wait_for_completion /*= true*/) {
 void moveToXYPositionInches_PnP(float targetX_inch, float targetY_inch) {
     // Check if steppers exist
     if (!stepper_x || !stepper_y_left || !stepper_y_right) {
-        Serial.println("ERROR: Cannot move XY (PnP) - Steppers not initialized.");
+        LOGE("Cannot move XY (PnP) - Steppers not initialized.");
         webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"XY Steppers not initialized.\"}");
         return;
     }
@@ -110,7 +155,7 @@ void moveToXYPositionInches_PnP(float targetX_inch, float targetY_inch) {
     bool y_at_target = (stepper_y_left->getCurrentPosition() == targetY_steps) && (stepper_y_right->getCurrentPosition() == targetY_steps);
 
     if (x_at_target && y_at_target) {
-        Serial.println("PnP: Already at target XY position.");
+        LOGI("PnP: Already at target XY position.");
         return; // No move needed
     }
 
@@ -118,20 +163,30 @@ void moveToXYPositionInches_PnP(float targetX_inch, float targetY_inch) {
     if (!x_at_target) {
         stepper_x->setSpeedInHz(patternXSpeed);
         stepper_x->setAcceleration(patternXAccel);
-        stepper_x->moveTo(targetX_steps);
+        emergencyStopMoveTo(stepper_x, targetX_steps);
     }
     if (!y_at_target) {
         stepper_y_left->setSpeedInHz(patternYSpeed);
         stepper_y_left->setAcceleration(patternYAccel);
-        stepper_y_left->moveTo(targetY_steps);
+        emergencyStopMoveTo(stepper_y_left, targetY_steps);
 
         stepper_y_right->setSpeedInHz(patternYSpeed);
         stepper_y_right->setAcceleration(patternYAccel);
-        stepper_y_right->moveTo(targetY_steps);
+        emergencyStopMoveTo(stepper_y_right, targetY_steps);
     }
     // Note: Completion is waited for within the calling PnP functions (enter/execute)
 }
 
+// True once STOP or the e-stop has force-stopped the axes under a blocking PnP
+// wait. The sequence must end there: no cylinder/suction action, no new move.
+// STOP and emergencyStopService() reset the machine state and report.
+static bool pnpInterrupted(const char* stage) {
+    if (!stopRequested && !emergencyStopLatched()) return false;
+    LOGW("PnP: %s interrupted by STOP/e-stop, aborting sequence.", stage);
+    isMoving = false;
+    return true;
+}
+
 // --- Main PnP Functions ---
 
 void enterPickPlaceMode() {
@@ -144,28 +199,31 @@ void enterPickPlaceMode() {
          return;
     }
 
-    Serial.println("[DEBUG] Entering Pick and Place Mode...");
+    LOGD("Entering Pick and Place Mode...");
     inPickPlaceMode = true; // Set flag BEFORE starting move to prevent loop() interference
     isMoving = true; // Block other actions during the initial moves
+    stopRequested = false; // A STOP from here on aborts the entry moves
     webSocket.broadcastTXT("{\"status\":\"Moving\", \"message\":\"Entering PnP Mode - Rotating to 0 and Moving...\"}"); // Updated message
 
     // Reset PnP state
     currentPlaceCol = 0;
     currentPlaceRow = 0;
     pnpSequenceComplete = false;
+    jobBegin(JOB_PICK_PLACE, -1);
+    jobSetCategory(JOB_CAT_REPOSITION);
 
     // === Rotate to 0 Degrees First ===
-    Serial.println("[DEBUG] PnP Entry: Rotating to 0 degrees...");
+    LOGD("PnP Entry: Rotating to 0 degrees...");
     if (stepper_rot) {
         if (stepper_rot->getCurrentPosition() != 0) { // Only move if not already at 0
             stepper_rot->setSpeedInHz(patternRotSpeed); // Use pattern speed/accel
             stepper_rot->setAcceleration(patternRotAccel);
-            stepper_rot->moveTo(0);
+            emergencyStopMoveTo(stepper_rot, 0);
 
             unsigned long rotStartTime = millis();
             while (stepper_rot->isRunning()) {
                 if (millis() - rotStartTime > 15000) { // Timeout
-                    Serial.println("[ERROR] Timeout rotating to 0 in PnP Entry!");
+                    LOGE("Timeout rotating to 0 in PnP Entry!");
                     if (stepper_rot) stepper_rot->forceStop();
                     // Consider error handling: should we exit PnP mode?
                     // For now, continue to XY move, but log error.
@@ -174,21 +232,22 @@ void enterPickPlaceMode() {
                 }
                 webSocket.loop(); yield(); // Keep responsive
             }
+            if (pnpInterrupted("Entry rotation")) return;
             if (!stepper_rot->isRunning()) { // Check if rotation completed successfully
-                 Serial.println("[DEBUG] PnP Entry: Rotation to 0 complete.");
+                 LOGD("PnP Entry: Rotation to 0 complete.");
             }
         } else {
-             Serial.println("[DEBUG] PnP Entry: Already at 0 degrees.");
+             LOGD("PnP Entry: Already at 0 degrees.");
         }
     } else {
-        Serial.println("[WARN] PnP Entry: Rotation stepper not available, skipping rotation.");
+        LOGW("PnP Entry: Rotation stepper not available, skipping rotation.");
     }
     // === End Rotation ===
 
     // === Move to the PnP offset WAITING position (Pick Y + 1 inch) ===
     float waitingPosX = pnpOffsetX_inch;
     float waitingPosY = pnpOffsetY_inch + 1.0f; // Wait 1 inch away in Y+
-    Serial.printf("[DEBUG] PnP Entry: Moving to WAITING position X=%.2f, Y=%.2f\n", waitingPosX, waitingPosY);
+    LOGD("PnP Entry: Moving to WAITING position X=%.2f, Y=%.2f", waitingPosX, waitingPosY);
     moveToXYPositionInches_PnP(waitingPosX, waitingPosY);
 
     // --- Wait for XY move completion --- (Blocking for simplicity here)
@@ -196,13 +255,14 @@ void enterPickPlaceMode() {
     while (stepper_x->isRunning() || stepper_y_left->isRunning() || stepper_y_right->isRunning()) {
         // Basic timeout check
         if (millis() - entryMoveStartTime > 15000) {
-            Serial.println("[ERROR] Timeout waiting for move to Pick position!");
+            LOGE("Timeout waiting for move to Pick position!");
             if (stepper_x) stepper_x->forceStop();
             if (stepper_y_left) stepper_y_left->forceStop();
             if (stepper_y_right) stepper_y_right->forceStop();
             // if (stepper_z) stepper_z->forceStop(); // Stop Z if involved
             isMoving = false; // Force clear flag
             inPickPlaceMode = false; // Failed to enter mode, clear flag
+            jobEnd(JOB_FAILED);
             webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Timeout moving to Pick position!\"}");
             return; // Failed to enter mode
         }
@@ -215,33 +275,37 @@ void enterPickPlaceMode() {
          yield();
     }
     // --- Move Completion ---
+    if (pnpInterrupted("Entry move")) return;
 
-    Serial.printf("[DEBUG] enterPickPlaceMode: Move complete. isRunning X:%d YL:%d YR:%d\n", stepper_x->isRunning(), stepper_y_left->isRunning(), stepper_y_right->isRunning()); // DEBUG
+    LOGD("enterPickPlaceMode: Move complete. isRunning X:%d YL:%d YR:%d", stepper_x->isRunning(), stepper_y_left->isRunning(), stepper_y_right->isRunning()); // DEBUG
 
     delay(50); // Add small delay to allow stepper state to settle
 
     // Double check motors stopped
     if (stepper_x->isRunning() || stepper_y_left->isRunning() || stepper_y_right->isRunning()) { // Check only XY
-         Serial.println("[ERROR] Motors still running after move to Pick pos wait loop!");
+         LOGE("Motors still running after move to Pick pos wait loop!");
          isMoving = false;
          inPickPlaceMode = false;
+         jobEnd(JOB_FAILED);
          webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Failed to reach Pick position reliably!\"}");
          return; // Failed to enter mode
     }
 
-    Serial.println("[DEBUG] Reached PnP WAITING position. Clearing isMoving flag."); // Updated Debug message
+    LOGD("Reached PnP WAITING position. Clearing isMoving flag."); // Updated Debug message
     isMoving = false; // Clear busy flag AFTER ALL moves complete and state is confirmed
+    jobSetCategory(JOB_CAT_IDLE); // Until the operator requests a step
     webSocket.broadcastTXT("{\"status\":\"PickPlaceReady\", \"message\":\"Pick/Place mode entered. Ready for step.\"}");
 }
 
 void exitPickPlaceMode(bool shouldHomeAfterExit /*= false*/) {
     if (!inPickPlaceMode) return; // Already out
 
-    Serial.println("[DEBUG] Exiting Pick and Place Mode.");
+    LOGD("Exiting Pick and Place Mode.");
+    jobEnd(pnpSequenceComplete ? JOB_DONE : JOB_STOPPED);
     inPickPlaceMode = false;
     pnpSequenceComplete = false;
     if (shouldHomeAfterExit) {
-        Serial.println("[DEBUG] PnP sequence complete. Requesting post-PnP homing.");
+        LOGD("PnP sequence complete. Requesting post-PnP homing.");
         pendingHomingAfterPnP = true;
         // Don't broadcast Ready yet, main loop will handle homing and status update
     } else {
@@ -251,35 +315,46 @@ void exitPickPlaceMode(bool shouldHomeAfterExit /*= false*/) {
 }
 
 void executeNextPickPlaceStep() {
-     Serial.println("[DEBUG] executeNextPickPlaceStep: Entered function."); // DEBUG
+     LOGD("executeNextPickPlaceStep: Entered function."); // DEBUG
      if (!inPickPlaceMode) {
-        Serial.println("[DEBUG] executeNextPickPlaceStep: Failed check !inPickPlaceMode"); // DEBUG
+        LOGD("executeNextPickPlaceStep: Failed check !inPickPlaceMode"); // DEBUG
         webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Not in Pick/Place mode.\"}");
         return;
     }
     if (isMoving || isHoming) {
-         Serial.printf("[DEBUG] executeNextPickPlaceStep: Failed check isMoving=%d || isHoming=%d\n", isMoving, isHoming); // DEBUG
+         LOGD("executeNextPickPlaceStep: Failed check isMoving=%d || isHoming=%d", isMoving, isHoming); // DEBUG
          webSocket.broadcastTXT("{\"status\":\"Busy\", \"message\":\"Machine is busy.\"}");
          return;
     }
     if (pnpSequenceComplete) {
-        Serial.println("[DEBUG] executeNextPickPlaceStep: Failed check pnpSequenceComplete"); // DEBUG
+        LOGD("executeNextPickPlaceStep: Failed check pnpSequenceComplete"); // DEBUG
         webSocket.broadcastTXT("{\"status\":\"PickPlaceReady\", \"message\":\"PnP sequence already completed.\"}");
         return;
     }
-    Serial.println("[DEBUG] executeNextPickPlaceStep: Checks passed. Setting isMoving = true."); // DEBUG
+    LOGD("executeNextPickPlaceStep: Checks passed. Setting isMoving = true."); // DEBUG
     isMoving = true; // Set busy flag for the entire step
+    stopRequested = false; // A STOP from here on aborts the step
+    JobCategoryScope stepTime(JOB_CAT_REPOSITION); // Back to idle when the step returns
     webSocket.broadcastTXT("{\"status\":\"Busy\", \"message\":\"Executing PnP Step...\"}");
-    Serial.println("[DEBUG] --- Starting PnP Step --- ");
+    LOGD("--- Starting PnP Step --- ");
+
+    // Place target comes from the compiled place table (serpentine order already applied)
+    float absoluteTargetX = 0.0f, absoluteTargetY = 0.0f;
+    if (!getPlaceTarget(currentPlaceRow, currentPlaceCol, absoluteTargetX, absoluteTargetY)) {
+        LOGE("No place position for Row=%d, Col=%d", currentPlaceRow, currentPlaceCol);
+        isMoving = false;
+        webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Invalid place grid position.\"}");
+        return;
+    }
 
     // == Move from Waiting Offset to Actual Pick Location == (NEW)
-    Serial.printf("[DEBUG] Moving from waiting offset to actual Pick location (X=%.2f, Y=%.2f)...\n", pnpPickLocationX_inch, pnpPickLocationY_inch);
+    LOGD("Moving from waiting offset to actual Pick location (X=%.2f, Y=%.2f)...", pnpPickLocationX_inch, pnpPickLocationY_inch);
     webSocket.broadcastTXT("{\"status\":\"Moving\", \"message\":\"Moving to Pick Location...\"}");
     moveToXYPositionInches_PnP(pnpPickLocationX_inch, pnpPickLocationY_inch);
     unsigned long prePickMoveStartTime = millis();
     while (stepper_x->isRunning() || stepper_y_left->isRunning() || stepper_y_right->isRunning()) {
         if (millis() - prePickMoveStartTime > 5000) { // Shorter timeout for this small move
-             Serial.println("[ERROR] Timeout moving to actual Pick location!");
+             LOGE("Timeout moving to actual Pick location!");
              if (stepper_x) stepper_x->forceStop();
              if (stepper_y_left) stepper_y_left->forceStop();
              if (stepper_y_right) stepper_y_right->forceStop();
@@ -289,47 +364,40 @@ void executeNextPickPlaceStep() {
         }
         webSocket.loop(); yield(); // Keep responsive
     }
-     Serial.println("[DEBUG] Arrived at actual Pick location.");
+    if (pnpInterrupted("Move to Pick")) return;
+     LOGD("Arrived at actual Pick location.");
     // == End Move to Pick Location ==
 
     // == Pick Action (User Steps 1-5) ==
-    Serial.println("[DEBUG] 1. Performing Pick Action...");
+    LOGD("1. Performing Pick Action...");
     // Move Z down to Pick height
 
+    {
+    JobCategoryScope dwell(JOB_CAT_DWELL);
     digitalWrite(SUCTION_PIN, HIGH);       // 1. Suction ON
     digitalWrite(PICK_CYLINDER_PIN, HIGH); // 2. Extend Cylinder
     delay(500);                            // 3. Wait
     digitalWrite(PICK_CYLINDER_PIN, LOW);  // 4. Retract Cylinder
     delay(50);                             // 5. Wait (Reduced from 200ms)
+    }
     // Suction stays ON
-    Serial.println("[DEBUG] Pick Action Complete (Suction ON).");
+    LOGD("Pick Action Complete (Suction ON).");
+    if (pnpInterrupted("Pick")) return;
 
     // Move Z up to Travel height before XY move
 
     // == Move to Place Location (User Step 6) ==
-    // Determine effective column index for serpentine pattern (relative to starting X)
-    int effectiveCol = currentPlaceCol;
-    if (currentPlaceRow % 2 != 0) { // Odd rows (1, 3, 5...): Reverse direction
-        effectiveCol = (placeGridCols - 1 - currentPlaceCol);
-    }
-
-    // Calculate target X: Start at placeFirstXAbsolute_inch and SUBTRACT offset based on effectiveCol
-    float stepX = pnpItemWidth_inch + placeGapX_inch;
-    float absoluteTargetX = placeFirstXAbsolute_inch - (effectiveCol * stepX);
-    // Calculate target Y: Start at placeFirstYAbsolute_inch and SUBTRACT offset based on row (changed from ADD to make Y move in negative direction)
-    float stepY = pnpItemHeight_inch + placeGapY_inch;
-    float absoluteTargetY = placeFirstYAbsolute_inch - (currentPlaceRow * stepY);
+    // Target was looked up from the compiled place table before picking
 
     char msgBuffer[150];
     // Update debug log format slightly
-    Serial.printf("[DEBUG] PnP Step Target Calc: Row=%d, Col=%d (EffCol=%d), FirstAbs(%.2f, %.2f), Step(%.3f, %.3f) -> Target(%.2f, %.2f)\n",
-                   currentPlaceRow, currentPlaceCol, effectiveCol,
+    LOGD("PnP Step Target: Row=%d, Col=%d, FirstAbs(%.2f, %.2f) -> Target(%.2f, %.2f)",
+                   currentPlaceRow, currentPlaceCol,
                    placeFirstXAbsolute_inch, placeFirstYAbsolute_inch,
-                   stepX, stepY, // Log step size
                    absoluteTargetX, absoluteTargetY); // DEBUG
     sprintf(msgBuffer, "{\"status\":\"Moving\", \"message\":\"PnP Step %d,%d: Moving to Place (Abs: %.2f, %.2f)\"}",
             currentPlaceRow + 1, currentPlaceCol + 1, absoluteTargetX, absoluteTargetY);
-    Serial.println("[DEBUG] 6. Moving to Place location...");
+    LOGD("6. Moving to Place location...");
     Serial.println(msgBuffer); // Debug
     webSocket.broadcastTXT(msgBuffer);
     
@@ -339,7 +407,7 @@ void executeNextPickPlaceStep() {
     unsigned long placeMoveStartTime = millis();
     while (stepper_x->isRunning() || stepper_y_left->isRunning() || stepper_y_right->isRunning()) {
         if (millis() - placeMoveStartTime > 15000) { /* Timeout check */
-             Serial.println("[ERROR] Timeout moving to Place!");
+             LOGE("Timeout moving to Place!");
              if (stepper_x) stepper_x->forceStop();
              if (stepper_y_left) stepper_y_left->forceStop();
              if (stepper_y_right) stepper_y_right->forceStop();
@@ -349,19 +417,24 @@ void executeNextPickPlaceStep() {
         }
         webSocket.loop(); yield(); // Keep responsive
     }
-    Serial.printf("[DEBUG] Arrived at Place (Abs: %.2f, %.2f).\n", absoluteTargetX, absoluteTargetY);
+    if (pnpInterrupted("Move to Place")) return; // Part stays held: suction is left as it is
+    LOGD("Arrived at Place (Abs: %.2f, %.2f).", absoluteTargetX, absoluteTargetY);
 
     // == Place Action (User Steps 7-12) ==
-    Serial.println("[DEBUG] 7. Performing Place Action...");
+    LOGD("7. Performing Place Action...");
     // Move Z down to Place height
 
+    {
+    JobCategoryScope dwell(JOB_CAT_DWELL);
     digitalWrite(PICK_CYLINDER_PIN, HIGH); // 7. Extend Cylinder
     delay(500);                            // 8. Wait
     digitalWrite(SUCTION_PIN, LOW);        // 9. Turn Suction OFF
     delay(100);                            // 10. Wait
     digitalWrite(PICK_CYLINDER_PIN, LOW);  // 11. Retract Cylinder
     delay(150);                            // 12. Wait (Changed from 500ms)
-    Serial.println("[DEBUG] Place Action Complete.");
+    }
+    LOGD("Place Action Complete.");
+    if (pnpInterrupted("Place")) return;
 
     // Move Z up to Travel height
 
@@ -371,7 +444,7 @@ void executeNextPickPlaceStep() {
     float returnPosY = pnpPickLocationY_inch;
     sprintf(msgBuffer, "{\"status\":\"Moving\", \"message\":\"PnP Step %d,%d: Returning to Pick Pos (%.2f, %.2f)\"}",
             currentPlaceRow + 1, currentPlaceCol + 1, returnPosX, returnPosY);
-    Serial.println("[DEBUG] 13. Returning to Pick location..."); // Updated message
+    LOGD("13. Returning to Pick location..."); // Updated message
     Serial.println(msgBuffer); // Debug
     webSocket.broadcastTXT(msgBuffer);
     // Move XY to Pick Location
@@ -380,7 +453,7 @@ void executeNextPickPlaceStep() {
     unsigned long pickMoveStartTime = millis();
     while (stepper_x->isRunning() || stepper_y_left->isRunning() || stepper_y_right->isRunning()) {
          if (millis() - pickMoveStartTime > 15000) { /* Timeout check */
-             Serial.println("[ERROR] Timeout returning to Pick!");
+             LOGE("Timeout returning to Pick!");
              if (stepper_x) stepper_x->forceStop();
              if (stepper_y_left) stepper_y_left->forceStop();
              if (stepper_y_right) stepper_y_right->forceStop();
@@ -390,22 +463,24 @@ void executeNextPickPlaceStep() {
          }
         webSocket.loop(); yield(); // Keep responsive
     }
-     Serial.printf("[DEBUG] Arrived back at Pick location (%.2f, %.2f).\n", returnPosX, returnPosY); // Updated message
-     Serial.println("[DEBUG] --- Completed PnP Step --- ");
-     Serial.printf("[DEBUG] Current Grid Pos Before Increment: Col=%d, Row=%d\n", currentPlaceCol, currentPlaceRow); // DEBUG
+    if (pnpInterrupted("Return to Pick")) return;
+     LOGD("Arrived back at Pick location (%.2f, %.2f).", returnPosX, returnPosY); // Updated message
+     LOGD("--- Completed PnP Step --- ");
+     LOGD("Current Grid Pos Before Increment: Col=%d, Row=%d", currentPlaceCol, currentPlaceRow); // DEBUG
 
     // == Update Grid Position for next step ==
+    jobAddUnit();
     currentPlaceCol++;
     if (currentPlaceCol >= placeGridCols) {
         currentPlaceCol = 0;
         currentPlaceRow++;
         if (currentPlaceRow >= placeGridRows) {
             pnpSequenceComplete = true;
-            Serial.println("[DEBUG] PnP Sequence Complete (All grid positions finished).");
+            LOGD("PnP Sequence Complete (All grid positions finished).");
         }
     }
 
-    Serial.printf("[DEBUG] PnP Step End: Clearing isMoving flag. New Grid Pos: Col=%d, Row=%d, SequenceComplete=%d\n", currentPlaceCol, currentPlaceRow, pnpSequenceComplete); // DEBUG
+    LOGD("PnP Step End: Clearing isMoving flag. New Grid Pos: Col=%d, Row=%d, SequenceComplete=%d", currentPlaceCol, currentPlaceRow, pnpSequenceComplete); // DEBUG
     isMoving = false; // Clear busy flag for the whole step
 
     // == Send Status Update ==
@@ -425,7 +500,7 @@ void executeNextPickPlaceStep() {
 
 // Function to skip the current target location and move to the next one
 void skipPickPlaceLocation() {
-    Serial.println("[DEBUG] skipPickPlaceLocation: Entered function.");
+    LOGD("skipPickPlaceLocation: Entered function.");
     if (!inPickPlaceMode) {
         webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Not in Pick/Place mode.\"}");
         return;
@@ -451,19 +526,19 @@ void skipPickPlaceLocation() {
 
     if (nextIndex >= totalLocations) {
         // Skipped the last location, sequence is now complete
-        Serial.println("[DEBUG] Skipped last location. Sequence complete.");
+        LOGD("Skipped last location. Sequence complete.");
         pnpSequenceComplete = true;
         webSocket.broadcastTXT("{\"status\":\"PickPlaceComplete\", \"message\":\"Sequence completed by skipping last location.\"}");
     } else {
         // Update row and column to the next location (without moving)
         currentPlaceCol = nextIndex % placeGridCols;
         currentPlaceRow = nextIndex / placeGridCols;
-        Serial.printf("[DEBUG] Skipped to next location: Col=%d, Row=%d\n", currentPlaceCol, currentPlaceRow);
+        LOGD("Skipped to next location: Col=%d, Row=%d", currentPlaceCol, currentPlaceRow);
 
-        // Calculate new target coordinates (for reference only, no movement)
-        float absoluteTargetX = placeFirstXAbsolute_inch + (currentPlaceCol * (pnpItemWidth_inch + placeGapX_inch));
-        float absoluteTargetY = placeFirstYAbsolute_inch + (currentPlaceRow * (pnpItemHeight_inch + placeGapY_inch));
-        Serial.printf("[DEBUG] Next location coordinates (not moving): X=%.2f, Y=%.2f\n", absoluteTargetX, absoluteTargetY);
+        // Look up new target coordinates (for reference only, no movement)
+        float absoluteTargetX = 0.0f, absoluteTargetY = 0.0f;
+        getPlaceTarget(currentPlaceRow, currentPlaceCol, absoluteTargetX, absoluteTargetY);
+        LOGD("Next location coordinates (not moving): X=%.2f, Y=%.2f", absoluteTargetX, absoluteTargetY);
 
         sprintf(msgBuffer, "{\"status\":\"PickPlaceReady\", \"message\":\"Skipped to location %d,%d. Ready for next step.\"}",
                 currentPlaceRow + 1, currentPlaceCol + 1);
@@ -473,7 +548,7 @@ void skipPickPlaceLocation() {
 
 // Function to move back to the previous target location
 void goBackPickPlaceLocation() {
-    Serial.println("[DEBUG] goBackPickPlaceLocation: Entered function.");
+    LOGD("goBackPickPlaceLocation: Entered function.");
     if (!inPickPlaceMode) {
         webSocket.broadcastTXT("{\"status\":\"Error\", \"message\":\"Not in Pick/Place mode.\"}");
         return;
@@ -491,7 +566,7 @@ void goBackPickPlaceLocation() {
 
     if (prevIndex < 0) {
         // Already at the first location (or before it)
-        Serial.println("[DEBUG] Cannot go back further.");
+        LOGD("Cannot go back further.");
         webSocket.broadcastTXT("{\"status\":\"PickPlaceReady\", \"message\":\"Already at first location.\"}");
         return;
     }
@@ -502,19 +577,19 @@ void goBackPickPlaceLocation() {
 
     // If the sequence was marked complete, going back means it's no longer complete
     if (pnpSequenceComplete) {
-        Serial.println("[DEBUG] Sequence was complete, marking as incomplete due to move back.");
+        LOGD("Sequence was complete, marking as incomplete due to move back.");
         pnpSequenceComplete = false;
     }
 
     // Update row and column to the previous location (without moving)
     currentPlaceCol = prevIndex % placeGridCols;
     currentPlaceRow = prevIndex / placeGridCols;
-    Serial.printf("[DEBUG] Went back to location: Col=%d, Row=%d\n", currentPlaceCol, currentPlaceRow);
+    LOGD("Went back to location: Col=%d, Row=%d", currentPlaceCol, currentPlaceRow);
 
-    // Calculate coordinates (for reference only, no movement)
-    float absoluteTargetX = placeFirstXAbsolute_inch + (currentPlaceCol * (pnpItemWidth_inch + placeGapX_inch));
-    float absoluteTargetY = placeFirstYAbsolute_inch + (currentPlaceRow * (pnpItemHeight_inch + placeGapY_inch));
-    Serial.printf("[DEBUG] Previous location coordinates (not moving): X=%.2f, Y=%.2f\n", absoluteTargetX, absoluteTargetY);
+    // Look up coordinates (for reference only, no movement)
+    float absoluteTargetX = 0.0f, absoluteTargetY = 0.0f;
+    getPlaceTarget(currentPlaceRow, currentPlaceCol, absoluteTargetX, absoluteTargetY);
+    LOGD("Previous location coordinates (not moving): X=%.2f, Y=%.2f", absoluteTargetX, absoluteTargetY);
 
     sprintf(msgBuffer, "{\"status\":\"PickPlaceReady\", \"message\":\"Moved back to location %d,%d. Ready for next step.\"}",
             currentPlaceRow + 1, currentPlaceCol + 1);
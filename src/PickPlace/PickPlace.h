@@ -7,6 +7,7 @@
 #include <Bounce2.h> // For button debouncer access (if needed directly)
 #include "../Main/GeneralSettings_PinDef.h" // Access pin definitions
 #include "../Main/SharedGlobals.h" // Include for access to PnP variables
+#include "../Painting/Patterns/ToolpathCompiler.h" // For PlaceTable
 
 // Forward declare stepper objects defined in main.cpp
 extern FastAccelStepper *stepper_x;
@@ -15,7 +16,7 @@ extern FastAccelStepper *stepper_y_right;
 extern FastAccelStepper *stepper_z; // Add Z if PnP needs Z control
 
 // Forward declare WebSocket object defined in main.cpp
-extern WebSocketsServer webSocket;
+extern BufferedWebSocketsServer webSocket;
 
 // Forward declare global state flags defined in main.cpp that PnP needs to READ
 extern bool allHomed;
@@ -57,6 +58,10 @@ void executeNextPickPlaceStep();
 void skipPickPlaceLocation();
 void goBackPickPlaceLocation();
 
+// Compiled place positions (cached per settings version)
+const PlaceTable* getPlaceTable();
+void installPlaceTable(const PlaceTable& table); // Used when loading a recipe
+
 // Helper function (called internally or possibly from main.cpp if needed)
 void moveToXYPositionInches_PnP(float targetX_inch, float targetY_inch); // PnP specific XY move
 void moveToZ_PnP(float targetZ_inch, bool wait_for_completion = true); // PnP specific Z move with optional wait
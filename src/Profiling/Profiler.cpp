@@ -0,0 +1,71 @@
+#include "Profiler.h"
+
+static ProfileRegion* regions = nullptr;
+
+void profilerRegister(ProfileRegion& region) {
+    region.next = regions;
+    regions = &region;
+}
+
+#ifdef ENABLE_PROFILING
+static unsigned long windowStartMs = 0; // Start of the current measurement window
+
+static void resetRegion(ProfileRegion& r) {
+    r.count = 0;
+    r.minCycles = UINT64_MAX;
+    r.maxCycles = 0;
+    r.totalCycles = 0;
+    memset(r.hist, 0, sizeof(r.hist));
+}
+#endif
+
+#ifdef ENABLE_PROFILING
+static int writeRegions(char* buf, size_t len, unsigned long now) {
+    float cyclesPerUs = (float)ESP.getCpuFreqMHz();
+    int pos = snprintf(buf, len, "{\"status\":\"Profile\",\"cpuMHz\":%lu,\"windowMs\":%lu,\"regions\":[",
+                       (unsigned long)ESP.getCpuFreqMHz(), now - windowStartMs);
+    if (pos < 0 || (size_t)pos >= len) return -1;
+
+    for (ProfileRegion* r = regions; r; r = r->next) {
+        float meanUs = r->count ? (float)r->totalCycles / r->count / cyclesPerUs : 0.0f;
+        int n = snprintf(buf + pos, len - pos,
+                         "%s{\"name\":\"%s\",\"count\":%lu,\"minUs\":%.2f,\"maxUs\":%.2f,\"meanUs\":%.2f,\"totalMs\":%.1f,\"hist\":[",
+                         r == regions ? "" : ",", r->name, (unsigned long)r->count,
+                         r->count ? r->minCycles / cyclesPerUs : 0.0f, r->maxCycles / cyclesPerUs, meanUs,
+                         (float)r->totalCycles / cyclesPerUs / 1000.0f);
+        if (n < 0 || (size_t)n >= len - pos) return -1;
+        pos += n;
+
+        // Histogram up to the highest non-empty bin
+        int last = PROFILE_HIST_BINS - 1;
+        while (last > 0 && r->hist[last] == 0) last--;
+        for (int b = 0; b <= last; b++) {
+            n = snprintf(buf + pos, len - pos, b ? ",%lu" : "%lu", (unsigned long)r->hist[b]);
+            if (n < 0 || (size_t)n >= len - pos) return -1;
+            pos += n;
+        }
+        n = snprintf(buf + pos, len - pos, "]}");
+        if (n < 0 || (size_t)n >= len - pos) return -1;
+        pos += n;
+    }
+    int n = snprintf(buf + pos, len - pos, "]}");
+    if (n < 0 || (size_t)n >= len - pos) return -1;
+    return pos + n;
+}
+#endif
+
+int profilerWriteJson(char* buf, size_t len, bool reset) {
+#ifndef ENABLE_PROFILING
+    (void)reset;
+    int n = snprintf(buf, len, "{\"status\":\"Error\", \"message\":\"Profiling not compiled in (build with -D ENABLE_PROFILING).\"}");
+    return (n < 0 || (size_t)n >= len) ? -1 : n;
+#else
+    unsigned long now = millis();
+    int pos = writeRegions(buf, len, now);
+    if (reset) {
+        for (ProfileRegion* r = regions; r; r = r->next) resetRegion(*r);
+        windowStartMs = now;
+    }
+    return pos;
+#endif
+}
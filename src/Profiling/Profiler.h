@@ -0,0 +1,91 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// === Cycle-Count Profiler ===
+// PROFILE_SCOPE("name") times the rest of the enclosing block with the CPU
+// cycle counter and accumulates count/min/max/mean plus a log2 histogram for
+// that region. Regions register themselves on first use. GET_PROFILE dumps
+// all regions as JSON and resets them.
+//
+// The 32-bit cycle counter wraps every 2^32 cycles (~17.9 s at 240 MHz), so
+// each probe also reads esp_timer_get_time(); samples past half a wrap are
+// taken from the microsecond timer instead, keeping long regions correct.
+//
+// Probes only exist when built with -D ENABLE_PROFILING; otherwise
+// PROFILE_SCOPE expands to nothing and costs nothing.
+// Not ISR safe: probe from task context (loop() and what it calls).
+
+#define PROFILE_HIST_BINS 40 // Bin k counts samples of [2^k, 2^(k+1)) cycles; the last bin takes everything longer
+
+struct ProfileRegion {
+    const char* name;
+    ProfileRegion* next;      // Registry (singly linked, newest first)
+    uint32_t count;
+    uint64_t minCycles;
+    uint64_t maxCycles;
+    uint64_t totalCycles;
+    uint32_t hist[PROFILE_HIST_BINS];
+};
+
+/**
+ * @brief Add a region to the registry (called once per region by PROFILE_SCOPE).
+ */
+void profilerRegister(ProfileRegion& region);
+
+/**
+ * @brief Record one sample for a region.
+ */
+inline void profilerRecord(ProfileRegion& r, uint64_t cycles) {
+    r.count++;
+    r.totalCycles += cycles;
+    if (cycles < r.minCycles) r.minCycles = cycles;
+    if (cycles > r.maxCycles) r.maxCycles = cycles;
+    int bin = cycles ? 63 - __builtin_clzll(cycles) : 0;
+    r.hist[bin < PROFILE_HIST_BINS ? bin : PROFILE_HIST_BINS - 1]++;
+}
+
+/**
+ * @brief Write {"status":"Profile",...,"regions":[...]} and optionally reset all regions.
+ * Writes an error status if profiling is not compiled in. With reset set, the regions
+ * are reset even when the JSON does not fit, so the next window starts clean.
+ * @return Length written, or -1 if buf is too small.
+ */
+int profilerWriteJson(char* buf, size_t len, bool reset);
+
+#ifdef ENABLE_PROFILING
+
+class ProfileProbe {
+public:
+    explicit ProfileProbe(ProfileRegion& region)
+        : region_(region), startUs_(esp_timer_get_time()), start_(ESP.getCycleCount()) {}
+    ~ProfileProbe() {
+        uint32_t cycles = ESP.getCycleCount() - start_;
+        uint64_t timerCycles = (uint64_t)(esp_timer_get_time() - startUs_) * ESP.getCpuFreqMHz();
+        // Past half a wrap the 32-bit delta can no longer be trusted
+        profilerRecord(region_, timerCycles < (1ULL << 31) ? cycles : timerCycles);
+    }
+private:
+    ProfileRegion& region_;
+    int64_t startUs_;
+    uint32_t start_;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name)                                                              \
+    static ProfileRegion PROFILE_CONCAT(profRegion_, __LINE__) = {name, nullptr, 0, UINT64_MAX, 0, 0, {0}}; \
+    static bool PROFILE_CONCAT(profRegistered_, __LINE__) =                               \
+        (profilerRegister(PROFILE_CONCAT(profRegion_, __LINE__)), true);                  \
+    (void)PROFILE_CONCAT(profRegistered_, __LINE__);                                     \
+    ProfileProbe PROFILE_CONCAT(profProbe_, __LINE__)(PROFILE_CONCAT(profRegion_, __LINE__))
+
+#else
+
+#define PROFILE_SCOPE(name) do {} while (0)
+
+#endif // ENABLE_PROFILING
+
+#endif // PROFILER_H
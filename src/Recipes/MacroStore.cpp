@@ -0,0 +1,183 @@
+#include "MacroStore.h"
+#include <LittleFS.h>
+#include "RecipeStore.h" // For recipeNameValid()
+#include "../Logging/Log.h"
+
+// === Internal State ===
+static bool dirReady = false;
+
+static void macroPath(const char* name, const char* ext, char* out, size_t len) {
+    snprintf(out, len, MACRO_DIR "/%s%s", name, ext);
+}
+
+void macroStoreInit() {
+    dirReady = LittleFS.exists(MACRO_DIR) || LittleFS.mkdir(MACRO_DIR);
+    if (!dirReady) LOGE("MacroStore: cannot create " MACRO_DIR ", macros unavailable.");
+}
+
+// Checks shared by all commands; fills msg and returns false on failure
+static bool checkRequest(const char* name, char* msg, size_t msgLen) {
+    if (!dirReady) {
+        snprintf(msg, msgLen, "Macro storage is not available.");
+        return false;
+    }
+    if (!recipeNameValid(name)) {
+        snprintf(msg, msgLen, "Invalid macro name (1-%d chars, A-Z a-z 0-9 _ -).", RECIPE_NAME_MAX);
+        return false;
+    }
+    return true;
+}
+
+int macroNextLine(const char*& pos, const char* end, char* line, size_t lineLen) {
+    while (pos < end) {
+        const char* eol = (const char*)memchr(pos, '\n', end - pos);
+        if (!eol) eol = end;
+        const char* start = pos;
+        const char* stop = eol;
+        pos = eol < end ? eol + 1 : end;
+        while (start < stop && (*start == ' ' || *start == '\t')) start++;
+        while (stop > start && (stop[-1] == ' ' || stop[-1] == '\t' || stop[-1] == '\r')) stop--;
+        size_t n = stop - start;
+        if (n == 0) continue; // Blank line
+        if (n >= lineLen) return -1;
+        memcpy(line, start, n);
+        line[n] = '\0';
+        return (int)n;
+    }
+    return 0;
+}
+
+bool macroCheckBody(const char* body, size_t len, char* msg, size_t msgLen) {
+    static const char* const NESTED[] = {"BATCH", "DEFINE_MACRO", "RUN_MACRO"};
+    char line[MACRO_LINE_MAX];
+    const char* pos = body;
+    const char* end = body + len;
+    int count = 0;
+    for (;;) {
+        int n = macroNextLine(pos, end, line, sizeof(line));
+        if (n == 0) break;
+        count++;
+        if (n < 0) {
+            snprintf(msg, msgLen, "Line %d is longer than %d characters.", count, MACRO_LINE_MAX - 1);
+            return false;
+        }
+        const char* cmd = line;
+        if (cmd[0] == '#') { // Request id: check the command after it
+            const char* space = strchr(cmd, ' ');
+            cmd = space ? space + 1 : cmd + strlen(cmd);
+            while (*cmd == ' ') cmd++;
+        }
+        size_t cmdLen = strcspn(cmd, " ");
+        for (const char* nested : NESTED) {
+            if (cmdLen == strlen(nested) && strncmp(cmd, nested, cmdLen) == 0) {
+                snprintf(msg, msgLen, "Line %d: %s cannot be used inside a command list.", count, nested);
+                return false;
+            }
+        }
+    }
+    if (count == 0) {
+        snprintf(msg, msgLen, "Command list is empty.");
+        return false;
+    }
+    snprintf(msg, msgLen, "%d commands.", count);
+    return true;
+}
+
+bool macroSave(const char* name, const char* body, size_t len, char* msg, size_t msgLen) {
+    if (!checkRequest(name, msg, msgLen)) return false;
+    if (len > MACRO_BODY_MAX) {
+        snprintf(msg, msgLen, "Macro exceeds %d bytes.", MACRO_BODY_MAX);
+        return false;
+    }
+    if (!macroCheckBody(body, len, msg, msgLen)) return false;
+
+    // Temp file + rename, as for recipes: a failed write keeps the old macro
+    char tmpPath[48], finalPath[48];
+    macroPath(name, ".tmp", tmpPath, sizeof(tmpPath));
+    macroPath(name, MACRO_EXT, finalPath, sizeof(finalPath));
+    File file = LittleFS.open(tmpPath, "w");
+    if (!file) {
+        snprintf(msg, msgLen, "Could not create macro file.");
+        return false;
+    }
+    bool ok = file.write((const uint8_t*)body, len) == len;
+    file.close();
+    if (!ok || !LittleFS.rename(tmpPath, finalPath)) {
+        LittleFS.remove(tmpPath);
+        snprintf(msg, msgLen, "Failed to write macro '%s' (storage full?).", name);
+        return false;
+    }
+    LOGI("MacroStore: Saved '%s' (%u bytes).", name, (unsigned)len);
+    snprintf(msg, msgLen, "Macro '%s' saved (%u bytes).", name, (unsigned)len);
+    return true;
+}
+
+bool macroLoad(const char* name, char* buf, size_t& outLen, char* msg, size_t msgLen) {
+    if (!checkRequest(name, msg, msgLen)) return false;
+    char path[48];
+    macroPath(name, MACRO_EXT, path, sizeof(path));
+    if (!LittleFS.exists(path)) {
+        snprintf(msg, msgLen, "Macro '%s' not found.", name);
+        return false;
+    }
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        snprintf(msg, msgLen, "Could not open macro '%s'.", name);
+        return false;
+    }
+    size_t size = file.size();
+    bool ok = size <= MACRO_BODY_MAX && file.read((uint8_t*)buf, size) == size;
+    file.close();
+    if (!ok) {
+        snprintf(msg, msgLen, "Macro '%s' is unreadable.", name);
+        return false;
+    }
+    outLen = size;
+    snprintf(msg, msgLen, "Macro '%s' loaded.", name);
+    return true;
+}
+
+bool macroDelete(const char* name, char* msg, size_t msgLen) {
+    if (!checkRequest(name, msg, msgLen)) return false;
+    char path[48];
+    macroPath(name, MACRO_EXT, path, sizeof(path));
+    if (!LittleFS.exists(path)) {
+        snprintf(msg, msgLen, "Macro '%s' not found.", name);
+        return false;
+    }
+    if (!LittleFS.remove(path)) {
+        snprintf(msg, msgLen, "Failed to delete macro '%s'.", name);
+        return false;
+    }
+    snprintf(msg, msgLen, "Macro '%s' deleted.", name);
+    return true;
+}
+
+int macroListJson(char* buf, size_t len) {
+    size_t pos = 0;
+    int n = snprintf(buf, len, "{\"status\":\"Macros\",\"macros\":[");
+    if (n < 0 || (size_t)n >= len) return -1;
+    pos = n;
+
+    if (dirReady) {
+        File dir = LittleFS.open(MACRO_DIR);
+        bool first = true;
+        for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile()) {
+            const char* fileName = entry.name();
+            size_t nameLen = strlen(fileName);
+            size_t extLen = strlen(MACRO_EXT);
+            if (entry.isDirectory() || nameLen <= extLen || strcmp(fileName + nameLen - extLen, MACRO_EXT) != 0) {
+                continue; // Skip leftovers such as .tmp files
+            }
+            n = snprintf(buf + pos, len - pos, "%s{\"name\":\"%.*s\",\"size\":%u}",
+                         first ? "" : ",", (int)(nameLen - extLen), fileName, (unsigned)entry.size());
+            if (n < 0 || (size_t)n >= len - pos) return -1;
+            pos += n;
+            first = false;
+        }
+    }
+
+    n = snprintf(buf + pos, len - pos, "]}");
+    if (n < 0 || (size_t)n >= len - pos) return -1;
+    return (int)(pos + n);
+}
@@ -0,0 +1,60 @@
+#ifndef MACRO_STORE_H
+#define MACRO_STORE_H
+
+#include <Arduino.h>
+
+// === Macro Store ===
+// Named command macros on the LittleFS partition (/macros/<name>.mac). A macro
+// is plain text, one WebSocket command per line, exactly as a client would send
+// them; RUN_MACRO replays it on the machine without a network round trip per
+// step. Names follow the recipe rules (recipeNameValid()).
+
+#define MACRO_DIR "/macros"
+#define MACRO_EXT ".mac"
+#define MACRO_BODY_MAX 2048 // Whole macro file
+#define MACRO_LINE_MAX 256  // One command
+
+/**
+ * @brief Create the macro directory. Call after recipeStoreInit() has mounted LittleFS.
+ */
+void macroStoreInit();
+
+/**
+ * @brief Split the next non-blank line off a command list (BATCH frame or macro body).
+ * Leading/trailing blanks and a trailing '\r' are trimmed.
+ * @param pos In: where to start; out: just past the line.
+ * @param line Receives the line (truncated lines are reported as too long).
+ * @return Length of the line, 0 at the end, or -1 if the line exceeds lineLen - 1.
+ */
+int macroNextLine(const char*& pos, const char* end, char* line, size_t lineLen);
+
+/**
+ * @brief Check a command list: 1..n lines, each short enough and not itself a
+ * list command (BATCH, DEFINE_MACRO, RUN_MACRO), so lists never nest.
+ * @return true if valid; otherwise msg says which line is wrong.
+ */
+bool macroCheckBody(const char* body, size_t len, char* msg, size_t msgLen);
+
+/**
+ * @brief Store a macro (replaces an existing one). The body is checked first.
+ */
+bool macroSave(const char* name, const char* body, size_t len, char* msg, size_t msgLen);
+
+/**
+ * @brief Read a whole macro into buf (MACRO_BODY_MAX bytes).
+ * @param outLen Receives the body length.
+ */
+bool macroLoad(const char* name, char* buf, size_t& outLen, char* msg, size_t msgLen);
+
+/**
+ * @brief Delete a macro.
+ */
+bool macroDelete(const char* name, char* msg, size_t msgLen);
+
+/**
+ * @brief Write {"status":"Macros","macros":[{"name":..,"size":..},..]} into buf.
+ * @return Length written, or -1 if buf is too small.
+ */
+int macroListJson(char* buf, size_t len);
+
+#endif // MACRO_STORE_H
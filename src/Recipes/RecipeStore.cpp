@@ -0,0 +1,309 @@
+#include "RecipeStore.h"
+#include <LittleFS.h>
+#include "../Main/SharedGlobals.h"
+#include "../Settings/SettingsSchema.h"
+#include "../Settings/SettingsStore.h" // For settingsCrc32()
+#include "../Painting/Patterns/ToolpathExecutor.h"
+#include "../PickPlace/PickPlace.h"
+
+// Defined in main.cpp
+void calculateAndSetGridSpacing(int cols, int rows);
+void saveSettings();
+void broadcastSettingsDelta();
+
+// === Internal State ===
+static bool fsMounted = false;
+
+// Everything a load needs, staged so nothing is applied until the CRC checks out.
+// Static rather than on the stack: ~7 KB.
+static struct {
+    uint8_t settings[RECIPE_SETTINGS_MAX];
+    Toolpath paths[4];
+    PlaceTable place;
+} staging;
+
+static void recipePath(const char* name, const char* ext, char* out, size_t len) {
+    snprintf(out, len, RECIPE_DIR "/%s%s", name, ext);
+}
+
+bool recipeNameValid(const char* name) {
+    if (!name) return false;
+    size_t len = strlen(name);
+    if (len == 0 || len > RECIPE_NAME_MAX) return false;
+    for (size_t i = 0; i < len; i++) {
+        char c = name[i];
+        bool ok = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_' || c == '-';
+        if (!ok) return false;
+    }
+    return true;
+}
+
+bool recipeStoreInit() {
+    if (!LittleFS.begin(true)) { // Format on first boot
+        Serial.println("[ERROR] RecipeStore: LittleFS mount failed, recipes unavailable.");
+        fsMounted = false;
+        return false;
+    }
+    if (!LittleFS.exists(RECIPE_DIR)) {
+        LittleFS.mkdir(RECIPE_DIR);
+    }
+    fsMounted = true;
+    Serial.printf("[INFO] RecipeStore: LittleFS mounted (%u / %u bytes used).\n",
+                  (unsigned)LittleFS.usedBytes(), (unsigned)LittleFS.totalBytes());
+    return true;
+}
+
+// Checks shared by all commands; fills msg and returns false on failure
+static bool checkRequest(const char* name, char* msg, size_t msgLen) {
+    if (!fsMounted) {
+        snprintf(msg, msgLen, "Recipe storage is not available.");
+        return false;
+    }
+    if (!recipeNameValid(name)) {
+        snprintf(msg, msgLen, "Invalid recipe name (1-%d chars, A-Z a-z 0-9 _ -).", RECIPE_NAME_MAX);
+        return false;
+    }
+    return true;
+}
+
+// Write a chunk and fold it into the running CRC
+static bool writeChunk(File& file, const void* data, size_t len, uint32_t& crc) {
+    if (len == 0) return true;
+    crc = settingsCrc32(crc, data, len);
+    return file.write((const uint8_t*)data, len) == len;
+}
+
+// Read a chunk and fold it into the running CRC
+static bool readChunk(File& file, void* data, size_t len, uint32_t& crc) {
+    if (len == 0) return true;
+    if (file.read((uint8_t*)data, len) != len) return false;
+    crc = settingsCrc32(crc, data, len);
+    return true;
+}
+
+bool recipeSave(const char* name, char* msg, size_t msgLen) {
+    if (!checkRequest(name, msg, msgLen)) return false;
+
+    // Compile (or fetch from cache) everything from the current settings
+    uint8_t settings[RECIPE_SETTINGS_MAX];
+    size_t settingsSize = settingsPack(settings, sizeof(settings));
+    if (settingsSize == 0) {
+        snprintf(msg, msgLen, "Settings payload exceeds recipe limit.");
+        return false;
+    }
+    const Toolpath* paths[4];
+    for (int side = 0; side < 4; side++) {
+        paths[side] = getSideToolpath(side, paintSpeed[side]); // nullptr = side not paintable
+    }
+    const PlaceTable* place = getPlaceTable();
+
+    RecipeHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = RECIPE_MAGIC;
+    header.formatVersion = RECIPE_FORMAT_VERSION;
+    header.headerSize = sizeof(RecipeHeader);
+    strncpy(header.name, name, RECIPE_NAME_MAX);
+    header.schemaHash = settingsSchemaHash();
+    header.settingsSize = (uint16_t)settingsSize;
+    header.toolpathFormat = TOOLPATH_FORMAT_VERSION;
+    for (int side = 0; side < 4; side++) {
+        header.segmentCount[side] = paths[side] ? paths[side]->count : 0;
+    }
+    if (place) {
+        header.placeCols = place->cols;
+        header.placeRows = place->rows;
+        header.placeCount = place->count;
+    }
+
+    // Write to a temp file and rename over the old recipe so a failed write
+    // (power loss, full partition) never leaves a half-written recipe behind
+    char tmpPath[48], finalPath[48];
+    recipePath(name, ".tmp", tmpPath, sizeof(tmpPath));
+    recipePath(name, RECIPE_EXT, finalPath, sizeof(finalPath));
+    File file = LittleFS.open(tmpPath, "w");
+    if (!file) {
+        snprintf(msg, msgLen, "Could not create recipe file.");
+        return false;
+    }
+
+    unsigned long startUs = micros();
+    bool ok = file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header); // Placeholder, CRC patched below
+    uint32_t crc = 0;
+    ok = ok && writeChunk(file, settings, settingsSize, crc);
+    for (int side = 0; ok && side < 4; side++) {
+        if (paths[side]) {
+            ok = writeChunk(file, paths[side]->segments, paths[side]->count * sizeof(ToolpathSegment), crc);
+        }
+    }
+    if (ok && place) {
+        ok = writeChunk(file, place->x, place->count * sizeof(float), crc);
+        ok = ok && writeChunk(file, place->y, place->count * sizeof(float), crc);
+    }
+    header.bodyCrc = crc;
+    ok = ok && file.seek(0, SeekSet);
+    ok = ok && file.write((const uint8_t*)&header, sizeof(header)) == sizeof(header);
+    size_t fileSize = file.size();
+    file.close();
+
+    if (!ok || !LittleFS.rename(tmpPath, finalPath)) {
+        LittleFS.remove(tmpPath);
+        snprintf(msg, msgLen, "Failed to write recipe '%s' (storage full?).", name);
+        return false;
+    }
+    Serial.printf("[INFO] RecipeStore: Saved '%s' (%u bytes, %lu us).\n", name, (unsigned)fileSize, micros() - startUs);
+    snprintf(msg, msgLen, "Recipe '%s' saved (%u bytes).", name, (unsigned)fileSize);
+    return true;
+}
+
+// Read and verify a whole recipe into staging. Nothing global is touched.
+static bool stageRecipe(const char* name, RecipeHeader& header, char* msg, size_t msgLen) {
+    char path[48];
+    recipePath(name, RECIPE_EXT, path, sizeof(path));
+    if (!LittleFS.exists(path)) {
+        snprintf(msg, msgLen, "Recipe '%s' not found.", name);
+        return false;
+    }
+    File file = LittleFS.open(path, "r");
+    if (!file) {
+        snprintf(msg, msgLen, "Could not open recipe '%s'.", name);
+        return false;
+    }
+
+    bool ok = file.read((uint8_t*)&header, sizeof(header)) == sizeof(header);
+    if (!ok || header.magic != RECIPE_MAGIC || header.formatVersion < 1 || header.formatVersion > RECIPE_FORMAT_VERSION ||
+        header.headerSize != sizeof(RecipeHeader)) {
+        file.close();
+        snprintf(msg, msgLen, "Recipe '%s' is not a valid recipe file.", name);
+        return false;
+    }
+    // Untagged settings can only be read if their layout is one we know
+    if (header.formatVersion == 1 && settingsPositionalRevision(header.schemaHash) < 0) {
+        file.close();
+        snprintf(msg, msgLen, "Recipe '%s' was saved by an incompatible firmware.", name);
+        return false;
+    }
+    if (header.settingsSize > RECIPE_SETTINGS_MAX) ok = false;
+    size_t expected = sizeof(header) + header.settingsSize + header.placeCount * 2 * sizeof(float);
+    for (int side = 0; side < 4; side++) {
+        if (header.segmentCount[side] > TOOLPATH_MAX_SEGMENTS) ok = false;
+        expected += header.segmentCount[side] * sizeof(ToolpathSegment);
+    }
+    if (header.placeCount > PLACE_TABLE_MAX || header.placeCount != header.placeCols * header.placeRows) ok = false;
+    if (!ok || file.size() != expected) {
+        file.close();
+        snprintf(msg, msgLen, "Recipe '%s' is truncated or corrupt.", name);
+        return false;
+    }
+
+    uint32_t crc = 0;
+    ok = readChunk(file, staging.settings, header.settingsSize, crc);
+    for (int side = 0; ok && side < 4; side++) {
+        Toolpath& tp = staging.paths[side];
+        tp.side = (uint8_t)side;
+        tp.count = header.segmentCount[side];
+        tp.valid = tp.count > 0 ? 1 : 0;
+        ok = readChunk(file, tp.segments, tp.count * sizeof(ToolpathSegment), crc);
+    }
+    PlaceTable& pt = staging.place;
+    pt.cols = header.placeCols;
+    pt.rows = header.placeRows;
+    pt.count = header.placeCount;
+    pt.valid = pt.count > 0 ? 1 : 0;
+    ok = ok && readChunk(file, pt.x, pt.count * sizeof(float), crc);
+    ok = ok && readChunk(file, pt.y, pt.count * sizeof(float), crc);
+    file.close();
+
+    if (!ok || crc != header.bodyCrc) {
+        snprintf(msg, msgLen, "Recipe '%s' failed its checksum.", name);
+        return false;
+    }
+    return true;
+}
+
+bool recipeLoad(const char* name, char* msg, size_t msgLen) {
+    if (!checkRequest(name, msg, msgLen)) return false;
+
+    unsigned long startUs = micros();
+    RecipeHeader header;
+    if (!stageRecipe(name, header, msg, msgLen)) {
+        Serial.printf("[WARN] RecipeStore: %s\n", msg);
+        return false;
+    }
+
+    // --- Apply: settings first, then the compiled data keyed to the new settings version ---
+    int rows = header.formatVersion == 1
+        ? settingsUnpackPositional(settingsPositionalRevision(header.schemaHash), staging.settings, header.settingsSize)
+        : settingsUnpack(staging.settings, header.settingsSize);
+    if (rows < 0) { // Rejected before anything was applied
+        snprintf(msg, msgLen, "Recipe '%s' has corrupt settings.", name);
+        Serial.printf("[WARN] RecipeStore: %s\n", msg);
+        return false;
+    }
+    int corrected = settingsValidate();
+    calculateAndSetGridSpacing(placeGridCols, placeGridRows);
+    // Precompiled data only matches if every setting came from the recipe unchanged,
+    // and toolpaths only if their coordinates mean what the executor expects
+    bool settingsExact = corrected == 0 && (size_t)rows == settingsPersistedRows();
+    bool pathsCurrent = header.toolpathFormat == TOOLPATH_FORMAT_VERSION;
+    if (settingsExact && pathsCurrent) {
+        for (int side = 0; side < 4; side++) {
+            installSideToolpath(side, staging.paths[side]);
+        }
+    } else {
+        invalidateToolpathCache(); // Recompile from the applied settings on next use
+    }
+    if (settingsExact && staging.place.valid) installPlaceTable(staging.place);
+    saveSettings();
+    broadcastSettingsDelta();
+
+    Serial.printf("[INFO] RecipeStore: Loaded '%s' (format %u, %d rows) in %lu us (%d settings clamped%s).\n",
+                  name, header.formatVersion, rows, micros() - startUs, corrected,
+                  pathsCurrent ? "" : ", toolpaths recompiled");
+    snprintf(msg, msgLen, "Recipe '%s' loaded.", name);
+    return true;
+}
+
+bool recipeDelete(const char* name, char* msg, size_t msgLen) {
+    if (!checkRequest(name, msg, msgLen)) return false;
+    char path[48];
+    recipePath(name, RECIPE_EXT, path, sizeof(path));
+    if (!LittleFS.exists(path)) {
+        snprintf(msg, msgLen, "Recipe '%s' not found.", name);
+        return false;
+    }
+    if (!LittleFS.remove(path)) {
+        snprintf(msg, msgLen, "Failed to delete recipe '%s'.", name);
+        return false;
+    }
+    snprintf(msg, msgLen, "Recipe '%s' deleted.", name);
+    return true;
+}
+
+int recipeListJson(char* buf, size_t len) {
+    size_t pos = 0;
+    int n = snprintf(buf, len, "{\"status\":\"Recipes\",\"recipes\":[");
+    if (n < 0 || (size_t)n >= len) return -1;
+    pos = n;
+
+    if (fsMounted) {
+        File dir = LittleFS.open(RECIPE_DIR);
+        bool first = true;
+        for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile()) {
+            const char* fileName = entry.name();
+            size_t nameLen = strlen(fileName);
+            size_t extLen = strlen(RECIPE_EXT);
+            if (entry.isDirectory() || nameLen <= extLen || strcmp(fileName + nameLen - extLen, RECIPE_EXT) != 0) {
+                continue; // Skip leftovers such as .tmp files
+            }
+            n = snprintf(buf + pos, len - pos, "%s{\"name\":\"%.*s\",\"size\":%u}",
+                         first ? "" : ",", (int)(nameLen - extLen), fileName, (unsigned)entry.size());
+            if (n < 0 || (size_t)n >= len - pos) return -1;
+            pos += n;
+            first = false;
+        }
+    }
+
+    n = snprintf(buf + pos, len - pos, "]}");
+    if (n < 0 || (size_t)n >= len - pos) return -1;
+    return (int)(pos + n);
+}
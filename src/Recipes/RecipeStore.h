@@ -0,0 +1,82 @@
+#ifndef RECIPE_STORE_H
+#define RECIPE_STORE_H
+
+#include <Arduino.h>
+#include "../Painting/Patterns/ToolpathCompiler.h"
+
+// === Recipe Store ===
+// Named job recipes on the LittleFS partition (/recipes/<name>.rcp). A recipe
+// is a snapshot of every persisted setting plus the compiled toolpath for each
+// side and the PnP place table, so a changeover is one LOAD_RECIPE instead of
+// a string of SET_* commands and nothing needs recompiling afterwards.
+//
+// File layout: RecipeHeader | settings payload | side 0..3 segments | place x[] | place y[]
+// The CRC in the header covers everything after it. The settings payload is
+// tagged by key (settingsPack()), so recipes keep loading when settings are
+// added or removed; settings a recipe lacks get their default. Format 1 recipes
+// carry the older untagged payload and are read through its frozen layouts.
+// Side toolpaths saved with a different TOOLPATH_FORMAT_VERSION are not used;
+// they are recompiled from the recipe's settings.
+
+#define RECIPE_DIR "/recipes"
+#define RECIPE_EXT ".rcp"
+#define RECIPE_NAME_MAX 23          // [A-Za-z0-9_-], fits the header name field
+#define RECIPE_MAGIC 0x31504352UL   // "RCP1"
+#define RECIPE_FORMAT_VERSION 2     // 2 = tagged settings payload, 1 = untagged
+#define RECIPE_SETTINGS_MAX 512     // Upper bound for the settings payload
+
+struct RecipeHeader {
+    uint32_t magic;
+    uint16_t formatVersion;
+    uint16_t headerSize;            // sizeof(RecipeHeader) when written
+    char name[RECIPE_NAME_MAX + 1];
+    uint32_t schemaHash;            // settingsSchemaHash() when written (format 1: selects the untagged layout)
+    uint16_t settingsSize;          // settingsPayloadSize() when written
+    uint16_t segmentCount[4];       // Per side; 0 = side had no valid toolpath
+    uint16_t placeCols;
+    uint16_t placeRows;
+    uint16_t placeCount;
+    uint16_t toolpathFormat;        // TOOLPATH_FORMAT_VERSION when written (0 in older recipes)
+    uint32_t bodyCrc;               // settingsCrc32 over the body
+};
+
+/**
+ * @brief Mount LittleFS (formatting on first use) and create the recipe directory.
+ * @return false if the filesystem is unavailable; recipe commands then fail cleanly.
+ */
+bool recipeStoreInit();
+
+/**
+ * @brief Check a recipe name: 1-RECIPE_NAME_MAX chars of [A-Za-z0-9_-].
+ */
+bool recipeNameValid(const char* name);
+
+/**
+ * @brief Compile the current settings and write them as a recipe (replaces an existing one).
+ * @param name Recipe name.
+ * @param msg Receives a human-readable result.
+ * @return true on success.
+ */
+bool recipeSave(const char* name, char* msg, size_t msgLen);
+
+/**
+ * @brief Load a recipe and apply it in one step.
+ * The whole file is read and CRC-checked before anything is applied, so a
+ * corrupt or mismatched recipe leaves the current job untouched. Callers must
+ * make sure the machine is idle.
+ * @return true if the recipe was applied.
+ */
+bool recipeLoad(const char* name, char* msg, size_t msgLen);
+
+/**
+ * @brief Delete a recipe.
+ */
+bool recipeDelete(const char* name, char* msg, size_t msgLen);
+
+/**
+ * @brief Write {"status":"Recipes","recipes":[{"name":..,"size":..},..]} into buf.
+ * @return Length written, or -1 if buf is too small.
+ */
+int recipeListJson(char* buf, size_t len);
+
+#endif // RECIPE_STORE_H
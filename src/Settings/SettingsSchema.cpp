@@ -0,0 +1,459 @@
+#include "SettingsSchema.h"
+#include <math.h>
+#include "../Main/SharedGlobals.h"
+#include "../Main/GeneralSettings_PinDef.h" // For SERVO_INIT_POS_PITCH, PITCH_SERVO_MIN/MAX
+#include "../PickPlace/PickPlace.h"         // For pnpOffsetX_inch / pnpOffsetY_inch
+#include "../Painting/Painting.h"           // For paintPatternOffsetX_inch / paintPatternOffsetY_inch
+
+// Defined in main.cpp
+extern float paintGunOffsetX_inch;
+extern float paintGunOffsetY_inch;
+extern float patternXSpeed;
+extern float patternYSpeed;
+
+// Per-side defaults [Back, Right, Front, Left]
+static constexpr float DEFAULT_PAINT_PATTERN[4] = { 0.0f, 90.0f, 0.0f, 90.0f }; // Back/Front=Up-Down, Left/Right=Sideways
+// Every side started at 25/30 before the starts were used: keep those paths
+static constexpr float DEFAULT_PAINT_START_X[4] = { 25.0f, 25.0f, 25.0f, 25.0f };
+static constexpr float DEFAULT_PAINT_START_Y[4] = { 30.0f, 30.0f, 30.0f, 30.0f };
+
+#define P  SETTING_PERSIST
+#define J  SETTING_JSON
+#define D  SETTING_DERIVED
+#define T  SETTING_TRANSFORM
+
+// Persisted rows are stored tagged by key, so rows can be added, removed or
+// moved freely. Never rename a persisted key: a renamed row loads as new
+// (default). Changing a row's type or count also resets it to its default.
+static constexpr SettingDef SETTINGS_TABLE[] = {
+    // key               legacyKey      type           cnt flags  ptr                        default   defs                   min       max
+    // --- PnP/Grid/Tray ---
+    { "gridCols",        "gridCols",    SETTING_INT,   1, P|J, &placeGridCols,            4.0f,     nullptr,               1.0f,     20.0f },
+    { "gridRows",        "gridRows",    SETTING_INT,   1, P|J, &placeGridRows,            5.0f,     nullptr,               1.0f,     20.0f },
+    { "gapX",            nullptr,       SETTING_FLOAT, 1, J|D, &placeGapX_inch,           0.0f,     nullptr,               0.0f,     0.0f },
+    { "gapY",            nullptr,       SETTING_FLOAT, 1, J|D, &placeGapY_inch,           0.0f,     nullptr,               0.0f,     0.0f },
+    { "trayWidth",       "trayWidth",   SETTING_FLOAT, 1, P|J, &trayWidth_inch,           24.0f,    nullptr,               1.0f,     60.0f },
+    { "trayHeight",      "trayHeight",  SETTING_FLOAT, 1, P|J, &trayHeight_inch,          18.0f,    nullptr,               1.0f,     60.0f },
+    { "pnpOffsetX",      nullptr,       SETTING_FLOAT, 1, P|J, &pnpOffsetX_inch,          15.0f,    nullptr,              -60.0f,    60.0f },
+    { "pnpOffsetY",      nullptr,       SETTING_FLOAT, 1, P|J, &pnpOffsetY_inch,          0.0f,     nullptr,              -60.0f,    60.0f },
+    { "pnpPickX",        "pnpPickX",    SETTING_FLOAT, 1, P|J, &pnpPickLocationX_inch,    2.0f,     nullptr,              -60.0f,    60.0f },
+    { "pnpPickY",        "pnpPickY",    SETTING_FLOAT, 1, P|J, &pnpPickLocationY_inch,    2.0f,     nullptr,              -60.0f,    60.0f },
+    { "pnpPickZ",        "pnpPickZ",    SETTING_FLOAT, 1, P|J, &pnpPickLocationZ_inch,    2.0f,     nullptr,               0.0f,     12.0f },
+    { "pnpPlaceZ",       "pnpPlaceZ",   SETTING_FLOAT, 1, P|J, &pnpPlaceHeight_inch,      0.5f,     nullptr,               0.0f,     12.0f },
+    { "firstPlaceX",     "firstPlaceX", SETTING_FLOAT, 1, P|J, &placeFirstXAbsolute_inch, 5.0f,     nullptr,              -60.0f,    60.0f },
+    { "firstPlaceY",     "firstPlaceY", SETTING_FLOAT, 1, P|J, &placeFirstYAbsolute_inch, 5.0f,     nullptr,              -60.0f,    60.0f },
+    { "patXSpeed",       nullptr,       SETTING_FLOAT, 1, P|J, &patternXSpeed,            20000.0f, nullptr,               100.0f,   60000.0f },
+    { "patYSpeed",       nullptr,       SETTING_FLOAT, 1, P|J, &patternYSpeed,            20000.0f, nullptr,               100.0f,   60000.0f },
+
+    // --- Painting General ---
+    { "paintGunOffsetX", "gunOffsetX",  SETTING_FLOAT, 1, P|J|T, &paintGunOffsetX_inch,    0.0f,     nullptr,              -12.0f,    12.0f },
+    { "paintGunOffsetY", "gunOffsetY",  SETTING_FLOAT, 1, P|J|T, &paintGunOffsetY_inch,    1.5f,     nullptr,              -12.0f,    12.0f },
+    { "patternOffsetX",  nullptr,       SETTING_FLOAT, 1, P|J|T, &paintPatternOffsetX_inch, 0.0f,    nullptr,              -12.0f,    12.0f },
+    { "patternOffsetY",  nullptr,       SETTING_FLOAT, 1, P|J|T, &paintPatternOffsetY_inch, 0.0f,    nullptr,              -12.0f,    12.0f },
+    { "sweepOT",         nullptr,       SETTING_INT,   1, P|J, &paintSweepOvertravel,     0.0f,     nullptr,               0.0f,     1.0f },
+
+    // --- Painting Side-Specific [Back, Right, Front, Left] ---
+    { "paintZ",          "paintZ",      SETTING_FLOAT, 4, P|J, paintZHeight_inch,         1.0f,     nullptr,               0.0f,     12.0f },
+    { "paintP",          "paintP",      SETTING_INT,   4, P|J, paintPitchAngle,           SERVO_INIT_POS_PITCH, nullptr,   0.0f,     180.0f },
+    { "paintR",          "paintPat",    SETTING_INT,   4, P|J, paintPatternType,          0.0f,     DEFAULT_PAINT_PATTERN, 0.0f,     179.0f }, // 'R' key matches the HTML select ID
+    { "paintS",          "paintS",      SETTING_FLOAT, 4, P|J, paintSpeed,                10000.0f, nullptr,               100.0f,   60000.0f },
+    { "paintStartX",     "paintStartX", SETTING_FLOAT, 4, P|J, paintStartX,               0.0f,     DEFAULT_PAINT_START_X, -60.0f,   60.0f },
+    { "paintStartY",     "paintStartY", SETTING_FLOAT, 4, P|J, paintStartY,               0.0f,     DEFAULT_PAINT_START_Y, -60.0f,   60.0f },
+    { "sprayW",          nullptr,       SETTING_FLOAT, 4, P|J, paintSprayWidth_inch,      0.0f,     nullptr,               0.0f,     24.0f },
+    { "sprayOvl",        nullptr,       SETTING_FLOAT, 4, P|J, paintSprayOverlap_pct,     25.0f,    nullptr,               0.0f,     90.0f },
+};
+
+#undef P
+#undef J
+#undef D
+#undef T
+
+static constexpr size_t SETTINGS_TABLE_COUNT = sizeof(SETTINGS_TABLE) / sizeof(SETTINGS_TABLE[0]);
+
+// Tagged row header in the persistent payload: uint32 tag, uint8 type, uint8 count
+#define PAYLOAD_ROW_HEADER 6
+
+static constexpr size_t payloadSize() {
+    size_t n = 0;
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        if (SETTINGS_TABLE[i].flags & SETTING_PERSIST) n += PAYLOAD_ROW_HEADER + SETTINGS_TABLE[i].count * 4;
+    }
+    return n;
+}
+static constexpr size_t SETTINGS_PAYLOAD_SIZE = payloadSize();
+static_assert(sizeof(float) == 4 && sizeof(int) == 4, "Settings payload assumes 4-byte float/int");
+
+static constexpr size_t jsonElements() {
+    size_t n = 0;
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        if (SETTINGS_TABLE[i].flags & SETTING_JSON) n += SETTINGS_TABLE[i].count;
+    }
+    return n;
+}
+static constexpr size_t SETTINGS_JSON_ELEMENTS = jsonElements();
+
+// === Version Tracking ===
+static uint32_t shadowBits[SETTINGS_JSON_ELEMENTS]; // Raw value at the last scan
+static uint32_t changedAt[SETTINGS_JSON_ELEMENTS];  // Version at which each element last changed
+static uint32_t currentVersion = 0;                 // 0 = never scanned
+static uint32_t bootEpoch = 0;
+
+const SettingDef* settingsSchema(size_t& count) {
+    count = SETTINGS_TABLE_COUNT;
+    return SETTINGS_TABLE;
+}
+
+const SettingDef* settingsFind(const char* key) {
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        if (strcmp(SETTINGS_TABLE[i].key, key) == 0) return &SETTINGS_TABLE[i];
+    }
+    return nullptr;
+}
+
+float settingsGet(const SettingDef& def, int index) {
+    if (def.type == SETTING_INT) return (float)((int*)def.ptr)[index];
+    return ((float*)def.ptr)[index];
+}
+
+void settingsSet(const SettingDef& def, int index, float value) {
+    if (def.type == SETTING_INT) ((int*)def.ptr)[index] = (int)lroundf(value);
+    else ((float*)def.ptr)[index] = value;
+}
+
+static float defaultFor(const SettingDef& def, int index) {
+    return def.defs ? def.defs[index] : def.def;
+}
+
+void settingsApplyDefaults() {
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        const SettingDef& def = SETTINGS_TABLE[i];
+        if (def.flags & SETTING_DERIVED) continue;
+        for (int e = 0; e < def.count; e++) settingsSet(def, e, defaultFor(def, e));
+    }
+}
+
+int settingsValidate() {
+    int corrected = 0;
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        const SettingDef& def = SETTINGS_TABLE[i];
+        if (def.flags & SETTING_DERIVED) continue;
+        for (int e = 0; e < def.count; e++) {
+            float v = settingsGet(def, e);
+            float fixed = v;
+            if (!isfinite(v)) fixed = defaultFor(def, e);
+            else if (v < def.minVal) fixed = def.minVal;
+            else if (v > def.maxVal) fixed = def.maxVal;
+            if (fixed != v) {
+                Serial.printf("[WARN] Setting %s[%d]=%.3f out of range [%.1f, %.1f], using %.3f\n",
+                              def.key, e, v, def.minVal, def.maxVal, fixed);
+                settingsSet(def, e, fixed);
+                corrected++;
+            }
+        }
+    }
+    return corrected;
+}
+
+size_t settingsPayloadSize() {
+    return SETTINGS_PAYLOAD_SIZE;
+}
+
+size_t settingsPersistedRows() {
+    size_t n = 0;
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        if (SETTINGS_TABLE[i].flags & SETTING_PERSIST) n++;
+    }
+    return n;
+}
+
+static uint32_t fnvBytes(uint32_t h, const char* key) {
+    for (const char* c = key; *c; c++) { h ^= (uint8_t)*c; h *= 16777619u; }
+    return h;
+}
+
+// FNV-1a over a row's key, type and count, as the untagged payloads were hashed
+static uint32_t fnvRow(uint32_t h, const char* key, uint8_t type, uint8_t count) {
+    h = fnvBytes(h, key);
+    h ^= type;  h *= 16777619u;
+    h ^= count; h *= 16777619u;
+    return h;
+}
+
+uint32_t settingsSchemaHash() {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        const SettingDef& def = SETTINGS_TABLE[i];
+        if (!(def.flags & SETTING_PERSIST)) continue;
+        h = fnvRow(h, def.key, def.type, def.count);
+    }
+    return h;
+}
+
+uint32_t settingsKeyTag(const char* key) {
+    return fnvBytes(2166136261u, key);
+}
+
+size_t settingsPack(uint8_t* buf, size_t len) {
+    if (len < SETTINGS_PAYLOAD_SIZE) return 0;
+    size_t off = 0;
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        const SettingDef& def = SETTINGS_TABLE[i];
+        if (!(def.flags & SETTING_PERSIST)) continue;
+        uint32_t tag = settingsKeyTag(def.key);
+        memcpy(buf + off, &tag, sizeof(tag));
+        buf[off + 4] = def.type;
+        buf[off + 5] = def.count;
+        off += PAYLOAD_ROW_HEADER;
+        memcpy(buf + off, def.ptr, def.count * 4); // float and int are both 4 bytes
+        off += def.count * 4;
+    }
+    return off;
+}
+
+// Copy one stored row into its setting if the type and count still match.
+// restored[] marks the persisted rows that received a value.
+static bool applyRow(const SettingDef* def, uint8_t type, uint8_t count, const uint8_t* data, bool* restored) {
+    if (!def || !(def->flags & SETTING_PERSIST)) return false; // Setting no longer persisted
+    if (def->type != type || def->count != count) {
+        Serial.printf("[WARN] Stored setting %s changed type/size, using its default.\n", def->key);
+        return false;
+    }
+    memcpy(def->ptr, data, count * 4);
+    restored[def - SETTINGS_TABLE] = true;
+    return true;
+}
+
+// Reset the persisted rows the payload did not provide
+static void defaultMissingRows(const bool* restored) {
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        const SettingDef& def = SETTINGS_TABLE[i];
+        if (!(def.flags & SETTING_PERSIST) || restored[i]) continue;
+        for (int e = 0; e < def.count; e++) settingsSet(def, e, defaultFor(def, e));
+    }
+}
+
+static const SettingDef* findByTag(uint32_t tag) {
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        if ((SETTINGS_TABLE[i].flags & SETTING_PERSIST) && settingsKeyTag(SETTINGS_TABLE[i].key) == tag) {
+            return &SETTINGS_TABLE[i];
+        }
+    }
+    return nullptr;
+}
+
+int settingsUnpack(const uint8_t* buf, size_t len) {
+    // Walk the rows once to check the framing, so a bad payload changes nothing
+    size_t off = 0;
+    while (off < len) {
+        if (len - off < PAYLOAD_ROW_HEADER || len - off - PAYLOAD_ROW_HEADER < (size_t)buf[off + 5] * 4) return -1;
+        off += PAYLOAD_ROW_HEADER + buf[off + 5] * 4;
+    }
+
+    bool restored[SETTINGS_TABLE_COUNT] = {};
+    int rows = 0;
+    for (off = 0; off < len; off += PAYLOAD_ROW_HEADER + buf[off + 5] * 4) {
+        uint32_t tag;
+        memcpy(&tag, buf + off, sizeof(tag));
+        if (applyRow(findByTag(tag), buf[off + 4], buf[off + 5], buf + off + PAYLOAD_ROW_HEADER, restored)) rows++;
+    }
+    defaultMissingRows(restored);
+    return rows;
+}
+
+// === Untagged Layouts ===
+// Persisted rows of the untagged payloads, in payload order, with the layout
+// revision that added each one. Revision 0 is also the v1 blob struct.
+// Frozen: new settings are never added here.
+struct PositionalRow {
+    const char* key;
+    uint8_t type;
+    uint8_t count;
+    uint8_t revision;
+};
+
+static constexpr PositionalRow POSITIONAL_ROWS[] = {
+    { "gridCols",        SETTING_INT,   1, 0 },
+    { "gridRows",        SETTING_INT,   1, 0 },
+    { "trayWidth",       SETTING_FLOAT, 1, 0 },
+    { "trayHeight",      SETTING_FLOAT, 1, 0 },
+    { "pnpOffsetX",      SETTING_FLOAT, 1, 0 },
+    { "pnpOffsetY",      SETTING_FLOAT, 1, 0 },
+    { "pnpPickX",        SETTING_FLOAT, 1, 0 },
+    { "pnpPickY",        SETTING_FLOAT, 1, 0 },
+    { "pnpPickZ",        SETTING_FLOAT, 1, 0 },
+    { "pnpPlaceZ",       SETTING_FLOAT, 1, 0 },
+    { "firstPlaceX",     SETTING_FLOAT, 1, 0 },
+    { "firstPlaceY",     SETTING_FLOAT, 1, 0 },
+    { "patXSpeed",       SETTING_FLOAT, 1, 0 },
+    { "patYSpeed",       SETTING_FLOAT, 1, 0 },
+    { "paintGunOffsetX", SETTING_FLOAT, 1, 0 },
+    { "paintGunOffsetY", SETTING_FLOAT, 1, 0 },
+    { "patternOffsetX",  SETTING_FLOAT, 1, 0 },
+    { "patternOffsetY",  SETTING_FLOAT, 1, 0 },
+    { "sweepOT",         SETTING_INT,   1, 2 }, // Sweep run-in/run-out
+    { "paintZ",          SETTING_FLOAT, 4, 0 },
+    { "paintP",          SETTING_INT,   4, 0 },
+    { "paintR",          SETTING_INT,   4, 0 },
+    { "paintS",          SETTING_FLOAT, 4, 0 },
+    { "paintStartX",     SETTING_FLOAT, 4, 0 },
+    { "paintStartY",     SETTING_FLOAT, 4, 0 },
+    { "sprayW",          SETTING_FLOAT, 4, 1 }, // Spray width pass planning
+    { "sprayOvl",        SETTING_FLOAT, 4, 1 },
+};
+#define POSITIONAL_REVISIONS 3
+
+// Stored by the untagged layouts and the legacy keys but never read by the
+// firmware that wrote them (every side started at 25/30). Migrated settings
+// take the default instead, which is that start, so the paths do not move.
+static bool unusedBeforeTagged(const char* key) {
+    return strcmp(key, "paintStartX") == 0 || strcmp(key, "paintStartY") == 0;
+}
+
+int settingsPositionalRevision(uint32_t schemaHash) {
+    for (int rev = 0; rev < POSITIONAL_REVISIONS; rev++) {
+        uint32_t h = 2166136261u;
+        for (const PositionalRow& row : POSITIONAL_ROWS) {
+            if (row.revision <= rev) h = fnvRow(h, row.key, row.type, row.count);
+        }
+        if (h == schemaHash) return rev;
+    }
+    return -1;
+}
+
+int settingsUnpackPositional(int revision, const uint8_t* buf, size_t len) {
+    if (revision < 0 || revision >= POSITIONAL_REVISIONS) return -1;
+    size_t expected = 0;
+    for (const PositionalRow& row : POSITIONAL_ROWS) {
+        if (row.revision <= revision) expected += row.count * 4;
+    }
+    if (len != expected) return -1;
+
+    bool restored[SETTINGS_TABLE_COUNT] = {};
+    int rows = 0;
+    size_t off = 0;
+    for (const PositionalRow& row : POSITIONAL_ROWS) {
+        if (row.revision > revision) continue;
+        if (!unusedBeforeTagged(row.key) && applyRow(settingsFind(row.key), row.type, row.count, buf + off, restored)) rows++;
+        off += row.count * 4;
+    }
+    defaultMissingRows(restored);
+    return rows;
+}
+
+int settingsLoadLegacy() {
+    int found = 0;
+    settingsApplyDefaults();
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        const SettingDef& def = SETTINGS_TABLE[i];
+        if (!def.legacyKey || !preferences.isKey(def.legacyKey)) continue;
+        if (unusedBeforeTagged(def.key)) continue; // Keeps the default; erased with the rest
+        if (def.count > 1) {
+            // Arrays were stored as raw byte blobs
+            size_t bytesRead = preferences.getBytes(def.legacyKey, def.ptr, def.count * 4);
+            if (bytesRead != (size_t)def.count * 4) {
+                Serial.printf("[WARN] Legacy key %s: expected %d bytes, read %d. Using defaults.\n",
+                              def.legacyKey, def.count * 4, (int)bytesRead);
+                for (int e = 0; e < def.count; e++) settingsSet(def, e, defaultFor(def, e));
+                continue;
+            }
+        } else if (def.type == SETTING_INT) {
+            *(int*)def.ptr = preferences.getInt(def.legacyKey, (int)def.def);
+        } else {
+            *(float*)def.ptr = preferences.getFloat(def.legacyKey, def.def);
+        }
+        found++;
+    }
+    return found;
+}
+
+bool settingsHasLegacy() {
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        const char* key = SETTINGS_TABLE[i].legacyKey;
+        if (key && preferences.isKey(key)) return true;
+    }
+    return false;
+}
+
+int settingsEraseLegacy() {
+    int removed = 0;
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        const char* key = SETTINGS_TABLE[i].legacyKey;
+        if (key && preferences.isKey(key) && preferences.remove(key)) removed++;
+    }
+    return removed;
+}
+
+static uint32_t elementBits(const SettingDef& def, int index) {
+    uint32_t bits;
+    memcpy(&bits, (const uint8_t*)def.ptr + index * 4, sizeof(bits));
+    return bits;
+}
+
+uint32_t settingsScanChanges() {
+    uint32_t next = currentVersion + 1;
+    bool changed = false;
+    size_t idx = 0;
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        const SettingDef& def = SETTINGS_TABLE[i];
+        if (!(def.flags & SETTING_JSON)) continue;
+        for (int e = 0; e < def.count; e++, idx++) {
+            uint32_t bits = elementBits(def, e);
+            if (currentVersion == 0 || bits != shadowBits[idx]) {
+                shadowBits[idx] = bits;
+                changedAt[idx] = next;
+                changed = true;
+            }
+        }
+    }
+    if (changed) currentVersion = next;
+    return currentVersion;
+}
+
+uint32_t settingsVersion() {
+    return currentVersion;
+}
+
+uint32_t settingsVersionExcept(uint8_t flags) {
+    uint32_t version = 0;
+    size_t idx = 0;
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        const SettingDef& def = SETTINGS_TABLE[i];
+        if (!(def.flags & SETTING_JSON)) continue;
+        for (int e = 0; e < def.count; e++, idx++) {
+            if (!(def.flags & flags) && changedAt[idx] > version) version = changedAt[idx];
+        }
+    }
+    return version;
+}
+
+uint32_t settingsEpoch() {
+    if (bootEpoch == 0) bootEpoch = (uint32_t)random(1, 0x7FFFFFFF);
+    return bootEpoch;
+}
+
+int settingsWriteJsonSince(uint32_t sinceVersion, char* buf, size_t len) {
+    size_t pos = 0;
+    size_t idx = 0;
+    if (len > 0) buf[0] = '\0';
+    for (size_t i = 0; i < SETTINGS_TABLE_COUNT; i++) {
+        const SettingDef& def = SETTINGS_TABLE[i];
+        if (!(def.flags & SETTING_JSON)) continue;
+        for (int e = 0; e < def.count; e++, idx++) {
+            if (sinceVersion != 0 && changedAt[idx] <= sinceVersion) continue;
+            int n;
+            const char* sep = (pos == 0) ? "" : ",";
+            char suffix[16] = ""; // "_" + any int
+            if (def.count > 1) snprintf(suffix, sizeof(suffix), "_%d", e);
+            if (def.type == SETTING_INT) {
+                n = snprintf(buf + pos, len - pos, "%s\"%s%s\":%d", sep, def.key, suffix, ((int*)def.ptr)[e]);
+            } else {
+                float v = ((float*)def.ptr)[e];
+                if (!isfinite(v)) v = 0.0f; // JSON has no NaN/Inf
+                n = snprintf(buf + pos, len - pos, "%s\"%s%s\":%.6g", sep, def.key, suffix, v);
+            }
+            if (n < 0 || (size_t)n >= len - pos) return -1; // Truncated
+            pos += n;
+        }
+    }
+    return (int)pos;
+}
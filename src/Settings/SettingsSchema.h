@@ -0,0 +1,180 @@
+#ifndef SETTINGS_SCHEMA_H
+#define SETTINGS_SCHEMA_H
+
+#include <Arduino.h>
+
+// === Settings Schema ===
+// One table describes every configurable setting: its key, storage type, the
+// global it lives in, default and valid range. Defaults, validation, the NVS
+// blob layout, legacy NVS migration and the "settings" JSON object are all
+// generated from this table, so adding a setting means adding one row.
+
+enum SettingType : uint8_t {
+    SETTING_FLOAT = 0,
+    SETTING_INT   = 1
+};
+
+// Setting flags
+#define SETTING_PERSIST 0x01 // Stored in the NVS settings blob
+#define SETTING_JSON    0x02 // Sent in the "settings" object to the UI
+#define SETTING_DERIVED 0x04 // Calculated from other settings (no default/range applied)
+#define SETTING_TRANSFORM 0x08 // Placement applied by the side transform at run time (compiled toolpaths stay valid)
+
+struct SettingDef {
+    const char* key;       // JSON key. Arrays are sent as key_0 .. key_{count-1}
+    const char* legacyKey; // Pre-blob NVS key (nullptr if never stored individually)
+    SettingType type;
+    uint8_t count;         // 1 for scalars, 4 for per-side arrays [Back, Right, Front, Left]
+    uint8_t flags;
+    void* ptr;             // Address of the global (float* or int*)
+    float def;             // Default for every element
+    const float* defs;     // Optional per-element defaults (overrides def)
+    float minVal;
+    float maxVal;
+};
+
+/**
+ * @brief Access the schema table.
+ * @param count Receives the number of rows.
+ * @return Pointer to the first row.
+ */
+const SettingDef* settingsSchema(size_t& count);
+
+/**
+ * @brief Find a schema row by JSON key (without the _i suffix).
+ * @return nullptr if not found.
+ */
+const SettingDef* settingsFind(const char* key);
+
+/**
+ * @brief Read/write element 'index' of a setting as float regardless of its storage type.
+ */
+float settingsGet(const SettingDef& def, int index);
+void settingsSet(const SettingDef& def, int index, float value);
+
+/**
+ * @brief Reset every non-derived setting to its schema default.
+ */
+void settingsApplyDefaults();
+
+/**
+ * @brief Clamp every non-derived setting into its [min, max] range.
+ * Non-finite values are reset to the default.
+ * @return Number of values that had to be corrected.
+ */
+int settingsValidate();
+
+// === Persistent Payload ===
+// The payload is a list of tagged rows, one per SETTING_PERSIST row:
+//   uint32 tag (settingsKeyTag(key)) | uint8 type | uint8 count | count x 4 bytes
+// Unpacking matches rows by tag, so adding, removing or reordering settings
+// keeps every other stored value; rows the payload lacks get their default.
+
+/**
+ * @brief Size in bytes of the packed persistent payload.
+ */
+size_t settingsPayloadSize();
+
+/**
+ * @brief Number of SETTING_PERSIST rows (a complete payload restores all of them).
+ */
+size_t settingsPersistedRows();
+
+/**
+ * @brief Hash of the persistent rows (keys, types, counts, order).
+ * Informational only: stored payloads are tagged and do not depend on it.
+ */
+uint32_t settingsSchemaHash();
+
+/**
+ * @brief Tag of a setting key in the persistent payload (FNV-1a of the key).
+ */
+uint32_t settingsKeyTag(const char* key);
+
+/**
+ * @brief Pack all SETTING_PERSIST values into buf as tagged rows.
+ * @return Bytes written, or 0 if buf is too small.
+ */
+size_t settingsPack(uint8_t* buf, size_t len);
+
+/**
+ * @brief Apply a payload produced by settingsPack() (by this or another firmware).
+ * Rows are matched by tag; unknown rows and rows whose type or count changed are
+ * skipped, and persisted settings missing from the payload are reset to their
+ * default. A malformed payload is rejected before anything is applied.
+ * @return Number of rows restored, or -1 if the payload is malformed.
+ */
+int settingsUnpack(const uint8_t* buf, size_t len);
+
+// Untagged payloads written before the tagged format (settings blob v1/v2,
+// recipe format 1) are plain values in table order. Their layout revisions are
+// frozen in SettingsSchema.cpp so they can still be read once.
+
+/**
+ * @brief Layout revision of an untagged payload from the schema hash stored with it.
+ * @return Revision, or -1 if no known layout has that hash.
+ */
+int settingsPositionalRevision(uint32_t schemaHash);
+
+/**
+ * @brief Apply an untagged payload of the given layout revision (same rules as settingsUnpack()).
+ * @return Number of rows restored, or -1 if the revision is unknown or len does not match it.
+ */
+int settingsUnpackPositional(int revision, const uint8_t* buf, size_t len);
+
+/**
+ * @brief Read the pre-blob one-key-per-value NVS layout into the globals.
+ * Missing keys keep their schema default. Caller must have preferences open.
+ * @return Number of legacy keys found.
+ */
+int settingsLoadLegacy();
+
+/**
+ * @brief Whether any pre-blob NVS key is still present. Caller must have preferences open.
+ */
+bool settingsHasLegacy();
+
+/**
+ * @brief Remove the pre-blob NVS keys. Caller must have preferences open read-write.
+ * @return Number of keys removed.
+ */
+int settingsEraseLegacy();
+
+// === Versioning ===
+// Every JSON element carries the settings version at which it last changed.
+// Versions only grow within one boot; settingsEpoch() identifies the boot so
+// clients can tell a stale version number from a different run.
+
+/**
+ * @brief Compare all JSON settings against the last scan and stamp changed
+ * elements with a new version. Cheap (a few dozen 4-byte compares).
+ * @return The current settings version (unchanged if nothing differed).
+ */
+uint32_t settingsScanChanges();
+
+/**
+ * @brief Current settings version (as of the last settingsScanChanges()).
+ */
+uint32_t settingsVersion();
+
+/**
+ * @brief Latest version at which a JSON element of a row without any of the
+ * given flags changed (as of the last settingsScanChanges()).
+ * E.g. SETTING_TRANSFORM keys a cache that placement changes should not drop.
+ */
+uint32_t settingsVersionExcept(uint8_t flags);
+
+/**
+ * @brief Random non-zero id chosen once per boot.
+ */
+uint32_t settingsEpoch();
+
+/**
+ * @brief Write SETTING_JSON elements changed after sinceVersion as comma-separated
+ * "key":value pairs (no surrounding braces) into buf. sinceVersion 0 writes all.
+ * No heap allocation.
+ * @return Characters written (0 if nothing changed), or -1 if buf was too small.
+ */
+int settingsWriteJsonSince(uint32_t sinceVersion, char* buf, size_t len);
+
+#endif // SETTINGS_SCHEMA_H
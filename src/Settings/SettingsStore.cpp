@@ -0,0 +1,187 @@
+#include "SettingsStore.h"
+#include "SettingsSchema.h"
+#include "../Main/SharedGlobals.h"
+
+// === Internal State ===
+static uint8_t committedBlob[SETTINGS_BLOB_MAX]; // Copy of what is currently in flash
+static size_t committedSize = 0;                 // 0 = nothing committed/loaded yet
+static bool dirty = false;                       // Settings changed since last commit check
+static unsigned long lastDirtyTime = 0;          // millis() of the most recent edit
+static bool legacyKeysPending = false;           // Pre-blob keys to erase once a blob is in flash
+
+// Plain CRC32 (reflected, poly 0xEDB88320). The blob is ~380 bytes, so a
+// table is not worth the flash.
+uint32_t settingsCrc32(uint32_t crc, const void* data, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    crc = ~crc;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= bytes[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+// Build the full blob (header + payload + CRC) from the live globals
+static size_t buildBlob(uint8_t* blob) {
+    SettingsBlobHeader header;
+    header.version = SETTINGS_BLOB_VERSION;
+    header.payloadSize = (uint16_t)settingsPayloadSize();
+    header.schemaHash = settingsSchemaHash();
+    memcpy(blob, &header, sizeof(header));
+
+    size_t payload = settingsPack(blob + sizeof(header), SETTINGS_BLOB_MAX - sizeof(header) - sizeof(uint32_t));
+    if (payload == 0) return 0;
+
+    size_t crcOffset = sizeof(header) + payload;
+    uint32_t crc = settingsCrc32(0, blob, crcOffset);
+    memcpy(blob + crcOffset, &crc, sizeof(crc));
+    return crcOffset + sizeof(crc);
+}
+
+// Apply a CRC-checked blob of any known version.
+// @return Rows restored, or -1 if the layout is not understood.
+static int applyBlob(const uint8_t* blob, size_t size) {
+    uint16_t version;
+    memcpy(&version, blob, sizeof(version));
+    if (version == 1) {
+        // v1: uint16 version, uint16 size, the revision 0 values, CRC
+        return settingsUnpackPositional(0, blob + 4, size - 4 - sizeof(uint32_t));
+    }
+    SettingsBlobHeader header;
+    if (size < sizeof(header) + sizeof(uint32_t)) return -1;
+    memcpy(&header, blob, sizeof(header));
+    if (header.payloadSize != size - sizeof(header) - sizeof(uint32_t)) return -1;
+    if (version == 2) {
+        return settingsUnpackPositional(settingsPositionalRevision(header.schemaHash), blob + sizeof(header), header.payloadSize);
+    }
+    if (version == SETTINGS_BLOB_VERSION) {
+        return settingsUnpack(blob + sizeof(header), header.payloadSize);
+    }
+    return -1;
+}
+
+bool settingsStoreLoad() {
+    if (!preferences.begin(SETTINGS_NVS_NAMESPACE, true)) {
+        Serial.println("[ERROR] SettingsStore: Failed to open NVS namespace for reading!");
+        settingsApplyDefaults();
+        return false;
+    }
+
+    static uint8_t blob[SETTINGS_BLOB_MAX];
+    size_t stored = preferences.getBytesLength(SETTINGS_BLOB_KEY);
+    size_t bytesRead = 0;
+    if (stored > 4 + sizeof(uint32_t) && stored <= sizeof(blob)) {
+        bytesRead = preferences.getBytes(SETTINGS_BLOB_KEY, blob, stored);
+    }
+    legacyKeysPending = settingsHasLegacy();
+
+    if (stored == 0) {
+        // First boot after the upgrade from one key per value
+        int found = settingsLoadLegacy(); // Schema-driven; missing keys keep their defaults
+        preferences.end();
+        Serial.printf("[INFO] SettingsStore: No settings blob, migrated %d legacy NVS keys.\n", found);
+        settingsValidate();
+        settingsStoreMarkDirty(); // Blob is written from loop() once idle, then the keys are erased
+        return found > 0;
+    }
+    preferences.end();
+
+    int rows = -1;
+    uint16_t version = 0;
+    if (bytesRead == stored) {
+        memcpy(&version, blob, sizeof(version));
+        uint32_t storedCrc;
+        memcpy(&storedCrc, blob + stored - sizeof(storedCrc), sizeof(storedCrc));
+        if (settingsCrc32(0, blob, stored - sizeof(storedCrc)) == storedCrc) {
+            rows = applyBlob(blob, stored);
+        }
+    }
+    if (rows < 0) {
+        // A blob exists, so the legacy keys are older than it: never fall back to them
+        Serial.printf("[WARN] SettingsStore: Settings blob unusable (v%u, %u bytes), using defaults.\n",
+                      version, (unsigned)stored);
+        settingsApplyDefaults();
+        settingsStoreMarkDirty();
+        return false;
+    }
+
+    bool current = version == SETTINGS_BLOB_VERSION && stored == sizeof(SettingsBlobHeader) + settingsPayloadSize() + sizeof(uint32_t);
+    if (settingsValidate() > 0 || !current) {
+        settingsStoreMarkDirty(); // Persist corrected values / rewrite in the current layout
+    } else {
+        memcpy(committedBlob, blob, stored);
+        committedSize = stored;
+        dirty = false;
+    }
+    Serial.printf("[INFO] SettingsStore: Loaded settings blob v%u (%u bytes, %d rows)%s.\n",
+                  version, (unsigned)stored, rows, current ? "" : ", will be rewritten");
+    return true;
+}
+
+void settingsStoreMarkDirty() {
+    dirty = true;
+    lastDirtyTime = millis();
+}
+
+bool settingsStoreIsDirty() {
+    return dirty;
+}
+
+bool settingsStoreCommitNow() {
+    if (!dirty && !legacyKeysPending) return true;
+    dirty = false;
+
+    static uint8_t blob[SETTINGS_BLOB_MAX];
+    size_t size = buildBlob(blob);
+    if (size == 0) {
+        Serial.println("[ERROR] SettingsStore: Settings payload exceeds SETTINGS_BLOB_MAX!");
+        return false;
+    }
+
+    // Skip the flash write entirely if nothing actually changed
+    bool unchanged = size == committedSize && memcmp(blob, committedBlob, size) == 0;
+    if (unchanged && !legacyKeysPending) {
+        return true;
+    }
+
+    if (!preferences.begin(SETTINGS_NVS_NAMESPACE, false)) {
+        Serial.println("[ERROR] SettingsStore: Failed to open NVS namespace for writing!");
+        dirty = true; // Retry on a later loop
+        lastDirtyTime = millis();
+        return false;
+    }
+    unsigned long startUs = micros();
+    size_t bytesWritten = unchanged ? size : preferences.putBytes(SETTINGS_BLOB_KEY, blob, size);
+    if (bytesWritten == size && legacyKeysPending) {
+        // The blob now holds everything the old keys did
+        int removed = settingsEraseLegacy();
+        legacyKeysPending = false;
+        Serial.printf("[INFO] SettingsStore: Erased %d legacy NVS keys.\n", removed);
+    }
+    preferences.end();
+
+    if (bytesWritten != size) {
+        Serial.printf("[ERROR] SettingsStore: Blob write failed (%u of %u bytes).\n",
+                      (unsigned)bytesWritten, (unsigned)size);
+        dirty = true;
+        lastDirtyTime = millis();
+        return false;
+    }
+    if (unchanged) return true;
+
+    memcpy(committedBlob, blob, size);
+    committedSize = size;
+    Serial.printf("[INFO] SettingsStore: Settings committed (%u bytes, %lu us).\n",
+                  (unsigned)size, micros() - startUs);
+    return true;
+}
+
+void settingsStoreLoop() {
+    if (!dirty && !legacyKeysPending) return;
+    if (millis() - lastDirtyTime < SETTINGS_COMMIT_DEBOUNCE_MS) return;
+    // Flash writes stall the cache; don't commit while steppers are being driven
+    if (isMoving || isHoming || isPainting) return;
+    settingsStoreCommitNow();
+}
@@ -0,0 +1,74 @@
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <Arduino.h>
+
+// === Settings Store ===
+// Write-behind persistence for all configurable settings.
+// The whole settings set is kept in NVS as ONE versioned blob with a CRC
+// (key SETTINGS_BLOB_KEY) instead of one NVS key per value.
+//
+// saveSettings() only marks the store dirty. settingsStoreLoop() (called from
+// loop()) commits the blob once the settings have been quiet for
+// SETTINGS_COMMIT_DEBOUNCE_MS, the machine is idle, and the content actually
+// differs from what is already in flash.
+//
+// Blobs of older layouts (v1 struct, v2 untagged payload) and the pre-blob
+// one-key-per-value layout are migrated once: they are read, the settings are
+// rewritten as a current blob, and after that write the legacy keys are erased.
+// Once any blob exists the legacy keys are never read again.
+
+#define SETTINGS_NVS_NAMESPACE "paint-machine"
+#define SETTINGS_BLOB_KEY "settings"
+#define SETTINGS_BLOB_VERSION 3 // 3 = tagged payload, 2 = untagged payload, 1 = fixed struct
+#define SETTINGS_COMMIT_DEBOUNCE_MS 1500 // Quiet time after the last edit before writing flash
+
+// On-flash layout: SettingsBlobHeader, the schema-packed payload
+// (see SettingsSchema.h), then a CRC32 over header + payload.
+// (v1 blobs start with just version and size.)
+struct SettingsBlobHeader {
+    uint16_t version;          // SETTINGS_BLOB_VERSION
+    uint16_t payloadSize;      // settingsPayloadSize() when written
+    uint32_t schemaHash;       // settingsSchemaHash() when written (v2: selects the untagged layout)
+};
+
+#define SETTINGS_BLOB_MAX 512 // Upper bound for header + payload + CRC
+
+/**
+ * @brief Load the settings blob from NVS with a single read.
+ * Applies and validates the values. Without a blob the legacy keys are migrated;
+ * with an unusable blob (bad CRC, unknown layout) every setting is reset to its
+ * default. Anything that is not a current blob is marked dirty to be rewritten.
+ * @return true if the settings came from a valid blob or the legacy keys.
+ */
+bool settingsStoreLoad();
+
+/**
+ * @brief Mark settings as changed. Cheap; does not touch flash.
+ * The commit happens later from settingsStoreLoop() if the content changed.
+ */
+void settingsStoreMarkDirty();
+
+/**
+ * @brief Commit pending changes once debounced and the machine is idle.
+ * Call from loop().
+ */
+void settingsStoreLoop();
+
+/**
+ * @brief Commit pending changes immediately (ignores debounce, not idle state).
+ * @return true if nothing was pending or the write succeeded.
+ */
+bool settingsStoreCommitNow();
+
+/**
+ * @brief True if there are edits that have not been written to flash yet.
+ */
+bool settingsStoreIsDirty();
+
+/**
+ * @brief CRC32 (IEEE). Start with crc = 0; chain calls to checksum data in chunks.
+ */
+uint32_t settingsCrc32(uint32_t crc, const void* data, size_t length);
+
+#endif // SETTINGS_STORE_H
@@ -0,0 +1,211 @@
+#include "BufferedWebSocketsServer.h"
+#include <lwip/priv/sockets_priv.h> // lwip_socket_dbg_get_socket(): the pcb behind a client socket
+#include <lwip/tcp.h>                // tcp_sndbuf()
+#include "../Logging/Log.h"
+
+// Queues start zeroed (the server is a global); each connection resets its own
+BufferedWebSocketsServer::BufferedWebSocketsServer(uint16_t port) : WebSocketsServer(port) {}
+
+void BufferedWebSocketsServer::onEvent(WebSocketServerEvent cbEvent) {
+    userEvent_ = cbEvent;
+    // A slot is reused by the next client: start every connection with empty queues
+    WebSocketsServer::onEvent([this](uint8_t num, WStype_t type, uint8_t* payload, size_t length) {
+        if (type == WStype_CONNECTED || type == WStype_DISCONNECTED) resetClient(num);
+        if (userEvent_) userEvent_(num, type, payload, length);
+    });
+}
+
+void BufferedWebSocketsServer::loop() {
+    WebSocketsServer::loop();
+    flush(WS_FLUSH_BUDGET_US);
+}
+
+// --- Sending ---
+
+static const char STATUS_PREFIX[] = "{\"status\":";
+
+static bool startsWith(const char* payload, size_t length, const char* prefix) {
+    size_t n = strlen(prefix);
+    return length >= n && memcmp(payload, prefix, n) == 0;
+}
+
+static bool isFailureStatus(const char* payload, size_t length) {
+    return startsWith(payload, length, "{\"status\":\"Error\"") || startsWith(payload, length, "{\"status\":\"Stopped\"");
+}
+
+bool BufferedWebSocketsServer::sendTXT(uint8_t num, const char* payload, size_t length) {
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX) return false;
+    if (length == 0) length = strlen(payload);
+    return sendReply(num, payload, length);
+}
+
+bool BufferedWebSocketsServer::broadcastTXT(const char* payload, size_t length) {
+    if (length == 0) length = strlen(payload);
+    if (isFailureStatus(payload, length)) failureBroadcasts_++;
+    bool ok = true;
+    for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+        if (clientIsConnected(i)) ok = sendReply(i, payload, length) && ok;
+    }
+    return ok;
+}
+
+void BufferedWebSocketsServer::setReplyTag(uint8_t num, const char* tag) {
+    if (!tag || num >= WEBSOCKETS_SERVER_CLIENT_MAX) {
+        tagNum_ = -1;
+        tag_[0] = '\0';
+        return;
+    }
+    tagNum_ = num;
+    strncpy(tag_, tag, WS_REPLY_TAG_MAX);
+    tag_[WS_REPLY_TAG_MAX] = '\0';
+}
+
+// The replying client's copy of a status message names the command being handled
+bool BufferedWebSocketsServer::sendReply(uint8_t num, const char* payload, size_t length) {
+    if (num != tagNum_ || !startsWith(payload, length, STATUS_PREFIX)) return send(num, payload, length);
+    if (isFailureStatus(payload, length)) replyFailures_++;
+    if (!tag_[0]) return send(num, payload, length); // Counted only
+
+    // {"status":... -> {"id":"<tag>","status":...
+    static char tagged[WS_TAGGED_REPLY_MAX];
+    int n = snprintf(tagged, sizeof(tagged), "{\"id\":\"%s\",%.*s", tag_, (int)(length - 1), payload + 1);
+    if (n < 0 || n >= (int)sizeof(tagged)) return send(num, payload, length);
+    return send(num, tagged, n);
+}
+
+bool BufferedWebSocketsServer::send(uint8_t num, const char* payload, size_t length) {
+    if (!clientIsConnected(num)) return false; // A failure reply to a gone client still counted above
+    ClientQueue& q = queues_[num];
+    if (q.used == 0 && clientWritable(num, length)) return writeFrame(num, payload, length);
+
+    if (q.used + 2 + length > WS_CLIENT_QUEUE_BYTES) {
+        dropClient(num, "outbound queue full");
+        return false;
+    }
+    if (q.used == 0) q.lastDrainMs = millis(); // Backlog starts now
+    q.data[q.used] = (uint8_t)length;
+    q.data[q.used + 1] = (uint8_t)(length >> 8);
+    memcpy(q.data + q.used + 2, payload, length);
+    q.used += 2 + length;
+    q.stats.deferred++;
+    if (q.used > q.stats.peakBytes) q.stats.peakBytes = q.used;
+    return true;
+}
+
+void BufferedWebSocketsServer::publishTelemetry(WsTopic topic, const char* payload, size_t length) {
+    if (topic >= WS_TOPIC_COUNT) return;
+    if (length == 0) length = strlen(payload);
+    if (length > WS_TELEMETRY_MAX_BYTES) { // Does not fit the topic slot: send it as a normal message
+        broadcastTXT(payload, length);
+        return;
+    }
+    Topic& t = topics_[topic];
+    memcpy(t.data, payload, length);
+    t.length = length;
+
+    uint8_t bit = 1 << topic;
+    for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+        if (!clientIsConnected(i)) continue;
+        ClientQueue& q = queues_[i];
+        if (q.telemetryDirty & bit) q.stats.telemetryDropped++; // The unsent older value is superseded
+        q.telemetryDirty |= bit;
+        if (q.used == 0 && clientWritable(i, t.length)) {
+            q.telemetryDirty &= ~bit;
+            writeFrame(i, t.data, t.length);
+        }
+    }
+}
+
+bool BufferedWebSocketsServer::writeFrame(uint8_t num, const char* payload, size_t length) {
+    uint32_t startUs = micros();
+    bool ok = WebSocketsServer::sendTXT(num, payload, length);
+    if (micros() - startUs > WS_SLOW_SEND_US) queues_[num].stats.slowSends++;
+    return ok;
+}
+
+// True if lwIP can take the whole frame (header + payload) now. The library's
+// write only returns once every byte is in the send buffer, so a socket with
+// just some room would still block for the rest until the client ACKs.
+// snd_buf is read without the core lock: it only grows behind our back (ACKs),
+// so a stale value errs towards queueing.
+bool BufferedWebSocketsServer::clientWritable(uint8_t num, size_t length) {
+    WiFiClient* tcp = _clients[num].tcp;
+    int fd = tcp ? tcp->fd() : -1;
+    if (fd < 0) return true;
+    struct lwip_sock* sock = lwip_socket_dbg_get_socket(fd);
+    struct tcp_pcb* pcb = (sock && sock->conn) ? sock->conn->pcb.tcp : nullptr;
+    if (!pcb) return true; // Closing: let the library report it
+    if (tcp_sndqueuelen(pcb) + 2 > TCP_SND_QUEUELEN) return false; // Header and payload are separate writes
+    size_t frame = length + (length < 126 ? 2 : length < 65536 ? 4 : 10); // Server frames are unmasked
+    if (frame > TCP_SND_BUF) frame = TCP_SND_BUF; // Never fits: send it once the buffer has drained
+    return tcp_sndbuf(pcb) >= frame;
+}
+
+// --- Flushing ---
+
+void BufferedWebSocketsServer::flush(uint32_t budgetUs) {
+    uint32_t startUs = micros();
+    for (uint8_t k = 0; k < WEBSOCKETS_SERVER_CLIENT_MAX; k++) {
+        uint8_t num = (nextFlush_ + k) % WEBSOCKETS_SERVER_CLIENT_MAX;
+        if (!clientIsConnected(num)) continue;
+        ClientQueue& q = queues_[num];
+        if (q.used == 0 && !q.telemetryDirty) continue;
+        if (!flushClient(num, startUs, budgetUs)) {
+            nextFlush_ = num; // Out of time: this client goes first next time
+            return;
+        }
+        if (q.used > 0 && millis() - q.lastDrainMs > WS_CLIENT_STALL_MS) dropClient(num, "not draining");
+    }
+    nextFlush_ = (nextFlush_ + 1) % WEBSOCKETS_SERVER_CLIENT_MAX;
+}
+
+// Returns false if the budget ran out before the client was done
+bool BufferedWebSocketsServer::flushClient(uint8_t num, uint32_t startUs, uint32_t budgetUs) {
+    ClientQueue& q = queues_[num];
+    while (q.used > 0) {
+        if (micros() - startUs >= budgetUs) return false;
+        size_t length = q.data[0] | ((size_t)q.data[1] << 8);
+        if (!clientWritable(num, length)) return true;
+        writeFrame(num, (const char*)q.data + 2, length);
+        if (!clientIsConnected(num)) return true; // Write failed; the disconnect reset the queue
+        q.used -= 2 + length;
+        memmove(q.data, q.data + 2 + length, q.used);
+        q.lastDrainMs = millis();
+    }
+    for (uint8_t topic = 0; topic < WS_TOPIC_COUNT && q.telemetryDirty; topic++) {
+        uint8_t bit = 1 << topic;
+        if (!(q.telemetryDirty & bit)) continue;
+        if (micros() - startUs >= budgetUs) return false;
+        if (!clientWritable(num, topics_[topic].length)) return true;
+        q.telemetryDirty &= ~bit;
+        writeFrame(num, topics_[topic].data, topics_[topic].length);
+        if (!clientIsConnected(num)) return true;
+    }
+    return true;
+}
+
+// Close the TCP connection without a close handshake (that would block on the
+// stalled socket too); the library reports the disconnect on its next loop()
+void BufferedWebSocketsServer::dropClient(uint8_t num, const char* reason) {
+    LOGW("WebSocket client %u dropped: %s (%u bytes queued)", num, reason, (unsigned)queues_[num].used);
+    disconnects_++;
+    resetClient(num);
+    WiFiClient* tcp = _clients[num].tcp;
+    if (tcp && tcp->fd() >= 0) tcp->stop();
+    else WebSocketsServer::disconnect(num);
+}
+
+void BufferedWebSocketsServer::resetClient(uint8_t num) {
+    ClientQueue& q = queues_[num];
+    q.used = 0;
+    q.telemetryDirty = 0;
+    q.lastDrainMs = millis();
+    memset(&q.stats, 0, sizeof(q.stats));
+}
+
+bool BufferedWebSocketsServer::clientStats(uint8_t num, WsClientStats& out) {
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || !clientIsConnected(num)) return false;
+    out = queues_[num].stats;
+    out.pendingBytes = queues_[num].used;
+    return true;
+}
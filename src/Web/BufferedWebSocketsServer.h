@@ -0,0 +1,130 @@
+#ifndef BUFFERED_WEBSOCKETS_SERVER_H
+#define BUFFERED_WEBSOCKETS_SERVER_H
+
+#include <Arduino.h>
+#include <WebSocketsServer.h>
+
+// === Buffered WebSocket Fan-out ===
+// The library writes each frame synchronously, so one client on a weak link
+// stalls every sendTXT()/broadcastTXT() - and those run inside the motion and
+// paint loops. This server keeps a byte-limited outbound queue per client and
+// only writes a frame when the socket's send buffer has room for all of it:
+//  - Status and error messages (everything sent with sendTXT/broadcastTXT)
+//    are reliable: they go out directly when the client's queue is empty and
+//    its socket has room for them, otherwise they queue in order. A client whose
+//    queue would exceed WS_CLIENT_QUEUE_BYTES, or that drains nothing for
+//    WS_CLIENT_STALL_MS, is disconnected instead of holding up the machine.
+//  - Telemetry (publishTelemetry) is latest-value-wins: each topic keeps one
+//    shared copy of its newest message, and a client that cannot take it now
+//    gets only the newest value later. Superseded values are counted as drops.
+// loop() runs the library's loop and then flushes queues round-robin for at
+// most WS_FLUSH_BUDGET_US, so catching up never costs the caller more.
+//
+// The send functions hide the library's (non-virtual) ones, so existing
+// webSocket.sendTXT()/broadcastTXT()/loop() calls are buffered unchanged.
+// Call from the loop task only.
+
+#define WS_CLIENT_QUEUE_BYTES 8192   // Per client: two full settings snapshots
+#define WS_FLUSH_BUDGET_US 2000      // Max time loop() spends writing queued frames
+#define WS_CLIENT_STALL_MS 3000      // Backlogged and not draining this long: disconnect
+#define WS_SLOW_SEND_US 20000        // A single write this slow counts as a slow send
+#define WS_TELEMETRY_MAX_BYTES 200
+#define WS_REPLY_TAG_MAX 16          // Request id carried in tagged replies
+#define WS_TAGGED_REPLY_MAX 512      // Longer status replies go out untagged
+
+enum WsTopic : uint8_t {
+    WS_TOPIC_POSITION, // {"position":{...}}
+    WS_TOPIC_COUNT
+};
+
+struct WsClientStats {
+    uint32_t pendingBytes;     // Queued reliable bytes right now
+    uint32_t peakBytes;        // Most queued at once
+    uint32_t deferred;         // Reliable frames that had to wait in the queue
+    uint32_t telemetryDropped; // Telemetry values superseded before they could be sent
+    uint32_t slowSends;        // Writes that took longer than WS_SLOW_SEND_US
+};
+
+class BufferedWebSocketsServer : public WebSocketsServer {
+public:
+    explicit BufferedWebSocketsServer(uint16_t port);
+
+    void onEvent(WebSocketServerEvent cbEvent);
+    void loop();
+
+    bool sendTXT(uint8_t num, const char* payload, size_t length = 0);
+    bool sendTXT(uint8_t num, const uint8_t* payload, size_t length) { return sendTXT(num, (const char*)payload, length); }
+    bool broadcastTXT(const char* payload, size_t length = 0);
+    bool broadcastTXT(const uint8_t* payload, size_t length) { return broadcastTXT((const char*)payload, length); }
+
+    /**
+     * @brief Send the newest value of a telemetry topic to every client (latest-value-wins).
+     */
+    void publishTelemetry(WsTopic topic, const char* payload, size_t length = 0);
+
+    /**
+     * @brief Write queued frames until the queues are empty or budgetUs has passed.
+     */
+    void flush(uint32_t budgetUs);
+
+    /**
+     * @brief Queue and drop counters of a client, reset when it connects.
+     * @return false if the client is not connected.
+     */
+    bool clientStats(uint8_t num, WsClientStats& out);
+
+    /**
+     * @brief Slow clients disconnected since boot.
+     */
+    uint32_t slowDisconnects() const { return disconnects_; }
+
+    /**
+     * @brief Add "id":"<tag>" to {"status":...} messages for client num until the tag is changed.
+     * Applies to direct replies and to that client's copy of broadcasts. An empty tag
+     * only counts replyFailures(); nullptr stops both.
+     */
+    void setReplyTag(uint8_t num, const char* tag);
+
+    /**
+     * @brief Error/Stopped status messages sent to the client named by setReplyTag(), since boot.
+     */
+    uint32_t replyFailures() const { return replyFailures_; }
+
+    /**
+     * @brief Error/Stopped status messages broadcast since boot.
+     */
+    uint32_t failureBroadcasts() const { return failureBroadcasts_; }
+
+private:
+    struct ClientQueue {
+        uint8_t data[WS_CLIENT_QUEUE_BYTES]; // Frames as [length:u16][payload]
+        size_t used;
+        uint8_t telemetryDirty; // Bit per WsTopic not yet sent to this client
+        uint32_t lastDrainMs;   // Last time the queue was empty or made progress
+        WsClientStats stats;
+    };
+    struct Topic {
+        char data[WS_TELEMETRY_MAX_BYTES];
+        size_t length;
+    };
+
+    bool sendReply(uint8_t num, const char* payload, size_t length); // Adds the reply tag
+    bool send(uint8_t num, const char* payload, size_t length);      // Direct or queued
+    bool clientWritable(uint8_t num, size_t length); // Send buffer has room for the whole frame
+    bool writeFrame(uint8_t num, const char* payload, size_t length); // Timed library write
+    bool flushClient(uint8_t num, uint32_t startUs, uint32_t budgetUs);
+    void dropClient(uint8_t num, const char* reason);
+    void resetClient(uint8_t num);
+
+    ClientQueue queues_[WEBSOCKETS_SERVER_CLIENT_MAX];
+    Topic topics_[WS_TOPIC_COUNT];
+    WebSocketServerEvent userEvent_;
+    uint8_t nextFlush_ = 0; // Round-robin start
+    uint32_t disconnects_ = 0;
+    int8_t tagNum_ = -1; // Client whose command is being handled
+    char tag_[WS_REPLY_TAG_MAX + 1] = "";
+    uint32_t replyFailures_ = 0;
+    uint32_t failureBroadcasts_ = 0;
+};
+
+#endif // BUFFERED_WEBSOCKETS_SERVER_H
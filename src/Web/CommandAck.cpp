@@ -0,0 +1,131 @@
+#include "CommandAck.h"
+#include <esp_timer.h>
+#include "../Logging/Log.h"
+#include "../Main/SharedGlobals.h" // For webSocket and the busy flags
+
+extern volatile bool pendingHomingAfterPnP;
+
+struct PendingAck {
+    bool used;
+    uint8_t num;
+    char id[CMD_ACK_ID_MAX + 1];
+    char cmd[32];
+    int64_t startUs;
+    uint32_t failureBroadcasts; // At the end of the handler
+    bool macro;                 // RUN_MACRO: done when the macro ends, not just its current step
+};
+
+static PendingAck pending[CMD_ACK_PENDING_MAX];
+static CommandAckScope* innermost = nullptr;
+static bool lastOk = true;
+
+// A macro's steps are commands of their own: they are tracked against the
+// operation flags, and RUN_MACRO against macroRunning
+static bool operationBusy() {
+    return isMoving || isHoming || isPainting || pendingHomingAfterPnP;
+}
+
+static bool isIdChar(char c) {
+    return isalnum((unsigned char)c) || c == '_' || c == '-' || c == '.';
+}
+
+size_t commandAckParseId(const uint8_t* payload, size_t length, char* id) {
+    id[0] = '\0';
+    if (length < 3 || payload[0] != '#') return 0;
+    size_t n = 0;
+    while (1 + n < length && n < CMD_ACK_ID_MAX && isIdChar((char)payload[1 + n])) n++;
+    if (n == 0 || 1 + n >= length || payload[1 + n] != ' ') return 0; // Not "#<id> ": leave the frame alone
+    memcpy(id, payload + 1, n);
+    id[n] = '\0';
+    size_t skip = 1 + n;
+    while (skip < length && payload[skip] == ' ') skip++;
+    return skip;
+}
+
+static void sendAck(uint8_t num, const char* id, const char* cmd, const char* state, bool ok,
+                    int64_t startUs, int64_t doneUs) {
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "{\"ack\":\"%s\",\"cmd\":\"%s\",\"state\":\"%s\",\"ok\":%s,\"startUs\":%llu,\"doneUs\":%llu}",
+             id, cmd, state, ok ? "true" : "false",
+             (unsigned long long)startUs, (unsigned long long)doneUs);
+    webSocket.sendTXT(num, msg);
+}
+
+// --- Scope ---
+
+CommandAckScope::CommandAckScope(uint8_t num, const char* id)
+    : num_(num), startUs_(esp_timer_get_time()), busyBefore_(operationBusy()), macroBefore_(macroRunning),
+      rejected_(false), failures_(0), failureBase_(webSocket.replyFailures()), outer_(innermost) {
+    strncpy(id_, id ? id : "", sizeof(id_) - 1);
+    id_[sizeof(id_) - 1] = '\0';
+    strcpy(cmd_, "?");
+    if (outer_) outer_->failures_ += failureBase_ - outer_->failureBase_; // Close the outer command's tally
+    innermost = this;
+    webSocket.setReplyTag(num_, id_); // No id: counted, not tagged, even inside an outer tagged command
+}
+
+CommandAckScope::~CommandAckScope() {
+    innermost = outer_;
+    failures_ += webSocket.replyFailures() - failureBase_;
+    if (outer_) outer_->failureBase_ = webSocket.replyFailures(); // The outer tally resumes here
+    bool ok = !rejected_ && failures_ == 0;
+    lastOk = ok;
+    if (id_[0]) {
+        bool startedMacro = !macroBefore_ && macroRunning;
+        if (ok && ((!busyBefore_ && operationBusy()) || startedMacro)) {
+            sendAck(num_, id_, cmd_, "running", true, startUs_, 0);
+            PendingAck* slot = nullptr;
+            for (int i = 0; i < CMD_ACK_PENDING_MAX && !slot; i++) {
+                if (!pending[i].used) slot = &pending[i];
+            }
+            if (slot) {
+                slot->used = true;
+                slot->num = num_;
+                strcpy(slot->id, id_);
+                strcpy(slot->cmd, cmd_);
+                slot->startUs = startUs_;
+                slot->failureBroadcasts = webSocket.failureBroadcasts();
+                slot->macro = startedMacro;
+            } else {
+                LOGW("[%u] Command ack '%s': too many running commands, no done ack will follow", num_, id_);
+            }
+        } else {
+            sendAck(num_, id_, cmd_, "done", ok, startUs_, esp_timer_get_time());
+        }
+    }
+    if (outer_) webSocket.setReplyTag(outer_->num_, outer_->id_);
+    else webSocket.setReplyTag(0, nullptr);
+}
+
+void CommandAckScope::setCommand(const char* cmd) {
+    strncpy(cmd_, cmd, sizeof(cmd_) - 1);
+    cmd_[sizeof(cmd_) - 1] = '\0';
+}
+
+void commandAckReject() {
+    if (innermost) innermost->rejected_ = true;
+}
+
+bool commandAckLastOk() {
+    return lastOk;
+}
+
+// --- Deferred acks ---
+
+void commandAckLoop() {
+    if (operationBusy()) return; // Every tracked operation ends with the machine idle
+    for (int i = 0; i < CMD_ACK_PENDING_MAX; i++) {
+        PendingAck& p = pending[i];
+        if (!p.used || (p.macro && macroRunning)) continue;
+        p.used = false;
+        bool ok = webSocket.failureBroadcasts() == p.failureBroadcasts;
+        sendAck(p.num, p.id, p.cmd, "done", ok, p.startUs, esp_timer_get_time());
+    }
+}
+
+void commandAckDropClient(uint8_t num) {
+    for (int i = 0; i < CMD_ACK_PENDING_MAX; i++) {
+        if (pending[i].num == num) pending[i].used = false;
+    }
+}
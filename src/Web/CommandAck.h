@@ -0,0 +1,87 @@
+#ifndef COMMAND_ACK_H
+#define COMMAND_ACK_H
+
+#include <Arduino.h>
+#include "BufferedWebSocketsServer.h"
+
+// === Command Acknowledgements ===
+// Any WebSocket command may start with a request id: "#<id> <command ...>"
+// (id: 1..CMD_ACK_ID_MAX of A-Z a-z 0-9 _ - .). The id is stripped before the
+// command is parsed. While the command is handled, the {"status":...}
+// messages the sender receives (replies and its copy of broadcasts) carry
+// "id":"<id>", and the sender gets an ack:
+//   {"ack":"<id>","cmd":"MOVE_TO_COORDS","state":"running"|"done","ok":true,
+//    "startUs":..,"doneUs":..}
+//  - startUs: the command handler started. The library runs the handler as
+//    soon as loop() reads the frame, so time the frame spent in socket
+//    buffers before that is not visible here; it is part of the round trip.
+//  - A command that leaves the machine newly busy (move, homing, painting, macro)
+//    is acked "running" when its handler returns, then "done" from loop()
+//    once the machine is idle again; doneUs is 0 until then.
+//  - ok is false if the command was rejected or an Error/Stopped status
+//    reached the sender while it was handled; for a running operation also
+//    if any Error/Stopped status was broadcast before it finished (a STOP or
+//    ESTOP from another client, a motion fault, a failed step).
+// All times are esp_timer_get_time() microseconds since boot. Commands
+// without an id are handled as before and get no ack.
+
+#define CMD_ACK_ID_MAX WS_REPLY_TAG_MAX
+#define CMD_ACK_PENDING_MAX 8 // Running operations awaiting their "done" ack
+
+/**
+ * @brief Split a leading "#<id> " off a command frame.
+ * @param id Receives the id (CMD_ACK_ID_MAX + 1 bytes); empty if there is none.
+ * @return Bytes to skip to reach the command (0 if there is no valid id prefix).
+ */
+size_t commandAckParseId(const uint8_t* payload, size_t length, char* id);
+
+/**
+ * @brief One command being handled: tags its replies and sends its ack when it goes out of scope.
+ * Scopes nest (blocking handlers pump webSocket.loop(), which may handle
+ * further commands); the innermost scope owns the reply tag.
+ */
+class CommandAckScope {
+public:
+    CommandAckScope(uint8_t num, const char* id);
+    ~CommandAckScope();
+
+    /** @brief Name the command in the ack (called once it is parsed). */
+    void setCommand(const char* cmd);
+
+private:
+    friend void commandAckReject();
+
+    uint8_t num_;
+    char id_[CMD_ACK_ID_MAX + 1];
+    char cmd_[32];
+    int64_t startUs_;
+    bool busyBefore_;      // An operation was running when the command arrived
+    bool macroBefore_;
+    bool rejected_;
+    uint32_t failures_;    // Error/Stopped statuses sent to the sender while this command was innermost
+    uint32_t failureBase_; // webSocket.replyFailures() when this command last became innermost
+    CommandAckScope* outer_;
+};
+
+/**
+ * @brief Mark the command being handled as rejected (for refusals that are not Error statuses).
+ */
+void commandAckReject();
+
+/**
+ * @brief Whether the last command handled succeeded, by the same rule as its ack's ok
+ * (with or without an id). BATCH and RUN_MACRO use it to stop at the first failure.
+ */
+bool commandAckLastOk();
+
+/**
+ * @brief Send "done" acks for operations that have finished. Call from loop().
+ */
+void commandAckLoop();
+
+/**
+ * @brief Forget the pending acks of a client that disconnected.
+ */
+void commandAckDropClient(uint8_t num);
+
+#endif // COMMAND_ACK_H
@@ -0,0 +1,86 @@
+#include "NetworkManager.h"
+#include <WiFi.h>
+#include <ArduinoOTA.h>
+#include "WebHandler.h"
+#include "../Main/GeneralSettings_PinDef.h" // For ssid / password / hostname
+#include "../Main/SharedGlobals.h"
+#include "../Main/BootTiming.h"
+
+// === Internal State ===
+static bool servicesUp = false;
+static bool linkUp = false;
+static unsigned long lastAttemptTime = 0;
+static unsigned long reconnectDelayMs = WIFI_RECONNECT_MIN_MS;
+static uint32_t reconnectCount = 0;
+
+static void startOta() {
+    ArduinoOTA.setHostname(hostname);
+    // ArduinoOTA.setPassword("your_ota_password"); // Optional: set password
+    ArduinoOTA
+        .onStart([]() {
+            isMoving = true; // Prevent web commands during OTA
+            isHoming = true; // Prevent web commands during OTA
+            if(stepper_x) stepper_x->forceStopAndNewPosition(stepper_x->getCurrentPosition());
+            if(stepper_y_left) stepper_y_left->forceStopAndNewPosition(stepper_y_left->getCurrentPosition());
+            if(stepper_y_right) stepper_y_right->forceStopAndNewPosition(stepper_y_right->getCurrentPosition());
+            if(stepper_z) stepper_z->forceStopAndNewPosition(stepper_z->getCurrentPosition());
+        })
+        .onEnd([]() { /* Serial.println("\nEnd"); */ })
+        .onProgress([](unsigned int /*progress*/, unsigned int /*total*/) { /* Serial.printf("Progress: %u%%\r", (progress / (total / 100))); */ })
+        .onError([](ota_error_t /*error*/) { /* Error handling */ });
+    ArduinoOTA.begin();
+}
+
+void networkBegin() {
+    bootPhaseBegin(BOOT_WIFI_LINK);
+    WiFi.setHostname(hostname);
+    WiFi.mode(WIFI_STA);
+    WiFi.setAutoReconnect(false); // Reconnects are paced by networkLoop()
+    WiFi.begin(ssid, password);
+    lastAttemptTime = millis();
+    Serial.printf("[INFO] WiFi: Connecting to %s in the background...\n", ssid);
+}
+
+void networkLoop() {
+    bool connected = (WiFi.status() == WL_CONNECTED);
+
+    if (connected && !linkUp) {
+        linkUp = true;
+        reconnectDelayMs = WIFI_RECONNECT_MIN_MS;
+        bootPhaseEnd(BOOT_WIFI_LINK);
+        IPAddress ip = WiFi.localIP();
+        Serial.printf("[INFO] WiFi: Connected, IP %u.%u.%u.%u\n", ip[0], ip[1], ip[2], ip[3]);
+        if (!servicesUp) {
+            bootPhaseBegin(BOOT_SERVICES);
+            startOta();
+            setupWebServerAndWebSocket();
+            servicesUp = true;
+            bootPhaseEnd(BOOT_SERVICES);
+        }
+    } else if (!connected && linkUp) {
+        linkUp = false;
+        lastAttemptTime = millis();
+        Serial.println("[WARN] WiFi: Link lost, reconnecting with backoff.");
+    }
+
+    // Each attempt gets reconnectDelayMs to associate; the window doubles per failure
+    if (!connected && millis() - lastAttemptTime >= reconnectDelayMs) {
+        reconnectCount++;
+        reconnectDelayMs = min(reconnectDelayMs * 2, (unsigned long)WIFI_RECONNECT_MAX_MS);
+        Serial.printf("[INFO] WiFi: Reconnect attempt %lu (next in %lu ms)\n",
+                      (unsigned long)reconnectCount, reconnectDelayMs);
+        WiFi.disconnect();
+        WiFi.begin(ssid, password);
+        lastAttemptTime = millis();
+    }
+}
+
+bool networkServicesUp() {
+    return servicesUp;
+}
+
+int networkWriteJson(char* buf, size_t len) {
+    int n = snprintf(buf, len, "\"wifi\":{\"connected\":%s,\"rssi\":%d,\"reconnects\":%lu}",
+                     linkUp ? "true" : "false", linkUp ? (int)WiFi.RSSI() : 0, (unsigned long)reconnectCount);
+    return (n < 0 || (size_t)n >= len) ? -1 : n;
+}
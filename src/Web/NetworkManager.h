@@ -0,0 +1,36 @@
+#ifndef NETWORK_MANAGER_H
+#define NETWORK_MANAGER_H
+
+#include <Arduino.h>
+
+// === Network Manager ===
+// Non-blocking WiFi bring-up. networkBegin() only starts the connection; the
+// machine boots and homes while networkLoop() waits for the link, then starts
+// OTA, the web server and the WebSocket server once. If the link drops later
+// it reconnects with exponential backoff; the servers stay bound throughout.
+
+#define WIFI_RECONNECT_MIN_MS 5000   // Time an attempt gets before the first retry
+#define WIFI_RECONNECT_MAX_MS 30000  // Backoff cap
+
+/**
+ * @brief Start connecting to WiFi (returns immediately).
+ */
+void networkBegin();
+
+/**
+ * @brief Drive the connection state machine. Call often (loop, blocking waits).
+ */
+void networkLoop();
+
+/**
+ * @brief True once OTA/HTTP/WebSocket have been started.
+ */
+bool networkServicesUp();
+
+/**
+ * @brief Write "wifi":{"connected":b,"rssi":n,"reconnects":n} into buf.
+ * @return Length written, or -1 if buf is too small.
+ */
+int networkWriteJson(char* buf, size_t len);
+
+#endif // NETWORK_MANAGER_H
@@ -10,7 +10,7 @@
 
 // --- Define Web Server and WebSocket Server Objects ---
 WebServer webServer(80);
-WebSocketsServer webSocket(81);
+BufferedWebSocketsServer webSocket(81); // Per-client queues over the library's server
 
 // --- Forward declarations for functions defined in main.cpp ---
 // (These are declared extern in WebHandler.h, but needed here for the compiler)
@@ -56,17 +56,17 @@ void sendCurrentPositionUpdate() {
             stepper_z ? (float)stepper_z->getCurrentPosition() / STEPS_PER_INCH_Z : 0.0f,
             stepper_rot ? (float)stepper_rot->getCurrentPosition() / STEPS_PER_DEGREE : 0.0f);
     
-    // Broadcast the position to all connected clients
-    webSocket.broadcastTXT(buffer);
+    // Position is telemetry: a client that cannot keep up only gets the newest one
+    webSocket.publishTelemetry(WS_TOPIC_POSITION, buffer);
 }
 
 // Function to send all settings to a client or broadcast to all clients
-void sendAllSettingsUpdate(uint8_t specificClientNum, String message) {
+void sendAllSettingsUpdate(uint8_t specificClientNum, const char* message) {
     // Create JSON buffer with all settings
     char buffer[600]; // Make sure this is large enough
     
     // Format: Basic message + all current settings
-    sprintf(buffer, 
+    snprintf(buffer, sizeof(buffer),
         "{\"status\":\"Settings\",\"message\":\"%s\","
         "\"homed\":%s,"
         "\"pnpOffsetX\":%.2f,\"pnpOffsetY\":%.2f,"
@@ -75,7 +75,7 @@ void sendAllSettingsUpdate(uint8_t specificClientNum, String message) {
         "\"gapX\":%.3f,\"gapY\":%.3f,"
         "\"trayWidth\":%.2f,\"trayHeight\":%.2f,"
         "\"patXSpeed\":%.0f,\"patYSpeed\":%.0f}",
-        message.c_str(),
+        message,
         allHomed ? "true" : "false",
         pnpOffsetX_inch, pnpOffsetY_inch,
         placeFirstXAbsolute_inch, placeFirstYAbsolute_inch,
@@ -4,6 +4,7 @@
 #include <Arduino.h>
 #include <WebServer.h>
 #include <WebSocketsServer.h>
+#include "BufferedWebSocketsServer.h"
 #include <FastAccelStepper.h> // Needed for stepper types in extern declarations
 #include <ESP32Servo.h>     // Needed for Servo type
 
@@ -93,7 +94,7 @@ extern void calculateAndSetGridSpacing(int cols, int rows);
 
 // --- Web Server and WebSocket Objects ---
 extern WebServer webServer;
-extern WebSocketsServer webSocket;
+extern BufferedWebSocketsServer webSocket;
 
 // --- Function Declarations for WebHandler.cpp ---
 void setupWebServerAndWebSocket(); // Renamed from setupWebServer
@@ -102,7 +103,7 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t length
 extern void saveSettings(); // Declare saveSettings defined in main.cpp
 void sendCurrentPositionUpdate(); // Sends position via WebSocket
 void sendCurrentSettings(uint8_t specificClientNum); // NEW Declaration
-void sendAllSettingsUpdate(uint8_t specificClientNum, String message); // Add declaration for sendAllSettingsUpdate
+void sendAllSettingsUpdate(uint8_t specificClientNum, const char* message); // Add declaration for sendAllSettingsUpdate
 extern void setPitchServoAngle(int angle); // Declaration for the new function
 
 
@@ -0,0 +1,295 @@
+// Host micro-benchmarks for the firmware's compute paths.
+//
+// Links the real firmware sources against the host Arduino shim
+// (tools/host_shim), boots them with setup() (settings defaults, simulated
+// homing) and times:
+//     ws_unknown_command      webSocketEvent() walking the whole command chain
+//     ws_get_settings_delta   webSocketEvent() for an up-to-date GET_SETTINGS
+//     ws_set_feed_override    webSocketEvent() parsing a command with an argument
+//     send_current_settings   sendCurrentSettings(): full settings/status JSON
+//     grid_spacing            calculateAndSetGridSpacing() for the current grid
+//     place_table             compilePlaceTable(): PnP place targets
+//     toolpath_side_N         Side N's toolpath built and compiled from the settings
+//     toolpath_raster_45      Back side compiled as a 45 degree raster
+//
+// Replies go to a counting sink and the firmware log to stderr, so run with
+// 2>/dev/null for a quiet console.
+//
+// Build (from the repo root):
+//     g++ -O2 -std=gnu++17 -pthread -I tools/host_shim -I src -o bench tools/bench/bench.cpp
+//         tools/host_shim/*.cpp $(find src -name '*.cpp')
+//
+// Usage:
+//     bench [--filter SUBSTR] [--samples N] [--min-sample-ms MS] [--out FILE]
+//         Run the cases (optionally only names containing SUBSTR) and write
+//         JSON to FILE (default stdout).
+//     bench --compare BASE.json NEW.json [--threshold PCT]
+//         Compare the median ns/op of two runs. Cases slower by more than PCT
+//         (default 10) are flagged and the exit status is 1.
+//
+// Output has one case per line so --compare can read it back without a JSON
+// library:
+//     {"bench":"firmware-host","samples":N,"cases":[
+//     {"name":"...","iterations":N,"nsPerOp":{"min":..,"median":..,"mean":..,"p90":..}},
+//     ...]}
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <WebSocketsServer.h>
+#include "Main/SharedGlobals.h"
+#include "Settings/SettingsSchema.h"
+#include "Painting/Patterns/ToolpathCompiler.h"
+#include "Painting/Patterns/ToolpathExecutor.h"
+
+// Firmware entry points (main.cpp)
+void setup();
+void webSocketEvent(uint8_t num, WStype_t type, uint8_t* payload, size_t length);
+void sendCurrentSettings(uint8_t specificClientNum);
+void calculateAndSetGridSpacing(int cols, int rows);
+
+static const uint8_t BENCH_CLIENT = 0;
+
+struct BenchCase {
+    const char* name;
+    void (*run)();
+};
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations;
+    double minNs, medianNs, meanNs, p90Ns;
+};
+
+// === Cases ===
+
+static uint64_t replyBytes = 0; // Keeps the sink from being optimized away
+
+static void sendCommand(const char* text) {
+    char buf[96];
+    size_t len = strlen(text);
+    memcpy(buf, text, len + 1);
+    webSocketEvent(BENCH_CLIENT, WStype_TEXT, (uint8_t*)buf, len);
+}
+
+static void caseUnknownCommand() {
+    sendCommand("NO_SUCH_COMMAND 1 2 3");
+}
+
+static void caseGetSettingsDelta() {
+    static char cmd[64];
+    snprintf(cmd, sizeof(cmd), "GET_SETTINGS %lu %lu", (unsigned long)settingsEpoch(), (unsigned long)settingsVersion());
+    sendCommand(cmd);
+}
+
+static void caseSetFeedOverride() {
+    sendCommand("SET_FEED_OVERRIDE 100");
+}
+
+static void caseSendCurrentSettings() {
+    sendCurrentSettings(BENCH_CLIENT);
+}
+
+static void caseGridSpacing() {
+    calculateAndSetGridSpacing(placeGridCols, placeGridRows);
+}
+
+static void casePlaceTable() {
+    static PlaceTable table;
+    PlaceTableParams p;
+    p.firstX = placeFirstXAbsolute_inch;
+    p.firstY = placeFirstYAbsolute_inch;
+    p.cols = placeGridCols;
+    p.rows = placeGridRows;
+    p.itemWidth = pnpItemWidth_inch;
+    p.itemHeight = pnpItemHeight_inch;
+    p.gapX = placeGapX_inch;
+    p.gapY = placeGapY_inch;
+    compilePlaceTable(p, table);
+    replyBytes += table.count;
+}
+
+static void compileSide(int side) {
+    invalidateToolpathCache();
+    const Toolpath* path = getSideToolpath(side, paintSpeed[side]);
+    replyBytes += path ? path->count : 0;
+}
+
+static void caseToolpathSide0() { compileSide(0); }
+static void caseToolpathSide1() { compileSide(1); }
+static void caseToolpathSide2() { compileSide(2); }
+static void caseToolpathSide3() { compileSide(3); }
+
+static void caseToolpathRaster45() {
+    int saved = paintPatternType[0];
+    paintPatternType[0] = 45;
+    compileSide(0);
+    paintPatternType[0] = saved;
+}
+
+static const BenchCase CASES[] = {
+    {"ws_unknown_command", caseUnknownCommand},
+    {"ws_get_settings_delta", caseGetSettingsDelta},
+    {"ws_set_feed_override", caseSetFeedOverride},
+    {"send_current_settings", caseSendCurrentSettings},
+    {"grid_spacing", caseGridSpacing},
+    {"place_table", casePlaceTable},
+    {"toolpath_side_0", caseToolpathSide0},
+    {"toolpath_side_1", caseToolpathSide1},
+    {"toolpath_side_2", caseToolpathSide2},
+    {"toolpath_side_3", caseToolpathSide3},
+    {"toolpath_raster_45", caseToolpathRaster45},
+};
+
+// === Timing ===
+
+static double nowNs() {
+    return (double)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Calibrates a batch size that takes at least minSampleMs, then times `samples` batches
+static BenchResult runCase(const BenchCase& c, int samples, double minSampleMs) {
+    for (int i = 0; i < 16; i++) c.run(); // Warm caches and the firmware's own caches
+
+    uint64_t batch = 1;
+    for (;;) {
+        double t0 = nowNs();
+        for (uint64_t i = 0; i < batch; i++) c.run();
+        double ms = (nowNs() - t0) / 1e6;
+        if (ms >= minSampleMs || batch >= (1u << 24)) break;
+        batch = (ms <= 0.0) ? batch * 16 : std::max(batch * 2, (uint64_t)(batch * minSampleMs / ms * 1.2));
+    }
+
+    std::vector<double> perOp;
+    for (int s = 0; s < samples; s++) {
+        double t0 = nowNs();
+        for (uint64_t i = 0; i < batch; i++) c.run();
+        perOp.push_back((nowNs() - t0) / batch);
+    }
+    std::sort(perOp.begin(), perOp.end());
+    double sum = 0.0;
+    for (double v : perOp) sum += v;
+
+    BenchResult r;
+    r.name = c.name;
+    r.iterations = batch * samples;
+    r.minNs = perOp.front();
+    r.medianNs = perOp[perOp.size() / 2];
+    r.meanNs = sum / perOp.size();
+    r.p90Ns = perOp[std::min(perOp.size() - 1, perOp.size() * 9 / 10)];
+    return r;
+}
+
+static void writeJson(FILE* out, const std::vector<BenchResult>& results, int samples) {
+    fprintf(out, "{\"bench\":\"firmware-host\",\"samples\":%d,\"cases\":[\n", samples);
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(out, "{\"name\":\"%s\",\"iterations\":%llu,\"nsPerOp\":{\"min\":%.1f,\"median\":%.1f,\"mean\":%.1f,\"p90\":%.1f}}%s\n",
+                r.name.c_str(), (unsigned long long)r.iterations, r.minNs, r.medianNs, r.meanNs, r.p90Ns,
+                i + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "]}\n");
+}
+
+// === Compare ===
+
+static bool loadResults(const char* path, std::vector<BenchResult>& out) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        char name[128];
+        BenchResult r;
+        unsigned long long iterations;
+        if (sscanf(line, "{\"name\":\"%127[^\"]\",\"iterations\":%llu,\"nsPerOp\":{\"min\":%lf,\"median\":%lf,\"mean\":%lf,\"p90\":%lf",
+                   name, &iterations, &r.minNs, &r.medianNs, &r.meanNs, &r.p90Ns) == 6) {
+            r.name = name;
+            r.iterations = iterations;
+            out.push_back(r);
+        }
+    }
+    fclose(f);
+    if (out.empty()) fprintf(stderr, "No cases in %s\n", path);
+    return !out.empty();
+}
+
+static int compare(const char* basePath, const char* newPath, double thresholdPct) {
+    std::vector<BenchResult> base, cur;
+    if (!loadResults(basePath, base) || !loadResults(newPath, cur)) return 2;
+
+    int regressions = 0;
+    printf("%-24s %14s %14s %9s\n", "case", "base ns/op", "new ns/op", "change");
+    for (const BenchResult& n : cur) {
+        const BenchResult* b = nullptr;
+        for (const BenchResult& x : base) {
+            if (x.name == n.name) b = &x;
+        }
+        if (!b) {
+            printf("%-24s %14s %14.1f %9s\n", n.name.c_str(), "-", n.medianNs, "new");
+            continue;
+        }
+        double change = b->medianNs > 0.0 ? (n.medianNs - b->medianNs) / b->medianNs * 100.0 : 0.0;
+        bool regressed = change > thresholdPct;
+        regressions += regressed;
+        printf("%-24s %14.1f %14.1f %+8.1f%%%s\n", n.name.c_str(), b->medianNs, n.medianNs, change,
+               regressed ? "  REGRESSION" : "");
+    }
+    printf("%d regression(s) above %.1f%%\n", regressions, thresholdPct);
+    return regressions ? 1 : 0;
+}
+
+// === Main ===
+
+int main(int argc, char** argv) {
+    const char* filter = nullptr;
+    const char* outPath = nullptr;
+    const char* compareBase = nullptr;
+    const char* compareNew = nullptr;
+    int samples = 25;
+    double minSampleMs = 20.0;
+    double thresholdPct = 10.0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+        else if (strcmp(argv[i], "--samples") == 0 && i + 1 < argc) samples = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--min-sample-ms") == 0 && i + 1 < argc) minSampleMs = atof(argv[++i]);
+        else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) outPath = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) thresholdPct = atof(argv[++i]);
+        else if (strcmp(argv[i], "--compare") == 0 && i + 2 < argc) { compareBase = argv[++i]; compareNew = argv[++i]; }
+        else {
+            fprintf(stderr, "Usage: bench [--filter SUBSTR] [--samples N] [--min-sample-ms MS] [--out FILE]\n"
+                            "       bench --compare BASE.json NEW.json [--threshold PCT]\n");
+            return 2;
+        }
+    }
+    if (compareBase) return compare(compareBase, compareNew, thresholdPct);
+
+    setup();
+    webSocket.hostSetSink([](uint8_t, const char*, size_t len) { replyBytes += len; });
+    webSocket.hostConnect(BENCH_CLIENT);
+
+    std::vector<BenchResult> results;
+    for (const BenchCase& c : CASES) {
+        if (filter && !strstr(c.name, filter)) continue;
+        results.push_back(runCase(c, samples, minSampleMs));
+        fprintf(stderr, "[BENCH] %-24s %12.1f ns/op (median)\n", c.name, results.back().medianNs);
+    }
+
+    FILE* out = outPath ? fopen(outPath, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Cannot write %s\n", outPath);
+        return 2;
+    }
+    writeJson(out, results, samples);
+    if (outPath) fclose(out);
+    fprintf(stderr, "[BENCH] %llu reply bytes\n", (unsigned long long)replyBytes);
+    return 0;
+}
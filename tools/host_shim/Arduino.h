@@ -0,0 +1,128 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// === Host Arduino Shim ===
+// Just enough of the Arduino-ESP32 core for the firmware sources to build and
+// run on a PC (tools/bench, tools/loadtest). Time is the host's monotonic
+// clock, pins are an in-memory table (HostShim.h drives inputs) and Serial
+// writes to stderr so tools keep stdout for their own output.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <stdarg.h>
+#include <algorithm>
+#include <string>
+
+using std::min;
+using std::max;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+#define PROGMEM
+#define IRAM_ATTR
+#define ARDUINO_ISR_ATTR
+#define F(x) x
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// Minimal String (std::string backed); the firmware only uses it at the edges
+class String {
+public:
+    String(const char* s = "") : s_(s ? s : "") {}
+    String(const std::string& s) : s_(s) {}
+    String(int v, int base = 10) { char b[34]; snprintf(b, sizeof(b), base == 16 ? "%x" : "%d", v); s_ = b; }
+    String(unsigned v) : s_(std::to_string(v)) {}
+    String(long v) : s_(std::to_string(v)) {}
+    String(unsigned long v) : s_(std::to_string(v)) {}
+    String(float v, int d = 2) { char b[48]; snprintf(b, sizeof(b), "%.*f", d, v); s_ = b; }
+    String(double v, int d = 2) { char b[48]; snprintf(b, sizeof(b), "%.*f", d, v); s_ = b; }
+    String operator+(const String& o) const { return String(s_ + o.s_); }
+    String& operator+=(const String& o) { s_ += o.s_; return *this; }
+    friend String operator+(const char* a, const String& b) { return String(std::string(a) + b.s_); }
+    bool operator==(const char* o) const { return s_ == o; }
+    const char* c_str() const { return s_.c_str(); }
+    size_t length() const { return s_.size(); }
+private:
+    std::string s_;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(const uint8_t* data, size_t n) = 0;
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+    size_t print(int v) { char b[16]; int n = snprintf(b, sizeof(b), "%d", v); return write((const uint8_t*)b, n); }
+    size_t println(const char* s = "") { size_t n = print(s); return n + print("\n"); }
+    size_t println(const String& s) { return println(s.c_str()); }
+    size_t println(int v) { size_t n = print(v); return n + print("\n"); }
+    void flush() {}
+};
+
+class Stream : public Print {
+public:
+    int available() { return 0; }
+    int read() { return -1; }
+};
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    int availableForWrite() { return 4096; }
+    operator bool() const { return true; }
+    size_t write(const uint8_t* data, size_t n) override;
+    using Print::write;
+};
+extern HardwareSerial Serial;
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t level);
+int digitalRead(uint8_t pin);
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode);
+void detachInterrupt(uint8_t pin);
+inline int digitalPinToInterrupt(int pin) { return pin; }
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned us);
+void yield();
+
+long random(long howBig);
+long random(long howSmall, long howBig);
+
+class IPAddress {
+public:
+    IPAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) { o_[0] = a; o_[1] = b; o_[2] = c; o_[3] = d; }
+    uint8_t operator[](int i) const { return o_[i & 3]; }
+    String toString() const { char b[16]; snprintf(b, sizeof(b), "%u.%u.%u.%u", o_[0], o_[1], o_[2], o_[3]); return String(b); }
+private:
+    uint8_t o_[4];
+};
+
+// Heap figures come from a fixed pretend heap; the host has no fragmentation to report
+class EspClass {
+public:
+    uint32_t getFreeHeap() { return 256 * 1024; }
+    uint32_t getMinFreeHeap() { return 256 * 1024; }
+    uint32_t getMaxAllocHeap() { return 128 * 1024; }
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getCycleCount(); // micros() * 240
+    void restart();
+};
+extern EspClass ESP;
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,43 @@
+#ifndef HOST_ARDUINOJSON_H
+#define HOST_ARDUINOJSON_H
+
+#include <Arduino.h>
+
+// Parse-only stand-in: deserializeJson() always reports an error, so JSON
+// commands get the firmware's "Invalid JSON format" reply on the host. Put
+// the real (header-only) ArduinoJson ahead of this directory on the include
+// path to run them.
+
+class JsonObject;
+
+class JsonVariant {
+public:
+    JsonVariant operator[](const char*) const { return JsonVariant(); }
+    JsonVariant operator[](int) const { return JsonVariant(); }
+    operator const char*() const { return nullptr; }
+    operator float() const { return 0.0f; }
+    operator int() const { return 0; }
+    operator JsonObject() const;
+    bool isNull() const { return true; }
+};
+
+class JsonObject : public JsonVariant {
+public:
+    using JsonVariant::operator[];
+    bool containsKey(const char*) const { return false; }
+    explicit operator bool() const { return false; }
+};
+inline JsonVariant::operator JsonObject() const { return JsonObject(); }
+
+class JsonDocument : public JsonVariant {};
+
+class DeserializationError {
+public:
+    explicit operator bool() const { return true; }
+    const char* c_str() const { return "JSON not supported by the host shim"; }
+};
+
+template <class Input>
+DeserializationError deserializeJson(JsonDocument&, Input, size_t = 0) { return DeserializationError(); }
+
+#endif // HOST_ARDUINOJSON_H
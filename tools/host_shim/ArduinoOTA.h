@@ -0,0 +1,24 @@
+#ifndef HOST_ARDUINO_OTA_H
+#define HOST_ARDUINO_OTA_H
+
+#include <Arduino.h>
+#include <functional>
+
+typedef enum { OTA_AUTH_ERROR, OTA_BEGIN_ERROR, OTA_CONNECT_ERROR, OTA_RECEIVE_ERROR, OTA_END_ERROR } ota_error_t;
+#define U_FLASH 0
+
+class ArduinoOTAClass {
+public:
+    ArduinoOTAClass& setHostname(const char*) { return *this; }
+    ArduinoOTAClass& setPassword(const char*) { return *this; }
+    ArduinoOTAClass& onStart(std::function<void()>) { return *this; }
+    ArduinoOTAClass& onEnd(std::function<void()>) { return *this; }
+    ArduinoOTAClass& onProgress(std::function<void(unsigned int, unsigned int)>) { return *this; }
+    ArduinoOTAClass& onError(std::function<void(ota_error_t)>) { return *this; }
+    void begin() {}
+    void handle() {}
+    int getCommand() { return U_FLASH; }
+};
+extern ArduinoOTAClass ArduinoOTA;
+
+#endif // HOST_ARDUINO_OTA_H
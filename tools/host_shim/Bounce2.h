@@ -0,0 +1,32 @@
+#ifndef HOST_BOUNCE2_H
+#define HOST_BOUNCE2_H
+
+#include <Arduino.h>
+
+// Reads the pin directly (no debouncing). Unwritten inputs read HIGH, so home
+// switches report "triggered" and homing completes at once on the host.
+
+class Bounce {
+public:
+    void attach(int pin) { pin_ = pin; last_ = digitalRead(pin); }
+    void attach(int pin, int) { attach(pin); }
+    void interval(uint16_t) {}
+    bool update() {
+        int now = digitalRead(pin_);
+        rose_ = (last_ == LOW && now == HIGH);
+        fell_ = (last_ == HIGH && now == LOW);
+        last_ = now;
+        return rose_ || fell_;
+    }
+    int read() { return digitalRead(pin_); }
+    bool rose() { return rose_; }
+    bool fell() { return fell_; }
+
+private:
+    int pin_ = -1;
+    int last_ = HIGH;
+    bool rose_ = false;
+    bool fell_ = false;
+};
+
+#endif // HOST_BOUNCE2_H
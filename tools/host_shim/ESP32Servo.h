@@ -0,0 +1,24 @@
+#ifndef HOST_ESP32SERVO_H
+#define HOST_ESP32SERVO_H
+
+#include <Arduino.h>
+
+class ESP32PWM {
+public:
+    static void allocateTimer(int) {}
+};
+
+class Servo {
+public:
+    void setPeriodHertz(int) {}
+    int attach(int pin) { pin_ = pin; return 1; }
+    bool attached() { return pin_ >= 0; }
+    void write(int angle) { angle_ = angle; }
+    int read() { return angle_; }
+
+private:
+    int pin_ = -1;
+    int angle_ = 0;
+};
+
+#endif // HOST_ESP32SERVO_H
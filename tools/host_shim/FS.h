@@ -0,0 +1,57 @@
+#ifndef HOST_FS_H
+#define HOST_FS_H
+
+#include <Arduino.h>
+#include <memory>
+
+// Host filesystem: paths are relative to hostFsRoot() (HostShim.h)
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+namespace fs {
+
+struct HostFileImpl;
+
+class File {
+public:
+    File() {}
+    explicit File(std::shared_ptr<HostFileImpl> impl) : impl_(impl) {}
+    operator bool() const { return (bool)impl_; }
+    size_t write(const uint8_t* buf, size_t n);
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t read(uint8_t* buf, size_t n);
+    int read();
+    int available();
+    bool seek(uint32_t pos, SeekMode mode = SeekSet);
+    size_t position() const;
+    size_t size() const;
+    void close();
+    void flush();
+    const char* name() const;
+    const char* path() const;
+    bool isDirectory();
+    File openNextFile(const char* mode = "r");
+    void rewindDirectory();
+    size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+
+private:
+    std::shared_ptr<HostFileImpl> impl_;
+};
+
+class FS {
+public:
+    File open(const char* path, const char* mode = "r", bool create = false);
+    File open(const String& path, const char* mode = "r", bool create = false) { return open(path.c_str(), mode, create); }
+    bool exists(const char* path);
+    bool remove(const char* path);
+    bool rename(const char* from, const char* to);
+    bool mkdir(const char* path);
+    bool rmdir(const char* path);
+};
+
+} // namespace fs
+
+using fs::File;
+using fs::FS;
+
+#endif // HOST_FS_H
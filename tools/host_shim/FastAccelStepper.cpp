@@ -0,0 +1,158 @@
+#include "FastAccelStepper.h"
+#include <esp_timer.h>
+#include <mutex>
+
+static std::recursive_mutex stepperMutex;
+#define STEPPER_LOCK std::lock_guard<std::recursive_mutex> lock(stepperMutex)
+
+static const double MAX_SUBSTEP_S = 0.0005; // Integration step
+
+void FastAccelStepper::advance() {
+    int64_t now = esp_timer_get_time();
+    if (lastUs_ == 0) lastUs_ = now;
+    double remainingS = (now - lastUs_) * 1e-6;
+    lastUs_ = now;
+    while (mode_ != IDLE && remainingS > 0.0) {
+        double dt = remainingS < MAX_SUBSTEP_S ? remainingS : MAX_SUBSTEP_S;
+        remainingS -= dt;
+        double desired;
+        if (mode_ == RUN_FORWARD) {
+            desired = cruise_;
+        } else if (mode_ == RUN_BACKWARD) {
+            desired = -cruise_;
+        } else {
+            double togo = target_ - pos_;
+            double brake = sqrt(2.0 * acc_ * fabs(togo));
+            desired = (togo >= 0 ? 1.0 : -1.0) * (brake < cruise_ ? brake : cruise_);
+        }
+        double dv = acc_ * dt;
+        if (vel_ < desired) vel_ = (vel_ + dv < desired) ? vel_ + dv : desired;
+        else vel_ = (vel_ - dv > desired) ? vel_ - dv : desired;
+        double next = pos_ + vel_ * dt;
+        if (mode_ == TO_TARGET && (target_ - pos_) * (target_ - next) <= 0.0) { // Reached or crossed
+            pos_ = target_;
+            vel_ = 0.0;
+            mode_ = IDLE;
+        } else {
+            pos_ = next;
+        }
+    }
+}
+
+int8_t FastAccelStepper::setSpeedInHz(uint32_t speedHz) {
+    STEPPER_LOCK;
+    speedHz_ = speedHz ? speedHz : 1;
+    return 0;
+}
+
+int8_t FastAccelStepper::setAcceleration(int32_t accel) {
+    STEPPER_LOCK;
+    accel_ = accel > 0 ? accel : 1;
+    return 0;
+}
+
+void FastAccelStepper::applySpeedAcceleration() {
+    STEPPER_LOCK;
+    advance();
+    cruise_ = speedHz_;
+    acc_ = accel_;
+}
+
+int8_t FastAccelStepper::moveTo(int32_t position, bool blocking) {
+    {
+        STEPPER_LOCK;
+        advance();
+        cruise_ = speedHz_;
+        acc_ = accel_;
+        target_ = position;
+        mode_ = TO_TARGET;
+    }
+    while (blocking && isRunning()) yield();
+    return MOVE_OK;
+}
+
+int8_t FastAccelStepper::move(int32_t steps, bool blocking) {
+    return moveTo(targetPos() + steps, blocking);
+}
+
+void FastAccelStepper::runForward() {
+    STEPPER_LOCK;
+    advance();
+    cruise_ = speedHz_;
+    acc_ = accel_;
+    mode_ = RUN_FORWARD;
+}
+
+void FastAccelStepper::runBackward() {
+    STEPPER_LOCK;
+    advance();
+    cruise_ = speedHz_;
+    acc_ = accel_;
+    mode_ = RUN_BACKWARD;
+}
+
+void FastAccelStepper::stopMove() {
+    STEPPER_LOCK;
+    advance();
+    if (mode_ == IDLE) return;
+    // Decelerate to a stop: the target becomes the braking point
+    double brake = vel_ * fabs(vel_) / (2.0 * acc_);
+    target_ = (int32_t)lround(pos_ + brake);
+    mode_ = TO_TARGET;
+}
+
+void FastAccelStepper::forceStop() {
+    STEPPER_LOCK;
+    advance();
+    pos_ = lround(pos_);
+    vel_ = 0.0;
+    target_ = (int32_t)pos_;
+    mode_ = IDLE;
+}
+
+void FastAccelStepper::forceStopAndNewPosition(int32_t position) {
+    STEPPER_LOCK;
+    forceStop();
+    pos_ = position;
+    target_ = position;
+}
+
+void FastAccelStepper::setCurrentPosition(int32_t position) {
+    STEPPER_LOCK;
+    advance();
+    double delta = position - pos_;
+    pos_ = position;
+    target_ += (int32_t)lround(delta);
+}
+
+int32_t FastAccelStepper::getCurrentPosition() {
+    STEPPER_LOCK;
+    advance();
+    return (int32_t)lround(pos_);
+}
+
+int32_t FastAccelStepper::targetPos() {
+    STEPPER_LOCK;
+    advance();
+    return mode_ == TO_TARGET ? target_ : (int32_t)lround(pos_);
+}
+
+bool FastAccelStepper::isRunning() {
+    STEPPER_LOCK;
+    advance();
+    return mode_ != IDLE;
+}
+
+int32_t FastAccelStepper::getCurrentSpeedInMilliHz(bool) {
+    STEPPER_LOCK;
+    advance();
+    return (int32_t)(vel_ * 1000.0);
+}
+
+uint8_t FastAccelStepper::queueEntries() {
+    return isRunning() ? 16 : 0; // Pretend the queue is kept full while moving
+}
+
+FastAccelStepper* FastAccelStepperEngine::stepperConnectToPin(uint8_t) {
+    return new FastAccelStepper();
+}
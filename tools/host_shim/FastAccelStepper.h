@@ -0,0 +1,68 @@
+#ifndef HOST_FAST_ACCEL_STEPPER_H
+#define HOST_FAST_ACCEL_STEPPER_H
+
+#include <Arduino.h>
+
+// === Host FastAccelStepper ===
+// Simulated axis: position and speed are integrated from the commanded speed
+// and acceleration against the host clock whenever the axis is queried, with
+// the same ramp-to-target behaviour (braking distance v^2/2a) as the real
+// library. No pins are driven. Calls are serialized by one mutex so the
+// e-stop task can force-stop from its own thread.
+
+// moveTo()/move() result codes
+#define MOVE_OK 0
+#define MOVE_ERR_NO_DIRECTION_PIN -1
+#define MOVE_ERR_SPEED_IS_UNDEFINED -2
+#define MOVE_ERR_ACCELERATION_IS_UNDEFINED -3
+
+class FastAccelStepper {
+public:
+    void setDirectionPin(uint8_t, bool = true) {}
+    void setEnablePin(int8_t) {}
+    void setAutoEnable(bool) {}
+
+    int8_t setSpeedInHz(uint32_t speedHz);
+    int8_t setAcceleration(int32_t accel);
+    void applySpeedAcceleration();
+    int8_t moveTo(int32_t position, bool blocking = false);
+    int8_t move(int32_t steps, bool blocking = false);
+    void runForward();
+    void runBackward();
+    void stopMove();
+    void forceStop();
+    void forceStopAndNewPosition(int32_t position);
+    void setCurrentPosition(int32_t position);
+
+    int32_t getCurrentPosition();
+    int32_t targetPos();
+    bool isRunning();
+    uint32_t getSpeedInMilliHz() { return speedHz_ * 1000; }
+    int32_t getCurrentSpeedInMilliHz(bool = true);
+    uint32_t getMaxSpeedInHz() { return 200000; }
+    uint8_t queueEntries();
+    bool isQueueEmpty() { return !isRunning(); }
+    bool isQueueFull() { return false; }
+
+private:
+    enum Mode : uint8_t { IDLE, TO_TARGET, RUN_FORWARD, RUN_BACKWARD };
+    void advance(); // Integrate up to now (call with the mutex held)
+
+    double pos_ = 0.0;
+    double vel_ = 0.0;       // steps/s, signed
+    int32_t target_ = 0;
+    uint32_t speedHz_ = 1000;  // Set, applied on the next move command
+    int32_t accel_ = 1000;
+    double cruise_ = 1000.0; // Applied
+    double acc_ = 1000.0;
+    Mode mode_ = IDLE;
+    int64_t lastUs_ = 0;
+};
+
+class FastAccelStepperEngine {
+public:
+    void init(uint8_t = 0) {}
+    FastAccelStepper* stepperConnectToPin(uint8_t stepPin);
+};
+
+#endif // HOST_FAST_ACCEL_STEPPER_H
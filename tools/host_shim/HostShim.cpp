@@ -0,0 +1,286 @@
+#include "HostShim.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <esp_timer.h>
+#include <WiFi.h>
+#include <ArduinoOTA.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+HardwareSerial Serial;
+EspClass ESP;
+WiFiClass WiFi;
+ArduinoOTAClass ArduinoOTA;
+
+// === Time ===
+
+static const std::chrono::steady_clock::time_point bootTime = std::chrono::steady_clock::now();
+
+int64_t esp_timer_get_time() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - bootTime).count();
+}
+
+unsigned long millis() {
+    return (unsigned long)(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)esp_timer_get_time();
+}
+
+void delay(unsigned long ms) {
+    int64_t until = esp_timer_get_time() + (int64_t)ms * 1000;
+    do {
+        hostServiceTimers();
+        int64_t left = until - esp_timer_get_time();
+        if (left <= 0) break;
+        std::this_thread::sleep_for(std::chrono::microseconds(left < 1000 ? left : 1000));
+    } while (true);
+}
+
+void delayMicroseconds(unsigned us) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield() {
+    hostServiceTimers();
+    std::this_thread::yield();
+}
+
+uint32_t EspClass::getCycleCount() {
+    return (uint32_t)(esp_timer_get_time() * 240);
+}
+
+void EspClass::restart() {
+    fprintf(stderr, "[HOST] ESP.restart() - exiting\n");
+    exit(0);
+}
+
+// === Random ===
+
+static std::mt19937& rng() {
+    static std::mt19937 r(12345);
+    return r;
+}
+
+long random(long howBig) {
+    return howBig > 0 ? (long)(rng()() % (unsigned long)howBig) : 0;
+}
+
+long random(long howSmall, long howBig) {
+    return howBig > howSmall ? howSmall + random(howBig - howSmall) : howSmall;
+}
+
+// === Serial ===
+
+size_t Print::printf(const char* fmt, ...) {
+    char buf[512];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n < 0) return 0;
+    return write((const uint8_t*)buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* data, size_t n) {
+    return fwrite(data, 1, n, stderr);
+}
+
+// === Pins ===
+
+#define HOST_PINS 64
+
+struct HostPin {
+    int level = HIGH; // Unwritten inputs read as pulled up
+    void (*isr)(void) = nullptr;
+    int isrMode = 0;
+};
+static HostPin pins[HOST_PINS];
+
+void pinMode(uint8_t, uint8_t) {}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+    if (pin < HOST_PINS) pins[pin].level = level ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) {
+    return pin < HOST_PINS ? pins[pin].level : LOW;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(void), int mode) {
+    if (pin >= HOST_PINS) return;
+    pins[pin].isr = isr;
+    pins[pin].isrMode = mode;
+}
+
+void detachInterrupt(uint8_t pin) {
+    if (pin < HOST_PINS) pins[pin].isr = nullptr;
+}
+
+void hostPinSet(uint8_t pin, int level) {
+    if (pin >= HOST_PINS) return;
+    HostPin& p = pins[pin];
+    int old = p.level;
+    p.level = level ? HIGH : LOW;
+    bool rising = (old == LOW && p.level == HIGH), falling = (old == HIGH && p.level == LOW);
+    if (p.isr && ((rising && (p.isrMode & RISING)) || (falling && (p.isrMode & FALLING)))) p.isr();
+}
+
+const char* hostFsRoot() {
+    const char* root = getenv("HOST_FS_ROOT");
+    return root ? root : "./host_fs";
+}
+
+// === FreeRTOS ===
+
+static std::recursive_mutex criticalMutex;
+
+void hostEnterCritical() {
+    criticalMutex.lock();
+}
+
+void hostExitCritical() {
+    criticalMutex.unlock();
+}
+
+struct HostTask {
+    std::string name;
+    uint32_t stackDepth = 0;
+    std::mutex m;
+    std::condition_variable cv;
+    uint32_t notifications = 0;
+};
+
+static std::mutex tasksMutex;
+static std::vector<HostTask*> tasks;
+static thread_local HostTask* currentTask = nullptr;
+
+static HostTask* registerTask(const char* name, uint32_t stackDepth) {
+    HostTask* t = new HostTask();
+    t->name = name;
+    t->stackDepth = stackDepth;
+    std::lock_guard<std::mutex> lock(tasksMutex);
+    tasks.push_back(t);
+    return t;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                                   UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    HostTask* t = registerTask(name, stackDepth);
+    if (handle) *handle = t;
+    std::thread([fn, arg, t]() {
+        currentTask = t;
+        fn(arg);
+    }).detach();
+    return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                       UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stackDepth, arg, priority, handle, 0);
+}
+
+void vTaskDelete(TaskHandle_t) {
+    // Host tasks end by returning from their function; only self-deletion is used
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
+
+TickType_t xTaskGetTickCount() {
+    return (TickType_t)millis();
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    if (!currentTask) currentTask = registerTask("loopTask", 8192); // The main thread plays the loop task
+    return currentTask;
+}
+
+TaskHandle_t xTaskGetHandle(const char* name) {
+    std::lock_guard<std::mutex> lock(tasksMutex);
+    for (HostTask* t : tasks) {
+        if (t->name == name) return t;
+    }
+    return nullptr;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+    return task ? task->stackDepth : 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    if (!task) return pdFALSE;
+    {
+        std::lock_guard<std::mutex> lock(task->m);
+        task->notifications++;
+    }
+    task->cv.notify_one();
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    xTaskNotifyGive(task);
+    if (woken) *woken = pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+    HostTask* t = xTaskGetCurrentTaskHandle();
+    std::unique_lock<std::mutex> lock(t->m);
+    auto ready = [t]() { return t->notifications > 0; };
+    if (ticksToWait == portMAX_DELAY) t->cv.wait(lock, ready);
+    else t->cv.wait_for(lock, std::chrono::milliseconds(ticksToWait), ready);
+    uint32_t n = t->notifications;
+    if (n) t->notifications = clearOnExit ? 0 : n - 1;
+    return n;
+}
+
+// === esp_timer ===
+
+struct HostEspTimer {
+    esp_timer_cb_t callback;
+    void* arg;
+    uint64_t periodUs;
+    int64_t nextUs;
+    bool running;
+};
+
+static std::vector<HostEspTimer*> timers;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out) {
+    HostEspTimer* t = new HostEspTimer{args->callback, args->arg, 0, 0, false};
+    timers.push_back(t);
+    *out = t;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t periodUs) {
+    timer->periodUs = periodUs;
+    timer->nextUs = esp_timer_get_time() + periodUs;
+    timer->running = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    timer->running = false;
+    return ESP_OK;
+}
+
+void hostServiceTimers() {
+    static thread_local bool inTimer = false;
+    if (inTimer || xTaskGetCurrentTaskHandle()->name != "loopTask") return; // Main thread only
+    inTimer = true;
+    int64_t now = esp_timer_get_time();
+    for (HostEspTimer* t : timers) {
+        if (!t->running || now < t->nextUs) continue;
+        t->nextUs = now + t->periodUs;
+        t->callback(t->arg);
+    }
+    inTimer = false;
+}
@@ -0,0 +1,26 @@
+#ifndef HOST_SHIM_H
+#define HOST_SHIM_H
+
+#include <Arduino.h>
+
+// === Host Shim Controls ===
+// Hooks for host tools: drive input pins and run the shim's periodic
+// esp_timers. Timers fire from yield()/delay() on the calling thread, so
+// timer callbacks never race the firmware code that polls them.
+
+/**
+ * @brief Set the level of an input pin, firing an attached interrupt on a matching edge.
+ */
+void hostPinSet(uint8_t pin, int level);
+
+/**
+ * @brief Run periodic esp_timers that are due (also called by yield() and delay()).
+ */
+void hostServiceTimers();
+
+/**
+ * @brief Directory LittleFS files live in (default ./host_fs, or $HOST_FS_ROOT).
+ */
+const char* hostFsRoot();
+
+#endif // HOST_SHIM_H
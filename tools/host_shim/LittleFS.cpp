@@ -0,0 +1,145 @@
+#include "LittleFS.h"
+#include "HostShim.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+fs::LittleFSFS LittleFS;
+
+namespace fs {
+
+struct HostFileImpl {
+    std::string path;  // Firmware path ("/recipes/a.rcp")
+    std::string name;  // Last component
+    FILE* fp = nullptr;
+    DIR* dir = nullptr;
+};
+
+static std::string hostPath(const char* path) {
+    return std::string(hostFsRoot()) + (path[0] == '/' ? "" : "/") + path;
+}
+
+size_t File::write(const uint8_t* buf, size_t n) {
+    return (impl_ && impl_->fp) ? fwrite(buf, 1, n, impl_->fp) : 0;
+}
+
+size_t File::read(uint8_t* buf, size_t n) {
+    return (impl_ && impl_->fp) ? fread(buf, 1, n, impl_->fp) : 0;
+}
+
+int File::read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int File::available() {
+    return (int)(size() - position());
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+    static const int whence[] = {SEEK_SET, SEEK_CUR, SEEK_END};
+    return impl_ && impl_->fp && fseek(impl_->fp, pos, whence[mode]) == 0;
+}
+
+size_t File::position() const {
+    return (impl_ && impl_->fp) ? (size_t)ftell(impl_->fp) : 0;
+}
+
+size_t File::size() const {
+    if (!impl_) return 0;
+    if (impl_->fp) fflush(impl_->fp);
+    struct stat st;
+    return stat(hostPath(impl_->path.c_str()).c_str(), &st) == 0 ? (size_t)st.st_size : 0;
+}
+
+void File::close() {
+    if (!impl_) return;
+    if (impl_->fp) fclose(impl_->fp);
+    if (impl_->dir) closedir(impl_->dir);
+    impl_->fp = nullptr;
+    impl_->dir = nullptr;
+    impl_.reset();
+}
+
+void File::flush() {
+    if (impl_ && impl_->fp) fflush(impl_->fp);
+}
+
+const char* File::name() const {
+    return impl_ ? impl_->name.c_str() : "";
+}
+
+const char* File::path() const {
+    return impl_ ? impl_->path.c_str() : "";
+}
+
+bool File::isDirectory() {
+    return impl_ && impl_->dir;
+}
+
+File File::openNextFile(const char* mode) {
+    if (!impl_ || !impl_->dir) return File();
+    for (struct dirent* e = readdir(impl_->dir); e; e = readdir(impl_->dir)) {
+        if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+        return LittleFS.open((impl_->path + "/" + e->d_name).c_str(), mode);
+    }
+    return File();
+}
+
+void File::rewindDirectory() {
+    if (impl_ && impl_->dir) rewinddir(impl_->dir);
+}
+
+File FS::open(const char* path, const char* mode, bool) {
+    auto impl = std::make_shared<HostFileImpl>();
+    impl->path = path;
+    const char* slash = strrchr(path, '/');
+    impl->name = slash ? slash + 1 : path;
+    std::string hp = hostPath(path);
+    struct stat st;
+    if (stat(hp.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+        impl->dir = opendir(hp.c_str());
+        return impl->dir ? File(impl) : File();
+    }
+    // "w" truncates, "a" appends, "r" reads; binary on every platform
+    std::string m = std::string(mode[0] == 'w' ? "w+" : mode[0] == 'a' ? "a+" : "r") + "b";
+    impl->fp = fopen(hp.c_str(), m.c_str());
+    return impl->fp ? File(impl) : File();
+}
+
+bool FS::exists(const char* path) {
+    struct stat st;
+    return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) {
+    return ::unlink(hostPath(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to) {
+    return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+    return ::mkdir(hostPath(path).c_str(), 0755) == 0;
+}
+
+bool FS::rmdir(const char* path) {
+    return ::rmdir(hostPath(path).c_str()) == 0;
+}
+
+bool LittleFSFS::begin(bool, const char*, uint8_t, const char*) {
+    ::mkdir(hostFsRoot(), 0755);
+    struct stat st;
+    return stat(hostFsRoot(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool LittleFSFS::format() {
+    return true; // Leaves the host directory alone
+}
+
+size_t LittleFSFS::usedBytes() {
+    return 0;
+}
+
+} // namespace fs
@@ -0,0 +1,70 @@
+#include "Preferences.h"
+#include <map>
+#include <vector>
+
+static std::map<std::string, std::vector<uint8_t>>& store() {
+    static std::map<std::string, std::vector<uint8_t>> s; // "namespace/key" -> value
+    return s;
+}
+
+static std::string fullKey(const std::string& ns, const char* key) {
+    return ns + "/" + key;
+}
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    ns_ = name;
+    open_ = true;
+    readOnly_ = readOnly;
+    return true;
+}
+
+void Preferences::end() {
+    open_ = false;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+    if (!open_ || readOnly_) return 0;
+    const uint8_t* p = (const uint8_t*)value;
+    store()[fullKey(ns_, key)] = std::vector<uint8_t>(p, p + len);
+    return len;
+}
+
+int32_t Preferences::getInt(const char* key, int32_t defaultValue) {
+    int32_t v;
+    return getBytes(key, &v, sizeof(v)) == sizeof(v) ? v : defaultValue;
+}
+
+float Preferences::getFloat(const char* key, float defaultValue) {
+    float v;
+    return getBytes(key, &v, sizeof(v)) == sizeof(v) ? v : defaultValue;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    auto it = store().find(fullKey(ns_, key));
+    return (open_ && it != store().end()) ? it->second.size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+    auto it = store().find(fullKey(ns_, key));
+    if (!open_ || it == store().end() || it->second.size() > maxLen) return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+}
+
+bool Preferences::isKey(const char* key) {
+    return open_ && store().count(fullKey(ns_, key)) > 0;
+}
+
+bool Preferences::remove(const char* key) {
+    return open_ && !readOnly_ && store().erase(fullKey(ns_, key)) > 0;
+}
+
+bool Preferences::clear() {
+    if (!open_ || readOnly_) return false;
+    std::string prefix = ns_ + "/";
+    for (auto it = store().begin(); it != store().end();) {
+        if (it->first.compare(0, prefix.size(), prefix) == 0) it = store().erase(it);
+        else ++it;
+    }
+    return true;
+}
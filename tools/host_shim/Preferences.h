@@ -0,0 +1,29 @@
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <Arduino.h>
+
+// Host NVS: namespaces and keys live in memory for the life of the process
+
+class Preferences {
+public:
+    bool begin(const char* name, bool readOnly = false);
+    void end();
+    size_t putInt(const char* key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putFloat(const char* key, float value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putBytes(const char* key, const void* value, size_t len);
+    int32_t getInt(const char* key, int32_t defaultValue = 0);
+    float getFloat(const char* key, float defaultValue = 0.0f);
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buf, size_t maxLen);
+    bool isKey(const char* key);
+    bool remove(const char* key);
+    bool clear();
+
+private:
+    std::string ns_;
+    bool open_ = false;
+    bool readOnly_ = false;
+};
+
+#endif // HOST_PREFERENCES_H
@@ -0,0 +1,19 @@
+#ifndef HOST_WEBSERVER_H
+#define HOST_WEBSERVER_H
+
+#include <Arduino.h>
+#include <functional>
+
+// No HTTP on the host: the control page is not served
+
+class WebServer {
+public:
+    explicit WebServer(int) {}
+    void on(const char*, std::function<void()>) {}
+    void begin() {}
+    void handleClient() {}
+    void send(int, const char*, const char*) {}
+    void send_P(int, const char*, const char*) {}
+};
+
+#endif // HOST_WEBSERVER_H
@@ -0,0 +1,335 @@
+#include "WebSocketsServer.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <vector>
+
+typedef std::lock_guard<std::recursive_mutex> Guard;
+
+// === Handshake helpers ===
+
+static void sha1(const uint8_t* data, size_t len, uint8_t out[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::vector<uint8_t> msg(data, data + len);
+    msg.push_back(0x80);
+    while (msg.size() % 64 != 56) msg.push_back(0);
+    uint64_t bits = (uint64_t)len * 8;
+    for (int i = 7; i >= 0; i--) msg.push_back((uint8_t)(bits >> (i * 8)));
+
+    auto rol = [](uint32_t v, int n) { return (v << n) | (v >> (32 - n)); };
+    for (size_t chunk = 0; chunk < msg.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            const uint8_t* p = &msg[chunk + i * 4];
+            w[i] = ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+        }
+        for (int i = 16; i < 80; i++) w[i] = rol(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+            uint32_t t = rol(a, 5) + f + e + k + w[i];
+            e = d; d = c; c = rol(b, 30); b = a; a = t;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+    for (int i = 0; i < 20; i++) out[i] = (uint8_t)(h[i / 4] >> (24 - (i % 4) * 8));
+}
+
+static std::string base64(const uint8_t* data, size_t len) {
+    static const char* table = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < len; i += 3) {
+        uint32_t v = (uint32_t)data[i] << 16;
+        if (i + 1 < len) v |= (uint32_t)data[i + 1] << 8;
+        if (i + 2 < len) v |= data[i + 2];
+        out += table[(v >> 18) & 63];
+        out += table[(v >> 12) & 63];
+        out += i + 1 < len ? table[(v >> 6) & 63] : '=';
+        out += i + 2 < len ? table[v & 63] : '=';
+    }
+    return out;
+}
+
+// Case-insensitive header lookup in a raw HTTP request ("" if missing)
+static std::string headerValue(const std::string& request, const char* name) {
+    size_t nameLen = strlen(name);
+    size_t pos = request.find("\r\n");
+    while (pos != std::string::npos) {
+        pos += 2;
+        size_t end = request.find("\r\n", pos);
+        if (end == std::string::npos || end == pos) break;
+        if (end - pos > nameLen && request[pos + nameLen] == ':' && strncasecmp(request.c_str() + pos, name, nameLen) == 0) {
+            size_t v = pos + nameLen + 1;
+            while (v < end && request[v] == ' ') v++;
+            return request.substr(v, end - v);
+        }
+        pos = end;
+    }
+    return "";
+}
+
+// === Sending ===
+
+bool WebSocketsServer::sendTXT(uint8_t num, const char* text, size_t length) {
+    Guard guard(lock_);
+    if (!clientIsConnected(num)) return false;
+    if (length == 0) length = strlen(text);
+    bytesSent_ += length;
+    if (_clients[num].socket.fd_ >= 0) return writeFrame(num, 0x1, text, length);
+    if (sink_) sink_(num, text, length);
+    return true;
+}
+
+bool WebSocketsServer::broadcastTXT(const char* text, size_t length) {
+    Guard guard(lock_);
+    if (length == 0) length = strlen(text);
+    bool ok = true;
+    for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+        if (connected_[i]) ok = sendTXT(i, text, length) && ok;
+    }
+    return ok;
+}
+
+bool WebSocketsServer::writeFrame(uint8_t num, uint8_t opcode, const char* data, size_t length) {
+    uint8_t header[10];
+    size_t headerLen = 2;
+    header[0] = 0x80 | opcode; // FIN, server frames are not masked
+    if (length < 126) {
+        header[1] = (uint8_t)length;
+    } else if (length < 65536) {
+        header[1] = 126;
+        header[2] = (uint8_t)(length >> 8);
+        header[3] = (uint8_t)length;
+        headerLen = 4;
+    } else {
+        header[1] = 127;
+        for (int i = 0; i < 8; i++) header[2 + i] = (uint8_t)((uint64_t)length >> (56 - i * 8));
+        headerLen = 10;
+    }
+    int fd = _clients[num].socket.fd_;
+    if (writeAll(fd, (const char*)header, headerLen) && writeAll(fd, data, length)) return true;
+    fprintf(stderr, "[HOST] WebSocket client %u stopped taking data; dropping it\n", num);
+    closeClient(num);
+    return false;
+}
+
+bool WebSocketsServer::writeAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t n = ::send(fd, data, length, MSG_NOSIGNAL);
+        if (n > 0) {
+            data += n;
+            length -= n;
+            continue;
+        }
+        if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) return false;
+        pollfd p = {fd, POLLOUT, 0};
+        if (poll(&p, 1, HOST_WS_SEND_TIMEOUT_MS) <= 0) return false;
+    }
+    return true;
+}
+
+// === Connections ===
+
+void WebSocketsServer::disconnect(uint8_t num) {
+    Guard guard(lock_);
+    if (!clientIsConnected(num)) return;
+    if (_clients[num].socket.fd_ >= 0) {
+        writeFrame(num, 0x8, "", 0); // Close frame; closeClient() reports the disconnect
+        if (_clients[num].socket.fd_ >= 0) closeClient(num);
+        return;
+    }
+    connected_[num] = false;
+    if (event_) event_(num, WStype_DISCONNECTED, nullptr, 0);
+}
+
+void WebSocketsServer::disconnect() {
+    for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) disconnect(i);
+}
+
+uint8_t WebSocketsServer::connectedClients(bool) {
+    Guard guard(lock_);
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) n += connected_[i];
+    return n;
+}
+
+void WebSocketsServer::closeClient(uint8_t num) {
+    WSclient_t& c = _clients[num];
+    if (c.socket.fd_ < 0) return;
+    ::close(c.socket.fd_);
+    c.socket.fd_ = -1;
+    c.rx.clear();
+    bool wasConnected = connected_[num];
+    connected_[num] = false;
+    c.upgraded = false;
+    if (wasConnected && event_) event_(num, WStype_DISCONNECTED, nullptr, 0);
+}
+
+bool WebSocketsServer::hostConnect(uint8_t num) {
+    Guard guard(lock_);
+    if (num >= WEBSOCKETS_SERVER_CLIENT_MAX || connected_[num] || _clients[num].socket.fd_ >= 0) return false;
+    connected_[num] = true;
+    static uint8_t url[] = "/";
+    if (event_) event_(num, WStype_CONNECTED, url, 1);
+    return true;
+}
+
+void WebSocketsServer::hostReceive(uint8_t num, const char* text, size_t length) {
+    Guard guard(lock_);
+    if (!clientIsConnected(num) || !event_) return;
+    std::vector<uint8_t> frame(text, text + length); // The library hands out a mutable, NUL-terminated payload
+    frame.push_back(0);
+    event_(num, WStype_TEXT, frame.data(), length);
+}
+
+bool WebSocketsServer::hostListen(uint16_t port) {
+    Guard guard(lock_);
+    if (port == 0) port = port_;
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(fd, 8) < 0) {
+        ::close(fd);
+        return false;
+    }
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+    listenFd_ = fd;
+    port_ = port;
+    return true;
+}
+
+// === Receiving ===
+
+void WebSocketsServer::loop() {
+    Guard guard(lock_);
+    if (listenFd_ < 0) return;
+    acceptClients();
+    for (uint8_t i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX; i++) {
+        if (_clients[i].socket.fd_ >= 0 && !serviceClient(i)) closeClient(i);
+    }
+}
+
+void WebSocketsServer::acceptClients() {
+    for (;;) {
+        int fd = ::accept(listenFd_, nullptr, nullptr);
+        if (fd < 0) return;
+        int slot = -1;
+        for (int i = 0; i < WEBSOCKETS_SERVER_CLIENT_MAX && slot < 0; i++) {
+            if (!connected_[i] && _clients[i].socket.fd_ < 0) slot = i;
+        }
+        if (slot < 0) { // All slots taken: the library drops the connection too
+            ::close(fd);
+            continue;
+        }
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        int sndbuf = HOST_WS_SNDBUF;
+        setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        _clients[slot].socket.fd_ = fd;
+        _clients[slot].upgraded = false;
+        _clients[slot].rx.clear();
+    }
+}
+
+bool WebSocketsServer::serviceClient(uint8_t num) {
+    WSclient_t& c = _clients[num];
+    char buf[4096];
+    for (;;) {
+        ssize_t n = ::recv(c.socket.fd_, buf, sizeof(buf), 0);
+        if (n > 0) { c.rx.append(buf, n); continue; }
+        if (n == 0) return false;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+        if (errno != EINTR) return false;
+    }
+    if (!c.upgraded) {
+        if (c.rx.find("\r\n\r\n") == std::string::npos) return c.rx.size() < 8192;
+        if (!upgrade(num)) return false;
+    }
+
+    // Frames the client sent (always masked); one frame is dispatched per call
+    // so a chatty client cannot starve the others
+    while (c.socket.fd_ >= 0 && c.rx.size() >= 2) {
+        const uint8_t* p = (const uint8_t*)c.rx.data();
+        uint8_t opcode = p[0] & 0x0F;
+        uint64_t length = p[1] & 0x7F;
+        size_t headerLen = 2;
+        if (length == 126) {
+            if (c.rx.size() < 4) break;
+            length = ((uint64_t)p[2] << 8) | p[3];
+            headerLen = 4;
+        } else if (length == 127) {
+            if (c.rx.size() < 10) break;
+            length = 0;
+            for (int i = 0; i < 8; i++) length = (length << 8) | p[2 + i];
+            headerLen = 10;
+        }
+        bool masked = p[1] & 0x80;
+        if (masked) headerLen += 4;
+        if (c.rx.size() < headerLen + length) break;
+
+        std::vector<uint8_t> payload(c.rx.begin() + headerLen, c.rx.begin() + headerLen + length);
+        if (masked) {
+            const uint8_t* mask = p + headerLen - 4;
+            for (size_t i = 0; i < payload.size(); i++) payload[i] ^= mask[i % 4];
+        }
+        c.rx.erase(0, headerLen + length);
+
+        if (opcode == 0x8) { // Close
+            writeFrame(num, 0x8, "", 0);
+            return false;
+        }
+        if (opcode == 0x9) { // Ping
+            writeFrame(num, 0xA, (const char*)payload.data(), payload.size());
+            continue;
+        }
+        if (opcode == 0x1 && event_) {
+            payload.push_back(0);
+            event_(num, WStype_TEXT, payload.data(), length);
+            break;
+        }
+    }
+    return c.socket.fd_ >= 0;
+}
+
+bool WebSocketsServer::upgrade(uint8_t num) {
+    WSclient_t& c = _clients[num];
+    size_t end = c.rx.find("\r\n\r\n") + 4;
+    std::string request = c.rx.substr(0, end);
+    c.rx.erase(0, end);
+
+    std::string key = headerValue(request, "Sec-WebSocket-Key");
+    if (request.compare(0, 4, "GET ") != 0 || key.empty()) {
+        const char* bad = "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n";
+        writeAll(c.socket.fd_, bad, strlen(bad));
+        return false;
+    }
+    key += "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    uint8_t digest[20];
+    sha1((const uint8_t*)key.data(), key.size(), digest);
+    std::string response = "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                           "Sec-WebSocket-Accept: " + base64(digest, sizeof(digest)) + "\r\n\r\n";
+    if (!writeAll(c.socket.fd_, response.data(), response.size())) return false;
+
+    c.upgraded = true;
+    connected_[num] = true;
+    std::string url = request.substr(4, request.find(' ', 4) - 4);
+    std::vector<uint8_t> urlBuf(url.begin(), url.end());
+    urlBuf.push_back(0);
+    if (event_) event_(num, WStype_CONNECTED, urlBuf.data(), url.size());
+    return true;
+}
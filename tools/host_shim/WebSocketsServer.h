@@ -0,0 +1,89 @@
+#ifndef HOST_WEBSOCKETS_SERVER_H
+#define HOST_WEBSOCKETS_SERVER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <functional>
+#include <mutex>
+#include <string>
+
+// === Host WebSocketsServer ===
+// Two kinds of clients share the client slots:
+//  - In-process: a tool connects a client number, feeds it text frames
+//    (delivered to the event callback like the real library does from loop())
+//    and receives everything the firmware sends through a sink.
+//  - TCP: after hostListen() real WebSocket clients (browsers, load
+//    generators) connect over loopback. loop() accepts them, answers the
+//    upgrade handshake and dispatches their text frames; sends block until
+//    the socket takes the frame, as the library's synchronous write does.
+
+typedef enum { WStype_ERROR, WStype_DISCONNECTED, WStype_CONNECTED, WStype_TEXT, WStype_BIN,
+               WStype_FRAGMENT_TEXT_START, WStype_FRAGMENT_BIN_START, WStype_FRAGMENT, WStype_FRAGMENT_FIN,
+               WStype_PING, WStype_PONG } WStype_t;
+
+#define WEBSOCKETS_SERVER_CLIENT_MAX 5
+#define HOST_WS_SEND_TIMEOUT_MS 5000 // A client that takes no data for this long is dropped
+#define HOST_WS_SNDBUF 5744          // Socket send buffer, like lwIP's TCP_SND_BUF
+
+class WebSocketsServer {
+public:
+    typedef std::function<void(uint8_t num, WStype_t type, uint8_t* payload, size_t length)> WebSocketServerEvent;
+    typedef std::function<void(uint8_t num, const char* text, size_t length)> HostSink;
+
+    explicit WebSocketsServer(uint16_t port) : port_(port) {}
+    void begin() {}
+    void loop();
+    void onEvent(WebSocketServerEvent cb) { event_ = cb; }
+
+    bool sendTXT(uint8_t num, const char* text, size_t length = 0);
+    bool sendTXT(uint8_t num, const uint8_t* text, size_t length) { return sendTXT(num, (const char*)text, length); }
+    bool sendTXT(uint8_t num, const String& text) { return sendTXT(num, text.c_str(), text.length()); }
+    bool broadcastTXT(const char* text, size_t length = 0);
+    bool broadcastTXT(const uint8_t* text, size_t length) { return broadcastTXT((const char*)text, length); }
+    bool broadcastTXT(const String& text) { return broadcastTXT(text.c_str(), text.length()); }
+
+    void disconnect(uint8_t num);
+    void disconnect();
+    uint8_t connectedClients(bool ping = false);
+    bool clientIsConnected(uint8_t num) { return num < WEBSOCKETS_SERVER_CLIENT_MAX && connected_[num]; }
+    IPAddress remoteIP(uint8_t num) { return clientIsConnected(num) ? IPAddress(127, 0, 0, 1) : IPAddress(); }
+
+    // --- Host side ---
+    void hostSetSink(HostSink sink) { sink_ = sink; }
+    bool hostConnect(uint8_t num);
+    void hostReceive(uint8_t num, const char* text, size_t length);
+    uint64_t hostBytesSent() const { return bytesSent_; }
+
+    /**
+     * @brief Accept TCP WebSocket clients on 127.0.0.1:port (0 = the port given to the constructor).
+     * @return false if the port cannot be bound.
+     */
+    bool hostListen(uint16_t port = 0);
+
+protected:
+    struct WSclient_t {
+        WiFiClient socket;
+        WiFiClient* tcp = &socket; // Where the library keeps the connection
+        bool upgraded = false;
+        std::string rx;
+    };
+    WSclient_t _clients[WEBSOCKETS_SERVER_CLIENT_MAX];
+
+private:
+    void acceptClients();
+    bool serviceClient(uint8_t num); // false once the client is gone
+    bool upgrade(uint8_t num);
+    bool writeFrame(uint8_t num, uint8_t opcode, const char* data, size_t length);
+    bool writeAll(int fd, const char* data, size_t length);
+    void closeClient(uint8_t num);
+
+    uint16_t port_;
+    WebSocketServerEvent event_;
+    HostSink sink_;
+    bool connected_[WEBSOCKETS_SERVER_CLIENT_MAX] = {};
+    int listenFd_ = -1;
+    uint64_t bytesSent_ = 0;
+    std::recursive_mutex lock_; // Sends may come from any task
+};
+
+#endif // HOST_WEBSOCKETS_SERVER_H
@@ -0,0 +1,36 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+#include <sys/socket.h>
+
+// The host is always "connected" on loopback
+
+typedef enum { WL_IDLE_STATUS = 0, WL_NO_SSID_AVAIL = 1, WL_CONNECTED = 3, WL_CONNECT_FAILED = 4,
+               WL_CONNECTION_LOST = 5, WL_DISCONNECTED = 6 } wl_status_t;
+#define WIFI_STA 1
+
+class WiFiClass {
+public:
+    void setHostname(const char*) {}
+    void mode(int) {}
+    void begin(const char*, const char*) {}
+    wl_status_t status() { return WL_CONNECTED; }
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+    bool reconnect() { return true; }
+    void disconnect(bool = false) {}
+    void setAutoReconnect(bool) {}
+    void setSleep(bool) {}
+    int RSSI() { return 0; }
+};
+extern WiFiClass WiFi;
+
+// A TCP connection's socket; the WebSocket server owns and closes it
+class WiFiClient {
+public:
+    int fd() const { return fd_; }
+    void stop() { if (fd_ >= 0) ::shutdown(fd_, SHUT_RDWR); } // The server sees EOF and reports the disconnect
+    int fd_ = -1;
+};
+
+#endif // HOST_WIFI_H
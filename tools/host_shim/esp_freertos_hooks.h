@@ -0,0 +1,9 @@
+#ifndef HOST_ESP_FREERTOS_HOOKS_H
+#define HOST_ESP_FREERTOS_HOOKS_H
+
+// No idle task on the host: hooks are accepted and never called (idle reads 0%)
+
+typedef bool (*esp_freertos_idle_cb_t)(void);
+inline int esp_register_freertos_idle_hook_for_cpu(esp_freertos_idle_cb_t, unsigned) { return 0; }
+
+#endif // HOST_ESP_FREERTOS_HOOKS_H
@@ -0,0 +1,37 @@
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+// === Host FreeRTOS Shim ===
+// Tasks are detached std::threads; task notifications are a counting
+// semaphore per task; critical sections share one recursive mutex. There is
+// no priority or core affinity on the host.
+
+#include <stdint.h>
+
+struct HostTask;
+typedef HostTask* TaskHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portTICK_PERIOD_MS 1
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define tskIDLE_PRIORITY 0
+#define configMAX_PRIORITIES 25
+#define portMAX_DELAY 0xFFFFFFFFu
+#define IRAM_ATTR
+
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+void hostEnterCritical();
+void hostExitCritical();
+#define portENTER_CRITICAL(mux) hostEnterCritical()
+#define portEXIT_CRITICAL(mux) hostExitCritical()
+#define portENTER_CRITICAL_ISR(mux) hostEnterCritical()
+#define portEXIT_CRITICAL_ISR(mux) hostExitCritical()
+#define portYIELD_FROM_ISR(woken) (void)(woken)
+
+#endif // HOST_FREERTOS_H
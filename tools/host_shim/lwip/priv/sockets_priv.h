@@ -0,0 +1,31 @@
+#ifndef HOST_LWIP_SOCKETS_PRIV_H
+#define HOST_LWIP_SOCKETS_PRIV_H
+
+#include <lwip/tcp.h>
+
+// Just enough of lwIP's socket internals to reach a socket's pcb
+
+struct netconn {
+    union {
+        struct tcp_pcb* tcp;
+    } pcb;
+};
+
+struct lwip_sock {
+    struct netconn* conn;
+};
+
+#define HOST_LWIP_MAX_SOCKETS 256
+
+static inline struct lwip_sock* lwip_socket_dbg_get_socket(int fd) {
+    static struct tcp_pcb pcbs[HOST_LWIP_MAX_SOCKETS];
+    static struct netconn conns[HOST_LWIP_MAX_SOCKETS];
+    static struct lwip_sock socks[HOST_LWIP_MAX_SOCKETS];
+    if (fd < 0 || fd >= HOST_LWIP_MAX_SOCKETS) return nullptr;
+    pcbs[fd].fd = fd;
+    conns[fd].pcb.tcp = &pcbs[fd];
+    socks[fd].conn = &conns[fd];
+    return &socks[fd];
+}
+
+#endif // HOST_LWIP_SOCKETS_PRIV_H
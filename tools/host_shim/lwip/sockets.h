@@ -0,0 +1,9 @@
+#ifndef HOST_LWIP_SOCKETS_H
+#define HOST_LWIP_SOCKETS_H
+
+// lwIP's BSD socket API is the host's own
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#endif // HOST_LWIP_SOCKETS_H
@@ -0,0 +1,32 @@
+#ifndef HOST_LWIP_TCP_H
+#define HOST_LWIP_TCP_H
+
+#include <stdint.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/sockios.h>
+
+// A pcb is just the kernel socket; the send buffer is what the kernel has left
+
+#define TCP_SND_BUF 5744      // Arduino-ESP32's lwIP setting (4 * MSS)
+#define TCP_SND_QUEUELEN 16   // The kernel has no segment limit to mirror
+
+struct tcp_pcb {
+    int fd;
+};
+
+static inline uint16_t tcp_sndbuf(const struct tcp_pcb* pcb) {
+    int size = 0, queued = 0;
+    socklen_t len = sizeof(size);
+    if (getsockopt(pcb->fd, SOL_SOCKET, SO_SNDBUF, &size, &len) < 0) return 0;
+    if (ioctl(pcb->fd, SIOCOUTQ, &queued) < 0) return 0;
+    size /= 2; // Linux reports double the buffer (the other half is its bookkeeping)
+    int space = size > queued ? size - queued : 0;
+    return (uint16_t)(space > 0xFFFF ? 0xFFFF : space);
+}
+
+static inline uint16_t tcp_sndqueuelen(const struct tcp_pcb*) {
+    return 0;
+}
+
+#endif // HOST_LWIP_TCP_H
@@ -0,0 +1,45 @@
+// Stand-in machine for WebSocket load tests.
+//
+// Runs the real firmware (setup() then loop() forever) on the host shim
+// (tools/host_shim) with the WebSocket server listening on 127.0.0.1, so
+// browsers or tools/loadtest/loadtest.py can drive it like the controller.
+// Axes are simulated in real time and homing succeeds at once, so the machine
+// is ready for PAINT_ALL a moment after start-up.
+//
+// Build (from the repo root):
+//     g++ -O2 -std=gnu++17 -pthread -I tools/host_shim -I src -o host_machine tools/loadtest/host_machine.cpp
+//         tools/host_shim/*.cpp $(find src -name '*.cpp')
+//
+// Usage:
+//     host_machine [--port N]     (default 81, like the controller)
+// Prints "LISTENING <port>" on stdout once clients can connect; the firmware
+// log goes to stderr. Settings and recipes live in $HOST_FS_ROOT (./host_fs).
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Web/BufferedWebSocketsServer.h"
+
+void setup();
+void loop();
+extern BufferedWebSocketsServer webSocket;
+
+int main(int argc, char** argv) {
+    uint16_t port = 81;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--port") == 0 && i + 1 < argc) port = (uint16_t)atoi(argv[++i]);
+        else {
+            fprintf(stderr, "Usage: host_machine [--port N]\n");
+            return 2;
+        }
+    }
+
+    setup();
+    if (!webSocket.hostListen(port)) {
+        fprintf(stderr, "Cannot listen on 127.0.0.1:%u\n", port);
+        return 1;
+    }
+    printf("LISTENING %u\n", port);
+    fflush(stdout);
+    for (;;) loop();
+}
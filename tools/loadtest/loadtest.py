@@ -0,0 +1,412 @@
+#!/usr/bin/env python3
+"""Multi-client WebSocket load test against the host stand-in machine.
+
+Starts tools/loadtest/host_machine (the firmware on the host shim) on a
+loopback port, connects one control client and N load clients, and has the
+control client run a sequence (PAINT_ALL by default) while every load client
+issues GET_STATUS and GET_SETTINGS at the configured rates. Each run uses a
+fresh machine process and an empty settings directory.
+
+By default the sequence is run twice: once with no load clients as the
+baseline and once under load. The report gives round-trip latency
+percentiles per command and the extra sequence time caused by the load.
+
+Every request carries a request id ("#<n> GET_STATUS") and is complete when
+the firmware acks it ({"ack":"<n>","state":"done",...}). The ack's
+timestamps split each round trip into the time spent handling the command
+(doneUs - startUs, reported as "in firmware") and the rest: network, socket
+buffers and waiting for loop() to read the frame. Each load client has one
+request in flight at a time; the control client's sequence is complete when
+its own ack reports "done".
+
+Stalled clients (--stalled) model a browser on a dead link: they send
+GET_STATUS at the status rate but never read, with a small receive buffer.
+The machine should drop them instead of stalling the sequence.
+
+The firmware keeps WEBSOCKETS_SERVER_CLIENT_MAX (5) client slots, so at most
+4 load and stalled clients fit next to the control client.
+
+Usage:
+    loadtest.py --machine ./host_machine [--clients 4] [--status-hz 2]
+                [--settings-hz 1] [--sequence PAINT_ALL] [--port 8181]
+                [--stalled 0] [--no-baseline] [--timeout 600] [--json report.json]
+"""
+import argparse
+import base64
+import json
+import os
+import random
+import re
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+SLOT_LIMIT = 5
+EPOCH_RE = re.compile(rb'\{"settingsEpoch":(\d+),"settingsVersion":(\d+),"baseVersion":(\d+)')
+ACK_RE = re.compile(rb'\{"ack":"([^"]*)","cmd":"[^"]*","state":"(\w+)","ok":(true|false),'
+                    rb'"startUs":(\d+),"doneUs":(\d+)')
+
+
+class WsClient:
+    """Minimal RFC 6455 client: text frames out (masked), frames in."""
+
+    def __init__(self, port, timeout=10.0, rcvbuf=None):
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        if rcvbuf:
+            self.sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, rcvbuf)
+        self.sock.settimeout(timeout)
+        self.sock.connect(("127.0.0.1", port))
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        key = base64.b64encode(os.urandom(16)).decode()
+        self.sock.sendall(("GET / HTTP/1.1\r\nHost: 127.0.0.1:%d\r\nUpgrade: websocket\r\n"
+                           "Connection: Upgrade\r\nSec-WebSocket-Key: %s\r\n"
+                           "Sec-WebSocket-Version: 13\r\n\r\n" % (port, key)).encode())
+        self.buf = b""
+        while b"\r\n\r\n" not in self.buf:
+            chunk = self.sock.recv(4096)
+            if not chunk:
+                raise ConnectionError("connection closed during the handshake (no free client slot?)")
+            self.buf += chunk
+        head, self.buf = self.buf.split(b"\r\n\r\n", 1)
+        if b" 101 " not in head.split(b"\r\n", 1)[0]:
+            raise ConnectionError("upgrade refused: %r" % head[:80])
+        self.received = 0  # Text frames received, including broadcasts
+
+    def send(self, text):
+        data = text.encode()
+        mask = os.urandom(4)
+        if len(data) < 126:
+            header = struct.pack("!BB", 0x81, 0x80 | len(data))
+        else:
+            header = struct.pack("!BBH", 0x81, 0x80 | 126, len(data))
+        masked = bytes(b ^ mask[i % 4] for i, b in enumerate(data))
+        self.sock.sendall(header + mask + masked)
+
+    def _fill(self, n, deadline):
+        while len(self.buf) < n:
+            left = deadline - time.monotonic()
+            if left <= 0:
+                return False
+            self.sock.settimeout(left)
+            try:
+                chunk = self.sock.recv(65536)
+            except socket.timeout:
+                return False
+            if not chunk:
+                raise ConnectionError("connection closed by the machine")
+            self.buf += chunk
+        return True
+
+    def recv(self, timeout):
+        """Next text frame as bytes, or None on timeout."""
+        deadline = time.monotonic() + timeout
+        while True:
+            if not self._fill(2, deadline):
+                return None
+            opcode, length = self.buf[0] & 0x0F, self.buf[1] & 0x7F
+            header = 2
+            if length == 126:
+                if not self._fill(4, deadline):
+                    return None
+                length, = struct.unpack_from("!H", self.buf, 2)
+                header = 4
+            elif length == 127:
+                if not self._fill(10, deadline):
+                    return None
+                length, = struct.unpack_from("!Q", self.buf, 2)
+                header = 10
+            if not self._fill(header + length, deadline):
+                return None
+            payload, self.buf = self.buf[header:header + length], self.buf[header + length:]
+            if opcode == 0x8:
+                raise ConnectionError("machine closed the connection")
+            if opcode == 0x1:
+                self.received += 1
+                return payload
+
+    def drain(self):
+        """Discard frames that already arrived (broadcasts since the last request)."""
+        while self.recv(0.0005) is not None:
+            pass
+
+    def close(self):
+        try:
+            self.sock.close()
+        except OSError:
+            pass
+
+
+def percentile(values, pct):
+    if not values:
+        return None
+    s = sorted(values)
+    return s[min(len(s) - 1, int(round(pct / 100.0 * (len(s) - 1))))]
+
+
+def latency_summary(samples_ms):
+    return {
+        "count": len(samples_ms),
+        "p50": percentile(samples_ms, 50),
+        "p90": percentile(samples_ms, 90),
+        "p99": percentile(samples_ms, 99),
+        "max": max(samples_ms) if samples_ms else None,
+    }
+
+
+class LoadClient(threading.Thread):
+    """Issues GET_STATUS / GET_SETTINGS on a fixed schedule and times the replies."""
+
+    def __init__(self, port, status_hz, settings_hz, stop, reply_timeout):
+        super().__init__(daemon=True)
+        self.client = WsClient(port)
+        self.stop = stop
+        self.reply_timeout = reply_timeout
+        self.schedule = []
+        if status_hz > 0:
+            self.schedule.append(["GET_STATUS", 1.0 / status_hz, 0.0])
+        if settings_hz > 0:
+            self.schedule.append(["GET_SETTINGS", 1.0 / settings_hz, 0.0])
+        self.rtt_ms = {name: [] for name, _, _ in self.schedule}
+        self.firmware_ms = {name: [] for name, _, _ in self.schedule}
+        self.next_id = 0
+        self.timeouts = 0
+        self.error = None
+        self.epoch = self.version = None
+
+    def _request(self, name):
+        if name == "GET_SETTINGS" and self.epoch is not None:
+            text, want = "GET_SETTINGS %d %d" % (self.epoch, self.version), self.version
+        else:
+            text, want = "GET_STATUS" if name == "GET_STATUS" else "GET_SETTINGS", 0
+        self.next_id += 1
+        request_id = str(self.next_id).encode()
+        self.client.drain()
+        start = time.monotonic()
+        self.client.send("#%d %s" % (self.next_id, text))
+        deadline = start + self.reply_timeout
+        while True:
+            msg = self.client.recv(max(0.0, deadline - time.monotonic()))
+            if msg is None:
+                self.timeouts += 1
+                return
+            m = EPOCH_RE.match(msg)
+            if m and int(m.group(3)) == want:
+                self.epoch, self.version = int(m.group(1)), int(m.group(2))
+                continue
+            m = ACK_RE.match(msg)
+            if not m or m.group(1) != request_id or m.group(2) != b"done":
+                continue  # Broadcast (position, status, log) or someone else's change
+            self.rtt_ms[name].append((time.monotonic() - start) * 1000.0)
+            self.firmware_ms[name].append((int(m.group(5)) - int(m.group(4))) / 1000.0)
+            return
+
+    def run(self):
+        now = time.monotonic()
+        for entry in self.schedule:
+            entry[2] = now + random.uniform(0, entry[1])  # Spread clients over the period
+        try:
+            while not self.stop.is_set() and self.schedule:
+                entry = min(self.schedule, key=lambda e: e[2])
+                wait = entry[2] - time.monotonic()
+                if wait > 0:
+                    if self.stop.wait(wait):
+                        break
+                self._request(entry[0])
+                entry[2] = max(entry[2] + entry[1], time.monotonic())
+        except (OSError, ConnectionError) as e:
+            self.error = str(e)
+        finally:
+            self.client.close()
+
+
+class StalledClient(threading.Thread):
+    """Sends GET_STATUS but never reads; afterwards reports whether the machine dropped it."""
+
+    def __init__(self, port, status_hz, stop):
+        super().__init__(daemon=True)
+        self.client = WsClient(port, rcvbuf=4096)
+        self.period = 1.0 / status_hz if status_hz > 0 else 0.5
+        self.stop = stop
+        self.sent = 0
+
+    def run(self):
+        while not self.stop.wait(self.period):
+            try:
+                self.client.send("GET_STATUS")
+                self.sent += 1
+            except OSError:
+                return  # Dropped (or our own send buffer is full)
+
+    def dropped(self):
+        """Read what is left; the machine closed the connection if we reach EOF."""
+        self.client.sock.settimeout(0.5)
+        try:
+            while self.client.sock.recv(65536):
+                pass
+            return True
+        except socket.timeout:
+            return False
+        except OSError:
+            return True
+        finally:
+            self.client.close()
+
+
+def start_machine(path, port, fs_root):
+    env = dict(os.environ, HOST_FS_ROOT=fs_root)
+    proc = subprocess.Popen([path, "--port", str(port)], stdout=subprocess.PIPE,
+                            stderr=subprocess.DEVNULL, env=env)
+    line = proc.stdout.readline().decode().strip()
+    if not line.startswith("LISTENING"):
+        proc.kill()
+        raise RuntimeError("host machine did not start (got %r)" % line)
+    return proc
+
+
+def wait_ready(control, timeout):
+    """Poll GET_STATUS until the machine reports it is homed and idle."""
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        control.send("GET_STATUS")
+        end = time.monotonic() + 1.0
+        while time.monotonic() < end:
+            msg = control.recv(end - time.monotonic())
+            if msg and b'"allHomed":true' in msg and b'"isMoving":false' in msg:
+                return True
+        time.sleep(0.2)
+    return False
+
+
+def run_once(args, clients, stalled, fs_root):
+    proc = start_machine(args.machine, args.port, fs_root)
+    stop = threading.Event()
+    loaders = []
+    stallers = []
+    try:
+        control = WsClient(args.port)
+        if not wait_ready(control, 30):
+            raise RuntimeError("machine never reported ready (homed and idle)")
+        for _ in range(clients):
+            loaders.append(LoadClient(args.port, args.status_hz, args.settings_hz, stop, args.reply_timeout))
+        for _ in range(stalled):
+            stallers.append(StalledClient(args.port, args.status_hz, stop))
+        for t in loaders + stallers:
+            t.start()
+        time.sleep(args.warmup)
+
+        start = time.monotonic()
+        control.send("#seq " + args.sequence)
+        outcome, last = "timeout", ""
+        deadline = start + args.timeout
+        while time.monotonic() < deadline:
+            msg = control.recv(deadline - time.monotonic())
+            if msg is None:
+                break
+            if msg.startswith(b'{"id":"seq",'):
+                last = msg.decode(errors="replace")  # Status message for the sequence
+                continue
+            m = ACK_RE.match(msg)
+            if m and m.group(1) == b"seq" and m.group(2) == b"done":
+                outcome = "done" if m.group(3) == b"true" else "error"
+                break
+        elapsed = time.monotonic() - start
+        stop.set()
+        for t in loaders + stallers:
+            t.join(args.reply_timeout + 1.0)
+        stalled_dropped = sum(1 for t in stallers if t.dropped())
+        control.close()
+    finally:
+        stop.set()
+        proc.kill()
+        proc.wait()
+
+    rtt, firmware = {}, {}
+    for t in loaders:
+        for name, values in t.rtt_ms.items():
+            rtt.setdefault(name, []).extend(values)
+        for name, values in t.firmware_ms.items():
+            firmware.setdefault(name, []).extend(values)
+    return {
+        "clients": clients,
+        "outcome": outcome,
+        "message": last,
+        "sequenceSeconds": round(elapsed, 3),
+        "rttMs": {name: latency_summary(v) for name, v in rtt.items()},
+        "firmwareMs": {name: latency_summary(v) for name, v in firmware.items()},
+        "timeouts": sum(t.timeouts for t in loaders),
+        "framesPerClient": [t.client.received for t in loaders],
+        "clientErrors": [t.error for t in loaders if t.error],
+        "stalled": stalled,
+        "stalledDropped": stalled_dropped,
+    }
+
+
+def fmt_ms(v):
+    return "%8.2f" % v if v is not None else "       -"
+
+
+def print_run(label, r):
+    print("%s: %d load client(s), %s in %.2f s" % (label, r["clients"], r["outcome"], r["sequenceSeconds"]))
+    if r["outcome"] != "done":
+        print("    last message: %s" % r["message"])
+    for name, s in sorted(r["rttMs"].items()):
+        print("    %-13s n=%-6d p50 %s  p90 %s  p99 %s  max %s ms" % (
+            name, s["count"], fmt_ms(s["p50"]), fmt_ms(s["p90"]), fmt_ms(s["p99"]), fmt_ms(s["max"])))
+        f = r["firmwareMs"][name]
+        print("    %-13s in firmware  p50 %s  p90 %s  p99 %s  max %s ms" % (
+            "", fmt_ms(f["p50"]), fmt_ms(f["p90"]), fmt_ms(f["p99"]), fmt_ms(f["max"])))
+    if r["clients"]:
+        print("    reply timeouts %d, frames per client %s" % (r["timeouts"], r["framesPerClient"]))
+    if r["stalled"]:
+        print("    stalled clients %d, dropped by the machine %d" % (r["stalled"], r["stalledDropped"]))
+    for e in r["clientErrors"]:
+        print("    client error: %s" % e)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("--machine", required=True, help="host_machine binary")
+    ap.add_argument("--port", type=int, default=8181)
+    ap.add_argument("--clients", type=int, default=4, help="load clients (besides the control client)")
+    ap.add_argument("--status-hz", type=float, default=2.0, help="GET_STATUS per second per client")
+    ap.add_argument("--settings-hz", type=float, default=1.0, help="GET_SETTINGS per second per client")
+    ap.add_argument("--sequence", default="PAINT_ALL", help="command the control client runs")
+    ap.add_argument("--warmup", type=float, default=1.0, help="seconds of load before the sequence starts")
+    ap.add_argument("--reply-timeout", type=float, default=5.0)
+    ap.add_argument("--timeout", type=float, default=600.0, help="sequence timeout in seconds")
+    ap.add_argument("--stalled", type=int, default=0, help="clients that never read (loaded run only)")
+    ap.add_argument("--no-baseline", action="store_true", help="skip the run without load clients")
+    ap.add_argument("--json", help="also write the report to this file")
+    args = ap.parse_args()
+
+    if args.clients + args.stalled + 1 > SLOT_LIMIT:
+        ap.error("at most %d load and stalled clients fit next to the control client" % (SLOT_LIMIT - 1))
+
+    report = {"sequence": args.sequence, "statusHz": args.status_hz, "settingsHz": args.settings_hz}
+    with tempfile.TemporaryDirectory() as fs_root:
+        if not args.no_baseline:
+            report["baseline"] = run_once(args, 0, 0, os.path.join(fs_root, "baseline"))
+            print_run("Baseline", report["baseline"])
+        report["loaded"] = run_once(args, args.clients, args.stalled, os.path.join(fs_root, "loaded"))
+        print_run("Loaded", report["loaded"])
+
+    base = report.get("baseline")
+    if base and base["outcome"] == "done" and report["loaded"]["outcome"] == "done":
+        extra = report["loaded"]["sequenceSeconds"] - base["sequenceSeconds"]
+        report["extraSeconds"] = round(extra, 3)
+        report["extraPct"] = round(extra / base["sequenceSeconds"] * 100.0, 2) if base["sequenceSeconds"] else None
+        print("Extra sequence time under load: %+.2f s (%+.1f%%)" % (extra, report["extraPct"] or 0.0))
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(report, f, indent=2)
+    ok = report["loaded"]["outcome"] == "done" and (not base or base["outcome"] == "done")
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""Decode binary log frames from the firmware (see src/Logging/Log.h).
+
+In binary log mode (SET_LOG_MODE BINARY) each entry is written to Serial as
+
+    0xA5 | len | timestampUs:u32 | fmtAddr:u32 | level:u8 | argc:u8 | strUsed:u8
+         | args:u32[argc] | str[strUsed]
+
+fmtAddr is the address of the format literal in the firmware image, so the
+matching ELF (.pio/build/esp32/firmware.elf) is needed to turn frames back
+into text. Bytes outside valid frames (boot ROM output, plain Serial.printf)
+are passed through unchanged.
+
+Usage:
+    log_decode.py firmware.elf capture.bin
+    log_decode.py firmware.elf - < capture.bin
+"""
+import re
+import struct
+import sys
+
+FRAME_SYNC = 0xA5
+LEVEL_NAMES = {1: "ERROR", 2: "WARN", 3: "INFO", 4: "DEBUG"}
+SPEC_RE = re.compile(r"%([-+ #0-9.]*)[hlzjtL]*([diucxXofFeEgGs%])")
+
+
+class Elf:
+    """Just enough of an ELF reader to read strings at a virtual address.
+    ELF32 for the target; ELF64 so host builds can be decoded too."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] not in (1, 2):
+            raise ValueError("%s is not an ELF file" % path)
+        is64 = self.data[4] == 2
+        shoff, = struct.unpack_from("<Q" if is64 else "<I", self.data, 0x28 if is64 else 0x20)
+        shentsize, shnum = struct.unpack_from("<HH", self.data, 0x3A if is64 else 0x2E)
+        entry = "<IIQQQQ" if is64 else "<IIIIII"
+        self.sections = []
+        for i in range(shnum):
+            (_name, sh_type, flags, addr, offset, size) = struct.unpack_from(
+                entry, self.data, shoff + i * shentsize)
+            if sh_type == 1 and flags & 0x2 and size:  # PROGBITS + ALLOC
+                self.sections.append((addr, offset, size))
+
+    def string_at(self, addr):
+        for base, offset, size in self.sections:
+            if base <= addr < base + size:
+                start = offset + (addr - base)
+                end = self.data.index(b"\0", start)
+                return self.data[start:end].decode("utf-8", "replace")
+        return None
+
+
+def format_entry(fmt, args, strings):
+    """Same conversions as formatRecord() in Log.cpp."""
+    it = iter(args)
+
+    def repl(m):
+        flags, conv = m.group(1), m.group(2)
+        if conv == "%":
+            return "%"
+        raw = next(it, 0)
+        if conv in "di":
+            return ("%" + flags + "d") % struct.unpack("<i", struct.pack("<I", raw))[0]
+        if conv == "c":
+            return ("%" + flags + "c") % (raw & 0xFF)
+        if conv in "uxXo":
+            return ("%" + flags + (conv if conv != "u" else "d")) % raw
+        if conv in "fFeEgG":
+            return ("%" + flags + conv) % struct.unpack("<f", struct.pack("<I", raw))[0]
+        # %s: offset into the copied string area
+        end = strings.find(b"\0", raw)
+        text = strings[raw:end if end >= 0 else None].decode("utf-8", "replace")
+        return ("%" + flags + "s") % text
+
+    return SPEC_RE.sub(repl, fmt)
+
+
+def decode(elf, data, out):
+    i = 0
+    text_start = 0
+    while i < len(data):
+        if data[i] != FRAME_SYNC or i + 2 + 11 > len(data):
+            i += 1
+            continue
+        length = data[i + 1]
+        body = data[i + 2:i + 2 + length]
+        if len(body) != length or length < 11:
+            i += 1
+            continue
+        ts, fmt_addr, level, argc, str_used = struct.unpack_from("<IIBBB", body, 0)
+        if length != 11 + argc * 4 + str_used or level not in LEVEL_NAMES:
+            i += 1  # Not a frame, just a 0xA5 byte in text
+            continue
+        fmt = elf.string_at(fmt_addr)
+        if fmt is None:
+            i += 1
+            continue
+
+        out.write(data[text_start:i].decode("utf-8", "replace"))
+        args = struct.unpack_from("<%dI" % argc, body, 11)
+        strings = body[11 + argc * 4:]
+        out.write("[%5d.%03d] [%s] %s\n" % (ts // 1000000, (ts // 1000) % 1000,
+                                          LEVEL_NAMES[level], format_entry(fmt, args, strings)))
+        i += 2 + length
+        text_start = i
+    out.write(data[text_start:].decode("utf-8", "replace"))
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write(__doc__)
+        return 2
+    elf = Elf(argv[1])
+    data = sys.stdin.buffer.read() if argv[2] == "-" else open(argv[2], "rb").read()
+    decode(elf, data, sys.stdout)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,74 @@
+#include "CycleTime.h"
+#include <math.h>
+
+void machineTimingDefaults(MachineTiming& t) {
+    t.xyAccel = 20000.0f;
+    t.zAccel = 13000.0f;
+    t.zSpeedHz = 5000.0f;
+    t.homeSpeedHz = 20000.0f;
+    t.homeAccel = 20000.0f;
+    t.rotSpeedHz = 2000.0f;
+    t.rotAccel = 1000.0f;
+    t.stepsPerDegree = 11.11111f;
+    t.servoSettleS = 0.3f;
+    t.segmentOverheadS = 0.005f;
+}
+
+float trapezoidTime(float steps, float speedHz, float accel) {
+    float d = fabsf(steps);
+    if (d == 0.0f || speedHz <= 0.0f) return 0.0f;
+    if (accel <= 0.0f) return d / speedHz;
+    float rampSteps = speedHz * speedHz / accel; // Both ramps together
+    if (d >= rampSteps) return d / speedHz + speedHz / accel;
+    return 2.0f * sqrtf(d / accel);
+}
+
+static float xyMoveTime(float dx, float dy, float speedHz, float accel) {
+    return fmaxf(trapezoidTime(dx, speedHz, accel), trapezoidTime(dy, speedHz, accel));
+}
+
+// startXYLinearSteps_Paint: straight line at speedHz/accel along the move
+static float xyLinearMoveTime(float dx, float dy, float speedHz, float accel) {
+    return trapezoidTime(sqrtf(dx * dx + dy * dy), speedHz, accel);
+}
+
+float sideCycleTime(const Toolpath& path, const MachineTiming& t) {
+    float x = 0.0f, y = 0.0f, z = 0.0f, rotSteps = 0.0f;
+    float time = t.servoSettleS;
+
+    for (int i = 0; i < path.count; i++) {
+        // A sweep and its run-in/run-out are one move, like executeToolpath() runs them
+        int last = toolpathMoveEnd(path, i, (int32_t)x, (int32_t)y);
+        const ToolpathSegment& seg = path.segments[last];
+        i = last;
+        switch (seg.type) {
+            case SEG_ROTATE: {
+                float target = roundf(seg.x * t.stepsPerDegree);
+                time += trapezoidTime(target - rotSteps, t.rotSpeedHz, t.rotAccel);
+                rotSteps = target;
+                break;
+            }
+            case SEG_MOVE_Z:
+                time += trapezoidTime(seg.x - z, (float)seg.speedHz, t.zAccel);
+                z = (float)seg.x;
+                break;
+            case SEG_TRAVEL_XY:
+                time += xyMoveTime(seg.x - x, seg.y - y, (float)seg.speedHz, t.xyAccel);
+                x = (float)seg.x;
+                y = (float)seg.y;
+                break;
+            default:
+                time += xyLinearMoveTime(seg.x - x, seg.y - y, (float)seg.speedHz, t.xyAccel);
+                x = (float)seg.x;
+                y = (float)seg.y;
+                break;
+        }
+        time += t.segmentOverheadS;
+    }
+
+    // Post-pattern: Z to 0, XY to (0,0), rotation to 0
+    time += trapezoidTime(z, t.zSpeedHz, t.zAccel);
+    time += xyMoveTime(x, y, t.homeSpeedHz, t.homeAccel);
+    time += trapezoidTime(rotSteps, t.rotSpeedHz, t.rotAccel);
+    return time;
+}
@@ -0,0 +1,45 @@
+#ifndef CYCLE_TIME_H
+#define CYCLE_TIME_H
+
+#include "Painting/Patterns/ToolpathCompiler.h"
+
+// === Paint Cycle-Time Model ===
+// Time for one side as processPaintingStateMachine() runs it: servo settle,
+// the compiled toolpath (executeToolpath), then Z up, XY home and rotation
+// back to 0. Every move is a trapezoidal profile (v^2/a ramps, triangular when
+// the move is too short to reach speed). Travel moves drive X and Y
+// independently with the same speed/accel, so they take as long as the longer
+// axis; sweeps and step-overs are straight lines at the given speed.
+
+struct MachineTiming {
+    float xyAccel;          // Paint moves (patternXAccel)
+    float zAccel;           // patternZAccel
+    float zSpeedHz;         // Z return to safe height (patternZSpeed)
+    float homeSpeedHz;      // XY return to (0,0) (patternXSpeed)
+    float homeAccel;        // patternXAccel
+    float rotSpeedHz;       // patternRotSpeed
+    float rotAccel;         // patternRotAccel
+    float stepsPerDegree;   // STEPS_PER_DEGREE
+    float servoSettleS;     // Pitch servo delay before the pattern
+    float segmentOverheadS; // Per-segment status broadcast and wait loop
+};
+
+/**
+ * @brief Firmware defaults (main.cpp / GeneralSettings_PinDef.h).
+ */
+void machineTimingDefaults(MachineTiming& t);
+
+/**
+ * @brief Duration of a trapezoidal move.
+ * @param steps Distance (steps, sign ignored).
+ * @param speedHz Cruise speed (steps/s).
+ * @param accel Acceleration (steps/s^2), <= 0 for an instant start.
+ */
+float trapezoidTime(float steps, float speedHz, float accel);
+
+/**
+ * @brief Time to paint one side starting from X/Y/Z/rotation 0 and returning there.
+ */
+float sideCycleTime(const Toolpath& path, const MachineTiming& t);
+
+#endif // CYCLE_TIME_H
@@ -0,0 +1,94 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <stddef.h>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// === Work-Stealing Pool ===
+// run() splits [0, count) into grain-sized chunks and deals each worker a
+// contiguous block of them. A worker takes chunks from the back of its own
+// deque and, once that is empty, steals from the front of the others, so
+// uneven chunk costs (a slow Z height, a long pattern) even out without a
+// shared queue. No chunk spawns new work, so a worker that finds every deque
+// empty is done.
+
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threads)
+        : threads_(threads > 0 ? threads : (int)std::thread::hardware_concurrency()) {
+        if (threads_ < 1) threads_ = 1;
+    }
+
+    int threads() const { return threads_; }
+
+    // Chunks taken from another worker during the last run()
+    size_t steals() const { return steals_; }
+
+    /**
+     * @brief Call fn(begin, end, worker) over [0, count) and wait for all of it.
+     * worker is in [0, threads()) and can index per-thread scratch.
+     */
+    template <typename Fn>
+    void run(size_t count, size_t grain, Fn fn) {
+        if (grain < 1) grain = 1;
+        std::vector<Queue> queues(threads_);
+        size_t chunks = (count + grain - 1) / grain;
+        for (size_t c = 0; c < chunks; c++) {
+            Queue& q = queues[c * threads_ / chunks];
+            q.ranges.push_back(Range{c * grain, c * grain + grain < count ? c * grain + grain : count});
+        }
+
+        std::atomic<size_t> steals(0);
+        auto worker = [&](int self) {
+            Range r;
+            while (take(queues, self, r, steals)) fn(r.begin, r.end, self);
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads_; t++) pool.emplace_back(worker, t);
+        worker(0);
+        for (std::thread& t : pool) t.join();
+        steals_ = steals.load();
+    }
+
+private:
+    struct Range {
+        size_t begin;
+        size_t end;
+    };
+    struct Queue {
+        std::mutex lock;
+        std::deque<Range> ranges;
+    };
+
+    bool take(std::vector<Queue>& queues, int self, Range& out, std::atomic<size_t>& steals) {
+        {
+            Queue& own = queues[self];
+            std::lock_guard<std::mutex> guard(own.lock);
+            if (!own.ranges.empty()) {
+                out = own.ranges.back();
+                own.ranges.pop_back();
+                return true;
+            }
+        }
+        for (int i = 1; i < threads_; i++) {
+            Queue& victim = queues[(self + i) % threads_];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (!victim.ranges.empty()) {
+                out = victim.ranges.front();
+                victim.ranges.pop_front();
+                steals++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int threads_;
+    size_t steals_ = 0;
+};
+
+#endif // WORK_STEALING_POOL_H
@@ -0,0 +1,339 @@
+// Parallel paint-settings optimizer.
+//
+// For every side, evaluates each combination of sweep speed, XY accel, Z
+// height and pass spacing: compiles the toolpath with the firmware's
+// ToolpathCompiler, times it with the cycle-time model (CycleTime.h) and
+// deposits it with the spray model from tools/paint_sim. Combinations run on a
+// work-stealing thread pool. Prints the Pareto front of cycle time vs. quality
+// (fraction of the target at or above --min-mil) per side, and exports the
+// fastest acceptable settings as firmware commands.
+//
+// Build (from the repo root):
+//     g++ -O3 -march=native -std=c++17 -pthread -I src -I tools/paint_sim -o paint_opt tools/paint_opt/paint_opt.cpp
+//         tools/paint_opt/CycleTime.cpp tools/paint_sim/Deposition.cpp src/Painting/Patterns/ToolpathCompiler.cpp
+//
+// Ranges are "value", "a,b,c" or "from:to:step".
+//     --speed R           Sweep speed, steps/s (default 4000:20000:500)
+//     --accel R           XY accel, steps/s^2 (default 20000, the firmware's patternXAccel)
+//     --z R               Paint Z height (default 0.5:3:0.1)
+//     --spacing R         Pass spacing; passes are added/removed to cover the
+//                         same span (default: the item pitch, 3 + gap)
+//     --side N            Only side N
+//     --pattern DEG       Pattern/raster angle for all sides (default 0/90/0/90)
+//     --pitch DEG         Servo pitch written to the export (default 30)
+//     --overtravel        Sweeps get a run-in/run-out for the candidate accel
+//                         (SET_SWEEP_OVERTRAVEL 1); the spray model assumes
+//                         cruise speed, which only holds on the items with it
+//     --gap-x IN --gap-y IN --cols N --rows N --tray-w IN --tray-h IN
+//     --flux F --sigma0 IN --sigma-per-z IN --res IN (default 0.1) --min-mil MIL (default 0.5)
+//     --accept FRAC       Quality needed to be acceptable (default 0.95)
+//     --max-mil MIL       Thicker than this anywhere is rejected (runs) (default 3)
+//     --threads N         Worker threads (default: all cores)
+//     --export FILE       Write the commands to FILE instead of stdout
+//     --json              Fronts and winners as JSON
+//
+// Accel and pass spacing have no command yet: when they differ from the
+// firmware's values the export says so in a comment.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "Deposition.h"
+#include "SimSides.h"
+#include "CycleTime.h"
+#include "WorkStealingPool.h"
+
+static const float FIRMWARE_ACCEL = 20000.0f;
+
+struct Candidate {
+    int side;
+    float speedHz;
+    float accel;
+    float z;
+    float spacing;
+    int passes;
+    bool ok;           // Compiled and sprayed
+    float cycleS;
+    FilmStats stats;
+};
+
+static void usage() {
+    fprintf(stderr, "usage: paint_opt [--speed R] [--accel R] [--z R] [--spacing R] [--side N] [--pattern DEG] [--pitch DEG] [--overtravel]\n"
+                    "                 [--gap-x IN] [--gap-y IN] [--cols N] [--rows N] [--tray-w IN] [--tray-h IN]\n"
+                    "                 [--flux F] [--sigma0 IN] [--sigma-per-z IN] [--res IN] [--min-mil MIL]\n"
+                    "                 [--accept FRAC] [--max-mil MIL] [--threads N] [--export FILE] [--json]\n"
+                    "ranges: value | a,b,c | from:to:step\n");
+    exit(2);
+}
+
+static bool parseRange(const char* text, std::vector<float>& out) {
+    out.clear();
+    float from, to, step;
+    if (sscanf(text, "%f:%f:%f", &from, &to, &step) == 3) {
+        if (step <= 0.0f || to < from) return false;
+        for (int i = 0; from + i * step <= to + step * 1e-3f; i++) out.push_back(from + i * step);
+        return true;
+    }
+    const char* p = text;
+    while (*p) {
+        char* end;
+        float v = strtof(p, &end);
+        if (end == p) return false;
+        out.push_back(v);
+        p = (*end == ',') ? end + 1 : end;
+    }
+    return !out.empty();
+}
+
+// Pass count and step-over for a spacing, covering the span the default passes cover
+static void applySpacing(ToolpathParams& p, float spacing) {
+    if (p.patternType == 0) {
+        float span = (p.gridCols - 1) * (p.itemWidth + p.gapX);
+        p.gridCols = (int)ceilf(span / spacing - 1e-3f) + 1;
+        p.itemWidth = spacing;
+        p.gapX = 0.0f;
+    } else {
+        float span = (p.gridRows - 1) * (p.itemHeight + p.gapY);
+        p.gridRows = (int)ceilf(span / spacing - 1e-3f) + 1;
+        p.itemHeight = spacing;
+        p.gapY = 0.0f;
+    }
+}
+
+static float defaultSpacing(const ToolpathParams& p) {
+    return p.patternType == 0 ? p.itemWidth + p.gapX : p.itemHeight + p.gapY;
+}
+
+static void evaluate(Candidate& c, const ToolpathParams& base, const DepositionModel& model,
+                     const MachineTiming& timingBase, float res, float minMil) {
+    ToolpathParams p = base;
+    p.patternType = base.patternType;
+    p.speedHz = c.speedHz;
+    p.startZ = c.z;
+    if (p.sweepAccel > 0.0f) p.sweepAccel = c.accel; // --overtravel
+    applySpacing(p, c.spacing);
+    c.passes = p.patternType == 0 ? p.gridCols : p.gridRows;
+    c.ok = false;
+
+    Toolpath path;
+    if (!compileSideToolpath(SIM_SIDE_CONFIGS[c.side], p, path)) return;
+    MachineTiming timing = timingBase;
+    timing.xyAccel = c.accel;
+    c.cycleS = sideCycleTime(path, timing);
+
+    FilmRect target;
+    if (!toolpathSprayBounds(path, p.stepsPerInchXY, target)) return;
+    float margin = 4.0f * toolpathMaxSigma(model, path, p.stepsPerInchZ) + res;
+    FilmGrid grid = {};
+    FilmRect area = {target.x0 - margin, target.y0 - margin, target.x1 + margin, target.y1 + margin};
+    if (!filmGridInit(grid, area, res)) return;
+    float sprayTime = depositToolpath(grid, model, path, p.stepsPerInchXY, p.stepsPerInchZ);
+    filmStats(grid, target, 0.8f, minMil, model, sprayTime, c.stats);
+    filmGridFree(grid);
+    c.ok = true;
+}
+
+// Lowest cycle time first; each point must beat the quality of every faster one
+static std::vector<const Candidate*> paretoFront(const std::vector<Candidate>& all, int side) {
+    std::vector<const Candidate*> pts;
+    for (const Candidate& c : all) {
+        if (c.side == side && c.ok) pts.push_back(&c);
+    }
+    std::sort(pts.begin(), pts.end(), [](const Candidate* a, const Candidate* b) {
+        if (a->cycleS != b->cycleS) return a->cycleS < b->cycleS;
+        return a->stats.aboveMin > b->stats.aboveMin;
+    });
+    std::vector<const Candidate*> front;
+    float best = -1.0f;
+    for (const Candidate* c : pts) {
+        if (c->stats.aboveMin > best) {
+            front.push_back(c);
+            best = c->stats.aboveMin;
+        }
+    }
+    return front;
+}
+
+static const Candidate* fastestAcceptable(const std::vector<const Candidate*>& front, float accept, float maxMil) {
+    for (const Candidate* c : front) { // Front is sorted by cycle time
+        if (c->stats.aboveMin >= accept && c->stats.maxMil <= maxMil) return c;
+    }
+    return nullptr;
+}
+
+static void writeExport(FILE* out, const Candidate* winners[4], const ToolpathParams& base, int pitch,
+                        const int patterns[4]) {
+    fprintf(out, "# Paint settings from paint_opt - send each line as a WebSocket command\n");
+    for (int side = 0; side < 4; side++) {
+        const Candidate* w = winners[side];
+        if (!w) continue;
+        fprintf(out, "# %s: cycle %.2f s, %.1f%% at min film, max %.2f mil, CoV %.3f\n", SIM_SIDE_NAMES[side], w->cycleS,
+                w->stats.aboveMin * 100.0f, w->stats.maxMil, w->stats.cov);
+        ToolpathParams p = base;
+        p.patternType = patterns[side];
+        if (fabsf(w->accel - FIRMWARE_ACCEL) > 0.5f) {
+            fprintf(out, "#   needs patternXAccel = %.0f (no command, firmware uses %.0f)\n", w->accel, FIRMWARE_ACCEL);
+        }
+        if (fabsf(w->spacing - defaultSpacing(p)) > 1e-3f) {
+            fprintf(out, "#   needs pass spacing %.3f in (%d passes); firmware uses the item pitch %.3f\n", w->spacing,
+                    w->passes, defaultSpacing(p));
+        }
+        fprintf(out, "SET_PAINT_SIDE_SETTINGS %d %.2f %d %d %.0f\n", side, w->z, pitch, patterns[side], w->speedHz);
+    }
+    fprintf(out, "SET_SWEEP_OVERTRAVEL %d\n", base.sweepAccel > 0.0f ? 1 : 0);
+    // Starts are not optimized; exported so the machine runs the start the paths were evaluated with
+    fprintf(out, "{\"command\":\"SET_PAINT_STARTS\",\"data\":{");
+    for (int side = 0; side < 4; side++) {
+        fprintf(out, "%s\"X%d\":%.3f,\"Y%d\":%.3f", side ? "," : "", side, SIM_DEFAULT_START_X[side], side,
+                SIM_DEFAULT_START_Y[side]);
+    }
+    fprintf(out, "}}\n");
+}
+
+int main(int argc, char** argv) {
+    ToolpathParams base;
+    simDefaultParams(base);
+    DepositionModel model = {75.0f, 0.25f, 0.5f};
+    MachineTiming timing;
+    machineTimingDefaults(timing);
+
+    std::vector<float> speeds, accels, zs, spacings;
+    parseRange("4000:20000:500", speeds);
+    parseRange("20000", accels);
+    parseRange("0.5:3:0.1", zs);
+    float res = 0.1f, minMil = 0.5f, accept = 0.95f, maxMil = 3.0f;
+    int onlySide = -1, patternOverride = -1, pitch = 30, threads = 0;
+    bool json = false;
+    const char* exportFile = nullptr;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        if (i + 1 >= argc && strcmp(a, "--json") != 0 && strcmp(a, "--overtravel") != 0) usage();
+        auto range = [&](std::vector<float>& out) { if (!parseRange(argv[++i], out)) usage(); };
+        auto value = [&]() { return (float)atof(argv[++i]); };
+        if (!strcmp(a, "--speed")) range(speeds);
+        else if (!strcmp(a, "--accel")) range(accels);
+        else if (!strcmp(a, "--z")) range(zs);
+        else if (!strcmp(a, "--spacing")) range(spacings);
+        else if (!strcmp(a, "--side")) onlySide = (int)value();
+        else if (!strcmp(a, "--pattern")) patternOverride = (int)value();
+        else if (!strcmp(a, "--pitch")) pitch = (int)value();
+        else if (!strcmp(a, "--gap-x")) base.gapX = value();
+        else if (!strcmp(a, "--gap-y")) base.gapY = value();
+        else if (!strcmp(a, "--cols")) base.gridCols = (int)value();
+        else if (!strcmp(a, "--rows")) base.gridRows = (int)value();
+        else if (!strcmp(a, "--tray-w")) base.trayWidth = value();
+        else if (!strcmp(a, "--tray-h")) base.trayHeight = value();
+        else if (!strcmp(a, "--flux")) model.flux = value();
+        else if (!strcmp(a, "--sigma0")) model.sigma0 = value();
+        else if (!strcmp(a, "--sigma-per-z")) model.sigmaPerZ = value();
+        else if (!strcmp(a, "--res")) res = value();
+        else if (!strcmp(a, "--min-mil")) minMil = value();
+        else if (!strcmp(a, "--accept")) accept = value();
+        else if (!strcmp(a, "--max-mil")) maxMil = value();
+        else if (!strcmp(a, "--threads")) threads = (int)value();
+        else if (!strcmp(a, "--export")) exportFile = argv[++i];
+        else if (!strcmp(a, "--json")) json = true;
+        else if (!strcmp(a, "--overtravel")) base.sweepAccel = FIRMWARE_ACCEL;
+        else usage();
+    }
+    if (res <= 0.0f || onlySide > 3) usage();
+    for (float s : spacings) {
+        if (s <= 0.0f) usage();
+    }
+
+    // Every (side, speed, accel, z, spacing) combination
+    int patterns[4];
+    std::vector<Candidate> candidates;
+    for (int side = 0; side < 4; side++) {
+        patterns[side] = patternOverride >= 0 ? patternOverride : SIM_DEFAULT_PATTERN[side];
+        if (onlySide >= 0 && side != onlySide) continue;
+        ToolpathParams p = base;
+        p.patternType = patterns[side];
+        std::vector<float> sideSpacings = spacings.empty() ? std::vector<float>{defaultSpacing(p)} : spacings;
+        for (float speed : speeds)
+            for (float accel : accels)
+                for (float z : zs)
+                    for (float spacing : sideSpacings)
+                        candidates.push_back(Candidate{side, speed, accel, z, spacing, 0, false, 0.0f, FilmStats{}});
+    }
+
+    WorkStealingPool pool(threads);
+    auto start = std::chrono::steady_clock::now();
+    pool.run(candidates.size(), 8, [&](size_t begin, size_t end, int) {
+        for (size_t i = begin; i < end; i++) {
+            ToolpathParams p = base;
+            p.patternType = patterns[candidates[i].side];
+            p.startX = SIM_DEFAULT_START_X[candidates[i].side];
+            p.startY = SIM_DEFAULT_START_Y[candidates[i].side];
+            evaluate(candidates[i], p, model, timing, res, minMil);
+        }
+    });
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    const Candidate* winners[4] = {nullptr, nullptr, nullptr, nullptr};
+    std::vector<const Candidate*> fronts[4];
+    float jobS = 0.0f;
+    bool jobComplete = true;
+    for (int side = 0; side < 4; side++) {
+        if (onlySide >= 0 && side != onlySide) continue;
+        fronts[side] = paretoFront(candidates, side);
+        winners[side] = fastestAcceptable(fronts[side], accept, maxMil);
+        if (winners[side]) jobS += winners[side]->cycleS;
+        else jobComplete = false;
+    }
+
+    if (json) {
+        printf("{\"evaluated\":%zu,\"ms\":%.1f,\"threads\":%d,\"steals\":%zu,\"sides\":[", candidates.size(), elapsedMs,
+               pool.threads(), pool.steals());
+        bool firstSide = true;
+        for (int side = 0; side < 4; side++) {
+            if (onlySide >= 0 && side != onlySide) continue;
+            printf("%s{\"side\":%d,\"name\":\"%s\",\"front\":[", firstSide ? "" : ",", side, SIM_SIDE_NAMES[side]);
+            firstSide = false;
+            for (size_t i = 0; i < fronts[side].size(); i++) {
+                const Candidate* c = fronts[side][i];
+                printf("%s{\"cycleS\":%.3f,\"quality\":%.4f,\"speedHz\":%.0f,\"accel\":%.0f,\"z\":%.2f,\"spacing\":%.3f,"
+                       "\"passes\":%d,\"minMil\":%.3f,\"maxMil\":%.3f,\"cov\":%.4f,\"overspray\":%.4f}",
+                       i ? "," : "", c->cycleS, c->stats.aboveMin, c->speedHz, c->accel, c->z, c->spacing, c->passes,
+                       c->stats.minMil, c->stats.maxMil, c->stats.cov, c->stats.overspray);
+            }
+            const Candidate* w = winners[side];
+            printf("],\"best\":%d}", w ? (int)(std::find(fronts[side].begin(), fronts[side].end(), w) - fronts[side].begin()) : -1);
+        }
+        if (jobComplete) printf("],\"jobS\":%.3f}\n", jobS);
+        else printf("],\"jobS\":null}\n");
+    } else {
+        printf("%zu combinations in %.1f ms on %d threads (%zu chunks stolen)\n", candidates.size(), elapsedMs,
+               pool.threads(), pool.steals());
+        for (int side = 0; side < 4; side++) {
+            if (onlySide >= 0 && side != onlySide) continue;
+            printf("\n%s - Pareto front (cycle time vs. fraction >= %.2f mil)\n", SIM_SIDE_NAMES[side], minMil);
+            printf("  %8s %7s %8s %8s %6s %8s %7s %8s %8s\n", "cycle s", "quality", "speed", "accel", "z", "spacing",
+                   "max mil", "cov", "overspr");
+            for (const Candidate* c : fronts[side]) {
+                printf("%s %8.2f %7.3f %8.0f %8.0f %6.2f %8.3f %7.2f %8.3f %8.3f\n", c == winners[side] ? "*" : " ",
+                       c->cycleS, c->stats.aboveMin, c->speedHz, c->accel, c->z, c->spacing, c->stats.maxMil,
+                       c->stats.cov, c->stats.overspray);
+            }
+            if (!winners[side]) printf("  no combination reaches %.0f%% without exceeding %.2f mil\n", accept * 100.0f, maxMil);
+        }
+        if (jobComplete) printf("\nFastest acceptable job: %.2f s painting\n\n", jobS);
+    }
+
+    FILE* out = stdout;
+    if (exportFile) {
+        out = fopen(exportFile, "w");
+        if (!out) {
+            perror(exportFile);
+            return 1;
+        }
+    }
+    if (exportFile || !json) writeExport(out, winners, base, pitch, patterns);
+    if (exportFile) fclose(out);
+    return jobComplete ? 0 : 3;
+}
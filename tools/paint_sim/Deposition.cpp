@@ -0,0 +1,333 @@
+#include "Deposition.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+typedef int32_t DepIVec __attribute__((vector_size(DEPOSITION_LANES * sizeof(int32_t))));
+
+static const float SQRT_2PI = 2.50662827463f;
+static const float FOOTPRINT_SIGMAS = 4.0f; // Footprint is cut off beyond this (6e-5 of the volume)
+
+// === Vector Math ===
+
+static inline DepVec splat(float v) {
+    return DepVec{} + v;
+}
+
+static inline DepVec laneIndex() {
+    DepVec v;
+    for (int i = 0; i < DEPOSITION_LANES; i++) v[i] = (float)i;
+    return v;
+}
+
+// exp(x) for x <= 0 (relative error ~2e-6): 2^n * p(r) with r in [-ln2/2, ln2/2]
+static inline DepVec vexpNeg(DepVec x) {
+    x = x < splat(-87.0f) ? splat(-87.0f) : x;
+    DepVec fn = x * 1.44269504f - 0.5f;
+    DepIVec n = __builtin_convertvector(fn, DepIVec);     // Truncates toward zero: round(x * log2e)
+    DepVec r = x - __builtin_convertvector(n, DepVec) * 0.69314718f;
+    DepVec p = splat(1.0f / 5040.0f);
+    p = p * r + 1.0f / 720.0f;
+    p = p * r + 1.0f / 120.0f;
+    p = p * r + 1.0f / 24.0f;
+    p = p * r + 1.0f / 6.0f;
+    p = p * r + 0.5f;
+    p = p * r + 1.0f;
+    p = p * r + 1.0f;
+    DepIVec bits = (n + 127) << 23;
+    return p * (DepVec)bits;
+}
+
+// erf(x), Abramowitz & Stegun 7.1.26 (absolute error < 1.5e-7)
+static inline DepVec verf(DepVec x) {
+    DepVec ax = x < 0.0f ? -x : x;
+    DepVec t = 1.0f / (1.0f + 0.3275911f * ax);
+    DepVec p = splat(1.061405429f);
+    p = p * t - 1.453152027f;
+    p = p * t + 1.421413741f;
+    p = p * t - 0.284496736f;
+    p = p * t + 0.254829592f;
+    DepVec y = 1.0f - p * t * vexpNeg(-ax * ax);
+    return x < 0.0f ? -y : y;
+}
+
+// === Grid ===
+
+bool filmGridInit(FilmGrid& grid, const FilmRect& rect, float res) {
+    grid.res = res;
+    grid.originX = floorf(rect.x0 / res) * res;
+    grid.originY = floorf(rect.y0 / res) * res;
+    int w = (int)ceilf((rect.x1 - grid.originX) / res) + 1;
+    grid.width = (w + DEPOSITION_LANES - 1) / DEPOSITION_LANES * DEPOSITION_LANES;
+    grid.height = (int)ceilf((rect.y1 - grid.originY) / res) + 1;
+    size_t bytes = (size_t)grid.width * grid.height * sizeof(float);
+    grid.cells = (float*)aligned_alloc(sizeof(DepVec), bytes);
+    if (!grid.cells) return false;
+    filmGridClear(grid);
+    return true;
+}
+
+void filmGridClear(FilmGrid& grid) {
+    memset(grid.cells, 0, (size_t)grid.width * grid.height * sizeof(float));
+}
+
+void filmGridFree(FilmGrid& grid) {
+    free(grid.cells);
+    grid.cells = nullptr;
+}
+
+// Cell range [lo, hi) covering [a, b] inches, clamped; columns are widened to whole vectors
+static void cellRange(float a, float b, float origin, float res, int limit, bool vectorAlign, int& lo, int& hi) {
+    lo = (int)floorf((a - origin) / res);
+    hi = (int)ceilf((b - origin) / res) + 1;
+    if (lo < 0) lo = 0;
+    if (hi > limit) hi = limit;
+    if (vectorAlign) {
+        lo = lo / DEPOSITION_LANES * DEPOSITION_LANES;
+        hi = (hi + DEPOSITION_LANES - 1) / DEPOSITION_LANES * DEPOSITION_LANES;
+        if (hi > limit) hi = limit;
+    }
+}
+
+static inline DepVec* rowVec(FilmGrid& grid, int row, int col) {
+    return (DepVec*)(grid.cells + (size_t)row * grid.width + col);
+}
+
+// === Kernels ===
+
+// Move along X: grid[row] += perp(y_row) * along(x)
+static void depositAlongX(FilmGrid& grid, float x0, float x1, float y, float scale, float sigma) {
+    float lo = fminf(x0, x1), hi = fmaxf(x0, x1);
+    float reach = FOOTPRINT_SIGMAS * sigma;
+    int c0, c1, r0, r1;
+    cellRange(lo - reach, hi + reach, grid.originX, grid.res, grid.width, true, c0, c1);
+    cellRange(y - reach, y + reach, grid.originY, grid.res, grid.height, false, r0, r1);
+    if (c0 >= c1 || r0 >= r1) return;
+
+    static thread_local std::vector<DepVec> along; // Scratch, reused between calls
+    int nv = (c1 - c0) / DEPOSITION_LANES;
+    along.resize(nv);
+    float k = 1.0f / (sqrtf(2.0f) * sigma);
+    float len = hi - lo;
+    DepVec lanes = laneIndex();
+    for (int v = 0; v < nv; v++) {
+        DepVec x = grid.originX + (lanes + (float)(c0 + v * DEPOSITION_LANES)) * grid.res;
+        DepVec s = x - lo; // The profile is symmetric, direction does not matter
+        along[v] = 0.5f * (verf((len - s) * k) + verf(s * k));
+    }
+    for (int r = r0; r < r1; r++) {
+        float d = grid.originY + r * grid.res - y;
+        float w = scale * expf(-d * d / (2.0f * sigma * sigma)) / (SQRT_2PI * sigma);
+        DepVec* row = rowVec(grid, r, c0);
+        for (int v = 0; v < nv; v++) row[v] += w * along[v];
+    }
+}
+
+// Move along Y: grid[row] += along(y_row) * perp(x)
+static void depositAlongY(FilmGrid& grid, float x, float y0, float y1, float scale, float sigma) {
+    float lo = fminf(y0, y1), hi = fmaxf(y0, y1);
+    float reach = FOOTPRINT_SIGMAS * sigma;
+    int c0, c1, r0, r1;
+    cellRange(x - reach, x + reach, grid.originX, grid.res, grid.width, true, c0, c1);
+    cellRange(lo - reach, hi + reach, grid.originY, grid.res, grid.height, false, r0, r1);
+    if (c0 >= c1 || r0 >= r1) return;
+
+    static thread_local std::vector<DepVec> perp;
+    int nv = (c1 - c0) / DEPOSITION_LANES;
+    perp.resize(nv);
+    float norm = scale / (SQRT_2PI * sigma);
+    float inv2s2 = 1.0f / (2.0f * sigma * sigma);
+    DepVec lanes = laneIndex();
+    for (int v = 0; v < nv; v++) {
+        DepVec d = grid.originX + (lanes + (float)(c0 + v * DEPOSITION_LANES)) * grid.res - x;
+        perp[v] = norm * vexpNeg(-d * d * inv2s2);
+    }
+    float k = 1.0f / (sqrtf(2.0f) * sigma);
+    float len = hi - lo;
+    for (int r = r0; r < r1; r++) {
+        float s = grid.originY + r * grid.res - lo;
+        float a = 0.5f * (erff((len - s) * k) + erff(s * k));
+        DepVec* row = rowVec(grid, r, c0);
+        for (int v = 0; v < nv; v++) row[v] += a * perp[v];
+    }
+}
+
+// Any direction: evaluate the closed form per cell
+static void depositGeneral(FilmGrid& grid, float x0, float y0, float x1, float y1, float scale, float sigma) {
+    float dx = x1 - x0, dy = y1 - y0;
+    float len = sqrtf(dx * dx + dy * dy);
+    float ux = dx / len, uy = dy / len;
+    float reach = FOOTPRINT_SIGMAS * sigma;
+    int c0, c1, r0, r1;
+    cellRange(fminf(x0, x1) - reach, fmaxf(x0, x1) + reach, grid.originX, grid.res, grid.width, true, c0, c1);
+    cellRange(fminf(y0, y1) - reach, fmaxf(y0, y1) + reach, grid.originY, grid.res, grid.height, false, r0, r1);
+
+    float norm = 0.5f * scale / (SQRT_2PI * sigma);
+    float inv2s2 = 1.0f / (2.0f * sigma * sigma);
+    float k = 1.0f / (sqrtf(2.0f) * sigma);
+    DepVec lanes = laneIndex();
+    for (int r = r0; r < r1; r++) {
+        float ry = grid.originY + r * grid.res - y0;
+        DepVec* row = rowVec(grid, r, c0);
+        for (int v = 0; v < (c1 - c0) / DEPOSITION_LANES; v++) {
+            DepVec rx = grid.originX + (lanes + (float)(c0 + v * DEPOSITION_LANES)) * grid.res - x0;
+            DepVec s = rx * ux + ry * uy;
+            DepVec d = ry * ux - rx * uy;
+            row[v] += norm * vexpNeg(-d * d * inv2s2) * (verf((len - s) * k) + verf(s * k));
+        }
+    }
+}
+
+float depositSegment(FilmGrid& grid, const DepositionModel& model,
+                     float x0, float y0, float x1, float y1, float speed, float sigma) {
+    float dx = x1 - x0, dy = y1 - y0;
+    float len = sqrtf(dx * dx + dy * dy);
+    if (len < 1e-6f || speed <= 0.0f || sigma <= 0.0f) return 0.0f;
+    float scale = model.flux / speed;
+    if (fabsf(dy) < 1e-6f) depositAlongX(grid, x0, x1, y0, scale, sigma);
+    else if (fabsf(dx) < 1e-6f) depositAlongY(grid, x0, y0, y1, scale, sigma);
+    else depositGeneral(grid, x0, y0, x1, y1, scale, sigma);
+    return len / speed;
+}
+
+// === Toolpath Replay ===
+
+static float sigmaForZ(const DepositionModel& model, float z) {
+    return model.sigma0 + model.sigmaPerZ * z;
+}
+
+static bool isXYMove(uint8_t type) {
+    return type == SEG_TRAVEL_XY || type == SEG_SWEEP || type == SEG_SHIFT || type == SEG_RAMP;
+}
+
+float depositToolpath(FilmGrid& grid, const DepositionModel& model, const Toolpath& path,
+                      float stepsPerInchXY, float stepsPerInchZ) {
+    bool gunOn = false;
+    float x = 0.0f, y = 0.0f; // Paths start from wherever the machine is; the first move is a travel
+    float sigma = sigmaForZ(model, 0.0f);
+    float sprayTime = 0.0f;
+    for (int i = 0; i < path.count; i++) {
+        const ToolpathSegment& seg = path.segments[i];
+        if (seg.gun != GUN_KEEP) gunOn = (seg.gun == GUN_ON);
+        if (seg.type == SEG_MOVE_Z) {
+            sigma = sigmaForZ(model, seg.x / stepsPerInchZ);
+        } else if (isXYMove(seg.type)) {
+            float nx = seg.x / stepsPerInchXY, ny = seg.y / stepsPerInchXY;
+            if (gunOn) sprayTime += depositSegment(grid, model, x, y, nx, ny, seg.speedHz / stepsPerInchXY, sigma);
+            x = nx;
+            y = ny;
+        }
+    }
+    return sprayTime;
+}
+
+bool toolpathSprayBounds(const Toolpath& path, float stepsPerInchXY, FilmRect& out) {
+    bool gunOn = false, any = false;
+    float x = 0.0f, y = 0.0f;
+    float shiftX = 0.0f, shiftY = 0.0f;
+    float sweepX = 0.0f, sweepY = 0.0f; // Direction of the last sweep
+    int shifts = 0;
+    out = FilmRect{0, 0, 0, 0};
+    for (int i = 0; i < path.count; i++) {
+        const ToolpathSegment& seg = path.segments[i];
+        if (seg.gun != GUN_KEEP) gunOn = (seg.gun == GUN_ON);
+        if (!isXYMove(seg.type)) continue;
+        float nx = seg.x / stepsPerInchXY, ny = seg.y / stepsPerInchXY;
+        if (gunOn) {
+            if (!any) out = FilmRect{x, y, x, y};
+            any = true;
+            out.x0 = fminf(out.x0, fminf(x, nx));
+            out.x1 = fmaxf(out.x1, fmaxf(x, nx));
+            out.y0 = fminf(out.y0, fminf(y, ny));
+            out.y1 = fmaxf(out.y1, fmaxf(y, ny));
+        }
+        if (seg.type == SEG_SWEEP) {
+            sweepX = nx - x;
+            sweepY = ny - y;
+        }
+        // Step-overs square to the sweeps (gun on or off) put the band edge half a step
+        // past the outer passes; angled rasters already end their sweeps on the edge
+        if (seg.type == SEG_SHIFT && fabsf(sweepX * (nx - x) + sweepY * (ny - y)) < 1e-6f) {
+            shiftX += fabsf(nx - x);
+            shiftY += fabsf(ny - y);
+            shifts++;
+        }
+        x = nx;
+        y = ny;
+    }
+    if (shifts > 0) {
+        out.x0 -= 0.5f * shiftX / shifts;
+        out.x1 += 0.5f * shiftX / shifts;
+        out.y0 -= 0.5f * shiftY / shifts;
+        out.y1 += 0.5f * shiftY / shifts;
+    }
+    return any;
+}
+
+float toolpathMaxSigma(const DepositionModel& model, const Toolpath& path, float stepsPerInchZ) {
+    float sigma = sigmaForZ(model, 0.0f);
+    for (int i = 0; i < path.count; i++) {
+        if (path.segments[i].type == SEG_MOVE_Z) {
+            sigma = fmaxf(sigma, sigmaForZ(model, path.segments[i].x / stepsPerInchZ));
+        }
+    }
+    return sigma;
+}
+
+// === Statistics ===
+
+void filmStats(const FilmGrid& grid, const FilmRect& target, float coverageFrac, float minFilmMil,
+               const DepositionModel& model, float sprayTimeS, FilmStats& out) {
+    int c0, c1, r0, r1;
+    cellRange(target.x0, target.x1, grid.originX, grid.res, grid.width, false, c0, c1);
+    cellRange(target.y0, target.y1, grid.originY, grid.res, grid.height, false, r0, r1);
+
+    // Only cells whose centre lies in the target
+    auto inside = [&](int c, int r) {
+        float x = grid.originX + c * grid.res, y = grid.originY + r * grid.res;
+        return x >= target.x0 && x <= target.x1 && y >= target.y0 && y <= target.y1;
+    };
+
+    double sum = 0.0, sumSq = 0.0;
+    long n = 0;
+    float mn = INFINITY, mx = 0.0f;
+    for (int r = r0; r < r1; r++) {
+        const float* row = grid.cells + (size_t)r * grid.width;
+        for (int c = c0; c < c1; c++) {
+            if (!inside(c, r)) continue;
+            float t = row[c];
+            sum += t;
+            sumSq += (double)t * t;
+            mn = fminf(mn, t);
+            mx = fmaxf(mx, t);
+            n++;
+        }
+    }
+    memset(&out, 0, sizeof(out));
+    out.sprayTimeS = sprayTimeS;
+    out.sprayedVolume = model.flux * sprayTimeS;
+    if (n == 0) return;
+
+    double mean = sum / n;
+    double var = sumSq / n - mean * mean;
+    float threshold = (float)(coverageFrac * mean);
+    long covered = 0, aboveMin = 0;
+    for (int r = r0; r < r1; r++) {
+        const float* row = grid.cells + (size_t)r * grid.width;
+        for (int c = c0; c < c1; c++) {
+            if (!inside(c, r)) continue;
+            if (row[c] >= threshold) covered++;
+            if (row[c] >= minFilmMil) aboveMin++;
+        }
+    }
+    out.minMil = mn;
+    out.maxMil = mx;
+    out.meanMil = (float)mean;
+    out.cov = mean > 0.0 ? (float)(sqrt(var > 0.0 ? var : 0.0) / mean) : 0.0f;
+    out.coverage = (float)covered / n;
+    out.aboveMin = (float)aboveMin / n;
+    double insideVolume = sum * grid.res * grid.res;
+    out.overspray = out.sprayedVolume > 0.0f ? (float)(1.0 - insideVolume / out.sprayedVolume) : 0.0f;
+    if (out.overspray < 0.0f) out.overspray = 0.0f; // Cell quantisation at the target edge
+}
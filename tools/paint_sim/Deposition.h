@@ -0,0 +1,105 @@
+#ifndef DEPOSITION_H
+#define DEPOSITION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "Painting/Patterns/ToolpathCompiler.h"
+
+// === Spray Deposition Model ===
+// The gun footprint is an isotropic 2D Gaussian whose width grows with the
+// paint Z height. A straight move at constant speed v with the gun on lays
+// down, at a point a distance d from the line and s along it,
+//
+//   t = flux / v * exp(-d^2 / 2 sigma^2) / (sqrt(2 pi) sigma)
+//         * (erf((L - s) / (sqrt(2) sigma)) + erf(s / (sqrt(2) sigma))) / 2
+//
+// which is the footprint integrated exactly along the segment. Axis-aligned
+// moves (every move the compiler currently emits) are separable, so a move is
+// a rank-1 update of the grid. Other directions use a per-cell kernel.
+// Both are written with GCC vector extensions, 8 floats per row step.
+//
+// Acceleration ramps are ignored: moves are treated as running at speedHz
+// end to end.
+
+#define DEPOSITION_LANES 8
+
+typedef float DepVec __attribute__((vector_size(DEPOSITION_LANES * sizeof(float))));
+
+struct DepositionModel {
+    float flux;        // Film volume rate (mil * in^2 / s), i.e. thickness in mils
+    float sigma0;      // Footprint sigma at Z = 0 (inches)
+    float sigmaPerZ;   // Sigma growth per inch of Z
+};
+
+struct FilmGrid {
+    float originX;     // Machine X/Y of cell (0,0) centre (inches)
+    float originY;
+    float res;         // Cell size (inches)
+    int width;         // Cells in X (multiple of DEPOSITION_LANES)
+    int height;
+    float* cells;      // Row-major thickness in mils, 32-byte aligned
+};
+
+struct FilmRect {
+    float x0, y0, x1, y1;   // Inches, x0 < x1, y0 < y1
+};
+
+struct FilmStats {
+    float minMil;       // Inside the target
+    float maxMil;
+    float meanMil;
+    float cov;          // stddev / mean inside the target
+    float coverage;     // Fraction of target cells at or above coverageFrac * mean
+    float aboveMin;     // Fraction of target cells at or above the required film (minFilmMil)
+    float overspray;    // Fraction of sprayed volume landing outside the target
+    float sprayTimeS;   // Gun-on motion time
+    float sprayedVolume; // mil * in^2
+};
+
+/**
+ * @brief Allocate a zeroed grid covering rect (cells are centred on the res lattice).
+ * @return false if allocation fails.
+ */
+bool filmGridInit(FilmGrid& grid, const FilmRect& rect, float res);
+void filmGridClear(FilmGrid& grid);
+void filmGridFree(FilmGrid& grid);
+
+/**
+ * @brief Deposit one straight gun-on move.
+ * @param x0,y0,x1,y1 Endpoints (inches).
+ * @param speed Move speed (inches/s).
+ * @param sigma Footprint sigma (inches).
+ * @return Spray time of the move (s).
+ */
+float depositSegment(FilmGrid& grid, const DepositionModel& model,
+                     float x0, float y0, float x1, float y1, float speed, float sigma);
+
+/**
+ * @brief Replay a compiled toolpath, depositing every move made with the gun on.
+ * Gun state follows the segments (GUN_ON/GUN_OFF, GUN_KEEP carries over);
+ * the gun starts off. Z moves set the footprint sigma.
+ * @return Total spray time (s).
+ */
+float depositToolpath(FilmGrid& grid, const DepositionModel& model, const Toolpath& path,
+                      float stepsPerInchXY, float stepsPerInchZ);
+
+/**
+ * @brief Bounds of the gun-on moves, the target the film is judged on.
+ * Widened across axis-aligned passes by half the step-over, so each pass owns
+ * the strip around it (angled rasters already end their sweeps on the grid
+ * edge). Returns false if the path never sprays.
+ */
+bool toolpathSprayBounds(const Toolpath& path, float stepsPerInchXY, FilmRect& out);
+
+/**
+ * @brief Largest footprint sigma the path uses (for sizing the grid margin).
+ */
+float toolpathMaxSigma(const DepositionModel& model, const Toolpath& path, float stepsPerInchZ);
+
+/**
+ * @brief Thickness statistics inside target.
+ */
+void filmStats(const FilmGrid& grid, const FilmRect& target, float coverageFrac, float minFilmMil,
+               const DepositionModel& model, float sprayTimeS, FilmStats& out);
+
+#endif // DEPOSITION_H
@@ -0,0 +1,54 @@
+#ifndef SIM_SIDES_H
+#define SIM_SIDES_H
+
+#include "Painting/Patterns/ToolpathCompiler.h"
+
+// === Firmware Defaults for the Host Tools ===
+// Side directions and settings defaults as the firmware has them, so the
+// host tools compile the same toolpaths the machine would run.
+
+static const char* const SIM_SIDE_NAMES[4] = {"Back", "Right", "Front", "Left"};
+
+// Mirrors SIDE_CONFIG_* in src/Painting/Patterns/PaintPattern_<Side>.cpp
+static const ToolpathSideConfig SIM_SIDE_CONFIGS[4] = {
+    {"Back", 0, -1, -1, true, false},
+    {"Right", 90, +1, +1, true, true},
+    {"Front", 180, +1, +1, true, false},
+    {"Left", 270, +1, +1, true, false},
+};
+
+static const int SIM_DEFAULT_PATTERN[4] = {0, 90, 0, 90}; // paintPatternType[] defaults
+static const float SIM_DEFAULT_START_X[4] = {25.0f, 25.0f, 25.0f, 25.0f}; // paintStartX[] defaults
+static const float SIM_DEFAULT_START_Y[4] = {30.0f, 30.0f, 30.0f, 30.0f}; // paintStartY[] defaults
+
+/**
+ * @brief Compiler inputs as buildToolpathParams() fills them from the default settings.
+ * The start is the Back side's; per-side starts are SIM_DEFAULT_START_X/Y.
+ * Placement (gun/pattern offsets) is left out: it moves the machine, not the spray.
+ */
+static inline void simDefaultParams(ToolpathParams& p) {
+    p = ToolpathParams{};
+    p.startX = SIM_DEFAULT_START_X[0];
+    p.startY = SIM_DEFAULT_START_Y[0];
+    p.startZ = 1.0f;
+    p.trayWidth = 24.0f;    // trayWidth schema default
+    p.trayHeight = 18.0f;   // trayHeight schema default
+    p.gridCols = 4;
+    p.gridRows = 5;
+    p.itemWidth = 3.0f;
+    p.itemHeight = 3.0f;
+    // Gaps derived the way calculateAndSetGridSpacing() does (0.25 in border)
+    p.gapX = (p.trayWidth - 2 * 0.25f - p.gridCols * p.itemWidth) / (p.gridCols - 1);
+    p.gapY = (p.trayHeight - 2 * 0.25f - p.gridRows * p.itemHeight) / (p.gridRows - 1);
+    p.speedHz = 10000.0f;
+    p.zSpeedHz = 5000.0f;
+    p.stepsPerInchXY = 254.0f;
+    p.stepsPerInchZ = 254.0f;
+    p.sprayWidth = 0.0f;    // paintSprayWidth_inch[] default: one pass per item
+    p.sprayOverlap = 0.25f; // paintSprayOverlap_pct[] default
+    p.sweepAccel = 0.0f;    // sweepOT default off
+    p.travelX = 30.0f;      // X/Y_MAX_TRAVEL_POS_INCH
+    p.travelY = 30.0f;
+}
+
+#endif // SIM_SIDES_H
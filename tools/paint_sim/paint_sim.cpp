@@ -0,0 +1,262 @@
+// Host-side paint deposition simulator.
+//
+// Replays side toolpaths through the spray model in Deposition.h and reports
+// film thickness, uniformity, coverage and overspray per side. Toolpaths are
+// either compiled here with the firmware's ToolpathCompiler (same settings
+// defaults as the firmware, override with the flags below) or loaded from
+// GET_TOOLPATH replies saved from a running machine.
+//
+// Build (from the repo root):
+//     g++ -O3 -march=native -std=c++17 -I src -o paint_sim tools/paint_sim/paint_sim.cpp
+//         tools/paint_sim/Deposition.cpp src/Painting/Patterns/ToolpathCompiler.cpp
+//
+// Usage:
+//     paint_sim [options]                      Simulate all four sides
+//     paint_sim --toolpath back.json ...       Simulate captured GET_TOOLPATH replies
+//
+// Options (inches unless noted):
+//     --side N            Only side N (0=Back, 1=Right, 2=Front, 3=Left)
+//     --speed HZ          Paint speed in steps/s for all sides (default 10000)
+//     --z IN              Paint Z height (default 1.0)
+//     --pattern DEG       0 = Up/Down, 90 = Sideways, other 1-179 = raster angle, for all sides (default 0/90/0/90)
+//     --cols N --rows N   Pass counts (default 4 / 5)
+//     --gap-x IN --gap-y IN  Item gaps (default 0)
+//     --tray-w IN --tray-h IN  Sweep lengths (default 24 / 18)
+//     --start-x IN --start-y IN  Pattern start for all sides (default: the firmware's per-side starts)
+//     --spray-w IN        Spray fan width for pass planning (default 0 = one pass per item)
+//     --overlap PCT       Required pass overlap with --spray-w (default 25)
+//     --run-accel A       Sweep run-in/run-out for this accel, steps/s^2 (default 0 = off,
+//                         SET_SWEEP_OVERTRAVEL 1 uses the firmware's 20000)
+//     --flux F            Spray rate, mil*in^2/s (default 75)
+//     --sigma0 IN --sigma-per-z IN  Footprint sigma = sigma0 + sigma-per-z * Z (default 0.25 / 0.5)
+//     --res IN            Grid cell size (default 0.05)
+//     --coverage FRAC     Coverage threshold as a fraction of mean thickness (default 0.8)
+//     --min-mil MIL       Required film thickness for the "ok" column (default 0.5)
+//     --repeat N          Run the whole job N times and report the time per job
+//     --json              One JSON object instead of the table
+//
+// The spray model constants are placeholders until fitted to measured panels.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include "Deposition.h"
+#include "SimSides.h"
+
+struct SimSide {
+    int side;
+    float stepsPerInchXY;
+    float stepsPerInchZ;
+    Toolpath path;
+};
+
+struct SimResult {
+    FilmRect target;
+    FilmStats stats;
+};
+
+static void usage() {
+    fprintf(stderr, "usage: paint_sim [--side N] [--speed HZ] [--z IN] [--pattern DEG] [--cols N] [--rows N]\n"
+                    "                 [--gap-x IN] [--gap-y IN] [--tray-w IN] [--tray-h IN] [--start-x IN] [--start-y IN]\n"
+                    "                 [--spray-w IN] [--overlap PCT] [--run-accel A] [--flux F] [--sigma0 IN] [--sigma-per-z IN] [--res IN] [--coverage FRAC] [--min-mil MIL]\n"
+                    "                 [--repeat N] [--json] [--toolpath FILE ...]\n");
+    exit(2);
+}
+
+// Reads a GET_TOOLPATH reply:
+// {"status":"Toolpath","side":n,"stepsPerInchXY":f,"stepsPerInchZ":f,"segments":[[type,gun,pass,x,y,speedHz],...]}
+static bool loadToolpathJson(const char* file, SimSide& out) {
+    FILE* f = fopen(file, "rb");
+    if (!f) {
+        perror(file);
+        return false;
+    }
+    std::vector<char> text;
+    char chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) text.insert(text.end(), chunk, chunk + n);
+    fclose(f);
+    text.push_back('\0');
+
+    auto number = [&](const char* key, double& value) {
+        const char* p = strstr(text.data(), key);
+        if (!p) return false;
+        p = strchr(p + strlen(key), ':');
+        if (!p) return false;
+        value = strtod(p + 1, nullptr);
+        return true;
+    };
+    double side, spiXY, spiZ;
+    const char* segs = strstr(text.data(), "\"segments\"");
+    if (!number("\"side\"", side) || !number("\"stepsPerInchXY\"", spiXY) || !number("\"stepsPerInchZ\"", spiZ) || !segs ||
+        side < 0 || side > 3) {
+        fprintf(stderr, "%s: not a GET_TOOLPATH reply\n", file);
+        return false;
+    }
+    out.side = (int)side;
+    out.stepsPerInchXY = (float)spiXY;
+    out.stepsPerInchZ = (float)spiZ;
+    memset(&out.path, 0, sizeof(out.path));
+    out.path.side = (uint8_t)side;
+
+    const char* p = strchr(segs, '[');
+    if (!p) return false;
+    p++;
+    while (true) {
+        while (*p == ' ' || *p == ',' || *p == '\n' || *p == '\r') p++;
+        if (*p != '[') break;
+        long v[6];
+        p++;
+        for (int i = 0; i < 6; i++) {
+            char* end;
+            v[i] = strtol(p, &end, 10);
+            if (end == p) {
+                fprintf(stderr, "%s: bad segment %d\n", file, out.path.count);
+                return false;
+            }
+            p = end;
+            while (*p == ' ' || *p == ',') p++;
+        }
+        if (*p != ']' || out.path.count >= TOOLPATH_MAX_SEGMENTS) {
+            fprintf(stderr, "%s: bad segment %d\n", file, out.path.count);
+            return false;
+        }
+        p++;
+        ToolpathSegment& seg = out.path.segments[out.path.count++];
+        seg.type = (uint8_t)v[0];
+        seg.gun = (uint8_t)v[1];
+        seg.pass = (uint16_t)v[2];
+        seg.x = (int32_t)v[3];
+        seg.y = (int32_t)v[4];
+        seg.speedHz = (uint32_t)v[5];
+    }
+    out.path.valid = 1;
+    return true;
+}
+
+static bool simulateSide(const SimSide& s, const DepositionModel& model, float res, float coverageFrac, float minMil,
+                         FilmGrid& grid, SimResult& out) {
+    if (!toolpathSprayBounds(s.path, s.stepsPerInchXY, out.target)) return false;
+    float margin = 4.0f * toolpathMaxSigma(model, s.path, s.stepsPerInchZ) + res;
+    if (!grid.cells) {
+        FilmRect area = {out.target.x0 - margin, out.target.y0 - margin, out.target.x1 + margin, out.target.y1 + margin};
+        if (!filmGridInit(grid, area, res)) return false;
+    } else {
+        filmGridClear(grid);
+    }
+    float sprayTime = depositToolpath(grid, model, s.path, s.stepsPerInchXY, s.stepsPerInchZ);
+    filmStats(grid, out.target, coverageFrac, minMil, model, sprayTime, out.stats);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    ToolpathParams params;
+    simDefaultParams(params);
+    int patternOverride = -1;
+    int onlySide = -1;
+    float startX = NAN, startY = NAN; // NAN = per-side default
+
+    DepositionModel model = {75.0f, 0.25f, 0.5f};
+    float res = 0.05f;
+    float coverageFrac = 0.8f;
+    float minMil = 0.5f;
+    int repeat = 1;
+    bool json = false;
+    std::vector<SimSide> sides;
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool hasValue = i + 1 < argc;
+        auto value = [&]() { if (!hasValue) usage(); return (float)atof(argv[++i]); };
+        if (!strcmp(a, "--side")) onlySide = (int)value();
+        else if (!strcmp(a, "--speed")) params.speedHz = value();
+        else if (!strcmp(a, "--z")) params.startZ = value();
+        else if (!strcmp(a, "--pattern")) patternOverride = (int)value();
+        else if (!strcmp(a, "--cols")) params.gridCols = (int)value();
+        else if (!strcmp(a, "--rows")) params.gridRows = (int)value();
+        else if (!strcmp(a, "--gap-x")) params.gapX = value();
+        else if (!strcmp(a, "--gap-y")) params.gapY = value();
+        else if (!strcmp(a, "--tray-w")) params.trayWidth = value();
+        else if (!strcmp(a, "--tray-h")) params.trayHeight = value();
+        else if (!strcmp(a, "--start-x")) startX = value();
+        else if (!strcmp(a, "--start-y")) startY = value();
+        else if (!strcmp(a, "--spray-w")) params.sprayWidth = value();
+        else if (!strcmp(a, "--overlap")) params.sprayOverlap = value() / 100.0f;
+        else if (!strcmp(a, "--run-accel")) params.sweepAccel = value();
+        else if (!strcmp(a, "--flux")) model.flux = value();
+        else if (!strcmp(a, "--sigma0")) model.sigma0 = value();
+        else if (!strcmp(a, "--sigma-per-z")) model.sigmaPerZ = value();
+        else if (!strcmp(a, "--res")) res = value();
+        else if (!strcmp(a, "--coverage")) coverageFrac = value();
+        else if (!strcmp(a, "--min-mil")) minMil = value();
+        else if (!strcmp(a, "--repeat")) repeat = (int)value();
+        else if (!strcmp(a, "--json")) json = true;
+        else if (!strcmp(a, "--toolpath")) {
+            if (!hasValue) usage();
+            SimSide s;
+            if (!loadToolpathJson(argv[++i], s)) return 1;
+            sides.push_back(s);
+        } else usage();
+    }
+    if (res <= 0.0f || repeat < 1 || onlySide > 3) usage();
+
+    if (sides.empty()) {
+        for (int side = 0; side < 4; side++) {
+            if (onlySide >= 0 && side != onlySide) continue;
+            SimSide s;
+            s.side = side;
+            s.stepsPerInchXY = params.stepsPerInchXY;
+            s.stepsPerInchZ = params.stepsPerInchZ;
+            ToolpathParams p = params;
+            p.patternType = patternOverride >= 0 ? patternOverride : SIM_DEFAULT_PATTERN[side];
+            p.startX = isnan(startX) ? SIM_DEFAULT_START_X[side] : startX;
+            p.startY = isnan(startY) ? SIM_DEFAULT_START_Y[side] : startY;
+            if (!compileSideToolpath(SIM_SIDE_CONFIGS[side], p, s.path)) {
+                fprintf(stderr, "side %d: toolpath does not compile (pattern %d)\n", side, p.patternType);
+                return 1;
+            }
+            s.path.side = (uint8_t)side;
+            sides.push_back(s);
+        }
+    }
+
+    std::vector<FilmGrid> grids(sides.size(), FilmGrid{});
+    std::vector<SimResult> results(sides.size());
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeat; r++) {
+        for (size_t i = 0; i < sides.size(); i++) {
+            if (!simulateSide(sides[i], model, res, coverageFrac, minMil, grids[i], results[i])) {
+                fprintf(stderr, "side %d: nothing sprayed or out of memory\n", sides[i].side);
+                return 1;
+            }
+        }
+    }
+    double jobMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repeat;
+
+    if (json) {
+        printf("{\"jobMs\":%.3f,\"res\":%.3f,\"sides\":[", jobMs, res);
+    } else {
+        printf("%-6s %8s %8s %8s %7s %8s %7s %9s %8s\n", "side", "min mil", "max mil", "mean", "cov", "coverage", "ok", "overspray", "spray s");
+    }
+    for (size_t i = 0; i < sides.size(); i++) {
+        const FilmStats& st = results[i].stats;
+        const FilmRect& t = results[i].target;
+        if (json) {
+            printf("%s{\"side\":%d,\"name\":\"%s\",\"target\":[%.3f,%.3f,%.3f,%.3f],\"minMil\":%.4f,\"maxMil\":%.4f,"
+                   "\"meanMil\":%.4f,\"cov\":%.4f,\"coverage\":%.4f,\"aboveMin\":%.4f,\"overspray\":%.4f,\"sprayS\":%.3f}",
+                   i ? "," : "", sides[i].side, SIM_SIDE_NAMES[sides[i].side], t.x0, t.y0, t.x1, t.y1, st.minMil, st.maxMil,
+                   st.meanMil, st.cov, st.coverage, st.aboveMin, st.overspray, st.sprayTimeS);
+        } else {
+            printf("%-6s %8.3f %8.3f %8.3f %7.3f %8.3f %7.3f %9.3f %8.2f\n", SIM_SIDE_NAMES[sides[i].side], st.minMil, st.maxMil,
+                   st.meanMil, st.cov, st.coverage, st.aboveMin, st.overspray, st.sprayTimeS);
+        }
+    }
+    if (json) printf("]}\n");
+    else printf("%zu side(s) in %.3f ms per job (grid %.3f in)\n", sides.size(), jobMs, res);
+
+    for (FilmGrid& g : grids) filmGridFree(g);
+    return 0;
+}